@@ -0,0 +1,80 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantBookView.h"
+#include "QuantCalculator.h"
+
+namespace Quant
+{
+	class QuantOrderbook;
+
+	// Immutable copy of a book at one version
+	struct BookSnapshot
+	{
+		EXCHANGE_API exchange = EXCHANGE_API::NONE;
+		QString symbol;
+		quint64 version = 0;
+		qint64 timestamp_ns = 0; // When the version was applied, since the epoch
+		bool stale = false;
+		std::vector<BookLevel> bids;
+		std::vector<BookLevel> asks;
+		FlowFeatures flow;
+
+		BookView View() const;
+
+		// Computed by the first reader and shared by all the others; the version never changes
+		const BookFeatures& Features(FeaturesFn compute_features) const;
+
+	private:
+		mutable std::once_flag m_features_once;
+		mutable BookFeatures m_features;
+	};
+
+	/**
+	 * Latest version of every followed book, readable from any thread
+	 *
+	 * Each update of a registered book is copied into a new immutable snapshot on the
+	 * book's own thread and swapped in atomically; readers hold a shared_ptr, so a
+	 * snapshot stays valid for as long as they use it and the book thread never waits
+	 * for them. Lets threads that own no book (the cost service workers) compute on the
+	 * latest book without going through the GUI or an ingest thread.
+	 */
+	class QuantBookSnapshots : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantBookSnapshots(QObject* parent = nullptr);
+
+	public:
+		// Snapshots the book after each of its updates, on the book's thread
+		void AddOrderbook(QuantOrderbook* orderbook);
+
+		// Any thread; nullptr for a book that is not followed, an empty snapshot before its first update
+		std::shared_ptr<const BookSnapshot> Latest(EXCHANGE_API exchange, const char* symbol) const;
+		std::shared_ptr<const BookSnapshot> Latest(EXCHANGE_API exchange, const QString& symbol) const;
+
+	private:
+		struct Entry
+		{
+			std::shared_ptr<const BookSnapshot> snapshot; // std::atomic_load / std::atomic_store only
+		};
+
+		void Capture(const QuantOrderbook& orderbook, Entry& entry);
+		static std::string KeyOf(EXCHANGE_API exchange, const char* symbol);
+
+	private:
+		// Entries are added while books are registered and never removed
+		mutable std::shared_mutex m_mutex;
+		std::unordered_map<std::string, std::unique_ptr<Entry>> m_entries;
+	};
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <QtGlobal>
+
+namespace Quant
+{
+	/**
+	 * Numeric order book level as consumed by the calculator kernels.
+	 * Prices and amounts are parsed once when the book is updated, so the
+	 * per-tick path never touches QVariant or QString.
+	 */
+	struct BookLevel
+	{
+		double price = 0.0;
+		double amount = 0.0;
+	};
+
+	/**
+	 * Non-owning view over one side of the book, best level first
+	 * (descending prices for bids, ascending prices for asks).
+	 */
+	struct BookSide
+	{
+		const BookLevel* levels = nullptr;
+		int size = 0;
+
+		bool empty() const { return size <= 0; }
+		const BookLevel& operator[](int idx) const { return levels[idx]; }
+		const BookLevel* begin() const { return levels; }
+		const BookLevel* end() const { return levels + size; }
+	};
+
+	/**
+	 * Order-flow features of a book as of its last update, over a short rolling
+	 * window (QuantMicrostructure). Flows are in base units, positive for buying
+	 * pressure: bids added or asks taken. Depth 0 is the best level (Cont, Kukanov
+	 * and Stoikov's OFI), the deeper ones count every level within a band of the
+	 * best price.
+	 */
+	struct FlowFeatures
+	{
+		static constexpr int ofi_depths = 3;
+
+		bool valid = false; // The window saw updates and the book has both sides
+
+		double ofi[ofi_depths] = {};
+		double ofi_normalized[ofi_depths] = {}; // Net over gross flow, -1 to 1
+		double microprice = 0.0;                // Best prices weighted by the opposite queue
+
+		// Taken off the best queues by trades and cancels, base units per second,
+		// and the same over the queue now there
+		double bid_depletion_rate = 0.0;
+		double ask_depletion_rate = 0.0;
+		double bid_turnover = 0.0;
+		double ask_turnover = 0.0;
+
+		double quote_intensity = 0.0;  // Best level changes per second
+		double update_intensity = 0.0; // Level changes per second
+	};
+
+	/**
+	 * Non-owning view over both sides of the book. The owner guarantees the
+	 * underlying storage stays unchanged while the view is in use.
+	 */
+	struct BookView
+	{
+		BookSide bids;
+		BookSide asks;
+		quint64 version = 0;
+		const FlowFeatures* flow = nullptr; // nullptr when the owner does not follow the flow
+	};
+
+	/**
+	 * Best bid and ask with the features that only depend on them. Versioned apart
+	 * from the depth, so a BBO channel can move it without touching the levels.
+	 */
+	struct TopOfBook
+	{
+		BookLevel bid;
+		BookLevel ask;
+		double mid_price = 0.0;
+		double spread = 0.0;   // Relative to the mid, as in BookFeatures
+		quint64 version = 0;
+	};
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+
+#include "QuantCalculator.h"
+
+namespace Quant
+{
+	/**
+	 * Memoized calculations on one book
+	 *
+	 * Two tiers, both keyed by the book version:
+	 *  - the book features (spread, depth, volatility, maker ratio), computed once per
+	 *    version, so a new input on an unchanged book only costs the sweep;
+	 *  - whole results, keyed by the version and the complete input, so asking again
+	 *    for a result already computed on that version costs a hash lookup.
+	 *
+	 * A new book version makes every entry of the older ones unreachable; nothing
+	 * has to be flushed. Anything outside the version and the input that a result
+	 * depends on (the book followed, the exchange's kernels and fees) must Clear() the
+	 * cache when it changes. Views with version 0 carry no version and bypass it.
+	 *
+	 * Not synchronized, one per calculator context.
+	 */
+	class QuantCalculationCache
+	{
+	public:
+		// The features of this version of the book, computed on the first call
+		const BookFeatures& Features(const BookView& book, FeaturesFn compute_features);
+
+		bool FindResult(const BookView& book, const CalculationInput& input, CalculationOutput& output) const;
+		void StoreResult(const BookView& book, const CalculationInput& input, const CalculationOutput& output);
+
+		void Clear();
+
+	private:
+		static constexpr int result_slots = 64; // Direct mapped, power of two
+
+		struct ResultEntry
+		{
+			quint64 version = 0; // 0 for an empty slot
+			CalculationInput input;
+			CalculationOutput output;
+		};
+
+		static size_t SlotOf(quint64 version, const CalculationInput& input);
+		static bool SameInput(const CalculationInput& lhs, const CalculationInput& rhs);
+
+	private:
+		quint64 m_features_version = 0;
+		BookFeatures m_features;
+		BookFeatures m_unversioned_features; // Last result for a version 0 view, never reused
+
+		std::array<ResultEntry, result_slots> m_results;
+	};
+}
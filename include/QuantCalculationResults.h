@@ -14,6 +14,20 @@ namespace Quant
 		Q_PROPERTY(double maker_ratio READ MakerRation WRITE SetMakerRation NOTIFY ResultsChanged)
 		Q_PROPERTY(double volatility READ Volatility WRITE SetVolatility NOTIFY ResultsChanged)
 		Q_PROPERTY(double processing_time READ ProcessingTime WRITE SetProcessingTime NOTIFY ResultsChanged)
+		Q_PROPERTY(bool liquidity_exhausted READ LiquidityExhausted WRITE SetLiquidityExhausted NOTIFY ResultsChanged)
+		Q_PROPERTY(double unfilled_usd READ UnfilledUSD WRITE SetUnfilledUSD NOTIFY ResultsChanged)
+
+		// Same order swept across every configured venue, 0 venues without a consolidated book
+		Q_PROPERTY(int consolidated_venues READ ConsolidatedVenues NOTIFY ResultsChanged)
+		Q_PROPERTY(double consolidated_crypto_amount READ ConsolidatedCryptoAmount NOTIFY ResultsChanged)
+		Q_PROPERTY(double consolidated_cost READ ConsolidatedCost NOTIFY ResultsChanged)
+
+		// Transient impact of the order worked in equal slices, and of our recorded fills, in percentage
+		Q_PROPERTY(int sliced_slices READ SlicedSlices NOTIFY ResultsChanged)
+		Q_PROPERTY(double sliced_slice_seconds READ SlicedSliceSeconds NOTIFY ResultsChanged)
+		Q_PROPERTY(double sliced_impact READ SlicedImpact NOTIFY ResultsChanged)
+		Q_PROPERTY(double fill_impact READ FillImpact NOTIFY ResultsChanged)
+		Q_PROPERTY(bool propagator_calibrated READ PropagatorCalibrated NOTIFY ResultsChanged)
 
 	public:
 		QuantCalculationResults(QObject* parent = nullptr);
@@ -27,6 +41,10 @@ namespace Quant
 		void SetMakerRation(double maker_taker_ratio);
 		void SetVolatility(double volatility);
 		void SetProcessingTime(double processing_time);
+		void SetLiquidityExhausted(bool exhausted);
+		void SetUnfilledUSD(double unfilled_usd);
+		void SetConsolidated(int venues, double crypto_amount, double cost);
+		void SetTransientImpact(int slices, double slice_seconds, double sliced_impact, double fill_impact, bool calibrated);
 
 	public:
 		double Slippage() const { return m_slippage; }
@@ -37,6 +55,16 @@ namespace Quant
 		double MakerRation() const { return m_maker_ratio; }
 		double Volatility() const { return m_volatility; }
 		double ProcessingTime() const { return m_processing_time; }
+		bool LiquidityExhausted() const { return m_liquidity_exhausted; }
+		double UnfilledUSD() const { return m_unfilled_usd; }
+		int ConsolidatedVenues() const { return m_consolidated_venues; }
+		double ConsolidatedCryptoAmount() const { return m_consolidated_crypto_amount; }
+		double ConsolidatedCost() const { return m_consolidated_cost; }
+		int SlicedSlices() const { return m_sliced_slices; }
+		double SlicedSliceSeconds() const { return m_sliced_slice_seconds; }
+		double SlicedImpact() const { return m_sliced_impact; }
+		double FillImpact() const { return m_fill_impact; }
+		bool PropagatorCalibrated() const { return m_propagator_calibrated; }
 
 	signals:
 		void ResultsChanged();
@@ -50,5 +78,15 @@ namespace Quant
 		double m_maker_ratio = 0.0;
 		double m_volatility = 0.0;
 		double m_processing_time = 0.0;
+		bool m_liquidity_exhausted = false;
+		double m_unfilled_usd = 0.0;
+		int m_consolidated_venues = 0;
+		double m_consolidated_crypto_amount = 0.0;
+		double m_consolidated_cost = 0.0; // Fees and slippage, USD
+		int m_sliced_slices = 0;
+		double m_sliced_slice_seconds = 0.0;
+		double m_sliced_impact = 0.0;
+		double m_fill_impact = 0.0;
+		bool m_propagator_calibrated = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,411 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantBookView.h"
+#include "QuantExchangePolicy.h"
+#include "QuantPropagator.h"
+#include "QuantTracer.h"
+
+namespace Quant
+{
+	// Typed calculation inputs, read once from QuantInputHandler per calculation
+	struct CalculationInput
+	{
+		ORDER_TYPE order_type = ORDER_TYPE::MARKET;
+		ORDER_SIDE order_side = ORDER_SIDE::BUY;
+		FEE_TIER fee_tier = FEE_TIER::VIP_0;
+		double usd_amount = 0.0;
+		double volatility = 0.0;
+		bool volatility_enabled = false;
+	};
+
+	// Book-derived values shared by every estimator of one calculation
+	struct BookFeatures
+	{
+		double best_bid = 0.0;
+		double best_ask = 0.0;
+		double mid_price = 0.0;
+		double spread = 0.0;
+		double bid_depth = 0.0;
+		double ask_depth = 0.0;
+		double volatility = 0.0;
+		double maker_ratio = 0.0;
+		double maker_logit = 0.0; // The logistic's argument, for the flow terms added per order side
+
+		FlowFeatures flow; // Copied from the view, invalid when it carries none
+	};
+
+	struct CalculationOutput
+	{
+		double volatility = 0.0;
+		double fees = 0.0;
+		double slippage = 0.0;
+		double market_impact = 0.0;
+		double market_order_cost = 0.0;
+		double net_cost = 0.0;
+		double crypto_amount = 0.0;
+		double maker_ratio = 0.0;
+
+		// The order is larger than the visible book; the figures cover the fillable part
+		bool liquidity_exhausted = false;
+		double unfilled_usd = 0.0;
+	};
+
+	using CalculatorFn = CalculationOutput(*)(const CalculationInput&, const BookView&, const FeeSchedule&);
+	using FeaturesFn = BookFeatures(*)(const BookView&);
+	using EstimatorFn = CalculationOutput(*)(const CalculationInput&, const BookView&, const FeeSchedule&, const BookFeatures&);
+	using PropagatorFn = PropagatorParams(*)(double, const BookFeatures&, ORDER_SIDE);
+	using SlicedImpactFn = double(*)(QuantPropagator&, double, int, double, double, const BookFeatures&, ORDER_SIDE, const PropagatorParams*);
+
+	// The two halves of Evaluate(), for callers that reuse the book features across inputs, and the propagator's
+	struct CalculatorKernels
+	{
+		FeaturesFn compute_features = nullptr;
+		EstimatorFn evaluate = nullptr;
+		PropagatorFn propagator_params = nullptr;
+		SlicedImpactFn sliced_impact = nullptr;
+	};
+
+	/**
+	 * Statically dispatched calculator
+	 *
+	 * All kernels are static and inline; the exchange policy supplies fee schedule,
+	 * tick/lot sizes and model coefficients as compile-time constants. The models
+	 * themselves are documented on QuantOKXCalculator, which forwards to
+	 * QuantCalculator<OKXPolicy>.
+	 *
+	 * The per-tick entry point is Evaluate(). QuantCalculatorContext resolves it once
+	 * per exchange selection through ResolveCalculator(), so a tick costs one indirect
+	 * call and no QVariant unboxing.
+	 *
+	 * Kernels are pure functions of their arguments: fee rates come from the caller's
+	 * immutable schedule and there is no static state, so any number of threads may
+	 * evaluate concurrently.
+	 */
+	template <typename ExchangePolicy>
+	class QuantCalculator
+	{
+	public:
+		using Policy = ExchangePolicy;
+
+	public:
+		static constexpr FeeRate GetFeeRates(FEE_TIER tier, const FeeSchedule& fees = Policy::fee_schedule)
+		{
+			const int idx = static_cast<int>(tier);
+			return (idx >= 0 && idx < fee_tier_count) ? fees[idx] : fees[0];
+		}
+
+		// Fee rate in percentage
+		static double CalculateFees(FEE_TIER tier, bool is_taker, const FeeSchedule& fees = Policy::fee_schedule)
+		{
+			const FeeRate rates = GetFeeRates(tier, fees);
+			return is_taker ? rates.taker : rates.maker;
+		}
+
+		/**
+		 * Volume-weighted average execution price for quantity on one side of the book.
+		 * The walking estimators report what the visible book cannot fill through
+		 * their optional unfilled argument; the price covers the filled part only.
+		 */
+		static double CalculateMarketOrderCost(double quantity, const BookSide& side, double* unfilled_quantity = nullptr)
+		{
+			double total_cost = 0.0;
+			double remaining_quantity = quantity;
+
+			for (int i = 0; i < side.size && remaining_quantity > 0; i++)
+			{
+				const double executed_amount = std::min(remaining_quantity, side[i].amount);
+				total_cost += executed_amount * side[i].price;
+				remaining_quantity -= executed_amount;
+			}
+
+			if (unfilled_quantity)
+				*unfilled_quantity = std::max(0.0, remaining_quantity);
+
+			const double filled_quantity = quantity - std::max(0.0, remaining_quantity);
+			return (filled_quantity > 0) ? total_cost / filled_quantity : 0.0;
+		}
+
+		// Crypto amount acquired by spending usd_amount walking one side of the book
+		static double CalculateCryptoForFixedUSD(double usd_amount, const BookSide& side, double* unfilled_usd = nullptr)
+		{
+			double remaining_usd = usd_amount;
+			double total_crypto = 0.0;
+
+			for (int i = 0; i < side.size && remaining_usd > 0; i++)
+			{
+				const double price = side[i].price;
+				if (price <= 0.0) continue; // Protect against bad data
+
+				const double amount_to_spend = std::min(remaining_usd, price * side[i].amount);
+				total_crypto += amount_to_spend / price;
+				remaining_usd -= amount_to_spend;
+			}
+
+			if (unfilled_usd)
+				*unfilled_usd = std::max(0.0, remaining_usd);
+
+			return total_crypto;
+		}
+
+		// Slippage in percentage against the best price of the executed side
+		static double CalculateSlippage(double quantity, const BookView& book, ORDER_TYPE order_type, ORDER_SIDE order_side, double* unfilled_quantity = nullptr)
+		{
+			if (unfilled_quantity)
+				*unfilled_quantity = 0.0;
+
+			if (order_type != ORDER_TYPE::MARKET)
+				return 0.0;
+
+			const BookSide& side = (order_side == ORDER_SIDE::BUY) ? book.asks : book.bids;
+			if (side.empty())
+			{
+				if (unfilled_quantity)
+					*unfilled_quantity = quantity;
+				return 0.0;
+			}
+
+			const double market_cost = CalculateMarketOrderCost(quantity, side, unfilled_quantity);
+			const double reference_price = side[0].price;
+			if (reference_price <= 0.0)
+				return 0.0;
+
+			const double slippage = (order_side == ORDER_SIDE::BUY)
+				? ((market_cost - reference_price) / reference_price) * 100.0
+				: ((reference_price - market_cost) / reference_price) * 100.0;
+
+			return std::max(0.0, slippage);
+		}
+
+		// Order flow imbalance toward the order's side, -1 to 1; 0 without flow features
+		static double FlowWithOrder(const BookFeatures& features, ORDER_SIDE order_side)
+		{
+			if (!features.flow.valid)
+				return 0.0;
+
+			const double ofi = features.flow.ofi_normalized[Policy::flow_ofi_depth];
+			return order_side == ORDER_SIDE::BUY ? ofi : -ofi;
+		}
+
+		// Visible depth an order of that side trades against: a buy lifts the asks, a sell hits the bids
+		static double DepthAgainst(const BookFeatures& features, ORDER_SIDE order_side)
+		{
+			return order_side == ORDER_SIDE::BUY ? features.ask_depth : features.bid_depth;
+		}
+
+		/**
+		 * Almgren-Chriss impact in percentage; beyond the visible depth the model extrapolates.
+		 * Flow running with the order makes it more expensive, flow against it cheaper.
+		 */
+		static double CalculateMarketImpact(double quantity, double volatility, const BookFeatures& features, double* unfilled_quantity = nullptr,
+			ORDER_SIDE order_side = ORDER_SIDE::BUY)
+		{
+			const double sigma = volatility / 100.0;
+			const double market_depth = DepthAgainst(features, order_side);
+			const double average_daily_volume = market_depth * Policy::adv_depth_multiplier;
+
+			if (unfilled_quantity)
+				*unfilled_quantity = std::max(0.0, quantity - market_depth);
+
+			if (market_depth <= 0 || average_daily_volume <= 0)
+				return 0.0;
+
+			const double flow_factor = std::max(0.0, 1.0 + Policy::flow_impact_weight * FlowWithOrder(features, order_side));
+			return Policy::impact_coefficient * sigma * std::sqrt(quantity / market_depth) * (quantity / average_daily_volume) * flow_factor;
+		}
+
+		// The venue's propagator for a volatility in percentage, its volume scaled by the visible depth the order trades against
+		static PropagatorParams PropagatorParamsFor(double volatility, const BookFeatures& features, ORDER_SIDE order_side)
+		{
+			PropagatorParams params;
+			params.kernel = PROPAGATOR_KERNEL::POWER_LAW;
+			params.strength = Policy::propagator_strength * volatility / 100.0;
+			params.decay_seconds = Policy::propagator_decay_seconds;
+			params.exponent = Policy::propagator_exponent;
+			params.volume_exponent = Policy::propagator_volume_exponent;
+			params.volume_scale = DepthAgainst(features, order_side);
+			return params;
+		}
+
+		/**
+		 * Transient impact in percentage of working quantity in equal slices, one every
+		 * slice_seconds. The propagator is the caller's, so an optimizer trying schedules
+		 * on the same grid keeps its cached kernel spectrum. Calibrated parameters
+		 * (QuantPropagator::Calibrate) replace the venue's defaults and the volatility
+		 * whole, volume scale included, since the fitted strength only holds at the
+		 * scale it was fitted with.
+		 */
+		static double CalculateSlicedImpact(QuantPropagator& propagator, double quantity, int slices, double slice_seconds, double volatility, const BookFeatures& features,
+			ORDER_SIDE order_side = ORDER_SIDE::BUY, const PropagatorParams* calibrated = nullptr)
+		{
+			if (quantity <= 0.0 || slices <= 0 || (!calibrated && DepthAgainst(features, order_side) <= 0.0))
+				return 0.0;
+
+			propagator.SetParams(calibrated ? *calibrated : PropagatorParamsFor(volatility, features, order_side));
+			return propagator.UniformScheduleCost(quantity, slices, slice_seconds) / quantity * 100.0;
+		}
+
+		// The book's maker ratio, moved by the order flow on the side a passive order would rest
+		static double CalculateMakerRatio(const BookFeatures& features, ORDER_SIDE order_side)
+		{
+			if (!features.flow.valid || features.mid_price <= 0.0)
+				return features.maker_ratio;
+
+			const double turnover = order_side == ORDER_SIDE::BUY ? features.flow.bid_turnover : features.flow.ask_turnover;
+			const double x = features.maker_logit + Policy::maker_beta_3 * FlowWithOrder(features, order_side)
+				+ Policy::maker_beta_4 * std::log1p(turnover);
+			return 1.0 / (1.0 + std::exp(-x));
+		}
+
+		/**
+		 * Computes spread, depth, volatility and maker ratio in a single pass over
+		 * the book, and copies the order-flow features the view carries. Everything
+		 * here depends on the book only, not on the inputs.
+		 */
+		static BookFeatures ComputeFeatures(const BookView& book)
+		{
+			BookFeatures features;
+			if (book.flow)
+				features.flow = *book.flow;
+
+			if (book.bids.empty() || book.asks.empty())
+				return features;
+
+			features.best_bid = book.bids[0].price;
+			features.best_ask = book.asks[0].price;
+			if (features.best_bid <= 0 || features.best_ask <= 0)
+				return features;
+
+			features.mid_price = (features.best_bid + features.best_ask) / 2.0;
+			features.spread = (features.best_ask - features.best_bid) / features.mid_price;
+
+			double top_bid_depth = 0.0;
+			double top_ask_depth = 0.0;
+			double bid_depth = 0.0;
+			double ask_depth = 0.0;
+
+			for (int i = 0; i < book.bids.size; i++)
+			{
+				bid_depth += book.bids[i].amount;
+				if (i < Policy::depth_levels)
+					top_bid_depth += book.bids[i].amount;
+			}
+
+			for (int i = 0; i < book.asks.size; i++)
+			{
+				ask_depth += book.asks[i].amount;
+				if (i < Policy::depth_levels)
+					top_ask_depth += book.asks[i].amount;
+			}
+
+			features.bid_depth = bid_depth;
+			features.ask_depth = ask_depth;
+
+			/**
+			* Measure order books imbalance supply-demand asymmetry
+			* Measure the relative difference between the buying pressure (bid_depth) and selling pressure (ask_depth)
+			* The result always between 0 and 1.
+			*	- 0 means prefectly balanced order book (bid_depth == ask_depth)
+			*	- 1 means all orders are on one side (bid_depth == 0 or ask_depth == 0)
+			* High imbalance often correlates with directional price movement and volatility
+			*/
+			// Volatility from the top-of-book depth imbalance
+			const double top_depth = top_bid_depth + top_ask_depth;
+			const double top_imbalance = (top_depth > 0) ? std::abs(top_bid_depth - top_ask_depth) / top_depth : 0.0;
+			features.volatility = (features.spread * Policy::volatility_spread_weight + top_imbalance * Policy::volatility_imbalance_weight) * 100.0;
+
+			/**
+			 * Maker ratio from the full-depth imbalance
+			 * Logistic function: 1 / (1 + e^(-x)) where x = β₀ + β₁*spread + β₂*imbalance
+			 *  - β₁ is negative because wider spreads favor taker orders
+			 *  - β₂ is positive because imbalance may create maker opportunities
+			 **/
+			const double depth = bid_depth + ask_depth;
+			const double imbalance = (depth > 0) ? std::abs(bid_depth - ask_depth) / depth : 0.0;
+			const double x = Policy::maker_beta_0 + (Policy::maker_beta_1 * features.spread) + (Policy::maker_beta_2 * imbalance);
+			features.maker_logit = x;
+			features.maker_ratio = 1.0 / (1.0 + std::exp(-x));
+
+			return features;
+		}
+
+		static CalculationOutput Evaluate(const CalculationInput& input, const BookView& book, const FeeSchedule& fees)
+		{
+			BookFeatures features;
+			{
+				QUANT_TRACE_SCOPE("features", "estimator");
+				features = ComputeFeatures(book);
+			}
+			return Evaluate(input, book, fees, features);
+		}
+
+		static CalculationOutput Evaluate(const CalculationInput& input, const BookView& book, const FeeSchedule& fees, const BookFeatures& features)
+		{
+			CalculationOutput output;
+			const BookSide& side = (input.order_side == ORDER_SIDE::BUY) ? book.asks : book.bids;
+
+			output.volatility = input.volatility_enabled ? input.volatility : features.volatility;
+
+			// Available amount after fees
+			double available_usd = input.usd_amount;
+			{
+				QUANT_TRACE_SCOPE("fees", "estimator");
+				const double fee_pctg = CalculateFees(input.fee_tier, true, fees);
+				available_usd = input.usd_amount / (1.0 + fee_pctg / 100.0);
+				output.fees = input.usd_amount - available_usd;
+			}
+
+			// Whatever an estimator could not fill on the visible book
+			double unfilled_usd = 0.0;
+			double unfilled_slippage = 0.0;
+			double unfilled_impact = 0.0;
+
+			// Slippage reduces the available amount
+			double estimated_crypto = 0.0;
+			{
+				QUANT_TRACE_SCOPE("slippage", "estimator");
+				estimated_crypto = CalculateCryptoForFixedUSD(available_usd, side, &unfilled_usd);
+				const double slippage_pctg = CalculateSlippage(estimated_crypto, book, input.order_type, input.order_side, &unfilled_slippage);
+				output.slippage = available_usd * (slippage_pctg / 100.0);
+				available_usd -= output.slippage;
+			}
+
+			// Market impact reduces it further
+			{
+				QUANT_TRACE_SCOPE("market_impact", "estimator");
+				const double impact_pctg = CalculateMarketImpact(estimated_crypto, output.volatility, features, &unfilled_impact, input.order_side);
+				output.market_impact = available_usd * (impact_pctg / 100.0);
+				available_usd -= output.market_impact;
+			}
+
+			{
+				QUANT_TRACE_SCOPE("crypto_amount", "estimator");
+				output.crypto_amount = CalculateCryptoForFixedUSD(available_usd, side, &output.unfilled_usd);
+			}
+			output.liquidity_exhausted = unfilled_usd > 0.0 || unfilled_slippage > 0.0 || unfilled_impact > 0.0 || output.unfilled_usd > 0.0;
+			output.net_cost = available_usd;
+			output.market_order_cost = input.usd_amount - output.fees - output.slippage - output.market_impact;
+			output.maker_ratio = CalculateMakerRatio(features, input.order_side);
+
+			return output;
+		}
+	};
+
+	/**
+	 * Returns the Evaluate() specialization of the given exchange, or nullptr
+	 * when no exchange is selected. Meant to be called once per selection change.
+	 */
+	CalculatorFn ResolveCalculator(EXCHANGE_API exchange);
+
+	// Same as ResolveCalculator(), split into features and estimators; both nullptr for NONE
+	CalculatorKernels ResolveKernels(EXCHANGE_API exchange);
+
+	/**
+	 * Returns the exchange's fee schedule as an immutable table. The table is built
+	 * once per process and shared by every calculator context; nullptr for NONE.
+	 */
+	std::shared_ptr<const FeeSchedule> GetFeeSchedule(EXCHANGE_API exchange);
+}
@@ -3,15 +3,12 @@
 #include <QDebug>
 
 #include "IQuantCalculatorAPI.h"
-#include "QuantOKXCalculator.h"
+#include "QuantCalculatorContext.h"
+#include "QuantConsolidatedBook.h"
 #include "QuantInputHandler.h"
 #include "QuantOrderbook.h"
-
-namespace {
-	void SetCalculatorVolatilityEnabled(bool enabled) {
-		Quant::QuantOKXCalculator::SetVolatilityEnabled(enabled);
-	}
-}
+#include "QuantResultsJournal.h"
+#include "QuantShmPublisher.h"
 
 namespace Quant
 {
@@ -32,12 +29,22 @@ namespace Quant
 		~QuantCalculatorAPI();
 
 	public:
-		IQuantCalculatorAPI* selectedExchange();
+		// Resolves the calculator of the selected exchange, returns false when none applies
+		bool ResolveExchange();
 
 	public:
 		void SetInputHandler(QuantInputHandler* input_handler);
 		void SetOrderbook(QuantOrderbook* orderbook);
 
+		// Every result is appended to the journal, not owned
+		void SetJournal(QuantResultsJournal* journal) { m_journal = journal; }
+
+		// Every result is published to local readers as well, not owned
+		void SetPublisher(QuantShmPublisher* publisher) { m_publisher = publisher; }
+
+		// Each calculation also sweeps the order across the venues of this book, not owned
+		void SetConsolidatedBook(QuantConsolidatedBook* consolidated_book);
+
 	public:
 		double CalculateVolatilityFromOrderbook() const { return m_volatility; }
 		double CalculateFees() const { return m_fees; }
@@ -48,14 +55,20 @@ namespace Quant
 
 		QObject* GetResult() const { return m_result; }
 
-		double CalculateCryptoForFixedUSD(double usd_amount, const QVariantList& orderbook);
+		// Transient impact in percentage of quantity (base asset) worked on the book in equal slices, on the input's side
+		Q_INVOKABLE double calculateSlicedImpact(double quantity, int slices, double slice_seconds);
+
+		// Our fill of quantity (base asset) on the input's side, now; the propagator calibrates on the mid that follows
+		Q_INVOKABLE void recordFill(double quantity);
 
 	public slots:
 		void Calculate();
 
 	private slots:
 		void OnOrderbookUpdated();
+		void OnPendingCalculation();
 		void OnInputChanged();
+		void OnExchangeChanged();
 
 	signals:
 		void CalculationUpdated();
@@ -73,7 +86,13 @@ namespace Quant
 	private:
 		QuantInputHandler* m_input_handler = nullptr;
 		QuantOrderbook* m_orderbook = nullptr;
+		QuantResultsJournal* m_journal = nullptr;
+		QuantShmPublisher* m_publisher = nullptr;
+		QuantConsolidatedBook* m_consolidated_book = nullptr;
+
+		QuantCalculatorContext m_context;
 
-		IQuantCalculatorAPI* m_calculator_interface = nullptr;
+		// A book-driven calculation is queued and not yet run
+		bool m_calculation_pending = false;
 	};
 }
@@ -0,0 +1,101 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "QuantCalculationCache.h"
+#include "QuantCalculator.h"
+
+namespace Quant
+{
+	/**
+	 * Per-instance calculator state
+	 *
+	 * A context owns everything a calculation used to read from process-wide statics:
+	 * the resolved kernel, the volatility override, the last processing time, and the
+	 * propagator of sliced orders with our fills and its calibrated fit, if any. The
+	 * fee schedule is an immutable table shared between contexts of the same exchange.
+	 *
+	 * Book features and results are memoized per book version (QuantCalculationCache).
+	 * A context follows one book; whoever points it at another calls InvalidateCache().
+	 *
+	 * Contexts are not internally synchronized; each thread (symbol, scenario, user)
+	 * uses its own context and different contexts never share mutable state.
+	 */
+	class QuantCalculatorContext
+	{
+	public:
+		explicit QuantCalculatorContext(EXCHANGE_API exchange = EXCHANGE_API::NONE);
+
+	public:
+		// Resolves kernel and fee schedule, returns false when the exchange has no calculator
+		bool SetExchange(EXCHANGE_API exchange);
+		EXCHANGE_API Exchange() const { return m_exchange; }
+		bool IsValid() const { return m_kernels.evaluate != nullptr && m_fee_schedule != nullptr; }
+
+		// The memoized features and results, our fills and their fit belong to another book from here on
+		void InvalidateCache();
+
+	public:
+		bool isVolatilityEnabled() const { return m_is_volatility_enabled; }
+		double Volatility() const { return m_volatility; }
+		double GetProcessingTime() const { return m_process_time_ms; }
+
+		void SetVolatilityEnabled(bool enabled) { m_is_volatility_enabled = enabled; }
+		void SetVolatility(double volatility) { m_volatility = volatility; }
+
+	public:
+		/**
+		 * Runs the resolved kernel on the book. The context's volatility override
+		 * replaces the one carried by the input, and the elapsed time is recorded
+		 * as this context's processing time. A result already computed for this
+		 * version and input is returned as is; otherwise only the estimators run when
+		 * the version's features are known.
+		 */
+		CalculationOutput Evaluate(const CalculationInput& input, const BookView& book);
+
+		/**
+		 * Transient impact in percentage of working quantity on the book in equal slices,
+		 * one every slice_seconds, from the memoized features and the volatility Evaluate()
+		 * would use. A valid fit set with SetPropagatorFit() replaces the venue's defaults.
+		 */
+		double SlicedImpact(const BookView& book, double quantity, int slices, double slice_seconds, ORDER_SIDE order_side);
+
+		// An invalid fit goes back to the venue's defaults
+		void SetPropagatorFit(const PropagatorFit& fit) { m_propagator_fit = fit; }
+		const PropagatorFit& GetPropagatorFit() const { return m_propagator_fit; }
+
+		/**
+		 * One of our fills on the book, times in seconds on a clock that only moves
+		 * forward. The first fill of a run takes the book's mid as reference and the
+		 * propagator's shape (kernel, exponent, depth scale) for the side it traded.
+		 * ObserveMid() then follows the mid, at most once per second; when no fill came
+		 * for the calibration window the run is fitted (QuantPropagator::Calibrate) and
+		 * a valid fit replaces the propagator's parameters.
+		 */
+		void RecordFill(const BookView& book, double quantity, ORDER_SIDE order_side, double time_seconds);
+		void ObserveMid(double mid_price, double time_seconds);
+
+		// Price move in percentage our fills of the current run still cause, 0 without a run
+		double FillImpact(double time_seconds) const;
+
+	private:
+		EXCHANGE_API m_exchange = EXCHANGE_API::NONE;
+		CalculatorKernels m_kernels;
+		std::shared_ptr<const FeeSchedule> m_fee_schedule;
+		QuantCalculationCache m_cache;
+		QuantPropagator m_propagator;
+		PropagatorFit m_propagator_fit;
+
+		// Fills of the current calibration run, times relative to its first fill
+		QuantPropagator m_fill_propagator;
+		std::vector<PropagatorFill> m_fills;
+		std::vector<PriceObservation> m_fill_path;
+		double m_fill_reference_mid = 0.0;
+		double m_fill_start = 0.0;
+		double m_last_fill = 0.0;
+
+		bool m_is_volatility_enabled = false;
+		double m_volatility = 0.0;
+		double m_process_time_ms = 0.0;
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <chrono>
+
+#include <QtGlobal>
+
+namespace Quant
+{
+	// Clocks shared by the pipeline, in nanoseconds
+	namespace QuantClock
+	{
+		// Since the Unix epoch; for timestamps that leave the process (files, shared memory)
+		inline qint64 WallNs()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		// Monotonic, also the tracer's clock; for intervals and latencies within the process
+		inline qint64 SteadyNs()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+	}
+}
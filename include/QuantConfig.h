@@ -0,0 +1,117 @@
+#pragma once
+#include <memory>
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantConsolidatedBook.h"
+#include "QuantCostServer.h"
+#include "QuantFeedQueue.h"
+#include "QuantRuntimeProfile.h"
+#include "QuantShmPublisher.h"
+#include "QuantTickStore.h"
+
+namespace Quant
+{
+	/**
+	 * One immutable view of the configuration
+	 *
+	 * Built from the defaults, then config.json, then the environment (highest
+	 * precedence). Readers hold a shared_ptr and never see a partial update.
+	 */
+	struct ConfigSnapshot
+	{
+		// Credentials
+		QString api_key;
+		QString api_secret;
+		QString api_passphrase;
+
+		// Feed; endpoint and depth apply on reload, symbols at startup
+		QString socket_endpoint;
+		QStringList redundant_endpoints; // Same feed over other paths, arbitrated first-arrival; applies with the endpoint
+		QStringList symbols;       // Empty follows the selected asset
+		int book_depth = 0;        // Levels per side, 0 keeps the full depth
+		QHash<QString, int> symbol_depths;
+
+		int DepthFor(const QString& symbol) const { return symbol_depths.value(symbol, book_depth); }
+
+		// "bbo-tbt" or "books5" alongside the deep book, empty for none; applies on reload
+		QString top_of_book_channel;
+
+		// Subscribe and unsubscribe requests per second and connection, 0 for no limit; applies on reload
+		int requests_per_second = 0;
+
+		// Wire format of the endpoint, EXCHANGE_API::NONE for the generic one; applies with the endpoint
+		EXCHANGE_API feed_format = EXCHANGE_API::NONE;
+
+		// Other venues quoting the selected instrument, merged with it into a consolidated book; startup only
+		QList<VenueFeedConfig> venues;
+
+		// Backpressure between feed and book, applies on reload
+		BACKPRESSURE_POLICY backpressure_policy = BACKPRESSURE_POLICY::CONFLATE;
+		BackpressureLimits backpressure_limits;
+
+		// Startup only
+		int scenario_threads = 0;  // 0 uses QThread::idealThreadCount()
+		int ingest_connections = 0; // Feed connections for the other symbols, each on its own thread; 0 for none
+		quint16 metrics_port = 9464;
+		RuntimeProfileConfig runtime;  // Low-latency profile, Linux only
+		ShmPublisherConfig shm;        // Books and results for other local processes, POSIX only
+		CostServerConfig cost_service; // Cost queries from other local processes
+		TickStoreConfig tick_store;    // Book history on disk
+
+		// Initial model inputs, the UI owns them afterwards
+		bool volatility_enabled = false;
+		double volatility = 0.0;
+	};
+
+	/**
+	 * Parse-once configuration with hot reload
+	 *
+	 * Load() reads the environment and config.json once (the file is capped at
+	 * max_file_bytes) and publishes the snapshot. A QFileSystemWatcher reloads it
+	 * when the file changes; an unreadable or invalid file keeps the previous
+	 * snapshot. The swap is atomic, so Current() is safe from any thread.
+	 */
+	class QuantConfig : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		// An empty path uses config.json in the application config directory
+		explicit QuantConfig(const QString& path = QString(), QObject* parent = nullptr);
+
+	public:
+		bool Load();
+		QString FilePath() const { return m_path; }
+
+		// The last published snapshot, the defaults before any Load()
+		static std::shared_ptr<const ConfigSnapshot> Current();
+
+	signals:
+		// Current() holds the new snapshot
+		void configChanged();
+
+	private slots:
+		void OnFileChanged();
+		void OnReload();
+
+	private:
+		void Watch();
+
+	private:
+		static constexpr qint64 max_file_bytes = 1 << 20;
+		static constexpr int reload_delay_ms = 200;
+
+		QString m_path;
+		QFileSystemWatcher m_watcher;
+		QTimer m_reload_timer;
+		bool m_loaded = false;
+	};
+}
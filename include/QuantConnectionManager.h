@@ -0,0 +1,113 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+namespace Quant
+{
+	class QuantOrderbook;
+	class QuantWebSocket;
+
+	/**
+	 * Keeps the feed alive and the books consistent
+	 *
+	 * Reconnects with jittered exponential backoff and re-subscribes every tracked
+	 * symbol, so the venue answers with fresh snapshots. A book that reports a sequence
+	 * gap is resubscribed on its own; meanwhile it keeps serving its last good state
+	 * flagged as stale. A connection that goes silent is treated as dead.
+	 *
+	 * Time-to-recover runs from the disconnect (or gap) to the snapshot that clears
+	 * the book's stale flag.
+	 *
+	 * Subscription requests can be capped per second, as venues disconnect clients
+	 * that send too many. Resyncs over the cap wait, one per symbol, until the
+	 * budget refills; the subscriptions after a connect are always sent and borrow
+	 * from it.
+	 */
+	class QuantConnectionManager : public QObject
+	{
+		Q_OBJECT
+		Q_PROPERTY(bool connected READ isConnected NOTIFY connectionChanged)
+		Q_PROPERTY(qint64 lastRecoveryTime READ LastRecoveryTime NOTIFY recovered)
+		Q_PROPERTY(int recoveryCount READ RecoveryCount NOTIFY recovered)
+
+	public:
+		explicit QuantConnectionManager(QuantWebSocket* websocket, QObject* parent = nullptr);
+
+	public:
+		void AddBook(QuantOrderbook* orderbook);
+
+		void Start(const QString& url);
+		void Stop();
+		QString Url() const { return m_url; }
+
+		// Extra bbo-tbt or books5 subscription per symbol, empty for none
+		void SetTopOfBookChannel(const QString& channel);
+		QString TopOfBookChannel() const { return m_top_channel; }
+
+		// Subscribe and unsubscribe requests per second, 0 for no limit
+		void SetRequestRateLimit(int requests_per_second);
+		int RequestRateLimit() const { return m_requests_per_second; }
+
+		bool isConnected() const;
+
+		// Marks the books of the symbol stale and asks the venue for a new snapshot
+		void Resync(const QString& symbol);
+
+		qint64 LastRecoveryTime() const { return m_last_recovery_ms; }
+		int RecoveryCount() const { return m_recovery_count; }
+
+	signals:
+		void connectionChanged(bool connected);
+		void reconnectScheduled(int attempt, int delay_ms);
+		void recovered(const QString& symbol, qint64 recovery_ms);
+
+	private slots:
+		void OnConnected();
+		void OnDisconnected();
+		void OnReconnect();
+		void OnWatchdog();
+		void SendPendingResyncs();
+
+	private:
+		void ScheduleReconnect();
+		void ResyncBook(QuantOrderbook* orderbook);
+		void RefillRequests();
+		void SpendRequests(double requests);
+		void OnBookStaleChanged(QuantOrderbook* orderbook, bool stale);
+		QStringList Symbols() const;
+
+	private:
+		static constexpr int initial_backoff_ms = 250;
+		static constexpr int max_backoff_ms = 30000;
+		static constexpr int stall_timeout_ms = 10000;
+		static constexpr int watchdog_interval_ms = 1000;
+		static constexpr double resync_requests = 2.0; // An unsubscribe and a subscribe
+
+		QuantWebSocket* m_websocket = nullptr;
+		QList<QuantOrderbook*> m_books;
+		QString m_url;
+		QString m_top_channel;
+		bool m_running = false;
+
+		QTimer m_reconnect_timer;
+		QTimer m_watchdog_timer;
+		QElapsedTimer m_connected_since;
+		int m_attempt = 0;
+
+		// Token bucket of requests, a second's worth (or one resync) deep; unused without a limit
+		int m_requests_per_second = 0;
+		double m_request_budget = 0.0;
+		QElapsedTimer m_budget_clock;
+		QStringList m_pending_resyncs;
+		QTimer m_resync_timer;
+
+		// Books waiting for a snapshot, timed from the moment they went stale
+		QHash<QuantOrderbook*, QElapsedTimer> m_recovering;
+		qint64 m_last_recovery_ms = -1;
+		int m_recovery_count = 0;
+	};
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <map>
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantBookView.h"
+
+namespace Quant
+{
+	class QuantOrderbook;
+
+	// Another venue's feed of the selected instrument, merged into the consolidated book
+	struct VenueFeedConfig
+	{
+		EXCHANGE_API exchange = EXCHANGE_API::NONE; // Also the wire format of its endpoint
+		QString symbol;                              // The venue's name of the instrument, empty for the selected symbol
+		QString endpoint;
+	};
+
+	// One venue's level in the consolidated book
+	struct ConsolidatedLevel
+	{
+		double effective_price = 0.0; // Price after the venue's taker fee
+		double price = 0.0;
+		double amount = 0.0;
+		EXCHANGE_API exchange = EXCHANGE_API::NONE;
+	};
+
+	// Part of a sweep routed to one venue
+	struct VenueFill
+	{
+		EXCHANGE_API exchange = EXCHANGE_API::NONE;
+		double quantity = 0.0;
+		double notional = 0.0; // Before fees
+		double fees = 0.0;
+	};
+
+	struct SweepResult
+	{
+		double quantity = 0.0;
+		double notional = 0.0;
+		double fees = 0.0;
+		double average_price = 0.0;
+		double slippage = 0.0;     // Against the best raw price across venues, in USD
+		double unfilled_usd = 0.0; // Beyond the consolidated liquidity
+		QVector<VenueFill> fills;  // Venues that took part, in the order they were first hit
+	};
+
+	/**
+	 * Cross-venue book of one instrument
+	 *
+	 * Merges the books of several venues into one book per side ordered by effective
+	 * price, the price after the venue's taker fee (bids net of it, asks grossed up).
+	 * Levels are keyed by (effective price, venue), so a delta on one venue touches
+	 * only the consolidated levels it lists: an update is a lookup and a store per
+	 * changed level instead of a merge of every venue's book. A snapshot is diffed
+	 * against the levels the venue contributes, so only the levels it moved are
+	 * touched; a fee tier change, or a new instrument on the venue, reloads it.
+	 *
+	 * Because each level already carries its venue's fee, walking a side best first
+	 * is the cheapest way to fill a market order across venues; SweepCost() does that
+	 * and reports how the order splits between them.
+	 */
+	class QuantConsolidatedBook : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantConsolidatedBook(QObject* parent = nullptr);
+
+	public:
+		// Books must be of the same instrument; the venue is the book's exchange
+		void AddVenue(QuantOrderbook* orderbook);
+		void RemoveVenue(QuantOrderbook* orderbook);
+		int VenueCount() const { return static_cast<int>(m_venues.size()); }
+
+		// Taker fee tier used for the effective prices, reloads every venue
+		void SetFeeTier(FEE_TIER fee_tier);
+		FEE_TIER FeeTier() const { return m_fee_tier; }
+
+		// Best effective level, a zero level when the side is empty
+		ConsolidatedLevel BestBid() const;
+		ConsolidatedLevel BestAsk() const;
+
+		// Replaces out with the levels best first, at most max_levels of them (0 for all)
+		void CopyLevels(bool is_bids, QVector<ConsolidatedLevel>& out, int max_levels = 0) const;
+		int LevelCount(bool is_bids) const { return static_cast<int>(is_bids ? m_bids.size() : m_asks.size()); }
+
+		/**
+		 * Fills usd_amount across the venues at the lowest total cost. A buy spends
+		 * usd_amount including fees, a sell sells usd_amount of notional.
+		 */
+		SweepResult SweepCost(ORDER_SIDE side, double usd_amount) const;
+
+		quint64 Version() const { return m_version; }
+
+	signals:
+		void consolidatedUpdated();
+
+	private:
+		struct LevelKey
+		{
+			double effective_price = 0.0;
+			int venue_id = 0;
+		};
+
+		// Best first; a stateful order so both sides share the map type
+		struct LevelOrder
+		{
+			bool is_bids = true;
+
+			bool operator()(const LevelKey& a, const LevelKey& b) const
+			{
+				if (a.effective_price != b.effective_price)
+					return is_bids ? a.effective_price > b.effective_price : a.effective_price < b.effective_price;
+				return a.venue_id < b.venue_id;
+			}
+		};
+
+		using Side = std::map<LevelKey, ConsolidatedLevel, LevelOrder>;
+
+		struct Venue
+		{
+			QuantOrderbook* book = nullptr;
+			int id = 0;             // Stable across removals, part of the level keys
+			EXCHANGE_API exchange = EXCHANGE_API::NONE;
+			double taker_rate = 0.0; // Fraction, 0.001 for 0.10%
+
+			// Amount per price this venue contributes, to find its keys again and diff snapshots
+			QHash<double, double> bids;
+			QHash<double, double> asks;
+		};
+
+		void OnVenueUpdated(QuantOrderbook* orderbook);
+		void ReloadVenue(Venue& venue);
+		void DiffSide(Venue& venue, bool is_bids, const BookSide& levels);
+		void RemoveLevels(Venue& venue);
+		void SetLevel(Venue& venue, bool is_bids, const BookLevel& level);
+		LevelKey KeyOf(const Venue& venue, bool is_bids, double price) const;
+		Venue* Find(const QuantOrderbook* orderbook);
+
+	private:
+		std::vector<Venue> m_venues;
+		Side m_bids{ LevelOrder{ true } };
+		Side m_asks{ LevelOrder{ false } };
+		FEE_TIER m_fee_tier = FEE_TIER::VIP_0;
+		int m_next_venue_id = 0;
+		quint64 m_version = 0;
+		QSet<double> m_snapshot_prices; // Scratch for DiffSide()
+	};
+}
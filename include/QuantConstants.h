@@ -26,6 +26,9 @@ namespace Quant
 		**/
 		static constexpr const char* SOCKET_ENDPOINT = ""; // Endpoint ws
 
+		// Prometheus scrape port, loopback only
+		static constexpr quint16 METRICS_PORT = 9464;
+
 		// API Keys, Secrets, and Passphrases
 		static QString GetApiKey();
 		static QString GetApiSecret();
@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+#include "QuantCalculator.h"
+#include "QuantCostServiceFormat.h"
+
+class QIODevice;
+class QThread;
+
+namespace Quant
+{
+	class MetricCounter;
+	class MetricHistogram;
+	class QuantBookSnapshots;
+
+	struct CostServerConfig
+	{
+		bool enabled = false;
+		QString socket_name = "quant-cost"; // Local socket (Unix domain socket, named pipe on Windows), empty for none
+		quint16 tcp_port = 0;               // Loopback TCP port, 0 for none
+		int workers = 2;
+		int max_pending = 64;               // Requests queued per client before new ones are refused with BUSY
+	};
+
+	/**
+	 * Local request/response cost estimation for strategies
+	 *
+	 * Answers batched cost queries (symbol, side, size, fee tier, order type) over a
+	 * local socket and/or loopback TCP, in the binary format of
+	 * QuantCostServiceFormat.h. Every query is evaluated by the venue's calculator on
+	 * the latest snapshot of its book (QuantBookSnapshots), so neither the GUI thread
+	 * nor the ingest threads take part in serving it.
+	 *
+	 * Sockets live on the server's own I/O thread, which only frames requests and
+	 * writes responses. Each client has a bounded queue of pending requests; a client
+	 * with work waits in a ready queue served round-robin by the worker threads, one
+	 * request at a time, so a client sending large batches cannot starve the others and
+	 * its responses keep the order of its requests. A request arriving at a full queue
+	 * is refused with BUSY instead of queueing without bound; it is not evaluated, and
+	 * its BUSY response follows the response of the last request accepted before it.
+	 *
+	 * Workers block on a condition variable; under the low-latency profile's busy
+	 * polling, a worker pinned to a core of its own spins instead.
+	 */
+	class QuantCostServer : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		QuantCostServer(const CostServerConfig& config, const QuantBookSnapshots* snapshots, QObject* parent = nullptr);
+		~QuantCostServer();
+
+	public:
+		bool Start();
+		void Stop();
+		bool IsRunning() const { return m_io_thread != nullptr; }
+
+		// Full path of the local socket, for clients
+		QString SocketPath() const { return m_socket_path; }
+		quint16 TcpPort() const { return m_tcp_port; }
+
+	private:
+		struct Request
+		{
+			QByteArray frame;
+			qint64 received_ns = 0;
+			std::vector<quint64> refused_after; // Requests refused while this one was the client's last, answered BUSY after it
+		};
+
+		// Shared by the I/O thread and the workers; the socket is the I/O thread's only
+		struct Client
+		{
+			QIODevice* socket = nullptr; // QLocalSocket or QTcpSocket, nullptr once gone
+			QByteArray read_buffer;
+
+			std::mutex mutex;
+			std::deque<Request> pending;
+			bool scheduled = false; // In the ready queue or with a worker
+		};
+
+		struct Kernels
+		{
+			CalculatorKernels calculator;
+			std::shared_ptr<const FeeSchedule> fees;
+		};
+
+		// I/O thread
+		bool Listen();
+		void Close();
+		void Accept(QIODevice* socket);
+		void OnReadyRead(const std::shared_ptr<Client>& client);
+		void OnDisconnected(const std::shared_ptr<Client>& client);
+		void Submit(const std::shared_ptr<Client>& client, Request request);
+		void Write(Client& client, const QByteArray& response);
+
+		// Workers
+		void WorkerLoop();
+		std::shared_ptr<Client> NextClient();
+		void Schedule(const std::shared_ptr<Client>& client);
+		QByteArray Process(const QByteArray& frame);
+		void Deliver(const std::shared_ptr<Client>& client, QByteArray response, qint64 received_ns);
+
+	private:
+		CostServerConfig m_config;
+		const QuantBookSnapshots* m_snapshots = nullptr;
+		Kernels m_kernels[static_cast<int>(EXCHANGE_API::MEXC) + 1];
+
+		QThread* m_io_thread = nullptr;
+		QObject* m_io = nullptr; // Context object of the I/O thread, parent of the servers and sockets
+		std::vector<std::shared_ptr<Client>> m_clients; // I/O thread only
+		QString m_socket_path;
+		quint16 m_tcp_port = 0;
+
+		std::mutex m_ready_mutex;
+		std::condition_variable m_ready_condition;
+		std::deque<std::shared_ptr<Client>> m_ready;
+		std::atomic<int> m_ready_count{ 0 }; // Lets spinning workers poll without the lock
+		std::atomic<bool> m_stopping{ false };
+		std::vector<std::thread> m_workers;
+
+		MetricCounter* m_queries = nullptr;
+		MetricCounter* m_served = nullptr;
+		MetricCounter* m_refused = nullptr;
+		MetricHistogram* m_latency = nullptr;
+	};
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+
+namespace Quant
+{
+	/**
+	 * Wire format of the cost-estimation service
+	 *
+	 * A client sends request frames and reads one response frame per request, in
+	 * the order of its requests. A request is a RequestHeader followed by query_count
+	 * Query records; its response is a ResponseHeader followed by one Result per query,
+	 * in the same order, or by none when the whole batch was refused. request_id is
+	 * echoed back untouched.
+	 *
+	 * Every query is answered from the latest version of its book at the time a worker
+	 * picks the batch up, all queries on the same book from the same version. Sizes are
+	 * in USD (QUOTE) or in the base asset (BASE, converted at the mid price of that
+	 * version).
+	 *
+	 * Integers and doubles are little endian. Exchanges, sides, order types and fee
+	 * tiers use the values of IQuantCalculatorAPI.h. Plain C++ without Qt, so clients
+	 * can include it as is.
+	 */
+	namespace CostServiceFormat
+	{
+		constexpr std::uint32_t request_magic = 0x31514351;  // "QCQ1"
+		constexpr std::uint32_t response_magic = 0x31524351; // "QCR1"
+		constexpr std::uint16_t version = 1;
+
+		constexpr int max_queries = 1024; // Per request; a larger batch closes the connection
+		constexpr int symbol_size = 32;   // NUL padded
+
+		enum SIZE_UNIT : std::uint8_t
+		{
+			QUOTE = 0, // USD
+			BASE = 1,  // Base asset, e.g. BTC
+		};
+
+		enum STATUS : std::uint8_t
+		{
+			OK = 0,
+			UNKNOWN_BOOK = 1,         // The simulator does not follow the exchange and symbol
+			EMPTY_BOOK = 2,           // No levels yet, or no mid price for a BASE size
+			UNSUPPORTED_EXCHANGE = 3, // No calculator for the exchange
+			INVALID_QUERY = 4,        // Non-positive size or out-of-range enum
+			BUSY = 5,                 // Batch refused, too many requests of this client pending
+		};
+
+		struct RequestHeader
+		{
+			std::uint32_t magic = request_magic;
+			std::uint16_t version = CostServiceFormat::version;
+			std::uint16_t query_count = 0;
+			std::uint64_t request_id = 0;
+		};
+		static_assert(sizeof(RequestHeader) == 16, "Request header layout is part of the wire format");
+
+		struct Query
+		{
+			char symbol[symbol_size] = {};
+			std::uint8_t exchange = 0;
+			std::uint8_t order_side = 0;
+			std::uint8_t order_type = 0;
+			std::uint8_t fee_tier = 0;
+			std::uint8_t size_unit = QUOTE;
+			std::uint8_t reserved[3] = {};
+			double size = 0.0;
+		};
+		static_assert(sizeof(Query) == 48, "Query layout is part of the wire format");
+
+		struct ResponseHeader
+		{
+			std::uint32_t magic = response_magic;
+			std::uint16_t version = CostServiceFormat::version;
+			std::uint16_t result_count = 0;
+			std::uint64_t request_id = 0;
+			std::uint8_t status = OK; // BUSY refuses the whole batch, result_count is 0 then
+			std::uint8_t reserved[7] = {};
+		};
+		static_assert(sizeof(ResponseHeader) == 24, "Response header layout is part of the wire format");
+
+		struct Result
+		{
+			std::uint8_t status = OK;
+			std::uint8_t liquidity_exhausted = 0; // The order exceeds the visible book, figures cover the fillable part
+			std::uint8_t stale = 0;               // The book serves its last good state until the next snapshot
+			std::uint8_t reserved[5] = {};
+			std::uint64_t book_version = 0;
+			std::int64_t book_timestamp_ns = 0;   // When that version was applied, since the epoch
+
+			double usd_amount = 0.0;              // The size in USD
+			double fees = 0.0;
+			double slippage = 0.0;
+			double market_impact = 0.0;
+			double market_order_cost = 0.0;
+			double net_cost = 0.0;
+			double crypto_amount = 0.0;
+			double maker_ratio = 0.0;
+			double volatility = 0.0;
+			double unfilled_usd = 0.0;
+		};
+		static_assert(sizeof(Result) == 104, "Result layout is part of the wire format");
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <limits>
+#include <vector>
+
+#include <QColor>
+#include <QQuickItem>
+
+namespace Quant
+{
+	class QuantOrderbook;
+
+	/**
+	 * Cumulative depth and level sizes of a book, drawn straight into scene-graph geometry
+	 *
+	 * Bids fill the left of the item and asks the right, on a common price axis that
+	 * spans the displayed levels. Each level is one rectangle of the cumulative
+	 * depth area and one bar of its own size, six colored vertices each.
+	 *
+	 * The book is laid out in updatePolish(), on the GUI thread that owns it, at most
+	 * once per frame and only when its version changed; the render thread never reads
+	 * the book. The price axis and both height scales keep some headroom and are only
+	 * rescaled when the book outgrows or shrinks well inside it, so an update moves the
+	 * rectangles it affects (the changed level's bar, and the depth area from that
+	 * level outwards) and leaves the others as they are. The sync writes the vertices
+	 * of the levels whose rectangles moved, and nothing when none did.
+	 */
+	class QuantDepthChart : public QQuickItem
+	{
+		Q_OBJECT
+		Q_PROPERTY(QObject* orderbook READ Orderbook WRITE SetOrderbook NOTIFY orderbookChanged)
+		Q_PROPERTY(int maxLevels READ MaxLevels WRITE SetMaxLevels NOTIFY maxLevelsChanged)
+		Q_PROPERTY(QColor bidColor READ BidColor WRITE SetBidColor NOTIFY colorsChanged)
+		Q_PROPERTY(QColor askColor READ AskColor WRITE SetAskColor NOTIFY colorsChanged)
+
+	public:
+		explicit QuantDepthChart(QQuickItem* parent = nullptr);
+
+	public:
+		QObject* Orderbook() const;
+		void SetOrderbook(QObject* orderbook);
+
+		// Levels drawn per side, 0 for all of them
+		int MaxLevels() const { return m_max_levels; }
+		void SetMaxLevels(int max_levels);
+
+		QColor BidColor() const { return m_bid_color; }
+		QColor AskColor() const { return m_ask_color; }
+		void SetBidColor(const QColor& color);
+		void SetAskColor(const QColor& color);
+
+	signals:
+		void orderbookChanged();
+		void maxLevelsChanged();
+		void colorsChanged();
+
+	protected:
+		void updatePolish() override;
+		QSGNode* updatePaintNode(QSGNode* old_node, UpdatePaintNodeData* data) override;
+		void geometryChange(const QRectF& new_geometry, const QRectF& old_geometry) override;
+
+	private:
+		struct LevelRects
+		{
+			float left = 0.0f;
+			float right = 0.0f;
+			float top = 0.0f;     // Of the cumulative depth area
+			float bar_left = 0.0f;
+			float bar_right = 0.0f;
+			float bar_top = 0.0f;
+
+			bool operator==(const LevelRects& other) const
+			{
+				return left == other.left && right == other.right && top == other.top
+					&& bar_left == other.bar_left && bar_right == other.bar_right && bar_top == other.bar_top;
+			}
+		};
+
+		void OnOrderbookUpdated();
+		void Invalidate();
+		void MarkChanged(int first, int last);
+
+	private:
+		QuantOrderbook* m_orderbook = nullptr;
+		int m_max_levels = 0;
+		QColor m_bid_color = QColor(0, 255, 0);
+		QColor m_ask_color = QColor(255, 0, 0);
+
+		// Layout, GUI thread; the render thread reads it during the sync while the GUI thread is blocked
+		quint64 m_laid_out_version = 0;
+		bool m_dirty = true;
+		bool m_axis_valid = false;
+		double m_axis_low = 0.0;
+		double m_axis_high = 0.0;
+		double m_depth_max = 0.0;
+		double m_bar_max = 0.0;
+		float m_height = 0.0f;
+		int m_bid_count = 0;
+		std::vector<LevelRects> m_rects; // Bids then asks
+		std::vector<LevelRects> m_next_rects;
+
+		// Range of m_rects the nodes do not show yet, empty when first > last
+		int m_changed_first = std::numeric_limits<int>::max();
+		int m_changed_last = -1;
+	};
+}
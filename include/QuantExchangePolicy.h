@@ -0,0 +1,162 @@
+#pragma once
+#include <array>
+
+#include "IQuantCalculatorAPI.h"
+
+namespace Quant
+{
+	// Maker and taker fee rates in percentage (0.1 means 0.10%)
+	struct FeeRate
+	{
+		double maker = 0.0;
+		double taker = 0.0;
+	};
+
+	constexpr int fee_tier_count = static_cast<int>(FEE_TIER::VIP_9) + 1;
+	using FeeSchedule = std::array<FeeRate, fee_tier_count>;
+
+	/**
+	 * Model coefficients shared by every venue unless a policy overrides them.
+	 * The values are the ones the OKX calculator has always used; they are
+	 * placeholders until the models are calibrated per venue.
+	 */
+	struct DefaultModelCoefficients
+	{
+		// Number of levels summed for the volatility depth imbalance
+		static constexpr int depth_levels = 10;
+
+		// volatility = (spread * spread_weight + imbalance * imbalance_weight) * 100
+		static constexpr double volatility_spread_weight = 2.0;
+		static constexpr double volatility_imbalance_weight = 1.5;
+
+		// Almgren-Chriss impact coefficient and ADV estimate (ADV = depth * multiplier)
+		static constexpr double impact_coefficient = 0.1;
+		static constexpr double adv_depth_multiplier = 24.0;
+
+		// Maker ratio logistic regression: x = beta_0 + beta_1 * spread + beta_2 * imbalance
+		static constexpr double maker_beta_0 = 0.5;
+		static constexpr double maker_beta_1 = -2.0;
+		static constexpr double maker_beta_2 = 1.5;
+
+		/**
+		 * Order flow, for books that carry FlowFeatures. "With the order" is the
+		 * normalized OFI of flow_ofi_depth signed toward the order's side: buying
+		 * pressure for a buy. Impact scales by 1 + flow_impact_weight * with_the_order;
+		 * the maker logistic adds beta_3 * with_the_order (the price runs away from a
+		 * passive order) + beta_4 * ln(1 + turnover of the queue it would join).
+		 */
+		static constexpr int flow_ofi_depth = 1;
+		static constexpr double flow_impact_weight = 0.5;
+		static constexpr double maker_beta_3 = -1.0;
+		static constexpr double maker_beta_4 = 0.25;
+
+		/**
+		 * Transient impact of sliced execution (QuantPropagator), power-law kernel:
+		 * G(t) = propagator_strength * sigma / (1 + t / decay)^exponent, applied to
+		 * (slice / visible depth)^volume_exponent.
+		 */
+		static constexpr double propagator_strength = 0.1;
+		static constexpr double propagator_decay_seconds = 30.0;
+		static constexpr double propagator_exponent = 0.5;
+		static constexpr double propagator_volume_exponent = 0.5;
+	};
+
+	/**
+	 * Exchange policies
+	 *
+	 * Each policy is a stateless compile-time description of a venue: fee schedule
+	 * per FEE_TIER, tick and lot sizes of the reference instrument and the model
+	 * coefficients. QuantCalculator is instantiated once per policy so every venue
+	 * gets its own specialized kernels with all constants folded in.
+	 *
+	 * Fee schedules follow each venue's public spot/swap schedule for the first ten
+	 * tiers; tiers a venue does not publish repeat its last published tier.
+	 */
+	struct OKXPolicy : DefaultModelCoefficients
+	{
+		static constexpr EXCHANGE_API api = EXCHANGE_API::OKX;
+		static constexpr const char* name = "OKX";
+
+		static constexpr double tick_size = 0.1;
+		static constexpr double lot_size = 0.01;
+
+		static constexpr FeeSchedule fee_schedule = { {
+			{ 0.0800, 0.1000 },
+			{ 0.0700, 0.0900 },
+			{ 0.0650, 0.0800 },
+			{ 0.0600, 0.0750 },
+			{ 0.0550, 0.0700 },
+			{ 0.0500, 0.0600 },
+			{ 0.0450, 0.0550 },
+			{ 0.0400, 0.0500 },
+			{ 0.0350, 0.0450 },
+			{ 0.0300, 0.0400 },
+		} };
+	};
+
+	struct BinancePolicy : DefaultModelCoefficients
+	{
+		static constexpr EXCHANGE_API api = EXCHANGE_API::BINANCE;
+		static constexpr const char* name = "BINANCE";
+
+		static constexpr double tick_size = 0.01;
+		static constexpr double lot_size = 0.00001;
+
+		static constexpr FeeSchedule fee_schedule = { {
+			{ 0.1000, 0.1000 },
+			{ 0.0900, 0.1000 },
+			{ 0.0800, 0.1000 },
+			{ 0.0420, 0.0600 },
+			{ 0.0420, 0.0540 },
+			{ 0.0360, 0.0480 },
+			{ 0.0300, 0.0420 },
+			{ 0.0240, 0.0360 },
+			{ 0.0180, 0.0300 },
+			{ 0.0120, 0.0240 },
+		} };
+	};
+
+	struct CoinbasePolicy : DefaultModelCoefficients
+	{
+		static constexpr EXCHANGE_API api = EXCHANGE_API::COINBASE;
+		static constexpr const char* name = "COINBASE";
+
+		static constexpr double tick_size = 0.01;
+		static constexpr double lot_size = 0.00000001;
+
+		static constexpr FeeSchedule fee_schedule = { {
+			{ 0.4000, 0.6000 },
+			{ 0.2500, 0.4000 },
+			{ 0.1500, 0.2500 },
+			{ 0.1000, 0.2000 },
+			{ 0.0800, 0.1800 },
+			{ 0.0600, 0.1600 },
+			{ 0.0300, 0.1200 },
+			{ 0.0000, 0.0800 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+		} };
+	};
+
+	struct MEXCPolicy : DefaultModelCoefficients
+	{
+		static constexpr EXCHANGE_API api = EXCHANGE_API::MEXC;
+		static constexpr const char* name = "MEXC";
+
+		static constexpr double tick_size = 0.01;
+		static constexpr double lot_size = 0.000001;
+
+		static constexpr FeeSchedule fee_schedule = { {
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+			{ 0.0000, 0.0500 },
+		} };
+	};
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantFeedQueue.h"
+
+namespace Quant
+{
+	enum class DECODE_STATUS
+	{
+		VALID,
+		INVALID,
+		FILTERED,   // Acknowledgements, other symbols, messages the sequencing rules drop
+	};
+
+	/**
+	 * What a decoder remembers between messages of one connection. Only the parsing
+	 * thread touches it; subscriptions reach it as tasks queued on that thread.
+	 */
+	struct FeedDecoderState
+	{
+		QHash<QString, QString> instruments;  // Venue symbol (BTCUSDT) -> instrument (BTC-USDT)
+		QHash<QString, qint64> last_seq_id;   // Per instrument, for venues that chain updates themselves
+		QSet<QString> synced;                 // Instruments with a snapshot since their subscription
+
+		// Venues with one sequence for the whole connection
+		qint64 connection_seq_id = -1;
+		QSet<QString> connection_gap;         // Instruments that missed part of it
+
+		QString Instrument(const QString& venue_symbol) const { return instruments.value(venue_symbol, venue_symbol); }
+		void Track(const QString& venue_symbol, const QString& instrument);
+		void Reset(const QString& instrument);
+
+		// A new connection starts every sequence over
+		void ResetConnection();
+	};
+
+	// Decodes one frame into zero or more normalized book messages
+	using FeedDecodeFn = DECODE_STATUS(*)(QByteArrayView payload, const QString& symbol_filter, FeedDecoderState& state, std::vector<FeedMessage>& out);
+
+	// Subscribe (or unsubscribe) frame for instruments on one of the OKX-named channels: books, bbo-tbt, books5
+	using FeedSubscribeFn = QByteArray(*)(bool subscribe, const QStringList& instruments, const QString& channel);
+
+	// Instrument (BTC-USDT) as the venue spells it in its messages
+	using FeedVenueSymbolFn = QString(*)(const QString& instrument);
+
+	struct FeedAdapterFns
+	{
+		FeedDecodeFn decode = nullptr;
+		FeedSubscribeFn subscribe = nullptr;
+		FeedVenueSymbolFn venue_symbol = nullptr;
+
+		// Sequence numbers are the same on every connection to the venue
+		bool shared_sequence = true;
+
+		// Levels per side the venue's snapshots carry, 0 when they hold the whole book
+		int book_depth = 0;
+	};
+
+	/**
+	 * Feed adapters
+	 *
+	 * One specialization per venue, each a set of static functions that read that
+	 * venue's wire format straight from the frame with JsonCursor, apply its
+	 * sequencing rules and emit FeedMessages with typed levels:
+	 *  - NONE: the generic flat format ("bids"/"asks"/"action"/"seqId"), as sent by
+	 *    the mock exchange.
+	 *  - OKX: v5 "arg"/"action"/"data" envelope, seqId/prevSeqId chaining.
+	 *  - BINANCE: combined streams; depth20 partial books seed and reseed each symbol
+	 *    and the diff stream's U/u ids chain on their lastUpdateId. Only those 20
+	 *    levels are known, so books are capped there.
+	 *  - COINBASE: Advanced Trade level2 batches; sequence_num is per connection,
+	 *    so a hole in it resynchronizes every product that could have lost an update.
+	 *  - MEXC: v3 JSON limit-depth snapshots (20 levels) and book tickers.
+	 *
+	 * ResolveFeedAdapter() picks the functions once per connection, so a venue only
+	 * ever runs its own decoder.
+	 */
+	template <EXCHANGE_API Venue>
+	struct FeedAdapter;
+
+	FeedAdapterFns ResolveFeedAdapter(EXCHANGE_API exchange);
+
+	// "generic", "okx", "binance", "coinbase", "mexc"; anything else is the generic format
+	EXCHANGE_API StringToFeedFormat(const QString& format);
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+#include <QString>
+
+#include "QuantFeedQueue.h"
+
+namespace Quant
+{
+	class MetricCounter;
+	class MetricHistogram;
+
+	// One line's share of the merged feed
+	struct FeedLineStats
+	{
+		quint64 won = 0;          // Forwarded, first to arrive
+		quint64 duplicates = 0;   // Already forwarded by another line
+		double win_rate = 0.0;    // won / (won + duplicates)
+		quint64 lag_samples = 0;
+		qint64 lag_p50_ns = 0;    // Behind the winning line, upper bucket bound
+		qint64 lag_p99_ns = 0;
+	};
+
+	/**
+	 * First-arrival arbitration between redundant feed lines
+	 *
+	 * Every line decodes the same stream on its own parsing thread and asks Accept()
+	 * before pushing a message: the first line to bring a sequence number forwards
+	 * it, the others drop their copy. Each symbol (and, separately, its top-of-book
+	 * channel) has a slot in a fixed open-addressing table holding the highest
+	 * forwarded sequence number and the last forward_window ones forwarded, one
+	 * entry per sequence number modulo the window. A sequence number is claimed with
+	 * one compare-and-swap on its entry and the message itself is never copied.
+	 * Any number not forwarded yet goes through, also below the highest one: a line
+	 * that skipped it is covered by another line's copy, which the feed queue puts
+	 * back in order before the drain. Numbers forward_window or more behind the
+	 * highest are too late to fill a gap and dropped.
+	 *
+	 * Messages without a venue-wide sequence number cannot be matched across lines
+	 * and are taken from the active line only.
+	 *
+	 * The winner also records its arrival time in a small ring per slot; a line that
+	 * loses the same sequence number later observes how far behind it was.
+	 */
+	class QuantFeedArbiter
+	{
+	public:
+		static constexpr int max_lines = 8;
+
+		QuantFeedArbiter();
+		~QuantFeedArbiter();
+
+		QuantFeedArbiter(const QuantFeedArbiter&) = delete;
+		QuantFeedArbiter& operator=(const QuantFeedArbiter&) = delete;
+
+	public:
+		// Any thread. arrival_ns is the frame's receive time on the arbiter's clock
+		bool Accept(int line, const FeedMessage& message, bool sequenced, qint64 arrival_ns);
+
+		// Line that serves unsequenced messages
+		void SetActiveLine(int line) { m_active_line.store(line, std::memory_order_relaxed); }
+		int ActiveLine() const { return m_active_line.load(std::memory_order_relaxed); }
+
+		// The symbol's sequences start over, as after a new subscription
+		void Reset(const QString& symbol);
+		void ResetAll();
+
+		FeedLineStats Stats(int line) const;
+
+		// Order of creation in the process, the connection label of the line metrics
+		int Connection() const { return m_connection; }
+
+	private:
+		static constexpr int win_history = 16;
+		static constexpr int forward_window = 64;
+		static constexpr int slot_capacity = 512;
+
+		struct WinRecord
+		{
+			std::atomic<qint64> seq_id{ -1 };
+			std::atomic<qint64> arrival_ns{ 0 };
+		};
+
+		struct alignas(64) Slot
+		{
+			std::atomic<quint64> key{ 0 }; // 0 is free; claimed once, never released
+			std::atomic<qint64> last_seq_id{ -1 };
+			std::atomic<qint64> forwarded[forward_window]; // Sequence number forwarded at each entry, -1 for none
+			WinRecord wins[win_history];
+
+			Slot()
+			{
+				for (std::atomic<qint64>& entry : forwarded)
+					entry.store(-1, std::memory_order_relaxed);
+			}
+		};
+
+		struct LineMetrics
+		{
+			MetricCounter* won = nullptr;
+			MetricCounter* duplicates = nullptr;
+			MetricHistogram* lag = nullptr;
+		};
+
+		static quint64 KeyOf(const QString& symbol, bool is_top_of_book);
+		static void ClearSlot(Slot& slot);
+		Slot* Find(quint64 key);
+		void RecordWin(Slot& slot, qint64 seq_id, qint64 arrival_ns);
+		bool WinTime(const Slot& slot, qint64 seq_id, qint64& arrival_ns) const;
+
+	private:
+		std::unique_ptr<Slot[]> m_slots;
+		std::atomic<int> m_active_line{ 0 };
+		int m_connection = 0;
+		LineMetrics m_lines[max_lines];
+	};
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include "QuantBookView.h"
+
+namespace Quant
+{
+	// One decoded book message on its way to the orderbook, levels in venue order
+	struct FeedMessage
+	{
+		QString symbol;
+		QVector<BookLevel> bids;
+		QVector<BookLevel> asks;
+		bool is_delta = false;
+		qint64 seq_id = -1;
+		qint64 prev_seq_id = -1;
+		qint64 received_ns = 0;
+
+		// bbo-tbt and books5 carry only the best levels, parsed straight away
+		bool is_top_of_book = false;
+		BookLevel best_bid;
+		BookLevel best_ask;
+	};
+
+	enum class BACKPRESSURE_POLICY
+	{
+		CONFLATE,    // Collapse contiguous pending messages into one holding the latest state
+		KEEP_ALL,    // Deliver every message, unbounded
+		DROP_RESYNC, // Deliver every message, drop and resync past the limits
+	};
+
+	struct BackpressureLimits
+	{
+		int max_depth = 1024;          // Pending messages per symbol
+		qint64 max_staleness_ms = 1000; // Age of the oldest pending message
+	};
+
+	struct FeedQueueStats
+	{
+		int depth = 0;
+		qint64 enqueued = 0;
+		qint64 delivered = 0;
+		qint64 conflated = 0;
+		qint64 dropped = 0;
+		qint64 resyncs = 0;
+		qint64 top_delivered = 0;
+		qint64 top_conflated = 0;
+	};
+
+	/**
+	 * Hand-off between the parsing thread and the consumers of the book
+	 *
+	 * Messages are queued per symbol and delivered on the queue's thread by a single
+	 * scheduled drain, however many arrive before it runs. What piles up while the
+	 * consumer is busy depends on the symbol's policy:
+	 *  - CONFLATE merges deltas level by level into the pending message and a snapshot
+	 *    replaces everything pending. A delta that does not continue the sequence of
+	 *    the pending message (a message was lost in between, or either id is unknown)
+	 *    is queued on its own, so the book's gap check still fires; unsequenced deltas
+	 *    merge anyway once the symbol reaches its depth limit. Without gaps at most
+	 *    one message per symbol is pending.
+	 *  - KEEP_ALL queues every message, for consumers that need the full stream.
+	 *  - DROP_RESYNC queues every message until the symbol exceeds its depth or
+	 *    staleness limit, then discards its queue, drops deltas until the next
+	 *    snapshot and emits resyncRequested().
+	 *
+	 * A delta that a pending delta follows (a redundant line's copy of a message the
+	 * faster line skipped) is put back in front of it whatever the policy, merged
+	 * with its neighbours under CONFLATE, so the gap closes before the book sees it.
+	 *
+	 * Top-of-book messages bypass the policy: each symbol keeps only the latest one,
+	 * delivered after its book messages, so a fast BBO channel never queues behind
+	 * or merges into the deep book.
+	 *
+	 * Producers normally take the lock and post one drain to the queue's thread.
+	 * When that thread busy polls (QuantRuntimeProfile::SpinsCurrentThread() where
+	 * the queue is created), each producer instead hands its messages over through
+	 * its own single-producer single-consumer ring, and a zero-interval timer keeps
+	 * the thread's event loop polling the rings rather than sleeping until a drain is
+	 * posted. The books still belong to that event loop. What the poll takes goes
+	 * through the same policies and is delivered at once. A producer never waits on
+	 * a full ring: the message is dropped and its symbol resynchronized, as under
+	 * DROP_RESYNC.
+	 */
+	class QuantFeedQueue : public QObject
+	{
+		Q_OBJECT
+		Q_PROPERTY(int queueDepth READ QueueDepth NOTIFY statsChanged)
+		Q_PROPERTY(qint64 conflatedCount READ ConflatedCount NOTIFY statsChanged)
+		Q_PROPERTY(qint64 droppedCount READ DroppedCount NOTIFY statsChanged)
+
+	public:
+		explicit QuantFeedQueue(QObject* parent = nullptr);
+		~QuantFeedQueue();
+
+	public:
+		// Also applies to the symbols without a policy of their own
+		void SetDefaultPolicy(BACKPRESSURE_POLICY policy, const BackpressureLimits& limits = BackpressureLimits());
+		void SetPolicy(const QString& symbol, BACKPRESSURE_POLICY policy, const BackpressureLimits& limits = BackpressureLimits());
+
+		// Busy polling only: rings for producers 0 to count - 1; queue's thread, before those producers start
+		void SetProducerCount(int count);
+		bool IsBusyPolling() const { return m_busy_poll; }
+
+		// Thread-safe; a producer with a ring hands the message over through it, one thread at a time
+		void Push(FeedMessage message, int producer = -1);
+
+		int QueueDepth() const;
+		qint64 ConflatedCount() const;
+		qint64 DroppedCount() const;
+		FeedQueueStats Stats(const QString& symbol) const;
+
+	signals:
+		// The symbol comes last, so single-book slots can leave it out
+		void snapshotReady(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, const QString& symbol);
+		void deltaReady(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, qint64 prev_seq_id, const QString& symbol);
+		void topOfBookReady(const QString& symbol, const Quant::BookLevel& best_bid, const Quant::BookLevel& best_ask);
+		void resyncRequested(const QString& symbol);
+		void statsChanged();
+
+	private:
+		struct SymbolQueue
+		{
+			BACKPRESSURE_POLICY policy = BACKPRESSURE_POLICY::CONFLATE;
+			BackpressureLimits limits;
+			bool has_own_policy = false;
+			std::deque<FeedMessage> pending;
+			bool has_top = false;
+			FeedMessage top;
+			bool awaiting_snapshot = false;
+			FeedQueueStats stats;
+		};
+
+		// Producer side pushes at head, the queue's thread takes from tail
+		struct HandoffRing
+		{
+			explicit HandoffRing(int capacity) : slots(capacity), mask(static_cast<quint64>(capacity) - 1) {}
+
+			std::vector<FeedMessage> slots;
+			quint64 mask = 0;
+			alignas(64) std::atomic<quint64> head{ 0 }; // Written by the producer
+			alignas(64) std::atomic<quint64> tail{ 0 }; // Written by the queue's thread
+
+			// Symbols that lost a message to a full ring
+			std::atomic<bool> overflowed{ false };
+			std::mutex overflow_mutex;
+			QSet<QString> overflow_symbols;
+		};
+
+		void Drain();
+		void PollHandoffs();
+		void HandOff(HandoffRing& ring, FeedMessage message);
+
+		// Under the lock; true when the symbol has to be resynchronized
+		bool Enqueue(FeedMessage message, qint64 now_ns);
+		void EnqueueTopOfBook(FeedMessage message);
+		SymbolQueue& QueueFor(const QString& symbol);
+		bool ExceedsLimits(const SymbolQueue& queue, qint64 now_ns) const;
+		void Conflate(FeedMessage& pending, const FeedMessage& delta) const;
+		bool FillGap(SymbolQueue& queue, FeedMessage& message);
+
+	private:
+		mutable std::mutex m_mutex;
+		QHash<QString, SymbolQueue> m_queues;
+		BACKPRESSURE_POLICY m_default_policy = BACKPRESSURE_POLICY::CONFLATE;
+		BackpressureLimits m_default_limits;
+		bool m_drain_scheduled = false;
+		int m_depth = 0;
+		qint64 m_conflated = 0;
+		qint64 m_dropped = 0;
+
+		QElapsedTimer m_clock;
+
+		static constexpr int max_producers = 8;
+		static constexpr int ring_capacity = 4096; // Messages per producer, a power of two
+
+		bool m_busy_poll = false;
+		QTimer m_poll_timer;
+		std::array<std::unique_ptr<HandoffRing>, max_producers> m_rings;
+	};
+}
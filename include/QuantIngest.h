@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantFeedQueue.h"
+
+class QThread;
+
+namespace Quant
+{
+	class QuantConnectionManager;
+	class QuantOrderbook;
+	class QuantScenarioEngine;
+	class QuantWebSocket;
+
+	/**
+	 * One feed connection and the books of its symbols
+	 *
+	 * Lives on its own thread: the socket, its queue, the connection manager, the
+	 * books and the scenario engine of those books are all created there, so frames
+	 * are drained, books updated and scenarios evaluated by that thread's event loop.
+	 * Only QuantIngest talks to it, through queued calls.
+	 */
+	class QuantIngestShard : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantIngestShard(int index, QObject* parent = nullptr);
+
+	public:
+		int Index() const { return m_index; }
+
+		// Shard thread only
+		void Init();
+		QuantOrderbook* AddSymbol(EXCHANGE_API exchange, const QString& symbol, int depth);
+		void SetFeedSettings(const QString& top_channel, BACKPRESSURE_POLICY policy, const BackpressureLimits& limits, int requests_per_second);
+		void LoadScenarios(const QString& path);
+		QuantScenarioEngine* ScenarioEngine() const { return m_scenario_engine; }
+		void Start(const QString& url, const QStringList& redundant_urls, EXCHANGE_API format);
+		void Stop();
+		void Shutdown();
+
+	private:
+		void OnSnapshot(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, const QString& symbol);
+		void OnDelta(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, qint64 prev_seq_id, const QString& symbol);
+		void OnTopOfBook(const QString& symbol, const Quant::BookLevel& best_bid, const Quant::BookLevel& best_ask);
+
+	private:
+		int m_index = 0;
+		QuantWebSocket* m_websocket = nullptr;
+		QuantConnectionManager* m_connection_manager = nullptr;
+		QuantScenarioEngine* m_scenario_engine = nullptr;
+		QHash<QString, QuantOrderbook*> m_books;
+	};
+
+	/**
+	 * Sharded feed ingest
+	 *
+	 * Opens connection_count connections, each a QuantWebSocket with its own thread
+	 * and event loop. A symbol always goes to the same connection (FNV-1a of its
+	 * name modulo the connection count, so the assignment survives restarts), and its
+	 * book lives on that connection's thread: parsing, draining and book updates of
+	 * one connection never wait on another connection or on the GUI.
+	 *
+	 * The books returned by AddSymbol() belong to their shard's thread. Connect to
+	 * them with queued connections, or with direct ones from objects living there.
+	 * Standing scenarios of their symbols are evaluated there too, by one engine per
+	 * connection.
+	 */
+	class QuantIngest : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantIngest(int connection_count, QObject* parent = nullptr);
+		~QuantIngest();
+
+	public:
+		int ConnectionCount() const { return static_cast<int>(m_shards.size()); }
+
+		// Stable symbol to connection assignment
+		static int ConnectionFor(const QString& symbol, int connection_count);
+
+		// Adds the symbol to its connection and returns its book, the existing one if already added
+		QuantOrderbook* AddSymbol(EXCHANGE_API exchange, const QString& symbol, int depth = 0);
+		QuantOrderbook* Book(const QString& symbol) const { return m_books.value(symbol); }
+		QStringList Symbols(int connection) const;
+
+		// Top-of-book channel, backpressure and request rate limit of every connection, applied without a reconnect
+		void SetFeedSettings(const QString& top_channel, BACKPRESSURE_POLICY policy, const BackpressureLimits& limits, int requests_per_second);
+
+		// Loads the scenario file into every connection's engine, each evaluating those of its own symbols
+		void LoadScenarios(const QString& path);
+
+		// Engine of the connection, living on its thread; ResultsUpdated is emitted there
+		QuantScenarioEngine* ScenarioEngine(int connection) const;
+
+		// (Re)connects every connection that has symbols, each over the same redundant lines
+		void Start(const QString& url, const QStringList& redundant_urls, EXCHANGE_API format);
+		void Stop();
+
+	private:
+		struct Shard
+		{
+			QThread* thread = nullptr;
+			QuantIngestShard* worker = nullptr;
+			QStringList symbols;
+		};
+
+		std::vector<Shard> m_shards;
+		QHash<QString, QuantOrderbook*> m_books;
+	};
+}
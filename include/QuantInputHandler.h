@@ -7,6 +7,7 @@ namespace Quant
 	Q_NAMESPACE
 	
 	Q_ENUM_NS(ORDER_TYPE)
+	Q_ENUM_NS(ORDER_SIDE)
 	Q_ENUM_NS(FEE_TIER)
 
 	enum class SPOT_ASSET
@@ -27,6 +28,9 @@ namespace Quant
 	public:
 		static QString OrderTypeToString(ORDER_TYPE type);
 		static ORDER_TYPE StringToOrderType(const QString& str);
+	public:
+		static QString OrderSideToString(ORDER_SIDE side);
+		static ORDER_SIDE StringToOrderSide(const QString& str);
 	public:
 		static QString FeeTierToString(FEE_TIER tier);
 		static FEE_TIER StringToFeeTier(const QString& str);
@@ -38,6 +42,7 @@ namespace Quant
 		static EXCHANGE_API StringToExchange(const QString& str);
 	public:
 		static QStringList GetAllOrderType();
+		static QStringList GetAllOrderSides();
 		static QStringList GetAllFeeTierType();
 		static QStringList GetAllSpotAssets();
 		static QStringList GetAllExchanges();
@@ -49,6 +54,7 @@ namespace Quant
 		Q_PROPERTY(QString selected_exchange READ SelectedExchangeString WRITE SetSelectedExchangeString NOTIFY SelectedExchangeChanged)
 		Q_PROPERTY(QString selected_asset READ SelectedAssetString WRITE SetSelectedAssetString NOTIFY SelectedAssetChanged)
 		Q_PROPERTY(QString order_type READ OrderTypeString WRITE SetOrderTypeString NOTIFY OrderTypeChanged)
+		Q_PROPERTY(QString order_side READ OrderSideString WRITE SetOrderSideString NOTIFY OrderSideChanged)
 		Q_PROPERTY(QString fee_tier READ FeeTierString WRITE SetFeeTierString NOTIFY FeeTierChanged)
 		Q_PROPERTY(double quantity READ Quantity WRITE SetQuantity NOTIFY QuantityChanged)
 		Q_PROPERTY(double usd_amount READ USDAmount WRITE SetUSDAmount NOTIFY USDAmountChanged)
@@ -57,6 +63,7 @@ namespace Quant
 
 		// Expose the enum types to QML
 		Q_PROPERTY(QStringList available_order_types READ AvailableOrderTypes CONSTANT)
+		Q_PROPERTY(QStringList available_order_sides READ AvailableOrderSides CONSTANT)
 		Q_PROPERTY(QStringList available_fee_tiers READ AvailableFeeTiers CONSTANT)
 		Q_PROPERTY(QStringList available_spot_assets READ AvailableSpotAssets CONSTANT)
 		Q_PROPERTY(QStringList available_exchanges READ AvailableExchanges CONSTANT)
@@ -68,12 +75,14 @@ namespace Quant
 		QString SelectedExchangeString() const { return EnumConverter::ExchangeToString(m_selected_exchange); }
 		QString SelectedAssetString() const { return EnumConverter::SpotAssetToString(m_selected_asset); }
 		QString OrderTypeString() const { return EnumConverter::OrderTypeToString(m_order_type); }
+		QString OrderSideString() const { return EnumConverter::OrderSideToString(m_order_side); }
 		QString FeeTierString() const { return EnumConverter::FeeTierToString(m_fee_tier); }
 
 	public:
 		EXCHANGE_API SelectedExchange() const { return m_selected_exchange; }
 		SPOT_ASSET SelectedAsset() const { return m_selected_asset; }
 		ORDER_TYPE OrderType() const { return m_order_type; }
+		ORDER_SIDE OrderSide() const { return m_order_side; }
 		FEE_TIER FeeTier() const { return m_fee_tier; }
 
 	public:
@@ -86,12 +95,14 @@ namespace Quant
 		QStringList AvailableExchanges() const { return EnumConverter::GetAllExchanges(); }
 		QStringList AvailableSpotAssets() const { return EnumConverter::GetAllSpotAssets(); }
 		QStringList AvailableOrderTypes() const { return EnumConverter::GetAllOrderType(); }
+		QStringList AvailableOrderSides() const { return EnumConverter::GetAllOrderSides(); }
 		QStringList AvailableFeeTiers() const { return EnumConverter::GetAllFeeTierType(); }
 
 	public:
 		void SetSelectedExchange(EXCHANGE_API exchange);
 		void SetSelectedAsset(SPOT_ASSET asset);
 		void SetOrderType(ORDER_TYPE order_type);
+		void SetOrderSide(ORDER_SIDE order_side);
 		void SetFeeTier(FEE_TIER fee_tier);
 		void SetVolatilityEnabled(bool enabled);
 
@@ -104,6 +115,7 @@ namespace Quant
 		void SetSelectedExchangeString(const QString& exchange);
 		void SetSelectedAssetString(const QString& asset);
 		void SetOrderTypeString(const QString& order_type);
+		void SetOrderSideString(const QString& order_side);
 		void SetFeeTierString(const QString& fee_tier);
 
 	public slots:
@@ -113,6 +125,7 @@ namespace Quant
 		void SelectedExchangeChanged();
 		void SelectedAssetChanged();
 		void OrderTypeChanged();
+		void OrderSideChanged();
 		void QuantityChanged();
 		void USDAmountChanged();
 		void VolatilityChanged();
@@ -126,6 +139,7 @@ namespace Quant
 		EXCHANGE_API m_selected_exchange = EXCHANGE_API::OKX;
 		SPOT_ASSET m_selected_asset = SPOT_ASSET::BTC_USDT_SWAP;
 		ORDER_TYPE m_order_type = ORDER_TYPE::MARKET;
+		ORDER_SIDE m_order_side = ORDER_SIDE::BUY;
 		double m_quantity = 1.0;
 		double m_usd_amount = 100.0;
 		double m_volatility = 0.01;
@@ -0,0 +1,230 @@
+#pragma once
+#include <charconv>
+#include <string_view>
+
+#include <QtGlobal>
+
+// libc++ declares floating-point from_chars from version 20; the feature macro is only set with it
+#if defined(__cpp_lib_to_chars) || (defined(_LIBCPP_VERSION) && _LIBCPP_VERSION >= 200000)
+#define QUANT_HAS_FLOAT_FROM_CHARS 1
+#else
+#define QUANT_HAS_FLOAT_FROM_CHARS 0
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+#endif
+
+namespace Quant
+{
+	/**
+	 * Forward-only JSON reader over a UTF-8 buffer
+	 *
+	 * Reads values in place without building a document: strings come back as views
+	 * into the buffer (escapes are left as they are, which the feeds never need in
+	 * keys, symbols or numbers), numbers are converted with std::from_chars (strtod_l
+	 * in the C locale where the standard library has no floating-point from_chars),
+	 * and whatever the caller does not ask for is skipped. Numbers may also be given
+	 * as strings, the way venues send prices.
+	 *
+	 * Containers are read with Enter*() followed by Next*() until it returns false;
+	 * each member or element has to be read or skipped before the next Next*() call.
+	 * A malformed buffer makes every call fail from then on.
+	 */
+	class JsonCursor
+	{
+	public:
+		JsonCursor(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+	public:
+		bool Failed() const { return m_failed; }
+
+		// Next significant character, 0 at the end
+		char Peek()
+		{
+			SkipWhitespace();
+			return m_pos < m_end ? *m_pos : 0;
+		}
+
+		bool EnterObject() { return Expect('{'); }
+		bool EnterArray() { return Expect('['); }
+
+		// Positions on the value of the next member, false after the closing brace
+		bool NextMember(std::string_view& key)
+		{
+			if (!NextItem('}'))
+				return false;
+			return ReadString(key) && Expect(':');
+		}
+
+		// Positions on the next element, false after the closing bracket
+		bool NextElement() { return NextItem(']'); }
+
+		bool ReadString(std::string_view& value)
+		{
+			if (!Expect('"'))
+				return false;
+
+			const char* begin = m_pos;
+			while (m_pos < m_end && *m_pos != '"')
+				m_pos += (*m_pos == '\\') ? 2 : 1;
+
+			if (m_pos >= m_end)
+				return Fail();
+
+			value = std::string_view(begin, static_cast<size_t>(m_pos - begin));
+			m_pos++;
+			return true;
+		}
+
+		bool ReadDouble(double& value) { return ReadNumber(value); }
+		bool ReadInteger(qint64& value) { return ReadNumber(value); }
+
+		bool SkipValue()
+		{
+			const char next = Peek();
+			if (next == '"')
+			{
+				std::string_view ignored;
+				return ReadString(ignored);
+			}
+
+			if (next == '{' || next == '[')
+			{
+				// Brackets inside strings do not count
+				int depth = 0;
+				while (m_pos < m_end)
+				{
+					const char ch = *m_pos;
+					if (ch == '"')
+					{
+						std::string_view ignored;
+						if (!ReadString(ignored))
+							return false;
+						continue;
+					}
+
+					m_pos++;
+					if (ch == '{' || ch == '[')
+						depth++;
+					else if ((ch == '}' || ch == ']') && --depth == 0)
+						return true;
+				}
+				return Fail();
+			}
+
+			// Number, true, false or null
+			const char* begin = m_pos;
+			while (m_pos < m_end && *m_pos != ',' && *m_pos != '}' && *m_pos != ']' && !IsWhitespace(*m_pos))
+				m_pos++;
+			return m_pos > begin || Fail();
+		}
+
+	private:
+		static bool IsWhitespace(char ch) { return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t'; }
+
+		void SkipWhitespace()
+		{
+			while (m_pos < m_end && IsWhitespace(*m_pos))
+				m_pos++;
+		}
+
+		bool Fail()
+		{
+			m_failed = true;
+			m_pos = m_end;
+			return false;
+		}
+
+		bool Expect(char ch)
+		{
+			if (Peek() != ch)
+				return Fail();
+			m_pos++;
+			return true;
+		}
+
+		bool NextItem(char closing)
+		{
+			const char next = Peek();
+			if (next == closing)
+			{
+				m_pos++;
+				return false;
+			}
+			if (next == ',')
+			{
+				m_pos++;
+				SkipWhitespace();
+			}
+			return m_pos < m_end || Fail();
+		}
+
+		template <typename T>
+		bool ReadNumber(T& value)
+		{
+			const bool quoted = Peek() == '"';
+			if (quoted)
+				m_pos++;
+
+			if (!Convert(value))
+				return Fail();
+
+			return !quoted || Expect('"');
+		}
+
+		template <typename T>
+		bool Convert(T& value)
+		{
+			const std::from_chars_result result = std::from_chars(m_pos, m_end, value);
+			if (result.ec != std::errc())
+				return false;
+			m_pos = result.ptr;
+			return true;
+		}
+
+#if !QUANT_HAS_FLOAT_FROM_CHARS
+		// No floating-point from_chars (libc++ before 20, Apple's included): strtod in the C locale,
+		// on a terminated copy since the buffer need not end after the number
+		bool Convert(double& value)
+		{
+			char number[max_number_chars + 1];
+			int length = 0;
+			while (length < max_number_chars && m_pos + length < m_end && IsNumberChar(m_pos[length]))
+			{
+				number[length] = m_pos[length];
+				length++;
+			}
+			number[length] = '\0';
+
+			// from_chars takes no leading '+'
+			if (length == 0 || number[0] == '+')
+				return false;
+
+			static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", nullptr);
+			char* parsed = nullptr;
+			errno = 0;
+			value = strtod_l(number, &parsed, c_locale);
+			if (parsed == number || errno == ERANGE)
+				return false;
+
+			m_pos += parsed - number;
+			return true;
+		}
+
+		static bool IsNumberChar(char c)
+		{
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+		}
+
+		static constexpr int max_number_chars = 64;
+#endif
+
+	private:
+		const char* m_pos = nullptr;
+		const char* m_end = nullptr;
+		bool m_failed = false;
+	};
+}
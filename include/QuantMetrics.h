@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+namespace Quant
+{
+	// Monotonic count, one relaxed atomic add per event
+	class MetricCounter
+	{
+	public:
+		void Add(quint64 value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+		quint64 Value() const { return m_value.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<quint64> m_value{ 0 };
+	};
+
+	// Current level of something, such as a queue depth
+	class MetricGauge
+	{
+	public:
+		void Set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+		void Add(qint64 value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+		qint64 Value() const { return m_value.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<qint64> m_value{ 0 };
+	};
+
+	/**
+	 * Latency histogram with fixed bucket bounds in nanoseconds
+	 *
+	 * An observation is a scan of the (few) bounds and two relaxed atomic adds;
+	 * buckets are exported cumulatively, in seconds, as Prometheus expects.
+	 */
+	class MetricHistogram
+	{
+	public:
+		explicit MetricHistogram(std::vector<qint64> bounds_ns);
+
+		void Observe(qint64 value_ns);
+
+		const std::vector<qint64>& Bounds() const { return m_bounds_ns; }
+		quint64 BucketCount(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+		quint64 Count() const;
+		quint64 SumNs() const { return m_sum_ns.load(std::memory_order_relaxed); }
+
+		// 1 us to 1 s, 1-2.5-5 steps
+		static std::vector<qint64> LatencyBounds();
+
+	private:
+		std::vector<qint64> m_bounds_ns;
+		std::unique_ptr<std::atomic<quint64>[]> m_buckets; // Last one is +Inf
+		std::atomic<quint64> m_sum_ns{ 0 };
+	};
+
+	/**
+	 * Process-wide metrics registry
+	 *
+	 * Metrics are registered once, typically at startup, and live as long as the
+	 * process; the returned references stay valid and updating them takes no lock.
+	 * Expose() renders everything in the Prometheus text format (version 0.0.4).
+	 */
+	class QuantMetricsRegistry
+	{
+	public:
+		static QuantMetricsRegistry& Instance();
+
+	public:
+		// labels is the inside of the braces, e.g. stage="decode", empty for none
+		MetricCounter& Counter(const QString& name, const QString& help, const QString& labels = QString());
+		MetricGauge& Gauge(const QString& name, const QString& help, const QString& labels = QString());
+		MetricHistogram& Histogram(const QString& name, const QString& help, const QString& labels = QString());
+
+		QByteArray Expose() const;
+
+	private:
+		QuantMetricsRegistry() = default;
+
+		enum class METRIC_TYPE
+		{
+			COUNTER,
+			GAUGE,
+			HISTOGRAM,
+		};
+
+		struct Entry
+		{
+			METRIC_TYPE type;
+			QString name;
+			QString help;
+			QString labels;
+			void* metric;
+		};
+
+		void* Find(METRIC_TYPE type, const QString& name, const QString& labels) const;
+
+	private:
+		mutable std::mutex m_mutex;
+		std::vector<Entry> m_entries;
+		std::deque<MetricCounter> m_counters;
+		std::deque<MetricGauge> m_gauges;
+		std::deque<MetricHistogram> m_histograms;
+	};
+
+	// The simulator's pipeline metrics, registered on first use
+	struct PipelineMetrics
+	{
+		MetricCounter& messages_received;
+		MetricCounter& messages_filtered;
+		MetricCounter& decode_errors;
+		MetricCounter& book_snapshots;
+		MetricCounter& book_deltas;
+		MetricCounter& book_top_updates;
+		MetricCounter& sequence_gaps;
+		MetricCounter& feed_conflated;
+		MetricCounter& feed_dropped;
+		MetricGauge& feed_queue_depth;
+		MetricCounter& socket_connects;
+		MetricCounter& socket_disconnects;
+		MetricCounter& socket_errors;
+		MetricCounter& calculations;
+		MetricCounter& calculations_coalesced;
+		MetricCounter& feature_cache_hits;
+		MetricCounter& result_cache_hits;
+
+		MetricHistogram& decode_latency;
+		MetricHistogram& queue_latency;
+		MetricHistogram& book_apply_latency;
+		MetricHistogram& calculation_latency;
+
+		static PipelineMetrics& Get();
+	};
+}
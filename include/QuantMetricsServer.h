@@ -0,0 +1,39 @@
+#pragma once
+#include <QObject>
+#include <QTcpServer>
+
+class QTcpSocket;
+
+namespace Quant
+{
+	/**
+	 * Serves the metrics registry over HTTP on a loopback port
+	 *
+	 * GET /metrics answers with the Prometheus text exposition, GET /trace with the
+	 * span timeline (see QuantTracer) and POST /trace/start, /trace/stop toggle it.
+	 * The wrong method on a known path is a 405, anything else a 404.
+	 * One request per connection, so a scraper never holds a socket open.
+	 */
+	class QuantMetricsServer : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantMetricsServer(QObject* parent = nullptr);
+
+	public:
+		bool Listen(quint16 port);
+		quint16 Port() const { return m_server.serverPort(); }
+
+	private slots:
+		void OnNewConnection();
+
+	private:
+		void OnReadyRead(QTcpSocket* socket);
+
+	private:
+		static constexpr int max_request_bytes = 8192;
+
+		QTcpServer m_server;
+	};
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+
+#include "QuantBookView.h"
+
+namespace Quant
+{
+	/**
+	 * Streaming order-flow features of one book
+	 *
+	 * Follows the book update by update: the book reports its best levels before and
+	 * after each update and every level the update changed, with the amount it had.
+	 * An update costs O(changed levels); nothing rescans the book.
+	 *
+	 * Flows, depletions and update counts go to a rolling window of window_buckets
+	 * time buckets. The window keeps running totals and subtracts a bucket as it
+	 * expires, so memory is fixed and reading the features is O(1). The features are
+	 * taken as of the last update; the window does not move between updates.
+	 *
+	 * A snapshot replaces the book without saying what changed, so it only moves the
+	 * best-level flow and the intensities. Not synchronized; the book's thread only.
+	 */
+	class QuantMicrostructure
+	{
+	public:
+		static constexpr qint64 window_ns = 1000000000; // 1 s
+		static constexpr int window_buckets = 20;
+
+		// Half-widths of the deeper OFI bands around the best price, in basis points
+		static constexpr std::array<double, FlowFeatures::ofi_depths> ofi_band_bps = { 0.0, 10.0, 50.0 };
+
+	public:
+		void Reset();
+
+		// An update of the book: its best levels before it, each changed level, its best levels after it
+		void BeginUpdate(const BookLevel& best_bid, const BookLevel& best_ask, qint64 now_ns);
+		void OnLevel(bool is_bid, double price, double previous_amount, double amount);
+		void EndUpdate(const BookLevel& best_bid, const BookLevel& best_ask, bool is_snapshot);
+
+		const FlowFeatures& Features() const { return m_features; }
+
+	private:
+		enum CHANNEL
+		{
+			OFI_0,
+			GROSS_0 = OFI_0 + FlowFeatures::ofi_depths,
+			BID_DEPLETED = GROSS_0 + FlowFeatures::ofi_depths,
+			ASK_DEPLETED,
+			QUOTE_UPDATES,
+			LEVEL_UPDATES,
+			CHANNEL_COUNT,
+		};
+
+		void Advance(qint64 now_ns);
+		void Add(int channel, double value);
+		void Publish(const BookLevel& best_bid, const BookLevel& best_ask);
+
+	private:
+		using Bucket = std::array<double, CHANNEL_COUNT>;
+
+		std::array<Bucket, window_buckets> m_buckets{};
+		Bucket m_totals{};
+		int m_head = 0;
+		qint64 m_head_epoch = -1; // Bucket number of m_head since the clock's epoch, -1 before the first update
+
+		BookLevel m_bid_before;
+		BookLevel m_ask_before;
+		int m_changed_levels = 0;
+
+		FlowFeatures m_features;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "IQuantCalculatorAPI.h"
+#include "QuantCalculator.h"
 #include <QPair>
 #include <QMap>
 
@@ -15,8 +16,8 @@ namespace Quant
 		fee_rate_map m_fee_rates;
 		State m_state;
 
-		static bool m_is_volatility_enabled;
-		static double m_process_time_ms;
+		bool m_is_volatility_enabled = false;
+		double m_process_time_ms = 0.0;
 
 
 	public:
@@ -31,11 +32,11 @@ namespace Quant
 		double CalculateMakerRatio(const QVariantList& bids, const QVariantList& asks) override;
 
 	public:
-		static bool isVolatilityEnabled() { return m_is_volatility_enabled; }
-		static double GetProcessingTime() { return m_process_time_ms; }
+		bool isVolatilityEnabled() const { return m_is_volatility_enabled; }
+		double GetProcessingTime() const { return m_process_time_ms; }
 
-		static void SetVolatilityEnabled(bool enabled) { m_is_volatility_enabled = enabled; }
-		static void SetProcessingTime(double elapsed_ms) { m_process_time_ms = elapsed_ms; }
+		void SetVolatilityEnabled(bool enabled) { m_is_volatility_enabled = enabled; }
+		void SetProcessingTime(double elapsed_ms) { m_process_time_ms = elapsed_ms; }
 
 	private:
 		void InitializeFeeRates() override;
@@ -44,10 +45,9 @@ namespace Quant
 		State GetState() const override { return m_state; }
 
 	public:
-		static QuantOKXCalculator& get();
+		QuantOKXCalculator() { InitializeFeeRates(); }
 
 	private:
-		QuantOKXCalculator() { InitializeFeeRates(); }
 		price_amount_pair GetFeeRates(FEE_TIER tier) const;
 
 	};
@@ -1,6 +1,11 @@
 #pragma once
-#include <QJsonArray>
 #include <QObject>
+#include <QVector>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantBookView.h"
+#include "QuantMicrostructure.h"
+#include "QuantPriceLadder.h"
 
 namespace Quant
 {
@@ -11,38 +16,107 @@ namespace Quant
     	// TODO: Update the code to work with Q_PROPERTYs
         //Q_PROPERTY(QVariantList bids READ getBids NOTIFY orderbookUpdated)
         //Q_PROPERTY(QVariantList asks READ getAsks NOTIFY orderbookUpdated)
+        Q_PROPERTY(bool stale READ isStale NOTIFY staleChanged)
+        Q_PROPERTY(double bestBidPrice READ bestBidPrice NOTIFY topOfBookUpdated)
+        Q_PROPERTY(double bestAskPrice READ bestAskPrice NOTIFY topOfBookUpdated)
+        Q_PROPERTY(double midPrice READ midPrice NOTIFY topOfBookUpdated)
+        Q_PROPERTY(double spread READ spread NOTIFY topOfBookUpdated)
     public:
         explicit QuantOrderbook(QObject *parent = nullptr);
 
         // Methods to update data
-        void updateOrderbook(const QJsonArray &bids, const QJsonArray &asks);
+        // Snapshots replace the book, deltas set each listed level (amount 0 removes it)
+        void updateOrderbook(const QVector<BookLevel> &bids, const QVector<BookLevel> &asks, qint64 seq_id = -1);
+        void applyDelta(const QVector<BookLevel> &bids, const QVector<BookLevel> &asks, qint64 seq_id, qint64 prev_seq_id);
+
+        // bbo-tbt / books5 fast path: moves the top of book only, the depth keeps its own version
+        void updateTopOfBook(const QString& symbol, const BookLevel& best_bid, const BookLevel& best_ask);
+
+        // The top-of-book channel went away or changed; the deep book serves the top until it delivers again
+        void resetTopOfBook();
 
         // Methods to expose data to QML
         Q_INVOKABLE QVariantList getBids() const;
         Q_INVOKABLE QVariantList getAsks() const;
 
+        // Instrument the book belongs to
+        void SetInstrument(EXCHANGE_API exchange, const QString& symbol);
+        EXCHANGE_API Exchange() const { return m_exchange; }
+        QString Symbol() const { return m_symbol; }
+
+        // Levels kept per side, 0 for the full depth the venue sends; takes effect with the next snapshot
+        void SetDepth(int depth);
+        int Depth() const { return m_depth; }
+
+        // Levels per side the feed keeps correct, 0 when it covers the whole book; caps the depth set above
+        void SetDepthLimit(int levels);
+
+        // Typed view for the calculator, valid until the next update
+        BookView View() const;
+
+        // O(1) from the ladders, without rebuilding the sorted sides
+        BookLevel BestBid() const { return m_bid_ladder.Best(); }
+        BookLevel BestAsk() const { return m_ask_ladder.Best(); }
+        quint64 Version() const { return m_version; }
+        qint64 SequenceId() const { return m_seq_id; }
+
+        // Levels set by the last delta, for consumers that follow the book incrementally;
+        // after a snapshot the whole book changed and both are empty
+        bool LastUpdateWasSnapshot() const { return m_last_was_snapshot; }
+        const QVector<BookLevel>& LastBidChanges() const { return m_bid_changes; }
+        const QVector<BookLevel>& LastAskChanges() const { return m_ask_changes; }
+
+        // Order-flow features as of the last update, also carried by View()
+        const FlowFeatures& Flow() const { return m_flow.Features(); }
+
+        // Follows the top-of-book channel once it delivers, the deep book until then
+        const TopOfBook& Top() const { return m_top; }
+        quint64 TopVersion() const { return m_top.version; }
+        double bestBidPrice() const { return m_top.bid.price; }
+        double bestAskPrice() const { return m_top.ask.price; }
+        double midPrice() const { return m_top.mid_price; }
+        double spread() const { return m_top.spread; }
+
+        // A stale book keeps serving its last good state until the next snapshot
+        bool isStale() const { return m_is_stale; }
+        void SetStale(bool stale);
+
     signals:
         void orderbookUpdated();
+        void sequenceGap(qint64 expected_prev_seq_id, qint64 received_prev_seq_id);
+        void staleChanged(bool stale);
+        void topOfBookUpdated();
 
     private:
-        enum ITEM_TYPE
-        {
-            PRICE = 0,
-            AMOUNT = 1,
-            COUNT = 2
-		};
-
-        struct OrderEntry
-        {
-            QString price;
-            QString amount;
-        };
-
-        QVector<OrderEntry> m_bid_entries;
-        QVector<OrderEntry> m_ask_entries;
+        // Deltas land in the ladders; the sorted sides are rebuilt from them on the next read
+        QuantPriceLadder m_bid_ladder;
+        QuantPriceLadder m_ask_ladder;
+        mutable QVector<BookLevel> m_bid_levels;
+        mutable QVector<BookLevel> m_ask_levels;
+        mutable bool m_levels_dirty = false;
+        QVector<BookLevel> m_bid_changes;
+        QVector<BookLevel> m_ask_changes;
+        bool m_last_was_snapshot = true;
+        quint64 m_version = 0;
+        qint64 m_seq_id = -1;      // -1 when the feed sends no sequence ids
+        bool m_has_snapshot = false;
+        bool m_is_stale = false;
+        int m_depth = 0;
+        int m_requested_depth = 0;
+        int m_depth_limit = 0;
+
+        TopOfBook m_top;
+        bool m_top_from_channel = false;
+
+        QuantMicrostructure m_flow;
+
+        EXCHANGE_API m_exchange = EXCHANGE_API::OKX;
+        QString m_symbol;
 
     private:
-        QVariantList entriesAsVariantList(const QVector<OrderEntry>& entries, bool reverse = false) const;
+        void Materialize() const;
+        void SetTop(const BookLevel& bid, const BookLevel& ask);
+        QVariantList entriesAsVariantList(const QVector<BookLevel>& entries, bool reverse = false) const;
     };
 
 }
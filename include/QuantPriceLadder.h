@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+
+#include <QVector>
+
+#include "QuantBookView.h"
+
+namespace Quant
+{
+	/**
+	 * One side of the book on a tick-indexed ring
+	 *
+	 * A window of window_ticks ticks is direct-mapped: the slot of a price is its
+	 * tick number modulo the window, so setting a level is a division, a mask and a
+	 * store. An occupancy bitmap, one bit per slot, finds the next best level with a
+	 * few word scans when the best one is removed.
+	 *
+	 * Levels outside the window, and prices off the tick grid, go to a sorted
+	 * overflow vector. When the best price leaves the central half of the window,
+	 * the window recenters on it. Slots keep their place because they are indexed by
+	 * absolute tick, so only the levels that cross the window edge move.
+	 */
+	class QuantPriceLadder
+	{
+	public:
+		static constexpr int default_window_ticks = 4096;
+
+		QuantPriceLadder(bool is_bids = true, double tick_size = 0.01, int window_ticks = default_window_ticks);
+
+	public:
+		void Clear();
+
+		// Sets the amount of a price level, 0 removes it
+		void Set(const BookLevel& level);
+		double AmountAt(double price) const;
+
+		bool Empty() const { return m_size == 0; }
+		int Size() const { return m_size; }
+
+		// Best level, a zero level when the side is empty
+		BookLevel Best() const;
+
+		// Replaces out with the levels best first, at most max_levels of them (0 for all)
+		void CopyLevels(QVector<BookLevel>& out, int max_levels = 0) const;
+
+		int OverflowSize() const { return static_cast<int>(m_overflow.size()); }
+		qint64 RecenterCount() const { return m_recenters; }
+
+	private:
+		bool ToTick(double price, qint64& tick) const;
+		bool InWindow(qint64 tick) const { return tick >= m_base_tick && tick < m_base_tick + m_window; }
+		bool BetterTick(qint64 a, qint64 b) const { return m_is_bids ? a > b : a < b; }
+		bool BetterPrice(double a, double b) const { return m_is_bids ? a > b : a < b; }
+		bool IsOccupied(qint64 tick) const;
+
+		void SetInRing(qint64 tick, const BookLevel& level);
+		void SetInOverflow(const BookLevel& level);
+
+		// Nearest occupied tick from from_tick (inclusive) towards worse prices
+		bool NextWorse(qint64 from_tick, qint64& found) const;
+		void RescanRingBest();
+
+		void MaybeRecenter();
+		void Recenter(qint64 center_tick);
+
+	private:
+		bool m_is_bids = true;
+		double m_tick_size = 0.01;
+		qint64 m_window = default_window_ticks;
+		qint64 m_mask = default_window_ticks - 1;
+
+		std::vector<BookLevel> m_slots;
+		std::vector<quint64> m_occupied;
+		qint64 m_base_tick = 0;   // Multiple of 64, so bitmap words never straddle the window edge
+		bool m_anchored = false;
+
+		int m_ring_count = 0;
+		bool m_has_ring_best = false;
+		qint64 m_ring_best_tick = 0;
+
+		std::vector<BookLevel> m_overflow; // Best first
+		int m_size = 0;
+		qint64 m_recenters = 0;
+	};
+}
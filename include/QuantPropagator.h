@@ -0,0 +1,156 @@
+#pragma once
+#include <complex>
+#include <vector>
+
+#include <QtGlobal>
+
+namespace Quant
+{
+	enum class PROPAGATOR_KERNEL
+	{
+		EXPONENTIAL, // G(t) = G0 * exp(-t / decay)
+		POWER_LAW,   // G(t) = G0 / (1 + t / decay)^exponent
+	};
+
+	enum class PROPAGATOR_METHOD
+	{
+		AUTO,      // RECURSIVE for exponential kernels, FFT for long power-law schedules, DIRECT otherwise
+		DIRECT,    // O(N^2) sum
+		FFT,       // O(N log N) convolution
+		RECURSIVE, // O(N), exponential kernels only; power laws fall back to AUTO
+	};
+
+	struct PropagatorParams
+	{
+		PROPAGATOR_KERNEL kernel = PROPAGATOR_KERNEL::POWER_LAW;
+		double strength = 1.0;        // G0, price fraction moved by one unit of scaled volume
+		double decay_seconds = 30.0;  // Time constant of the exponential, or time scale of the power law
+		double exponent = 0.5;        // Power-law decay exponent
+		double volume_exponent = 0.5; // Concavity of the instantaneous impact in the traded volume
+		double volume_scale = 1.0;    // Volume one unit of scaled volume stands for, e.g. the visible depth
+	};
+
+	// One of our fills, for calibration; volume signed, positive for a buy
+	struct PropagatorFill
+	{
+		double time_seconds = 0.0;
+		double volume = 0.0;
+	};
+
+	// Mid price observed after the fills began, as a signed fraction of the mid before the first one
+	struct PriceObservation
+	{
+		double time_seconds = 0.0;
+		double price_move = 0.0;
+	};
+
+	struct PropagatorFit
+	{
+		bool valid = false;     // At least one candidate explained the moves with a positive strength
+		PropagatorParams params;
+		double residual = 0.0;  // Sum of squared errors over the observations
+		double r_squared = 0.0; // 1 - residual / sum of squared moves
+		int observations = 0;
+	};
+
+	/**
+	 * Transient price impact of our own trading (propagator model)
+	 *
+	 * The impact at time t is the convolution of the signed volume traded before t
+	 * with a decaying kernel:
+	 *   I(t) = sum over fills s <= t of G(t - t_s) * sign(v_s) * (|v_s| / volume_scale)^volume_exponent
+	 * so impact builds while an order is worked and fades once it stops, unlike the
+	 * permanent Almgren-Chriss form of the calculator.
+	 *
+	 * Schedules are slices of equal duration. ImpactPath() gives the impact each slice
+	 * trades at: the impact of the earlier slices plus half of its own, as it walks
+	 * into its own impact while filling. ScheduleCost() weighs that by the slice
+	 * volumes. The unit kernel's spectrum is kept between FFT evaluations of the
+	 * same grid, so an optimizer varying the volumes pays two FFTs per evaluation.
+	 *
+	 * RecordFill() / ImpactAt() follow fills as they happen, in O(1) for exponential
+	 * kernels; power-law kernels keep the last max_history fills. Calibrate() fits
+	 * the kernel to the mid price observed after fills.
+	 *
+	 * Not synchronized; one per thread, like a calculator context.
+	 */
+	class QuantPropagator
+	{
+	public:
+		static constexpr int fft_threshold = 64; // Slices from which AUTO convolves power laws by FFT
+		static constexpr int max_history = 4096;
+
+	public:
+		explicit QuantPropagator(const PropagatorParams& params = PropagatorParams());
+
+	public:
+		// Kernel shape changes drop the cached spectrum; any change but the strength restarts the live fills
+		void SetParams(const PropagatorParams& params);
+		const PropagatorParams& Params() const { return m_params; }
+
+		// Kernel value at a lag, strength included
+		double Kernel(double lag_seconds) const;
+
+		// Impact, as a signed price fraction, each slice trades at; impact must hold count values
+		void ImpactPath(const double* volumes, int count, double slice_seconds, double* impact, PROPAGATOR_METHOD method = PROPAGATOR_METHOD::AUTO);
+
+		// Sum of volume * impact over the schedule, in volume units times price fraction; positive is a cost
+		double ScheduleCost(const double* volumes, int count, double slice_seconds, PROPAGATOR_METHOD method = PROPAGATOR_METHOD::AUTO);
+
+		// Same for quantity split into equal slices
+		double UniformScheduleCost(double quantity, int slices, double slice_seconds, PROPAGATOR_METHOD method = PROPAGATOR_METHOD::AUTO);
+
+		// Live fills, in seconds on any clock that only moves forward
+		void RecordFill(double volume, double time_seconds);
+		double ImpactAt(double time_seconds) const;
+		void ResetFills();
+
+		/**
+		 * Least-squares fit of strength and decay to the price path observed around our
+		 * fills. The kernel family, exponent and volume scaling come from shape. For each
+		 * decay candidate the model is linear in the strength, which is solved in closed
+		 * form; the candidate with the smallest residual wins. Empty candidates search
+		 * 1 s to 10 min on a logarithmic grid.
+		 */
+		static PropagatorFit Calibrate(const PropagatorParams& shape, const std::vector<PropagatorFill>& fills,
+			const std::vector<PriceObservation>& path, const std::vector<double>& decay_candidates = {});
+
+	private:
+		double ScaledVolume(double volume) const;
+		double UnitKernel(double lag_seconds) const;
+		PROPAGATOR_METHOD Resolve(PROPAGATOR_METHOD method, int count) const;
+
+		void Direct(const double* scaled, int count, double slice_seconds, double* impact);
+		void Recursive(const double* scaled, int count, double slice_seconds, double* impact) const;
+		void Convolve(const double* scaled, int count, double slice_seconds, double* impact);
+
+		void PrepareSpectrum(int count, double slice_seconds);
+		void Transform(std::vector<std::complex<double>>& data, bool inverse) const;
+
+	private:
+		PropagatorParams m_params;
+
+		// FFT plan and unit-kernel spectrum of the last grid, and its lags for DIRECT
+		int m_spectrum_count = 0;
+		double m_spectrum_slice_seconds = 0.0;
+		std::vector<std::complex<double>> m_twiddles;
+		std::vector<int> m_bit_reversed;
+		std::vector<std::complex<double>> m_kernel_spectrum;
+		int m_lags_count = 0;
+		double m_lags_slice_seconds = 0.0;
+		std::vector<double> m_lags;
+
+		// Scratch, reused between evaluations
+		std::vector<double> m_volumes;
+		std::vector<double> m_scaled;
+		std::vector<double> m_impact;
+		std::vector<std::complex<double>> m_signal;
+
+		// Live fills
+		double m_live_impact = 0.0; // Exponential: unit impact as of m_live_time
+		double m_live_time = 0.0;
+		std::vector<double> m_fill_times;   // Power law: ring of the last fills
+		std::vector<double> m_fill_scaled;
+		int m_fill_next = 0;
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "QuantResultsJournalFormat.h"
+
+namespace Quant
+{
+	struct ResultsJournalConfig
+	{
+		QString directory;
+		int capacity = 65536;         // Records buffered between the calculation and the writer
+		int flush_interval_ms = 200;   // Partial block written out at most this late
+		int fsync_interval_ms = 1000;  // Durable at most this late
+	};
+
+	/**
+	 * Append-only journal of every calculation result
+	 *
+	 * Append() copies the record into a single-producer single-consumer ring and
+	 * returns; it never takes a lock nor touches the file. A background writer drains
+	 * the ring into fixed-size blocks (see QuantResultsJournalFormat.h), writes a full
+	 * block as soon as it fills and the partial one every flush_interval_ms, and
+	 * fsyncs every fsync_interval_ms. When the writer falls a whole ring behind, new
+	 * records are dropped and counted rather than stalling the calculation.
+	 *
+	 * One journal file per session, named after its start time.
+	 */
+	class QuantResultsJournal
+	{
+	public:
+		explicit QuantResultsJournal(const ResultsJournalConfig& config);
+		~QuantResultsJournal();
+
+		QuantResultsJournal(const QuantResultsJournal&) = delete;
+		QuantResultsJournal& operator=(const QuantResultsJournal&) = delete;
+
+	public:
+		bool Start();
+		void Stop();
+
+		// Producer side, one thread only
+		bool Append(const JournalFormat::JournalRecord& record);
+
+		QString FilePath() const { return m_file.fileName(); }
+		qint64 Written() const { return m_written.load(std::memory_order_relaxed); }
+		qint64 Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	private:
+		void WriterLoop();
+		int Drain();
+		bool WriteBlock();
+		void Sync();
+
+	private:
+		ResultsJournalConfig m_config;
+
+		std::vector<JournalFormat::JournalRecord> m_ring;
+		quint64 m_mask = 0;
+		alignas(64) std::atomic<quint64> m_head{ 0 }; // Written by the producer
+		alignas(64) std::atomic<quint64> m_tail{ 0 }; // Written by the writer
+
+		std::atomic<bool> m_running{ false };
+		std::thread m_writer;
+
+		// Writer thread only
+		QFile m_file;
+		QByteArray m_block;
+		qint64 m_block_offset = 0;
+		int m_block_records = 0;
+
+		std::atomic<qint64> m_written{ 0 };
+		std::atomic<qint64> m_dropped{ 0 };
+	};
+
+	// Reads the records of a journal file in order
+	class QuantResultsJournalReader
+	{
+	public:
+		explicit QuantResultsJournalReader(const QString& path);
+
+	public:
+		bool IsValid() const { return m_valid; }
+		qint64 RecordCount() const { return m_record_count; }
+
+		// Returns false on a damaged block
+		bool ForEach(const std::function<void(const JournalFormat::JournalRecord&)>& callback) const;
+
+	private:
+		QFile m_file;
+		const uchar* m_data = nullptr;
+		qint64 m_block_count = 0;
+		bool m_valid = false;
+		qint64 m_record_count = 0;
+	};
+}
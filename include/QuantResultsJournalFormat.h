@@ -0,0 +1,66 @@
+#pragma once
+#include <QtGlobal>
+
+namespace Quant
+{
+	/**
+	 * Layout of the results journal
+	 *
+	 * A journal file is a sequence of fixed-size blocks. Each block starts with a
+	 * BlockHeader followed by record_count JournalRecords; the rest of the block is
+	 * zero. Only the last block of a file may be partially filled, it is rewritten
+	 * in place as records arrive. Integers and doubles are little endian.
+	 */
+	namespace JournalFormat
+	{
+		constexpr quint32 magic = 0x314A5251; // "QRJ1"
+		constexpr quint32 version = 2; // 2 added the symbol
+		constexpr qint64 block_size = 16 * 1024;
+		constexpr int symbol_size = 32; // NUL padded
+
+		constexpr const char* file_suffix = ".qrj";
+
+		// One calculation: when, on which book, with which inputs, and every metric
+		struct JournalRecord
+		{
+			qint64 timestamp_ns = 0; // Since the epoch
+			quint64 book_version = 0;
+			char symbol[symbol_size] = {};
+
+			quint8 exchange = 0;
+			quint8 order_type = 0;
+			quint8 order_side = 0;
+			quint8 fee_tier = 0;
+			quint8 volatility_enabled = 0;
+			quint8 liquidity_exhausted = 0; // The order exceeded the visible book
+			quint8 reserved[2] = {};
+
+			double usd_amount = 0.0;
+			double input_volatility = 0.0;
+
+			double volatility = 0.0;
+			double fees = 0.0;
+			double slippage = 0.0;
+			double market_impact = 0.0;
+			double market_order_cost = 0.0;
+			double net_cost = 0.0;
+			double crypto_amount = 0.0;
+			double maker_ratio = 0.0;
+			double processing_time_ms = 0.0;
+		};
+		static_assert(sizeof(JournalRecord) == 144, "Journal record layout is part of the file format");
+
+		struct BlockHeader
+		{
+			quint32 magic = JournalFormat::magic;
+			quint32 version = JournalFormat::version;
+			quint32 record_size = sizeof(JournalRecord);
+			quint32 record_count = 0;
+			qint64 first_timestamp_ns = 0;
+			qint64 last_timestamp_ns = 0;
+		};
+		static_assert(sizeof(BlockHeader) == 32, "Block header layout is part of the file format");
+
+		constexpr int records_per_block = static_cast<int>((block_size - sizeof(BlockHeader)) / sizeof(JournalRecord));
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+
+#include <QString>
+#include <QVector>
+
+namespace Quant
+{
+	enum class THREAD_ROLE
+	{
+		INGEST,     // Socket parsing
+		BOOK,       // Queue drain and book updates
+		CALCULATOR, // Scenario workers
+	};
+
+	constexpr int thread_role_count = 3;
+
+	struct RuntimeProfileConfig
+	{
+		bool low_latency = false;
+		QVector<int> cores[thread_role_count]; // Per THREAD_ROLE, threads of a role take them in turn; empty leaves the role unpinned
+		bool busy_poll = true;    // Threads alone on a pinned core spin on their hand-offs instead of sleeping
+		bool lock_memory = true;  // mlockall, then prefault
+		int prefault_mb = 64;     // Heap touched and kept after mlockall
+	};
+
+	// What the profile got from the system
+	struct RuntimeProfileReport
+	{
+		bool enabled = false;
+		bool supported = false;       // Linux only
+		bool memory_locked = false;
+		QString memory_error;
+		int pinned[thread_role_count] = {};
+		int pin_failures[thread_role_count] = {};
+		QVector<int> unavailable_cores; // Configured but outside the process affinity
+		QVector<int> shared_cores;      // Configured but not in the kernel's isolated set
+	};
+
+	/**
+	 * Opt-in low-latency runtime profile (Linux)
+	 *
+	 * Apply() runs once at startup, before the pipeline threads exist. It locks the
+	 * process memory with mlockall and prefaults a heap reserve that the allocator is
+	 * told to keep, so the hot path does not take page faults. Threads then call
+	 * PinCurrentThread() with their role when they start; each is bound to the next
+	 * configured core of that role. With busy polling, a thread that is the first to
+	 * be pinned to its core may spin on its hand-offs instead of sleeping until woken
+	 * (SpinsCurrentThread()), trading that core for wake-up latency. There is at most
+	 * one spinner per core, and unpinned threads, or threads sharing a core with an
+	 * earlier one, always block.
+	 *
+	 * Everything is a no-op unless the profile is enabled.
+	 */
+	class QuantRuntimeProfile
+	{
+	public:
+		static bool Apply(const RuntimeProfileConfig& config);
+
+		static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+		// Binds the calling thread once; later calls from the same thread return at once
+		static void PinCurrentThread(THREAD_ROLE role);
+
+		// The calling thread was pinned to a core no other thread was pinned to first, and busy polling is on
+		static bool SpinsCurrentThread();
+
+		// Cores configured for a role, 0 while the profile is off
+		static int CoreCount(THREAD_ROLE role);
+
+		static RuntimeProfileReport Report();
+
+		// One line per finding, through qInfo/qWarning
+		static void LogReport();
+
+	private:
+		static std::atomic<bool> s_enabled;
+	};
+
+	// Busy-wait hint for spin loops
+	inline void CpuRelax()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		asm volatile("yield");
+#endif
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "QuantCalculator.h"
+#include "QuantWorkStealingPool.h"
+
+namespace Quant
+{
+	class QuantOrderbook;
+
+	using ScenarioId = int;
+
+	// One standing what-if order as registered by the risk desk
+	struct Scenario
+	{
+		EXCHANGE_API exchange = EXCHANGE_API::OKX;
+		QString symbol;
+		ORDER_TYPE order_type = ORDER_TYPE::MARKET;
+		ORDER_SIDE order_side = ORDER_SIDE::BUY;
+		FEE_TIER fee_tier = FEE_TIER::VIP_0;
+		double usd_amount = 0.0;
+		bool volatility_enabled = false;
+		double volatility = 0.0;
+	};
+
+	// Columnar results of one group, row i belongs to ScenarioGroup::ids[i]
+	struct ScenarioColumns
+	{
+		quint64 book_version = 0;
+		std::vector<double> volatility;
+		std::vector<double> fees;
+		std::vector<double> slippage;
+		std::vector<double> market_impact;
+		std::vector<double> net_cost;
+		std::vector<double> crypto_amount;
+		std::vector<double> maker_ratio;
+		std::vector<quint8> liquidity_exhausted; // The order exceeded the visible book
+		std::vector<double> unfilled_usd;
+
+		void Resize(size_t count);
+	};
+
+	struct ScenarioGroup;
+	using ScenarioFeaturesFn = BookFeatures(*)(const BookView&);
+	using ScenarioBatchFn = void(*)(const ScenarioGroup&, int begin, int end, const BookView&, const BookFeatures&);
+
+	/**
+	 * Scenarios of one (exchange, symbol) compiled into compact parameter arrays.
+	 * Every array has one entry per scenario; the venue kernels and fee schedule
+	 * are resolved at compile time so a pass is a tight loop over the arrays.
+	 */
+	struct ScenarioGroup
+	{
+		EXCHANGE_API exchange = EXCHANGE_API::NONE;
+		QString symbol;
+
+		std::vector<ScenarioId> ids;
+		std::vector<quint8> order_type;
+		std::vector<quint8> order_side;
+		std::vector<quint8> fee_tier;
+		std::vector<quint8> volatility_enabled;
+		std::vector<double> usd_amount;
+		std::vector<double> volatility;
+
+		std::shared_ptr<const FeeSchedule> fee_schedule;
+		ScenarioFeaturesFn compute_features = nullptr;
+		ScenarioBatchFn evaluate = nullptr;
+
+		// Written by the pass; rows are disjoint between tasks
+		mutable ScenarioColumns results;
+	};
+
+	/**
+	 * Multi-scenario evaluation engine
+	 *
+	 * Holds hundreds of standing scenarios and re-evaluates every scenario of a symbol
+	 * once per book version. Book features (spread, depth, volatility, maker ratio) are
+	 * computed once per group, then the scenarios are swept in chunks spread over a
+	 * work-stealing pool. Results land in the group's columnar buffer and a single
+	 * ResultsUpdated signal is emitted per pass, instead of one Calculate() round-trip
+	 * per scenario.
+	 */
+	class QuantScenarioEngine : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantScenarioEngine(QObject* parent = nullptr, int worker_count = 0);
+
+	public:
+		ScenarioId AddScenario(const Scenario& scenario);
+		bool RemoveScenario(ScenarioId id);
+		void ClearScenarios();
+		int ScenarioCount() const { return static_cast<int>(m_scenarios.size()); }
+
+		// Loads a JSON array of scenarios, returns the number added
+		int LoadScenarios(const QString& path);
+
+	public:
+		// Replaces the books the engine follows with this one
+		void SetOrderbook(QuantOrderbook* orderbook);
+
+		// Follows one more book; it has to live on the engine's thread, as the pass reads it in place
+		void AddOrderbook(QuantOrderbook* orderbook);
+
+		// Evaluates the group of (exchange, symbol) unless it already saw this book version
+		void Evaluate(EXCHANGE_API exchange, const QString& symbol, const BookView& book);
+
+		// Columnar results of the last pass, nullptr when no scenario targets the symbol
+		const ScenarioGroup* Group(EXCHANGE_API exchange, const QString& symbol);
+
+	signals:
+		void ResultsUpdated(const QString& symbol, quint64 book_version);
+
+	private:
+		void OnOrderbookUpdated(QuantOrderbook* orderbook);
+
+	private:
+		void Compile();
+
+	private:
+		static constexpr int chunk_size = 64;
+
+		QHash<ScenarioId, Scenario> m_scenarios;
+		ScenarioId m_next_id = 1;
+		bool m_dirty = false;
+
+		std::vector<ScenarioGroup> m_groups;
+		QHash<QString, int> m_group_index;
+
+		QuantWorkStealingPool m_pool;
+		QVector<QuantOrderbook*> m_orderbooks;
+	};
+}
@@ -0,0 +1,196 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Quant
+{
+	/**
+	 * Layout of the shared-memory segments
+	 *
+	 * The simulator publishes into POSIX shared memory (shm_open), one segment per
+	 * record kind: "/<prefix>-books" holds book snapshots, "/<prefix>-results" cost
+	 * results. This header is plain C++ without Qt, so any local process can include
+	 * it together with QuantShmReader.h.
+	 *
+	 * A segment is a SegmentHeader (segment_header_size bytes) followed by slot_count
+	 * slots of slot_size bytes each. Record n lives in slot n % slot_count: a SlotHeader,
+	 * then the record. head counts the records published so far.
+	 *
+	 * Slots are seqlocks. The writer sets the slot's sequence to 2n + 1 while it copies
+	 * record n in, then to 2n + 2 and only then advances head past n. A reader copies
+	 * the record out and accepts it when the sequence read before and after the copy is
+	 * 2n + 2; anything else means the writer lapped the reader. Readers never write to
+	 * the segment and never block the writer.
+	 *
+	 * Integers and doubles are little endian, the host's own. Exchanges and order
+	 * enums use the values of IQuantCalculatorAPI.h.
+	 */
+	namespace ShmFormat
+	{
+		constexpr std::uint32_t magic = 0x314D5351; // "QSM1"
+		constexpr std::uint32_t version = 1;
+
+		constexpr const char* default_prefix = "quant";
+		constexpr const char* books_suffix = "-books";
+		constexpr const char* results_suffix = "-results";
+
+		constexpr int max_depth = 64;   // Levels per side in a book record, deeper levels are cut
+		constexpr int symbol_size = 32; // NUL padded
+
+		enum RECORD_KIND : std::uint32_t
+		{
+			BOOK = 1,
+			RESULT = 2,
+		};
+
+		struct Level
+		{
+			double price = 0.0;
+			double amount = 0.0;
+		};
+
+		// The book after an update, best level first on both sides
+		struct BookRecord
+		{
+			std::int64_t timestamp_ns = 0; // Since the epoch
+			std::uint64_t version = 0;     // Increases with every update of the book
+			std::int64_t seq_id = -1;      // Venue sequence number, -1 when the venue has none
+
+			std::uint8_t exchange = 0;
+			std::uint8_t stale = 0;        // Serving the last good state until the next snapshot
+			std::uint8_t truncated = 0;    // More than max_depth levels on a side
+			std::uint8_t reserved[5] = {};
+
+			std::uint32_t bid_count = 0;
+			std::uint32_t ask_count = 0;
+			char symbol[symbol_size] = {};
+
+			Level bids[max_depth];
+			Level asks[max_depth];
+		};
+		static_assert(sizeof(BookRecord) == 72 + 2 * max_depth * sizeof(Level), "Book record layout is part of the segment format");
+
+		// One calculation, the fields of the results journal record plus the instrument
+		struct ResultRecord
+		{
+			std::int64_t timestamp_ns = 0;
+			std::uint64_t book_version = 0; // Version of the book the result was computed on
+			char symbol[symbol_size] = {};
+
+			std::uint8_t exchange = 0;
+			std::uint8_t order_type = 0;
+			std::uint8_t order_side = 0;
+			std::uint8_t fee_tier = 0;
+			std::uint8_t volatility_enabled = 0;
+			std::uint8_t liquidity_exhausted = 0;
+			std::uint8_t reserved[2] = {};
+
+			double usd_amount = 0.0;
+			double input_volatility = 0.0;
+
+			double volatility = 0.0;
+			double fees = 0.0;
+			double slippage = 0.0;
+			double market_impact = 0.0;
+			double market_order_cost = 0.0;
+			double net_cost = 0.0;
+			double crypto_amount = 0.0;
+			double maker_ratio = 0.0;
+			double processing_time_ms = 0.0;
+		};
+		static_assert(sizeof(ResultRecord) == 144, "Result record layout is part of the segment format");
+
+		struct SegmentHeader
+		{
+			std::uint32_t magic = ShmFormat::magic;
+			std::uint32_t version = ShmFormat::version;
+			std::uint32_t record_kind = 0;
+			std::uint32_t record_size = 0;
+			std::uint64_t slot_count = 0;  // Power of two
+			std::uint64_t slot_size = 0;   // Multiple of 64
+			std::int64_t writer_pid = 0;
+			std::int64_t created_ns = 0;   // Since the epoch; a new writer means a new segment
+			std::uint8_t reserved[16] = {};
+
+			alignas(64) std::atomic<std::uint64_t> head{ 0 };
+		};
+		static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Slot sequences are shared between processes");
+		static_assert(sizeof(SegmentHeader) == 128, "Segment header layout is part of the segment format");
+
+		struct SlotHeader
+		{
+			std::atomic<std::uint64_t> sequence{ 0 }; // 2n + 1 while record n is written, 2n + 2 once it is complete
+			std::uint64_t reserved = 0;
+		};
+		static_assert(sizeof(SlotHeader) == 16, "Slot header layout is part of the segment format");
+
+		constexpr std::size_t segment_header_size = sizeof(SegmentHeader);
+
+		constexpr std::uint64_t SlotSize(std::size_t record_size)
+		{
+			return (sizeof(SlotHeader) + record_size + 63) / 64 * 64;
+		}
+
+		constexpr std::size_t SegmentSize(std::uint64_t slot_count, std::uint64_t slot_size)
+		{
+			return segment_header_size + static_cast<std::size_t>(slot_count * slot_size);
+		}
+
+		inline SlotHeader* SlotAt(void* segment, std::uint64_t slot_size, std::uint64_t index)
+		{
+			return reinterpret_cast<SlotHeader*>(static_cast<char*>(segment) + segment_header_size + index * slot_size);
+		}
+
+		inline const SlotHeader* SlotAt(const void* segment, std::uint64_t slot_size, std::uint64_t index)
+		{
+			return reinterpret_cast<const SlotHeader*>(static_cast<const char*>(segment) + segment_header_size + index * slot_size);
+		}
+
+		// The record follows its slot header
+		inline void* RecordOf(SlotHeader* slot) { return reinterpret_cast<char*>(slot) + sizeof(SlotHeader); }
+		inline const void* RecordOf(const SlotHeader* slot) { return reinterpret_cast<const char*>(slot) + sizeof(SlotHeader); }
+
+		// Writer side; a segment has one writer at a time
+		inline void WriteRecord(void* segment, const void* record, std::size_t record_size)
+		{
+			SegmentHeader* header = static_cast<SegmentHeader*>(segment);
+			const std::uint64_t position = header->head.load(std::memory_order_relaxed);
+			SlotHeader* slot = SlotAt(segment, header->slot_size, position & (header->slot_count - 1));
+
+			slot->sequence.store(2 * position + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			std::memcpy(RecordOf(slot), record, record_size);
+			slot->sequence.store(2 * position + 2, std::memory_order_release);
+			header->head.store(position + 1, std::memory_order_release);
+		}
+
+		enum READ_STATUS
+		{
+			READ_OK = 0,
+			READ_EMPTY = 1,  // Nothing published at the position yet
+			READ_LAPPED = 2, // Overwritten before or while it was read
+		};
+
+		// Reader side, any number of processes
+		inline READ_STATUS ReadRecord(const void* segment, std::uint64_t position, void* record, std::size_t record_size)
+		{
+			const SegmentHeader* header = static_cast<const SegmentHeader*>(segment);
+			const std::uint64_t head = header->head.load(std::memory_order_acquire);
+			if (position >= head)
+				return READ_EMPTY;
+			if (head - position > header->slot_count)
+				return READ_LAPPED;
+
+			const SlotHeader* slot = SlotAt(segment, header->slot_size, position & (header->slot_count - 1));
+			const std::uint64_t expected = 2 * position + 2;
+			if (slot->sequence.load(std::memory_order_acquire) != expected)
+				return READ_LAPPED;
+
+			std::memcpy(record, RecordOf(slot), record_size);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return slot->sequence.load(std::memory_order_relaxed) == expected ? READ_OK : READ_LAPPED;
+		}
+	}
+}
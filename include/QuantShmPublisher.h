@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <QObject>
+#include <QString>
+
+#include "QuantResultsJournalFormat.h"
+#include "QuantShmFormat.h"
+
+namespace Quant
+{
+	class MetricCounter;
+	class QuantOrderbook;
+
+	struct ShmPublisherConfig
+	{
+		bool enabled = false;
+		QString prefix = ShmFormat::default_prefix; // Segments "/<prefix>-books" and "/<prefix>-results"
+		int book_slots = 4096;   // Rounded up to a power of two
+		int result_slots = 4096;
+	};
+
+	/**
+	 * Publication of books and cost results to other local processes
+	 *
+	 * Writes every book update and every calculation result into POSIX shared-memory
+	 * rings (layout in QuantShmFormat.h), so strategies, dashboards and risk tools on
+	 * the host read them through QuantShmReader instead of opening their own exchange
+	 * connections. Publishing copies one fixed-size record into the next slot under a
+	 * seqlock; readers never block it, and one that falls a whole ring behind loses the
+	 * overwritten records rather than slowing the feed down.
+	 *
+	 * Books publish from the thread that updates them, so the books of the ingest
+	 * shards do not go through the GUI thread. Writers of the same segment are
+	 * serialized by a mutex held for the copy only.
+	 *
+	 * The segments are unlinked by Stop(); readers that still map them keep the last
+	 * records. POSIX only, Start() fails elsewhere.
+	 */
+	class QuantShmPublisher : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantShmPublisher(const ShmPublisherConfig& config, QObject* parent = nullptr);
+		~QuantShmPublisher();
+
+	public:
+		bool Start();
+		void Stop();
+		bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+		QString BooksSegment() const { return m_books.name; }
+		QString ResultsSegment() const { return m_results.name; }
+
+		// Publishes the book after each of its updates, on the book's thread
+		void AddOrderbook(QuantOrderbook* orderbook);
+
+		// Any thread; the book's own thread for PublishBook, its view is read
+		void PublishBook(const QuantOrderbook& orderbook);
+		void PublishResult(const QString& symbol, const JournalFormat::JournalRecord& result);
+
+	private:
+		struct Segment
+		{
+			QString name;
+			ShmFormat::RECORD_KIND kind = ShmFormat::BOOK;
+			void* mapping = nullptr;
+			std::size_t size = 0;
+			std::mutex write_mutex;
+			MetricCounter* published = nullptr;
+		};
+
+		bool OpenSegment(Segment& segment, int slots, std::size_t record_size);
+		void CloseSegment(Segment& segment);
+		void Write(Segment& segment, const void* record, std::size_t record_size);
+
+	private:
+		ShmPublisherConfig m_config;
+		Segment m_books;
+		Segment m_results;
+		std::atomic<bool> m_running{ false }; // Lets publishers skip building records while stopped
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "QuantShmFormat.h"
+
+namespace Quant
+{
+	/**
+	 * Reader of one shared-memory segment published by the simulator
+	 *
+	 * Maps the segment read-only once; every record afterwards is a copy out of the
+	 * mapping, with no system call and no lock. Each reader keeps its own cursor, so
+	 * any number of processes follow the same segment independently. A reader that
+	 * falls more than the ring's slot count behind loses the overwritten records:
+	 * Next() skips to the oldest one still there and counts the rest in Skipped().
+	 *
+	 * Plain C++ without Qt; link the QuantShmReader library. POSIX only, Open() fails
+	 * elsewhere.
+	 */
+	class QuantShmReader
+	{
+	public:
+		QuantShmReader() = default;
+		~QuantShmReader();
+
+		QuantShmReader(const QuantShmReader&) = delete;
+		QuantShmReader& operator=(const QuantShmReader&) = delete;
+
+	public:
+		// name as given to shm_open, e.g. "/quant-books"; reads what is published from now on,
+		// SeekToOldest() replays what the ring still holds
+		bool Open(const std::string& name, ShmFormat::RECORD_KIND kind);
+		void Close();
+		bool IsOpen() const { return m_segment != nullptr; }
+		const std::string& Error() const { return m_error; }
+
+		// The writer restarted and published a new segment under the name; Open() again to follow it.
+		// Costs a few system calls, meant for an occasional check rather than every record
+		bool IsReplaced() const;
+
+		// Next record after the cursor, false when there is none yet
+		bool Next(ShmFormat::BookRecord& record) { return NextRecord(ShmFormat::BOOK, &record, sizeof(record)); }
+		bool Next(ShmFormat::ResultRecord& record) { return NextRecord(ShmFormat::RESULT, &record, sizeof(record)); }
+
+		// The newest record, without moving the cursor
+		bool Latest(ShmFormat::BookRecord& record) const { return LatestRecord(ShmFormat::BOOK, &record, sizeof(record)); }
+		bool Latest(ShmFormat::ResultRecord& record) const { return LatestRecord(ShmFormat::RESULT, &record, sizeof(record)); }
+
+		void SeekToOldest();
+		void SeekToNewest();
+
+		std::uint64_t Position() const { return m_position; }
+		std::uint64_t Published() const;
+		std::uint64_t Skipped() const { return m_skipped; }
+		std::uint64_t SlotCount() const { return m_slot_count; }
+		std::int64_t WriterPid() const { return m_writer_pid; }
+
+	private:
+		bool NextRecord(ShmFormat::RECORD_KIND kind, void* record, std::size_t record_size);
+		bool LatestRecord(ShmFormat::RECORD_KIND kind, void* record, std::size_t record_size) const;
+
+	private:
+		std::string m_name;
+		std::string m_error;
+
+		const void* m_segment = nullptr;
+		std::size_t m_mapped_size = 0;
+
+		ShmFormat::RECORD_KIND m_kind = ShmFormat::BOOK;
+		std::uint64_t m_slot_count = 0;
+		std::int64_t m_writer_pid = 0;
+		std::uint64_t m_inode = 0;
+
+		std::uint64_t m_position = 0;
+		std::uint64_t m_skipped = 0;
+	};
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+
+#include "IQuantCalculatorAPI.h"
+#include "QuantBookView.h"
+#include "QuantTickStoreFormat.h"
+
+namespace Quant
+{
+	class QuantOrderbook;
+
+	struct TickStoreConfig
+	{
+		bool enabled = false;
+		QString root;                       // Empty uses ticks/ in the application data directory
+		qint64 chunk_seconds = 3600;        // Time partition of a chunk file
+		qint64 keyframe_interval_ms = 1000; // A block (keyframe and index entry) at most this long
+		int max_pending = 4096;             // Books queued for the writer before new ones are dropped
+		double tick_size = 0.0;             // Price grid, 0 takes the venue's tick size
+		double size_quantum = 0.0;          // Size grid, 0 takes the venue's lot size
+	};
+
+	/**
+	 * Append-only columnar store of order book history
+	 *
+	 * Append() copies the book into a bounded queue and returns; a background writer
+	 * does the rest. It diffs every book against the previous one, so a record only
+	 * holds the levels that changed, with prices as tick offsets and sizes as varint
+	 * quanta. Records are gathered into one block per keyframe interval and written
+	 * column by column (see QuantTickStoreFormat.h). Each block starts with a keyframe
+	 * of the whole book and is indexed, so readers can seek to any time without
+	 * decoding the chunk from its start. A block reaches the file when it is sealed,
+	 * at most keyframe_interval_ms after its first record.
+	 *
+	 * A level that does not fit the grid (an instrument with a finer tick than its
+	 * venue's default) refines the grid and starts a new chunk, so nothing is rounded.
+	 * When the writer falls max_pending books behind, new books are dropped and
+	 * counted rather than stalling the book's thread.
+	 */
+	class QuantTickStore : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantTickStore(const TickStoreConfig& config, QObject* parent = nullptr);
+		~QuantTickStore();
+
+	public:
+		bool Start();
+		void Stop();
+
+		// Records the book after every update
+		void SetOrderbook(QuantOrderbook* orderbook);
+
+		// Queues the state of a book at a time in nanoseconds since the epoch, from any thread
+		bool Append(EXCHANGE_API exchange, const QString& symbol, qint64 timestamp_ns, const BookView& book);
+
+		qint64 BytesWritten() const { return m_bytes_written.load(std::memory_order_relaxed); }
+		qint64 Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	private slots:
+		void OnOrderbookUpdated();
+
+	private:
+		struct PendingBook
+		{
+			EXCHANGE_API exchange = EXCHANGE_API::OKX;
+			QString symbol;
+			qint64 timestamp_ns = 0;
+			std::vector<BookLevel> bids;
+			std::vector<BookLevel> asks;
+		};
+
+		struct TickLevel
+		{
+			qint64 ticks = 0;
+			qint64 quanta = 0;
+		};
+		using TickSide = std::vector<TickLevel>;
+
+		struct Stream
+		{
+			QString directory;
+			double default_tick_size = 0.0;
+			double default_size_quantum = 0.0;
+
+			std::unique_ptr<QFile> chunk;
+			std::unique_ptr<QFile> index;
+			TickStoreFormat::ChunkHeader header;
+			qint64 chunk_bytes = 0;
+			qint64 partition_end_ns = 0;
+
+			// Block being gathered, one buffer per column
+			TickStoreFormat::BlockHeader block;
+			QByteArray columns[TickStoreFormat::COLUMN_COUNT];
+			qint64 last_timestamp_ns = 0;
+
+			// Book as last recorded, and scratch space for the incoming one
+			TickSide bids;
+			TickSide asks;
+			TickSide next_bids;
+			TickSide next_asks;
+			TickSide bid_changes;
+			TickSide ask_changes;
+		};
+
+		void WriterLoop();
+		void Record(const PendingBook& book);
+
+		Stream& StreamFor(EXCHANGE_API exchange, const QString& symbol);
+		bool OpenChunk(Stream& stream, qint64 timestamp_ns, double tick_size, double size_quantum);
+		void CloseChunk(Stream& stream);
+		bool SealBlock(Stream& stream);
+		void SealExpiredBlocks(qint64 now_ns);
+
+		enum GRID_FIT
+		{
+			FITS = 0,
+			PRICE_OFF_GRID = 1,
+			SIZE_OFF_GRID = 2,
+		};
+
+		static int ToGrid(const std::vector<BookLevel>& side, double tick_size, double size_quantum, TickSide& out);
+		static void EncodeSide(Stream& stream, const TickSide& levels, qint64 reference_ticks);
+		static void DiffSide(const TickSide& previous, const TickSide& next, bool is_bids, TickSide& changes);
+
+	private:
+		TickStoreConfig m_config;
+		QuantOrderbook* m_orderbook = nullptr;
+
+		// Producer side; the writer swaps the filled queue for its own, so neither reallocates
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::vector<PendingBook> m_pending;
+		size_t m_pending_count = 0;
+		bool m_running = false;
+		std::thread m_writer;
+
+		// Writer thread only
+		std::vector<PendingBook> m_writing;
+		std::map<QString, std::unique_ptr<Stream>> m_streams;
+
+		std::atomic<qint64> m_bytes_written{ 0 };
+		std::atomic<qint64> m_dropped{ 0 };
+	};
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+namespace Quant
+{
+	/**
+	 * On-disk layout of the tick store
+	 *
+	 * <root>/<EXCHANGE>/<symbol>/<start_ns>.qtk   chunk: header, then blocks
+	 * <root>/<EXCHANGE>/<symbol>/<start_ns>.qti   sparse index: one entry per block
+	 *
+	 * A chunk covers one time partition (an hour by default) and is a run of blocks.
+	 * A block holds the records of one keyframe interval, stored column by column:
+	 *   BlockHeader | timestamps | counts | prices | sizes
+	 * Each column is a stream of varints, and the header gives its length in bytes.
+	 *   timestamps  zigzag, relative to the previous record (the first to first_timestamp_ns)
+	 *   counts      bid count, ask count per record
+	 *   prices      zigzag price in ticks per level, relative to the previous level of the side
+	 *   sizes       size in quanta per level
+	 * The levels of a record are its bids then its asks, in the same order in prices
+	 * and sizes. The first record of a block is a keyframe with the whole book, and
+	 * its first price of each side is relative to 0. The other records are deltas with
+	 * the changed levels only (size 0 removes a level), and their first price of a side
+	 * is relative to that side's best price before the record. Decoding can start at
+	 * any block.
+	 *
+	 * Keeping the columns apart puts values of one kind next to each other, so each
+	 * column compresses well on its own. A reader also finds the time of a record
+	 * from the timestamp column alone.
+	 *
+	 * Integers are little endian; both files are append-only and a block is written
+	 * whole, so a reader may only find a truncated block at the end of a chunk that
+	 * is still being written.
+	 */
+	namespace TickStoreFormat
+	{
+		constexpr quint32 magic = 0x324B5451; // "QTK2"
+		constexpr quint32 version = 2;
+		constexpr quint32 block_magic = 0x424B5451; // "QTKB"
+
+		constexpr const char* chunk_suffix = ".qtk";
+		constexpr const char* index_suffix = ".qti";
+
+		enum COLUMN
+		{
+			TIMESTAMPS,
+			COUNTS,
+			PRICES,
+			SIZES,
+			COLUMN_COUNT,
+		};
+
+		struct ChunkHeader
+		{
+			quint32 magic = TickStoreFormat::magic;
+			quint32 version = TickStoreFormat::version;
+			double tick_size = 0.0;
+			double size_quantum = 0.0;
+			qint64 start_ns = 0;
+		};
+		static_assert(sizeof(ChunkHeader) == 32, "Chunk header layout is part of the file format");
+
+		struct BlockHeader
+		{
+			quint32 magic = block_magic;
+			quint32 record_count = 0;
+			qint64 first_timestamp_ns = 0;
+			qint64 last_timestamp_ns = 0;
+			quint32 column_bytes[COLUMN_COUNT] = {};
+		};
+		static_assert(sizeof(BlockHeader) == 40, "Block header layout is part of the file format");
+
+		struct IndexEntry
+		{
+			qint64 timestamp_ns = 0; // First record of the block
+			qint64 offset = 0;       // Of its header in the chunk
+		};
+		static_assert(sizeof(IndexEntry) == 16, "Index entry layout is part of the file format");
+
+		inline qint64 BlockBytes(const BlockHeader& header)
+		{
+			qint64 bytes = sizeof(BlockHeader);
+			for (int column = 0; column < COLUMN_COUNT; column++)
+				bytes += header.column_bytes[column];
+			return bytes;
+		}
+
+		inline quint64 ZigZag(qint64 value) { return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63); }
+		inline qint64 UnZigZag(quint64 value) { return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1); }
+
+		inline void AppendVarint(QByteArray& out, quint64 value)
+		{
+			while (value >= 0x80)
+			{
+				out.append(static_cast<char>((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+			out.append(static_cast<char>(value));
+		}
+
+		// Returns false on a truncated or overlong value
+		inline bool ReadVarint(const uchar*& cursor, const uchar* end, quint64& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 64 && cursor < end; shift += 7)
+			{
+				const uchar byte = *cursor++;
+				value |= static_cast<quint64>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return true;
+			}
+			return false;
+		}
+
+		inline QString StreamDirectory(const QString& root, const QString& exchange, const QString& symbol)
+		{
+			return root + QLatin1Char('/') + exchange + QLatin1Char('/') + symbol;
+		}
+
+		// Fixed width so that names sort by time
+		inline QString ChunkFileName(qint64 start_ns)
+		{
+			return QString("%1%2").arg(start_ns, 19, 10, QLatin1Char('0')).arg(chunk_suffix);
+		}
+
+		inline QString IndexFileName(qint64 start_ns)
+		{
+			return QString("%1%2").arg(start_ns, 19, 10, QLatin1Char('0')).arg(index_suffix);
+		}
+	}
+}
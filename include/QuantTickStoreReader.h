@@ -0,0 +1,75 @@
+#pragma once
+#include <functional>
+
+#include <QString>
+#include <QVector>
+
+#include "QuantBookView.h"
+#include "QuantTickStoreFormat.h"
+
+namespace Quant
+{
+	// Book reconstructed from the store
+	struct StoredBook
+	{
+		qint64 timestamp_ns = 0;
+		QVector<BookLevel> bids;
+		QVector<BookLevel> asks;
+
+		BookView View() const;
+	};
+
+	struct SpreadDepthSample
+	{
+		qint64 timestamp_ns = 0;
+		double spread = 0.0;
+		double bid_depth = 0.0;
+		double ask_depth = 0.0;
+	};
+
+	/**
+	 * Queries over the history of one (exchange, symbol) stream of QuantTickStore
+	 *
+	 * Chunks and their indexes are memory-mapped on demand. A query picks the chunks
+	 * overlapping its range from the file names, seeks to the block holding the start
+	 * of the range through the sparse index, and decodes forward from there, so the cost is
+	 * proportional to the range rather than to the history.
+	 */
+	class QuantTickStoreReader
+	{
+	public:
+		explicit QuantTickStoreReader(const QString& directory);
+		QuantTickStoreReader(const QString& root, const QString& exchange, const QString& symbol);
+
+	public:
+		// Picks up chunks written since the last call
+		void Refresh();
+		int ChunkCount() const { return static_cast<int>(m_chunks.size()); }
+
+		// Last recorded book at or before the time, false when none exists
+		bool BookAt(qint64 timestamp_ns, StoredBook& book) const;
+
+		// Calls back with every recorded book in [from, to], returns the number of books
+		using ScanFn = std::function<void(qint64 timestamp_ns, const BookView& book)>;
+		qint64 Scan(qint64 from_ns, qint64 to_ns, const ScanFn& callback) const;
+
+		// Spread and the amounts of the best depth_levels levels of each side
+		QVector<SpreadDepthSample> SpreadDepth(qint64 from_ns, qint64 to_ns, int depth_levels = 10) const;
+
+	private:
+		struct ChunkFile
+		{
+			qint64 start_ns = 0;
+			QString chunk_path;
+			QString index_path;
+		};
+
+		// Visits the books of [from, to] in order, preceded by the last book before from
+		// when include_preceding is set; visit returns false to stop
+		void Walk(qint64 from_ns, qint64 to_ns, bool include_preceding, const std::function<bool(const StoredBook& book)>& visit) const;
+
+	private:
+		QString m_directory;
+		QVector<ChunkFile> m_chunks;
+	};
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+
+#include <QByteArray>
+#include <QString>
+
+namespace Quant
+{
+	/**
+	 * Span tracer exporting the Chrome trace-event format (chrome://tracing, Perfetto)
+	 *
+	 * Each thread records into its own ring of the last ring_capacity spans, so
+	 * recording takes no lock and never waits on the exporter; the oldest spans
+	 * are overwritten. When a thread exits its ring is kept, spans included, until
+	 * a new thread takes it over, so pools that retire and recreate threads reuse
+	 * rings instead of adding one per thread. Disabled, a span costs one relaxed
+	 * atomic load.
+	 *
+	 * Span names and categories must be string literals, only the pointers are kept.
+	 */
+	class QuantTracer
+	{
+	public:
+		static constexpr int ring_capacity = 1 << 14;
+
+		static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+		static void SetEnabled(bool enabled);
+
+		// Monotonic clock of every span, in nanoseconds
+		static qint64 Now();
+
+		static void Record(const char* name, const char* category, qint64 begin_ns, qint64 end_ns);
+
+		// Shown as the track name in the viewer
+		static void SetThreadName(const char* name);
+
+		// {"traceEvents": [...]} with one complete ("X") event per span
+		static QByteArray ExportChromeTrace();
+		static bool Dump(const QString& path);
+
+	private:
+		static std::atomic<bool> s_enabled;
+	};
+
+	// Records the enclosing scope as one span when tracing is enabled
+	class TraceScope
+	{
+	public:
+		TraceScope(const char* name, const char* category)
+		{
+			if (QuantTracer::IsEnabled())
+			{
+				m_name = name;
+				m_category = category;
+				m_begin_ns = QuantTracer::Now();
+			}
+		}
+
+		~TraceScope()
+		{
+			if (m_name)
+				QuantTracer::Record(m_name, m_category, m_begin_ns, QuantTracer::Now());
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+	private:
+		const char* m_name = nullptr;
+		const char* m_category = nullptr;
+		qint64 m_begin_ns = 0;
+	};
+}
+
+#define QUANT_TRACE_CONCAT_IMPL(a, b) a##b
+#define QUANT_TRACE_CONCAT(a, b) QUANT_TRACE_CONCAT_IMPL(a, b)
+#define QUANT_TRACE_SCOPE(name, category) Quant::TraceScope QUANT_TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
@@ -1,12 +1,33 @@
 #pragma once
+#include <memory>
+#include <vector>
+
 #include <QtWebSockets/QWebSocket>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
 #include <QUrl>
 
+#include "QuantFeedAdapter.h"
+#include "QuantFeedArbiter.h"
+#include "QuantFeedQueue.h"
+
 namespace Quant
 {
+	/**
+	 * Feed connection, optionally over redundant lines
+	 *
+	 * Line 0 connects to the endpoint given to connect(), every redundant URL adds a
+	 * line carrying the same feed over another path. Each line decodes on its own
+	 * parsing thread and QuantFeedArbiter forwards whichever copy of a message
+	 * arrives first, so the feed's latency is that of the fastest line at any moment.
+	 *
+	 * The socket counts as connected while any line is. A line that drops or stalls
+	 * while another one is up is reconnected on its own and resubscribed; the others
+	 * keep feeding the books in the meantime.
+	 */
 	class QuantWebSocket : public QObject
 	{
 		Q_OBJECT
@@ -20,24 +41,88 @@ namespace Quant
 		void disconnect();
 		bool isConnected() const;
 
+		// Extra lines to the same feed, applied at the next connect()
+		void SetRedundantUrls(const QStringList& urls);
+		QStringList RedundantUrls() const { return m_redundant_urls; }
+		int LineCount() const { return static_cast<int>(m_lines.size()); }
+		FeedLineStats LineStats(int line) const { return m_arbiter.Stats(line); }
+
+		// Drops messages of other symbols, empty accepts everything
+		void SetSymbolFilter(const QString& symbol) { m_symbol_filter = symbol; }
+
+		// Wire format of the venue behind the endpoint, EXCHANGE_API::NONE for the generic one
+		void SetFeedFormat(EXCHANGE_API format);
+		EXCHANGE_API FeedFormat() const { return m_feed_format; }
+
+		// Levels per side the format's snapshots carry, 0 for the whole book
+		int BookDepth() const { return m_adapter.book_depth; }
+
+		// Channels by their OKX names (books, bbo-tbt, books5), translated by the feed adapter;
+		// the venue answers with a fresh snapshot
+		void Subscribe(const QStringList& symbols, const QString& channel = "books");
+		void Unsubscribe(const QStringList& symbols, const QString& channel = "books");
+
+		// Time since the last frame (or connect) on any line, -1 before the first one
+		qint64 MillisecondsSinceLastMessage() const;
+
+		// Backpressure between parsing and the book listeners, policies are per symbol
+		QuantFeedQueue* Queue() { return &m_queue; }
+
 	signals:
 		void connected();
 		void disconnected();
-		void orderbookUpdated(const QJsonArray& bids, const QJsonArray& asks);
+		void orderbookUpdated(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, const QString& symbol);
+		void orderbookDeltaReceived(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, qint64 prev_seq_id, const QString& symbol);
+		void topOfBookUpdated(const QString& symbol, const Quant::BookLevel& best_bid, const Quant::BookLevel& best_ask);
 		void error(const QString& error_message);
 
-	private slots:
-		void onConnected();
-		void onDisconnected();
-		void onTextMessageReceived(const QString& message);
-		void onError(QAbstractSocket::SocketError error);
-
 	private:
-		QJsonParseError m_parse_error;
-		QByteArray m_message_buffer;
+		struct FeedLine
+		{
+			int index = 0;
+			QString url;
+			QWebSocket socket;
+			bool connected = false;
+			QElapsedTimer last_message; // Or the connect
+			QTimer reconnect_timer;
+			FeedDecoderState decoder_state; // Parsing thread only
+			QThreadPool parse_pool;         // Destroyed first, waiting for the parses that use the state
+		};
+
+		void ResizeLines(int count);
+		void OnLineConnected(FeedLine& line);
+		void OnLineDisconnected(FeedLine& line);
+		void OnLineMessage(FeedLine& line, const QString& message);
+		void OnLineError(FeedLine& line);
+		void OnLineWatchdog();
+		void UpdateActiveLine();
+		int ConnectedLineCount() const;
+
+		void SendOperation(bool subscribe, const QStringList& symbols, const QString& channel);
+		void SendLineOperation(FeedLine& line, bool subscribe, const QStringList& symbols, const QString& channel);
 
 	private:
-		QWebSocket m_webSocket;
-		bool m_is_connected;
+		static constexpr int line_stall_ms = 2000;
+		static constexpr int line_reconnect_ms = 1000;
+		static constexpr int line_watchdog_interval_ms = 500;
+
+		QString m_url;
+		QStringList m_redundant_urls;
+		bool m_running = false;
+		QString m_symbol_filter;
+		QElapsedTimer m_clock; // Arrival times, shared by the lines
+		QTimer m_line_watchdog;
+
+		// Replayed on a line that connects while others are up
+		QHash<QString, QStringList> m_subscriptions; // Channel -> symbols
+
+		EXCHANGE_API m_feed_format = EXCHANGE_API::NONE;
+		FeedAdapterFns m_adapter;
+
+		QuantFeedQueue m_queue;
+		QuantFeedArbiter m_arbiter;
+
+		// Last, so the parsing threads are done before the queue and arbiter go
+		std::vector<std::unique_ptr<FeedLine>> m_lines;
 	};
-}
\ No newline at end of file
+}
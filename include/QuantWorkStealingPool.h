@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QtGlobal>
+
+namespace Quant
+{
+	/**
+	 * Fixed-size work-stealing pool for batched passes
+	 *
+	 * Run() splits task indices [0, task_count) into one contiguous range per worker.
+	 * Each worker pops tasks from the front of its own range and, once empty, steals
+	 * from the back of the others. A range is a single atomic word (begin, end), so
+	 * pop and steal are one CAS each and never hand out a task twice.
+	 *
+	 * The calling thread takes part as worker 0 and Run() returns once every task has
+	 * completed. Run() itself is not reentrant; use one pool per evaluating thread.
+	 *
+	 * Under the low-latency profile, the pool's own threads are capped at one per
+	 * calculator core. With busy polling, idle workers that have a core to themselves
+	 * spin on the pass generation (and Run() on the active count, when the caller has
+	 * one) instead of sleeping on the condition variables; the others block.
+	 */
+	class QuantWorkStealingPool
+	{
+	public:
+		// worker_count counts the calling thread; 0 uses QThread::idealThreadCount(), both capped by the profile
+		explicit QuantWorkStealingPool(int worker_count = 0);
+		~QuantWorkStealingPool();
+
+		QuantWorkStealingPool(const QuantWorkStealingPool&) = delete;
+		QuantWorkStealingPool& operator=(const QuantWorkStealingPool&) = delete;
+
+	public:
+		int WorkerCount() const { return m_worker_count; }
+		void Run(int task_count, const std::function<void(int)>& task);
+
+	private:
+		struct alignas(64) WorkRange
+		{
+			std::atomic<quint64> range{ 0 };
+		};
+
+		bool PopFront(int worker, int& task);
+		bool StealBack(int victim, int& task);
+		void Drain(int worker);
+		void WorkerLoop(int worker);
+		bool WaitForPass(quint64& seen_generation, bool spin);
+
+	private:
+		int m_worker_count = 1;
+		std::unique_ptr<WorkRange[]> m_ranges;
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+
+		// Changed under the mutex; atomic so that busy-polling threads can watch them without it
+		std::atomic<quint64> m_generation{ 0 };
+		std::atomic<int> m_active{ 0 };
+		std::atomic<bool> m_stop{ false };
+		const std::function<void(int)>* m_task = nullptr;
+	};
+}
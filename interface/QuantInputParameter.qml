@@ -30,7 +30,7 @@ Rectangle {
             Layout.fillWidth: true
             model: QuantInputModel.available_exchanges
             currentIndex: 0
-            enabled: false // Only OKX supported
+            onCurrentTextChanged: QuantInputModel.selected_exchange = currentText
         }
 
         // Asset selection
@@ -59,6 +59,18 @@ Rectangle {
             enabled: false // Only market supported
         }
 
+        // Order side
+        Label {
+            text: "Order Side"
+            color: "#ffffff"
+        }
+        ComboBox {
+            Layout.fillWidth: true
+            model: QuantInputModel.available_order_sides
+            currentIndex: 0
+            onCurrentTextChanged: dataContext.order_side = currentText
+        }
+
         // Quantity
         Label {
             text: "Quantity (USD)"
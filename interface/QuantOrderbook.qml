@@ -1,6 +1,7 @@
 import QtQuick
 import QtQuick.Controls
 import QtQuick.Layouts
+import Quant
 
 Rectangle {
     id: orderBookPanel
@@ -9,150 +10,71 @@ Rectangle {
     // Reference to shared data context
     property var dataContext
 
-    // Store models locally for reactivity
-    property var bidsModel: []
-    property var asksModel: []
-
-    // Update models when data changes
-    Connections {
-
-        target: QuantOrderbookModel
-        function onOrderbookUpdated() {
-            //console.log("QML: Orderbook updated signal received");
-            bidsModel = QuantOrderbookModel.getBids();
-            asksModel = QuantOrderbookModel.getAsks();
-            //console.log("QML: Updated bids:", bidsModel.length, "asks:", asksModel.length);
-
-            // TODO: Update output parameter base on new orderbook
-            // If auto-update is enabled, recalculate outputs
-            // this would update output parameters with each new tick
-            //if (dataContext)
-                //dataContext.calculateOutput();
-        }
-    }
-
-    // Initial population
-    Component.onCompleted: {
-        //console.log("QML: Component completed, fetching initial data");
-        bidsModel = QuantOrderbookModel.getBids();
-        asksModel = QuantOrderbookModel.getAsks();
-        //console.log("QML: Initial bids:", bidsModel.length, "asks:", asksModel.length);
-    }
-
     ColumnLayout {
         anchors.fill: parent
         anchors.margins: 10
         spacing: 10
 
-        Label {
-            text: "L2 Orderbook"
-            font.bold: true
-            font.pixelSize: 18
-            color: "#ffffff"
-        }
-
         RowLayout {
             Layout.fillWidth: true
-            Layout.fillHeight: true
-            spacing: 20
-
-            // Bids (Buy Orders) Column - Green
-            ColumnLayout {
-                Layout.fillWidth: true
-                Layout.fillHeight: true
-                spacing: 5
+            spacing: 10
 
-                Label {
-                    text: "Bids (Buy Orders)"
-                    color: "#00ff00"
-                    horizontalAlignment: Text.AlignHCenter
-                    Layout.fillWidth: true
-                }
-
-                ListView {
-                    id: bidsView
-                    Layout.fillWidth: true
-                    Layout.fillHeight: true
-                    clip: true
-                    model: bidsModel
-
-                    // Debug placeholder
-                    Text {
-                        anchors.centerIn: parent
-                        text: "Bids: " + (bidsModel ? bidsModel.length : 0)
-                        visible: bidsModel.length === 0
-                    }
+            Label {
+                text: "L2 Orderbook"
+                font.bold: true
+                font.pixelSize: 18
+                color: "#ffffff"
+            }
 
-                    delegate: Rectangle {
-                        width: bidsView.width
-                        height: 30
-                        color: "#1a3a1a"  // Dark green background
+            // Last good book shown while resynchronizing
+            Label {
+                text: "STALE"
+                font.bold: true
+                color: "#ffa500"
+                visible: QuantOrderbookModel.stale
+            }
 
-                        Row {
-                            width: parent.width
-                            Text {
-                                width: parent.width * 0.5
-                                text: modelData.price
-                                color: "#00ff00"  // Green text
-                            }
-                            Text {
+            Item { Layout.fillWidth: true }
 
-                                width: parent.width * 0.5
-                                text: modelData.amount
-                                color: "#ffffff"
-                            }
-                        }
-                    }
-                }
+            // Top of book, updated by the BBO channel without redrawing the depth
+            Label {
+                text: QuantOrderbookModel.midPrice > 0
+                      ? QuantOrderbookModel.bestBidPrice + " / " + QuantOrderbookModel.bestAskPrice
+                        + "  (" + (QuantOrderbookModel.spread * 10000).toFixed(2) + " bps)"
+                      : ""
+                color: "#ffffff"
             }
 
-            // Asks (Sell Orders) Column - Red
-            ColumnLayout {
-                Layout.fillWidth: true
-                Layout.fillHeight: true
-                spacing: 5
+            Label {
+                text: QuantConnectionModel.lastRecoveryTime >= 0
+                      ? "Recovered in " + QuantConnectionModel.lastRecoveryTime + " ms"
+                      : ""
+                color: "#aaaaaa"
+            }
+        }
 
-                Label {
-                    text: "Asks (Sell Orders)"
-                    color: "#ff0000"
-                    horizontalAlignment: Text.AlignHCenter
-                    Layout.fillWidth: true
-                }
+        // Cumulative depth with the size of each level, bids left and asks right
+        QuantDepthChart {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            orderbook: QuantOrderbookModel
+            bidColor: "#00ff00"
+            askColor: "#ff0000"
+        }
 
-                ListView {
-                    id: asksView
-                    Layout.fillWidth: true
-                    Layout.fillHeight: true
-                    clip: true
-                    model: asksModel
+        RowLayout {
+            Layout.fillWidth: true
 
-                    // Debug placeholder
-                    Text {
-                        anchors.centerIn: parent
-                        text: "Asks: " + (asksModel ? asksModel.length : 0)
-                        visible: asksModel.length === 0
-                    }
+            Label {
+                text: "Bids (Buy Orders)"
+                color: "#00ff00"
+            }
 
-                    delegate: Rectangle {
-                        width: asksView.width
-                        height: 30
-                        color: "#3a1a1a"  // Dark red background
+            Item { Layout.fillWidth: true }
 
-                        Row {
-                            width: parent.width
-                            Text {
-                                width: parent.width * 0.5
-                                text: modelData.price
-                                color: "#ff0000"  // Red text
-                            }
-                            Text {
-                                width: parent.width * 0.5
-                                text: modelData.amount
-                                color: "#ffffff"
-                            }
-                        }
-                    }
-                }
+            Label {
+                text: "Asks (Sell Orders)"
+                color: "#ff0000"
             }
         }
     }
@@ -92,6 +92,63 @@ Rectangle {
             }
         }
 
+        // Same order swept across the configured venues
+        RowLayout {
+            Layout.fillWidth: true
+            visible: QuantResultsModel ? QuantResultsModel.consolidated_venues > 0 : false
+            Label {
+                text: "Across Venues:"
+                color: "#ffffff"
+            }
+            Label {
+                text: QuantResultsModel ? QuantResultsModel.consolidated_crypto_amount.toFixed(6) + " BTC, " +
+                    QuantResultsModel.consolidated_cost.toFixed(2) + " USD cost on " + QuantResultsModel.consolidated_venues + " venue(s)" : ""
+                color: "#aaffaa"
+            }
+        }
+
+        // Same order worked in equal slices, with the impact decaying between them
+        RowLayout {
+            Layout.fillWidth: true
+            Label {
+                text: "Sliced Impact:"
+                color: "#ffffff"
+            }
+            Label {
+                text: QuantResultsModel ? QuantResultsModel.sliced_impact.toFixed(4) + "% over " + QuantResultsModel.sliced_slices + " x " +
+                    QuantResultsModel.sliced_slice_seconds + " s" + (QuantResultsModel.propagator_calibrated ? " (calibrated)" : "") : ""
+                color: "#aaffaa"
+            }
+        }
+
+        // Our recorded fills: the impact they still cause, and the fills the propagator calibrates on
+        RowLayout {
+            Layout.fillWidth: true
+            Label {
+                text: "Fill Impact:"
+                color: "#ffffff"
+            }
+            Label {
+                text: QuantResultsModel ? QuantResultsModel.fill_impact.toFixed(4) + "%" : "0.0000%"
+                color: "#aaffaa"
+            }
+            Button {
+                text: "Record Fill"
+                enabled: QuantResultsModel ? QuantResultsModel.crypto_amount > 0 : false
+                onClicked: QuantCalculatorModel.recordFill(QuantResultsModel.crypto_amount)
+            }
+        }
+
+        // Shown when the order walks past the last visible level
+        Label {
+            Layout.fillWidth: true
+            visible: QuantResultsModel ? QuantResultsModel.liquidity_exhausted : false
+            text: QuantResultsModel ? "Exceeds visible liquidity: " + QuantResultsModel.unfilled_usd.toFixed(2) + " USD unfilled" : ""
+            color: "#ff6666"
+            font.bold: true
+            wrapMode: Text.WordWrap
+        }
+
         // TODO: add market order cost
 
         // Maker/Taker proportion
@@ -0,0 +1,99 @@
+#include "QuantBookSnapshots.h"
+
+#include "QuantClock.h"
+#include "QuantOrderbook.h"
+
+namespace Quant
+{
+	BookView BookSnapshot::View() const
+	{
+		BookView view;
+		view.bids = BookSide{ bids.data(), static_cast<int>(bids.size()) };
+		view.asks = BookSide{ asks.data(), static_cast<int>(asks.size()) };
+		view.version = version;
+		view.flow = &flow;
+		return view;
+	}
+
+	const BookFeatures& BookSnapshot::Features(FeaturesFn compute_features) const
+	{
+		std::call_once(m_features_once, [this, compute_features]() { m_features = compute_features(View()); });
+		return m_features;
+	}
+
+	QuantBookSnapshots::QuantBookSnapshots(QObject* parent)
+		: QObject(parent)
+	{
+	}
+
+	std::string QuantBookSnapshots::KeyOf(EXCHANGE_API exchange, const char* symbol)
+	{
+		// Short enough for the small-string buffer with the usual instrument names
+		std::string key(1, static_cast<char>('0' + static_cast<int>(exchange)));
+		key += symbol;
+		return key;
+	}
+
+	void QuantBookSnapshots::AddOrderbook(QuantOrderbook* orderbook)
+	{
+		Entry* entry = nullptr;
+		{
+			const std::string key = KeyOf(orderbook->Exchange(), orderbook->Symbol().toLatin1().constData());
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			std::unique_ptr<Entry>& slot = m_entries[key];
+			if (!slot)
+			{
+				slot = std::make_unique<Entry>();
+				auto empty = std::make_shared<BookSnapshot>();
+				empty->exchange = orderbook->Exchange();
+				empty->symbol = orderbook->Symbol();
+				slot->snapshot = std::move(empty);
+			}
+			entry = slot.get();
+		}
+
+		// On the book's own thread; its levels are only valid until it moves on
+		QObject::connect(orderbook, &QuantOrderbook::orderbookUpdated, this, [this, orderbook, entry]()
+			{
+				Capture(*orderbook, *entry);
+			}, Qt::DirectConnection);
+		QObject::connect(orderbook, &QuantOrderbook::staleChanged, this, [this, orderbook, entry]()
+			{
+				Capture(*orderbook, *entry);
+			}, Qt::DirectConnection);
+	}
+
+	void QuantBookSnapshots::Capture(const QuantOrderbook& orderbook, Entry& entry)
+	{
+		const BookView view = orderbook.View();
+
+		auto snapshot = std::make_shared<BookSnapshot>();
+		snapshot->exchange = orderbook.Exchange();
+		snapshot->symbol = orderbook.Symbol();
+		snapshot->version = view.version;
+		snapshot->timestamp_ns = QuantClock::WallNs();
+		snapshot->stale = orderbook.isStale();
+		snapshot->bids.assign(view.bids.begin(), view.bids.end());
+		snapshot->asks.assign(view.asks.begin(), view.asks.end());
+		if (view.flow)
+			snapshot->flow = *view.flow;
+
+		std::atomic_store(&entry.snapshot, std::shared_ptr<const BookSnapshot>(std::move(snapshot)));
+	}
+
+	std::shared_ptr<const BookSnapshot> QuantBookSnapshots::Latest(EXCHANGE_API exchange, const char* symbol) const
+	{
+		const std::string key = KeyOf(exchange, symbol);
+
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		const auto found = m_entries.find(key);
+		if (found == m_entries.end())
+			return nullptr;
+		return std::atomic_load(&found->second->snapshot);
+	}
+
+	std::shared_ptr<const BookSnapshot> QuantBookSnapshots::Latest(EXCHANGE_API exchange, const QString& symbol) const
+	{
+		return Latest(exchange, symbol.toLatin1().constData());
+	}
+}
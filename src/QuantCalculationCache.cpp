@@ -0,0 +1,101 @@
+#include "QuantCalculationCache.h"
+
+#include <cstring>
+
+#include "QuantMetrics.h"
+
+namespace
+{
+	quint64 Bits(double value)
+	{
+		quint64 bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// splitmix64 finalizer, spreads the nearby amounts of a slider drag over the slots
+	quint64 Mix(quint64 value)
+	{
+		value ^= value >> 30;
+		value *= 0xbf58476d1ce4e5b9ull;
+		value ^= value >> 27;
+		value *= 0x94d049bb133111ebull;
+		value ^= value >> 31;
+		return value;
+	}
+}
+
+namespace Quant
+{
+	const BookFeatures& QuantCalculationCache::Features(const BookView& book, FeaturesFn compute_features)
+	{
+		if (book.version == 0)
+		{
+			m_unversioned_features = compute_features(book);
+			return m_unversioned_features;
+		}
+
+		if (book.version == m_features_version)
+		{
+			PipelineMetrics::Get().feature_cache_hits.Add();
+			return m_features;
+		}
+
+		{
+			QUANT_TRACE_SCOPE("features", "estimator");
+			m_features = compute_features(book);
+		}
+		m_features_version = book.version;
+		return m_features;
+	}
+
+	bool QuantCalculationCache::FindResult(const BookView& book, const CalculationInput& input, CalculationOutput& output) const
+	{
+		if (book.version == 0)
+			return false;
+
+		const ResultEntry& entry = m_results[SlotOf(book.version, input)];
+		if (entry.version != book.version || !SameInput(entry.input, input))
+			return false;
+
+		PipelineMetrics::Get().result_cache_hits.Add();
+		output = entry.output;
+		return true;
+	}
+
+	void QuantCalculationCache::StoreResult(const BookView& book, const CalculationInput& input, const CalculationOutput& output)
+	{
+		if (book.version == 0)
+			return;
+
+		ResultEntry& entry = m_results[SlotOf(book.version, input)];
+		entry.version = book.version;
+		entry.input = input;
+		entry.output = output;
+	}
+
+	void QuantCalculationCache::Clear()
+	{
+		m_features_version = 0;
+		for (ResultEntry& entry : m_results)
+			entry.version = 0;
+	}
+
+	size_t QuantCalculationCache::SlotOf(quint64 version, const CalculationInput& input)
+	{
+		quint64 hash = Mix(version);
+		hash = Mix(hash ^ Bits(input.usd_amount));
+		hash = Mix(hash ^ Bits(input.volatility));
+		hash ^= static_cast<quint64>(input.order_type) | static_cast<quint64>(input.order_side) << 8
+			| static_cast<quint64>(input.fee_tier) << 16 | static_cast<quint64>(input.volatility_enabled) << 24;
+		return static_cast<size_t>(Mix(hash) & (result_slots - 1));
+	}
+
+	bool QuantCalculationCache::SameInput(const CalculationInput& lhs, const CalculationInput& rhs)
+	{
+		// A NaN amount never equals itself, so it is recomputed every time
+		return lhs.order_type == rhs.order_type && lhs.order_side == rhs.order_side && lhs.fee_tier == rhs.fee_tier
+			&& lhs.usd_amount == rhs.usd_amount && lhs.volatility_enabled == rhs.volatility_enabled
+			&& lhs.volatility == rhs.volatility;
+	}
+}
@@ -76,4 +76,47 @@ namespace Quant
 		m_processing_time = processing_time;
 		emit ResultsChanged();
 	}
-}
\ No newline at end of file
+
+	void QuantCalculationResults::SetLiquidityExhausted(bool exhausted)
+	{
+		if (exhausted == m_liquidity_exhausted)
+			return;
+
+		m_liquidity_exhausted = exhausted;
+		emit ResultsChanged();
+	}
+
+	void QuantCalculationResults::SetUnfilledUSD(double unfilled_usd)
+	{
+		if (unfilled_usd == m_unfilled_usd)
+			return;
+
+		m_unfilled_usd = unfilled_usd;
+		emit ResultsChanged();
+	}
+
+	void QuantCalculationResults::SetConsolidated(int venues, double crypto_amount, double cost)
+	{
+		if (venues == m_consolidated_venues && crypto_amount == m_consolidated_crypto_amount && cost == m_consolidated_cost)
+			return;
+
+		m_consolidated_venues = venues;
+		m_consolidated_crypto_amount = crypto_amount;
+		m_consolidated_cost = cost;
+		emit ResultsChanged();
+	}
+
+	void QuantCalculationResults::SetTransientImpact(int slices, double slice_seconds, double sliced_impact, double fill_impact, bool calibrated)
+	{
+		if (slices == m_sliced_slices && slice_seconds == m_sliced_slice_seconds && sliced_impact == m_sliced_impact
+			&& fill_impact == m_fill_impact && calibrated == m_propagator_calibrated)
+			return;
+
+		m_sliced_slices = slices;
+		m_sliced_slice_seconds = slice_seconds;
+		m_sliced_impact = sliced_impact;
+		m_fill_impact = fill_impact;
+		m_propagator_calibrated = calibrated;
+		emit ResultsChanged();
+	}
+}
@@ -0,0 +1,70 @@
+#include "QuantCalculator.h"
+
+namespace Quant
+{
+	// One instantiation per supported venue
+	template class QuantCalculator<OKXPolicy>;
+	template class QuantCalculator<BinancePolicy>;
+	template class QuantCalculator<CoinbasePolicy>;
+	template class QuantCalculator<MEXCPolicy>;
+
+	namespace
+	{
+		template <typename ExchangePolicy>
+		CalculatorKernels KernelsOf()
+		{
+			using Calculator = QuantCalculator<ExchangePolicy>;
+			return { &Calculator::ComputeFeatures, static_cast<EstimatorFn>(&Calculator::Evaluate), &Calculator::PropagatorParamsFor, &Calculator::CalculateSlicedImpact };
+		}
+
+		template <typename ExchangePolicy>
+		std::shared_ptr<const FeeSchedule> SharedFeeSchedule()
+		{
+			// Thread-safe one-time initialization, never mutated afterwards
+			static const std::shared_ptr<const FeeSchedule> schedule = std::make_shared<const FeeSchedule>(ExchangePolicy::fee_schedule);
+			return schedule;
+		}
+	}
+
+	CalculatorFn ResolveCalculator(EXCHANGE_API exchange)
+	{
+		// Explicit overload selection since Evaluate() is overloaded
+		switch (exchange)
+		{
+		case EXCHANGE_API::OKX:
+			return static_cast<CalculatorFn>(&QuantCalculator<OKXPolicy>::Evaluate);
+		case EXCHANGE_API::BINANCE:
+			return static_cast<CalculatorFn>(&QuantCalculator<BinancePolicy>::Evaluate);
+		case EXCHANGE_API::COINBASE:
+			return static_cast<CalculatorFn>(&QuantCalculator<CoinbasePolicy>::Evaluate);
+		case EXCHANGE_API::MEXC:
+			return static_cast<CalculatorFn>(&QuantCalculator<MEXCPolicy>::Evaluate);
+		default:
+			return nullptr;
+		}
+	}
+
+	CalculatorKernels ResolveKernels(EXCHANGE_API exchange)
+	{
+		switch (exchange)
+		{
+		case EXCHANGE_API::OKX: return KernelsOf<OKXPolicy>();
+		case EXCHANGE_API::BINANCE: return KernelsOf<BinancePolicy>();
+		case EXCHANGE_API::COINBASE: return KernelsOf<CoinbasePolicy>();
+		case EXCHANGE_API::MEXC: return KernelsOf<MEXCPolicy>();
+		default: return {};
+		}
+	}
+
+	std::shared_ptr<const FeeSchedule> GetFeeSchedule(EXCHANGE_API exchange)
+	{
+		switch (exchange)
+		{
+		case EXCHANGE_API::OKX: return SharedFeeSchedule<OKXPolicy>();
+		case EXCHANGE_API::BINANCE: return SharedFeeSchedule<BinancePolicy>();
+		case EXCHANGE_API::COINBASE: return SharedFeeSchedule<CoinbasePolicy>();
+		case EXCHANGE_API::MEXC: return SharedFeeSchedule<MEXCPolicy>();
+		default: return nullptr;
+		}
+	}
+}
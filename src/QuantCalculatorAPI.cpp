@@ -1,14 +1,34 @@
 #include "QuantCalculatorAPI.h"
 
-#include <qelapsedtimer.h>
+#include <QElapsedTimer>
 
 #include "QuantCalculationResults.h"
+#include "QuantClock.h"
+#include "QuantMetrics.h"
+#include "QuantTracer.h"
 
 namespace {
 	// Utility
 	inline double percentageToUSD(double percentage, double baseAmount) {
 		return baseAmount * (percentage / 100.0);
 	}
+
+	// Schedule the transient impact is shown for: the order in equal slices, one every slice_seconds
+	constexpr int sliced_slices = 10;
+	constexpr double sliced_slice_seconds = 30.0;
+
+	double SteadySeconds()
+	{
+		return Quant::QuantClock::SteadyNs() / 1.0e9;
+	}
+
+	// Symbols are ASCII, NUL padded and cut to fit
+	void CopySymbol(const QString& symbol, char (&out)[Quant::JournalFormat::symbol_size])
+	{
+		const int length = qMin<int>(symbol.size(), Quant::JournalFormat::symbol_size - 1);
+		for (int idx = 0; idx < length; idx++)
+			out[idx] = symbol[idx].toLatin1();
+	}
 }
 
 namespace Quant
@@ -42,16 +62,14 @@ namespace Quant
 			m_result->deleteLater();
 			m_result = nullptr;
 		}
-
-		m_calculator_interface = nullptr;
 	}
 
-	IQuantCalculatorAPI* QuantCalculatorAPI::selectedExchange()
+	bool QuantCalculatorAPI::ResolveExchange()
 	{
 		if (!m_input_handler)
 		{
 			qWarning() << "Calculate Engine: missing input handler";
-			return nullptr;
+			return false;
 		}
 
 		EXCHANGE_API selected_exchange = m_input_handler->SelectedExchange();
@@ -59,20 +77,18 @@ namespace Quant
 		if (selected_exchange == EXCHANGE_API::NONE)
 		{
 			qDebug() << "No Exchange Selected";
-			return nullptr;
+			m_context.SetExchange(EXCHANGE_API::NONE);
+			return false;
 		}
-	
-		if (QuantOKXCalculator::get().isSelected(EXCHANGE_API::OKX))
+
+		if (!m_context.SetExchange(selected_exchange))
 		{
-			qDebug() << "OKX Selected";
-			m_calculator_interface = &QuantOKXCalculator::get();
-			return m_calculator_interface;
+			qDebug() << "No valid exchange selected";
+			return false;
 		}
 
-		// Add other exchanges here as needed
-
-		qDebug() << "No valid exchange selected";
-		return nullptr;
+		qDebug() << EnumConverter::ExchangeToString(selected_exchange) << "Selected";
+		return true;
 	}
 
 	void QuantCalculatorAPI::SetInputHandler(QuantInputHandler* input_handler)
@@ -85,9 +101,10 @@ namespace Quant
 
 		m_input_handler = input_handler;
 
-		QObject::connect(m_input_handler, &QuantInputHandler::SelectedExchangeChanged,this, &QuantCalculatorAPI::OnInputChanged);
+		QObject::connect(m_input_handler, &QuantInputHandler::SelectedExchangeChanged, this, &QuantCalculatorAPI::OnExchangeChanged);
 		QObject::connect(m_input_handler, &QuantInputHandler::SelectedAssetChanged, this, &QuantCalculatorAPI::OnInputChanged);
 		QObject::connect(m_input_handler, &QuantInputHandler::OrderTypeChanged, this, &QuantCalculatorAPI::OnInputChanged);
+		QObject::connect(m_input_handler, &QuantInputHandler::OrderSideChanged, this, &QuantCalculatorAPI::OnInputChanged);
 		QObject::connect(m_input_handler, &QuantInputHandler::FeeTierChanged, this, &QuantCalculatorAPI::OnInputChanged);
 		QObject::connect(m_input_handler, &QuantInputHandler::QuantityChanged, this, &QuantCalculatorAPI::OnInputChanged);
 		QObject::connect(m_input_handler, &QuantInputHandler::VolatilityChanged, this, &QuantCalculatorAPI::OnInputChanged);
@@ -108,10 +125,23 @@ namespace Quant
 		}
 
 		m_orderbook = orderbook;
+		m_context.InvalidateCache();
 
 		QObject::connect(m_orderbook, &QuantOrderbook::orderbookUpdated, this, &QuantCalculatorAPI::OnOrderbookUpdated);
 	}
 
+	void QuantCalculatorAPI::SetConsolidatedBook(QuantConsolidatedBook* consolidated_book)
+	{
+		if (m_consolidated_book)
+			QObject::disconnect(m_consolidated_book, nullptr, this, nullptr);
+
+		m_consolidated_book = consolidated_book;
+
+		// Other venues move the sweep too; coalesced with the selected book's updates
+		if (m_consolidated_book)
+			QObject::connect(m_consolidated_book, &QuantConsolidatedBook::consolidatedUpdated, this, &QuantCalculatorAPI::OnOrderbookUpdated);
+	}
+
 	void QuantCalculatorAPI::Calculate()
 	{
 		if (!m_input_handler || !m_orderbook)
@@ -120,136 +150,145 @@ namespace Quant
 			return;
 		}
 
-		if (!m_calculator_interface)
+		if (!m_context.IsValid())
 		{
 			qWarning() << "Calculate Engine: Invalid Calculator";
 			return;
 		}
 
-		// Start timing
-		QElapsedTimer time;
-		time.start();
-
-		// Get orderbook data
-		auto bids = m_orderbook->getBids();
-		auto asks = m_orderbook->getAsks();
+		QUANT_TRACE_SCOPE("calculate", "calculator");
+		QElapsedTimer calculation_timer;
+		calculation_timer.start();
 
 		// Get input data
-		// TODO: Add xchange check on the OKX calculator
-		auto selected_exchagne = m_input_handler->SelectedExchange();
-		auto order_type = m_input_handler->OrderType();
-		auto fee_tier = m_input_handler->FeeTier();
-		auto quantity = m_input_handler->Quantity();
-		auto usd_amount = m_input_handler->USDAmount();
-
-		// TODO: Add ORDER_SIDE enum to the QuantInputHandler class
-		ORDER_SIDE order_side = ORDER_SIDE::BUY;
-
-		// Calculate volatility from orderbook
-		if (QuantOKXCalculator::isVolatilityEnabled())
-		{
-			m_volatility = m_input_handler->Volatility();
-		}
-		else
-			m_volatility = m_calculator_interface->CalculateVolatilityFromOrderbook(bids, asks);
-
-
-		// Calculate fees percentage
-		double fee_pctg = m_calculator_interface->CalculateFees(usd_amount, fee_tier, true);
-
-		// Calculate available amount after fees
-		double available_usd = usd_amount / (1.0 + fee_pctg / 100.0);
-		m_fees = usd_amount - available_usd;
-		qDebug() << "fee: " << m_fees;
-		// Calculate market order cost
-		//m_market_order_cost = m_calculator_interface->CalculateMarketOrderCost(usd_amount, bids);
+		CalculationInput input;
+		input.order_type = m_input_handler->OrderType();
+		input.fee_tier = m_input_handler->FeeTier();
+		input.usd_amount = m_input_handler->USDAmount();
+		input.order_side = m_input_handler->OrderSide();
 
-		// Calculate slippage
-		double estimated_crypto = CalculateCryptoForFixedUSD(available_usd, order_side == ORDER_SIDE::BUY ? asks : bids);
-		double slippage_pctg = m_calculator_interface->CalculateSlippage(estimated_crypto, bids, asks, order_type, order_side);
-		//double slippage_pctg = m_calculator_interface->CalculateSlippage(usd_amount, bids, asks, order_type, order_side);
-		//m_slippage = percentageToUSD(slippage_pctg, m_market_order_cost);
+		// The volatility override belongs to this calculator's context only
+		m_context.SetVolatilityEnabled(m_input_handler->VolatilityEnabled());
+		m_context.SetVolatility(m_input_handler->Volatility());
 
-		// Apply slippage to reduce available USD
-		m_slippage = available_usd * (slippage_pctg / 100.0);
-		available_usd -= m_slippage;
+		// Run the exchange specialized kernels on the typed book
+		const BookView book = m_orderbook->View();
+		const CalculationOutput output = m_context.Evaluate(input, book);
 
-		// Calculate market impact
-		//double impact_pctg = m_calculator_interface->CalculateMarketImpact(usd_amount, m_volatility, bids, asks);
-		//m_market_impact = percentageToUSD(impact_pctg, m_market_order_cost);
-		double impact_pctg = m_calculator_interface->CalculateMarketImpact(estimated_crypto, m_volatility, bids, asks);
-		m_market_impact = available_usd * (impact_pctg / 100.0);
-		available_usd -= m_market_impact;
+		// The mid after our fills, for calibrating the propagator
+		const double now_seconds = SteadySeconds();
+		m_context.ObserveMid(m_orderbook->midPrice(), now_seconds);
 
-		// Final calculation of crypto amount after all costs
-		double final_crypto_amount = CalculateCryptoForFixedUSD(available_usd, order_side == ORDER_SIDE::BUY ? asks : bids);
+		m_volatility = output.volatility;
+		m_fees = output.fees;
+		m_slippage = output.slippage;
+		m_market_impact = output.market_impact;
+		m_market_order_cost = output.market_order_cost;
+		m_maker_ratio = output.maker_ratio;
 
-		qDebug() << "Final Crypto amount" << final_crypto_amount << " Net cost" << available_usd;
+		// Processing time in milliseconds, measured by the context
+		double elapsed_ms = m_context.GetProcessingTime();
 
-		// Set market order cost to original USD amount
-		m_market_order_cost = usd_amount - m_fees - m_slippage - m_market_impact;
-
-		// Calculate maker ratio
-		m_maker_ratio = m_calculator_interface->CalculateMakerRatio(bids, asks);
-
-		// Measure processing time in milliseconds
-		double elapsed_ms = time.elapsed();
-		QuantOKXCalculator::SetProcessingTime(elapsed_ms);
+		// Publishing covers the results object, the journal, shared memory and the UI notification
+		QUANT_TRACE_SCOPE("results_publish", "calculator");
 
 		// Update the results object
 		QuantCalculationResults* results = qobject_cast<QuantCalculationResults*>(m_result);
 		if (results)
 		{
-			//qDebug() << "Volatility: " << m_volatility;
-			//qDebug() << "  Slippage:" << m_slippage;
-			//qDebug() << "  Fees:" << m_fees;
-			//qDebug() << "  Market Impact:" << m_market_impact;
-			//qDebug() << "  Market Order Cost:" << m_market_order_cost;
-			//qDebug() << "  Elapsed Time: " << elapsed_ms;
-			//qDebug() << "  Net Cost:" <<  m_slippage + m_fees + m_market_impact;
-			
 			results->SetSlippage(m_slippage);
 			results->SetFees(m_fees);
 			results->SetMarketImpact(m_market_impact);
-			results->SetNetCost(available_usd);
-			results->SetCryptoAmount(final_crypto_amount);
+			results->SetNetCost(output.net_cost);
+			results->SetCryptoAmount(output.crypto_amount);
 			results->SetMakerRation(m_maker_ratio);
 			results->SetVolatility(m_volatility);
 			results->SetProcessingTime(elapsed_ms);
+			results->SetLiquidityExhausted(output.liquidity_exhausted);
+			results->SetUnfilledUSD(output.unfilled_usd);
+
+			if (m_consolidated_book)
+			{
+				// What the same budget buys, or the same notional sells, split across the venues
+				const SweepResult sweep = m_consolidated_book->SweepCost(input.order_side, input.usd_amount);
+				results->SetConsolidated(static_cast<int>(sweep.fills.size()), sweep.quantity, sweep.fees + sweep.slippage);
+			}
+
+			const double sliced_impact = m_context.SlicedImpact(book, output.crypto_amount, sliced_slices, sliced_slice_seconds, input.order_side);
+			results->SetTransientImpact(sliced_slices, sliced_slice_seconds, sliced_impact, m_context.FillImpact(now_seconds), m_context.GetPropagatorFit().valid);
+		}
+
+		// Session history and local readers; only copies into their rings on this thread
+		if (m_journal || m_publisher)
+		{
+			JournalFormat::JournalRecord record;
+			record.timestamp_ns = QuantClock::WallNs();
+			record.book_version = m_orderbook->Version();
+			CopySymbol(m_orderbook->Symbol(), record.symbol);
+			record.exchange = static_cast<quint8>(m_context.Exchange());
+			record.order_type = static_cast<quint8>(input.order_type);
+			record.order_side = static_cast<quint8>(input.order_side);
+			record.fee_tier = static_cast<quint8>(input.fee_tier);
+			record.volatility_enabled = m_context.isVolatilityEnabled() ? 1 : 0;
+			record.liquidity_exhausted = output.liquidity_exhausted ? 1 : 0;
+			record.usd_amount = input.usd_amount;
+			record.input_volatility = m_context.Volatility();
+			record.volatility = output.volatility;
+			record.fees = output.fees;
+			record.slippage = output.slippage;
+			record.market_impact = output.market_impact;
+			record.market_order_cost = output.market_order_cost;
+			record.net_cost = output.net_cost;
+			record.crypto_amount = output.crypto_amount;
+			record.maker_ratio = output.maker_ratio;
+			record.processing_time_ms = elapsed_ms;
+			if (m_journal)
+				m_journal->Append(record);
+			if (m_publisher)
+				m_publisher->PublishResult(m_orderbook->Symbol(), record);
 		}
 
+		PipelineMetrics& metrics = PipelineMetrics::Get();
+		metrics.calculations.Add();
+		metrics.calculation_latency.Observe(calculation_timer.nsecsElapsed());
+
 		// Notify UI
 		emit CalculationUpdated();
 	}
 
-	// New helper method to calculate crypto amount for a fixed USD amount
-	double QuantCalculatorAPI::CalculateCryptoForFixedUSD(double usd_amount, const QVariantList& orderbook)
+	double QuantCalculatorAPI::calculateSlicedImpact(double quantity, int slices, double slice_seconds)
 	{
-		double remaining_usd = usd_amount;
-		double total_crypto = 0.0;
+		if (!m_input_handler || !m_orderbook || !m_context.IsValid())
+			return 0.0;
 
-		// Walk through orderbook entries until USD is spent
-		for (int i = 0; i < orderbook.size() && remaining_usd > 0; i++)
-		{
-			QVariantMap level = orderbook[i].toMap();
-			double price = level["price"].toDouble();
-			double available_amount = level["amount"].toDouble();
+		return m_context.SlicedImpact(m_orderbook->View(), quantity, slices, slice_seconds, m_input_handler->OrderSide());
+	}
 
-			if (price <= 0.0) continue; // Protect against bad data
+	void QuantCalculatorAPI::recordFill(double quantity)
+	{
+		if (!m_input_handler || !m_orderbook || !m_context.IsValid())
+			return;
 
-			double max_spendable_at_level = price * available_amount;
-			double amount_to_spend = qMin(remaining_usd, max_spendable_at_level);
-			double crypto_acquired = amount_to_spend / price;
+		m_context.RecordFill(m_orderbook->View(), quantity, m_input_handler->OrderSide(), SteadySeconds());
+		Calculate();
+	}
 
-			total_crypto += crypto_acquired;
-			remaining_usd -= amount_to_spend;
+	void QuantCalculatorAPI::OnOrderbookUpdated()
+	{
+		// A burst of book updates delivered in one drain costs one calculation on the latest book
+		if (m_calculation_pending)
+		{
+			PipelineMetrics::Get().calculations_coalesced.Add();
+			return;
 		}
 
-		return total_crypto;
+		m_calculation_pending = true;
+		QMetaObject::invokeMethod(this, &QuantCalculatorAPI::OnPendingCalculation, Qt::QueuedConnection);
 	}
 
-	void QuantCalculatorAPI::OnOrderbookUpdated()
+	void QuantCalculatorAPI::OnPendingCalculation()
 	{
+		m_calculation_pending = false;
 		Calculate();
 	}
 
@@ -258,4 +297,10 @@ namespace Quant
 		Calculate();
 	}
 
+	void QuantCalculatorAPI::OnExchangeChanged()
+	{
+		ResolveExchange();
+		Calculate();
+	}
+
 }
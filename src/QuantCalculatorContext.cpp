@@ -0,0 +1,127 @@
+#include "QuantCalculatorContext.h"
+
+#include <QElapsedTimer>
+
+namespace
+{
+	constexpr double calibration_window_seconds = 300.0; // Quiet time after the last fill before a run is fitted
+	constexpr double observation_interval_seconds = 1.0;
+}
+
+namespace Quant
+{
+	QuantCalculatorContext::QuantCalculatorContext(EXCHANGE_API exchange)
+	{
+		SetExchange(exchange);
+	}
+
+	bool QuantCalculatorContext::SetExchange(EXCHANGE_API exchange)
+	{
+		m_exchange = exchange;
+		m_kernels = ResolveKernels(exchange);
+		m_fee_schedule = GetFeeSchedule(exchange);
+		InvalidateCache();
+
+		return IsValid();
+	}
+
+	void QuantCalculatorContext::InvalidateCache()
+	{
+		m_cache.Clear();
+		m_propagator_fit = PropagatorFit();
+		m_fills.clear();
+		m_fill_path.clear();
+		m_fill_propagator.ResetFills();
+	}
+
+	CalculationOutput QuantCalculatorContext::Evaluate(const CalculationInput& input, const BookView& book)
+	{
+		if (!IsValid())
+			return {};
+
+		QElapsedTimer time;
+		time.start();
+
+		CalculationInput effective_input = input;
+		effective_input.volatility_enabled = m_is_volatility_enabled;
+		effective_input.volatility = m_volatility;
+
+		CalculationOutput output;
+		if (!m_cache.FindResult(book, effective_input, output))
+		{
+			const BookFeatures& features = m_cache.Features(book, m_kernels.compute_features);
+			output = m_kernels.evaluate(effective_input, book, *m_fee_schedule, features);
+			m_cache.StoreResult(book, effective_input, output);
+		}
+
+		m_process_time_ms = time.nsecsElapsed() / 1.0e6;
+		return output;
+	}
+
+	double QuantCalculatorContext::SlicedImpact(const BookView& book, double quantity, int slices, double slice_seconds, ORDER_SIDE order_side)
+	{
+		if (!IsValid())
+			return 0.0;
+
+		const BookFeatures& features = m_cache.Features(book, m_kernels.compute_features);
+		const double volatility = m_is_volatility_enabled ? m_volatility : features.volatility;
+		const PropagatorParams* calibrated = m_propagator_fit.valid ? &m_propagator_fit.params : nullptr;
+		return m_kernels.sliced_impact(m_propagator, quantity, slices, slice_seconds, volatility, features, order_side, calibrated);
+	}
+
+	void QuantCalculatorContext::RecordFill(const BookView& book, double quantity, ORDER_SIDE order_side, double time_seconds)
+	{
+		if (!IsValid() || quantity <= 0.0)
+			return;
+
+		const BookFeatures& features = m_cache.Features(book, m_kernels.compute_features);
+		if (m_fills.empty())
+		{
+			if (features.mid_price <= 0.0)
+				return;
+
+			const double volatility = m_is_volatility_enabled ? m_volatility : features.volatility;
+			m_fill_reference_mid = features.mid_price;
+			m_fill_start = time_seconds;
+			m_fill_path.clear();
+			m_fill_propagator.SetParams(m_propagator_fit.valid ? m_propagator_fit.params : m_kernels.propagator_params(volatility, features, order_side));
+			m_fill_propagator.ResetFills();
+		}
+
+		const double volume = order_side == ORDER_SIDE::BUY ? quantity : -quantity;
+		m_fills.push_back({ time_seconds - m_fill_start, volume });
+		m_fill_propagator.RecordFill(volume, time_seconds - m_fill_start);
+		m_last_fill = time_seconds;
+	}
+
+	void QuantCalculatorContext::ObserveMid(double mid_price, double time_seconds)
+	{
+		if (m_fills.empty() || mid_price <= 0.0)
+			return;
+
+		const double elapsed = time_seconds - m_fill_start;
+		if (!m_fill_path.empty() && elapsed - m_fill_path.back().time_seconds < observation_interval_seconds)
+			return;
+
+		m_fill_path.push_back({ elapsed, mid_price / m_fill_reference_mid - 1.0 });
+		if (time_seconds - m_last_fill < calibration_window_seconds)
+			return;
+
+		// The shape is the propagator's; strength and decay are fitted
+		const PropagatorFit fit = QuantPropagator::Calibrate(m_fill_propagator.Params(), m_fills, m_fill_path);
+		if (fit.valid)
+			SetPropagatorFit(fit);
+
+		m_fills.clear();
+		m_fill_path.clear();
+		m_fill_propagator.ResetFills();
+	}
+
+	double QuantCalculatorContext::FillImpact(double time_seconds) const
+	{
+		if (m_fills.empty())
+			return 0.0;
+
+		return m_fill_propagator.ImpactAt(time_seconds - m_fill_start) * 100.0;
+	}
+}
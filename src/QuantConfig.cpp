@@ -0,0 +1,265 @@
+#include "QuantConfig.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcessEnvironment>
+#include <QStandardPaths>
+
+#include "QuantConstants.h"
+#include "QuantFeedAdapter.h"
+
+namespace
+{
+	using namespace Quant;
+
+	std::shared_ptr<const ConfigSnapshot> current_snapshot = std::make_shared<const ConfigSnapshot>();
+
+	BACKPRESSURE_POLICY StringToPolicy(const QString& policy, BACKPRESSURE_POLICY fallback)
+	{
+		const QString name = policy.toLower();
+		if (name == "conflate")
+			return BACKPRESSURE_POLICY::CONFLATE;
+		if (name == "keep_all")
+			return BACKPRESSURE_POLICY::KEEP_ALL;
+		if (name == "drop_resync")
+			return BACKPRESSURE_POLICY::DROP_RESYNC;
+
+		if (!name.isEmpty())
+			qWarning() << "Config: unknown backpressure policy" << policy;
+		return fallback;
+	}
+
+	// Reads config.json into the snapshot; a missing file is not an error
+	bool ApplyFile(const QString& path, qint64 max_bytes, ConfigSnapshot& config)
+	{
+		QFile file(path);
+		if (!file.exists())
+			return true;
+
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			qWarning() << "Config: cannot open" << path;
+			return false;
+		}
+		if (file.size() > max_bytes)
+		{
+			qWarning() << "Config: file larger than" << max_bytes << "bytes" << path;
+			return false;
+		}
+
+		QJsonParseError parse_error;
+		const QJsonDocument json_doc = QJsonDocument::fromJson(file.read(max_bytes), &parse_error);
+		if (parse_error.error != QJsonParseError::NoError || !json_doc.isObject())
+		{
+			qWarning() << "Config: invalid JSON in" << path << parse_error.errorString();
+			return false;
+		}
+
+		const QJsonObject root = json_doc.object();
+		config.api_key = root["api_key"].toString(config.api_key);
+		config.api_secret = root["api_secret"].toString(config.api_secret);
+		config.api_passphrase = root["api_passphrase"].toString(config.api_passphrase);
+
+		const QJsonObject feed = root["feed"].toObject();
+		config.socket_endpoint = feed["endpoint"].toString(config.socket_endpoint);
+		if (feed["redundant_endpoints"].isArray())
+		{
+			config.redundant_endpoints.clear();
+			for (const QJsonValue& endpoint : feed["redundant_endpoints"].toArray())
+				config.redundant_endpoints.append(endpoint.toString());
+		}
+		if (feed["symbols"].isArray())
+		{
+			config.symbols.clear();
+			for (const QJsonValue& symbol : feed["symbols"].toArray())
+				config.symbols.append(symbol.toString());
+		}
+		config.book_depth = qMax(0, feed["depth"].toInt(config.book_depth));
+		config.top_of_book_channel = feed["top_of_book"].toString(config.top_of_book_channel);
+		config.requests_per_second = qMax(0, feed["requests_per_second"].toInt(config.requests_per_second));
+		if (feed.contains("format"))
+			config.feed_format = StringToFeedFormat(feed["format"].toString());
+
+		// "venues": [ { "exchange": "binance", "symbol": "BTCUSDT", "endpoint": "wss://..." } ]
+		if (feed["venues"].isArray())
+		{
+			config.venues.clear();
+			for (const QJsonValue& value : feed["venues"].toArray())
+			{
+				const QJsonObject venue_object = value.toObject();
+				VenueFeedConfig venue;
+				venue.exchange = StringToFeedFormat(venue_object["exchange"].toString());
+				venue.symbol = venue_object["symbol"].toString();
+				venue.endpoint = venue_object["endpoint"].toString();
+				if (venue.exchange == EXCHANGE_API::NONE || venue.endpoint.isEmpty())
+				{
+					qWarning() << "Config: venue needs a known exchange and an endpoint" << venue_object;
+					continue;
+				}
+				config.venues.append(venue);
+			}
+		}
+
+		// "depths": { "BTC-USDT-SWAP": 400 } overrides the depth per symbol
+		const QJsonObject depths = feed["depths"].toObject();
+		for (auto it = depths.begin(); it != depths.end(); ++it)
+			config.symbol_depths.insert(it.key(), qMax(0, it.value().toInt()));
+
+		const QJsonObject backpressure = root["backpressure"].toObject();
+		config.backpressure_policy = StringToPolicy(backpressure["policy"].toString(), config.backpressure_policy);
+		config.backpressure_limits.max_depth = backpressure["max_depth"].toInt(config.backpressure_limits.max_depth);
+		config.backpressure_limits.max_staleness_ms = backpressure["max_staleness_ms"].toInt(config.backpressure_limits.max_staleness_ms);
+
+		const QJsonObject threads = root["threads"].toObject();
+		config.scenario_threads = qMax(0, threads["scenarios"].toInt(config.scenario_threads));
+		config.ingest_connections = qMax(0, threads["ingest"].toInt(config.ingest_connections));
+
+		// "runtime": { "low_latency": true, "cores": { "ingest": [2], "book": [3], "calculator": [4, 5] } }
+		const QJsonObject runtime = root["runtime"].toObject();
+		config.runtime.low_latency = runtime["low_latency"].toBool(config.runtime.low_latency);
+		config.runtime.busy_poll = runtime["busy_poll"].toBool(config.runtime.busy_poll);
+		config.runtime.lock_memory = runtime["lock_memory"].toBool(config.runtime.lock_memory);
+		config.runtime.prefault_mb = qMax(0, runtime["prefault_mb"].toInt(config.runtime.prefault_mb));
+
+		const QJsonObject cores = runtime["cores"].toObject();
+		const char* const role_names[thread_role_count] = { "ingest", "book", "calculator" };
+		for (int role = 0; role < thread_role_count; role++)
+		{
+			if (!cores[role_names[role]].isArray())
+				continue;
+
+			config.runtime.cores[role].clear();
+			for (const QJsonValue& core : cores[role_names[role]].toArray())
+				config.runtime.cores[role].append(core.toInt(-1));
+		}
+
+		// "shm": { "enabled": true, "prefix": "quant", "book_slots": 4096, "result_slots": 4096 }
+		const QJsonObject shm = root["shm"].toObject();
+		config.shm.enabled = shm["enabled"].toBool(config.shm.enabled);
+		config.shm.prefix = shm["prefix"].toString(config.shm.prefix);
+		config.shm.book_slots = qMax(2, shm["book_slots"].toInt(config.shm.book_slots));
+		config.shm.result_slots = qMax(2, shm["result_slots"].toInt(config.shm.result_slots));
+
+		// "cost_service": { "enabled": true, "socket": "quant-cost", "tcp_port": 0, "workers": 2, "max_pending": 64 }
+		const QJsonObject cost_service = root["cost_service"].toObject();
+		config.cost_service.enabled = cost_service["enabled"].toBool(config.cost_service.enabled);
+		config.cost_service.socket_name = cost_service["socket"].toString(config.cost_service.socket_name);
+		config.cost_service.tcp_port = static_cast<quint16>(cost_service["tcp_port"].toInt(config.cost_service.tcp_port));
+		config.cost_service.workers = qMax(1, cost_service["workers"].toInt(config.cost_service.workers));
+		config.cost_service.max_pending = qMax(1, cost_service["max_pending"].toInt(config.cost_service.max_pending));
+
+		// "tick_store": { "enabled": true, "root": "/data/ticks", "chunk_seconds": 3600, "keyframe_interval_ms": 1000 }
+		const QJsonObject tick_store = root["tick_store"].toObject();
+		config.tick_store.enabled = tick_store["enabled"].toBool(config.tick_store.enabled);
+		config.tick_store.root = tick_store["root"].toString(config.tick_store.root);
+		config.tick_store.chunk_seconds = qMax<qint64>(1, tick_store["chunk_seconds"].toInteger(config.tick_store.chunk_seconds));
+		config.tick_store.keyframe_interval_ms = qMax<qint64>(1, tick_store["keyframe_interval_ms"].toInteger(config.tick_store.keyframe_interval_ms));
+		config.tick_store.max_pending = qMax(1, tick_store["max_pending"].toInt(config.tick_store.max_pending));
+
+		const QJsonObject metrics = root["metrics"].toObject();
+		config.metrics_port = static_cast<quint16>(metrics["port"].toInt(config.metrics_port));
+
+		const QJsonObject model = root["model"].toObject();
+		config.volatility_enabled = model["volatility_enabled"].toBool(config.volatility_enabled);
+		config.volatility = model["volatility"].toDouble(config.volatility);
+		return true;
+	}
+
+	void ApplyEnvironment(ConfigSnapshot& config)
+	{
+		const QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+
+		config.api_key = env.value("OKX_API_KEY", config.api_key);
+		config.api_secret = env.value("OKX_API_SECRET", config.api_secret);
+		config.api_passphrase = env.value("OKX_API_PASSPHRASE", config.api_passphrase);
+		config.socket_endpoint = env.value("QUANT_SOCKET_ENDPOINT", config.socket_endpoint);
+
+		if (env.contains("QUANT_SYMBOLS"))
+			config.symbols = env.value("QUANT_SYMBOLS").split(',', Qt::SkipEmptyParts);
+
+		bool ok = false;
+		const int depth = env.value("QUANT_BOOK_DEPTH").toInt(&ok);
+		if (ok && depth >= 0)
+			config.book_depth = depth;
+
+		if (env.contains("QUANT_LOW_LATENCY"))
+			config.runtime.low_latency = env.value("QUANT_LOW_LATENCY").toInt() != 0;
+		if (env.contains("QUANT_SHM"))
+			config.shm.enabled = env.value("QUANT_SHM").toInt() != 0;
+		if (env.contains("QUANT_COST_SERVICE"))
+			config.cost_service.enabled = env.value("QUANT_COST_SERVICE").toInt() != 0;
+		if (env.contains("QUANT_TICK_STORE"))
+			config.tick_store.enabled = env.value("QUANT_TICK_STORE").toInt() != 0;
+	}
+}
+
+namespace Quant
+{
+	QuantConfig::QuantConfig(const QString& path, QObject* parent)
+		: QObject(parent), m_path(path)
+	{
+		if (m_path.isEmpty())
+			m_path = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/config.json";
+
+		// Editors save in bursts (truncate, write, rename); reload once they settle
+		m_reload_timer.setSingleShot(true);
+		m_reload_timer.setInterval(reload_delay_ms);
+
+		QObject::connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &QuantConfig::OnFileChanged);
+		QObject::connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &QuantConfig::OnFileChanged);
+		QObject::connect(&m_reload_timer, &QTimer::timeout, this, &QuantConfig::OnReload);
+	}
+
+	std::shared_ptr<const ConfigSnapshot> QuantConfig::Current()
+	{
+		return std::atomic_load(&current_snapshot);
+	}
+
+	bool QuantConfig::Load()
+	{
+		auto config = std::make_shared<ConfigSnapshot>();
+		config->socket_endpoint = QuantConstants::SOCKET_ENDPOINT;
+		config->metrics_port = QuantConstants::METRICS_PORT;
+
+		const bool file_ok = ApplyFile(m_path, max_file_bytes, *config);
+		Watch();
+
+		// A broken edit keeps the running configuration
+		if (!file_ok && m_loaded)
+			return false;
+
+		ApplyEnvironment(*config);
+
+		std::atomic_store(&current_snapshot, std::shared_ptr<const ConfigSnapshot>(std::move(config)));
+		m_loaded = true;
+
+		emit configChanged();
+		return file_ok;
+	}
+
+	void QuantConfig::Watch()
+	{
+		// The directory catches files created or replaced by a rename
+		const QString directory = QFileInfo(m_path).absolutePath();
+		if (QDir(directory).exists() && !m_watcher.directories().contains(directory))
+			m_watcher.addPath(directory);
+
+		if (QFile::exists(m_path) && !m_watcher.files().contains(m_path))
+			m_watcher.addPath(m_path);
+	}
+
+	void QuantConfig::OnFileChanged()
+	{
+		m_reload_timer.start();
+	}
+
+	void QuantConfig::OnReload()
+	{
+		Load();
+	}
+}
@@ -0,0 +1,298 @@
+#include "QuantConnectionManager.h"
+
+#include <cmath>
+
+#include <QDebug>
+#include <QRandomGenerator>
+
+#include "QuantOrderbook.h"
+#include "QuantWebSocket.h"
+
+namespace Quant
+{
+	QuantConnectionManager::QuantConnectionManager(QuantWebSocket* websocket, QObject* parent)
+		: QObject(parent), m_websocket(websocket)
+	{
+		m_reconnect_timer.setSingleShot(true);
+		m_watchdog_timer.setInterval(watchdog_interval_ms);
+		m_resync_timer.setSingleShot(true);
+
+		QObject::connect(m_websocket, &QuantWebSocket::connected, this, &QuantConnectionManager::OnConnected);
+		QObject::connect(m_websocket, &QuantWebSocket::disconnected, this, &QuantConnectionManager::OnDisconnected);
+
+		// A failed open reports an error without a disconnect
+		QObject::connect(m_websocket, &QuantWebSocket::error, this, [this](const QString&)
+			{
+				if (!m_websocket->isConnected())
+					ScheduleReconnect();
+			});
+
+		QObject::connect(&m_reconnect_timer, &QTimer::timeout, this, &QuantConnectionManager::OnReconnect);
+		QObject::connect(&m_watchdog_timer, &QTimer::timeout, this, &QuantConnectionManager::OnWatchdog);
+		QObject::connect(&m_resync_timer, &QTimer::timeout, this, &QuantConnectionManager::SendPendingResyncs);
+	}
+
+	void QuantConnectionManager::AddBook(QuantOrderbook* orderbook)
+	{
+		if (!orderbook || m_books.contains(orderbook))
+			return;
+
+		m_books.append(orderbook);
+		orderbook->SetDepthLimit(m_websocket->BookDepth());
+
+		QObject::connect(orderbook, &QuantOrderbook::sequenceGap, this, [this, orderbook](qint64, qint64)
+			{
+				ResyncBook(orderbook);
+			});
+		QObject::connect(orderbook, &QuantOrderbook::staleChanged, this, [this, orderbook](bool stale)
+			{
+				OnBookStaleChanged(orderbook, stale);
+			});
+
+		// Late additions are subscribed right away
+		if (isConnected() && !orderbook->Symbol().isEmpty())
+		{
+			m_websocket->Subscribe({ orderbook->Symbol() });
+			if (!m_top_channel.isEmpty())
+				m_websocket->Subscribe({ orderbook->Symbol() }, m_top_channel);
+			SpendRequests(m_top_channel.isEmpty() ? 1.0 : 2.0);
+		}
+	}
+
+	void QuantConnectionManager::SetTopOfBookChannel(const QString& channel)
+	{
+		if (channel == m_top_channel)
+			return;
+
+		if (isConnected() && !m_top_channel.isEmpty())
+		{
+			m_websocket->Unsubscribe(Symbols(), m_top_channel);
+			SpendRequests(1.0);
+		}
+
+		m_top_channel = channel;
+
+		// The old channel's last update would otherwise pin the top of book for good
+		for (QuantOrderbook* orderbook : m_books)
+			orderbook->resetTopOfBook();
+
+		if (isConnected() && !m_top_channel.isEmpty())
+		{
+			m_websocket->Subscribe(Symbols(), m_top_channel);
+			SpendRequests(1.0);
+		}
+	}
+
+	void QuantConnectionManager::SetRequestRateLimit(int requests_per_second)
+	{
+		requests_per_second = qMax(0, requests_per_second);
+		if (requests_per_second == m_requests_per_second)
+			return;
+
+		// A new limit starts with a full second's budget
+		m_requests_per_second = requests_per_second;
+		m_request_budget = qMax<double>(m_requests_per_second, resync_requests);
+		m_budget_clock.start();
+
+		// Resyncs held back by the old limit go under the new one
+		SendPendingResyncs();
+	}
+
+	void QuantConnectionManager::Start(const QString& url)
+	{
+		m_url = url;
+		m_running = true;
+		m_attempt = 0;
+
+		m_websocket->connect(m_url);
+		m_watchdog_timer.start();
+	}
+
+	void QuantConnectionManager::Stop()
+	{
+		m_running = false;
+		m_reconnect_timer.stop();
+		m_watchdog_timer.stop();
+		m_resync_timer.stop();
+		m_pending_resyncs.clear();
+		m_websocket->disconnect();
+	}
+
+	bool QuantConnectionManager::isConnected() const
+	{
+		return m_websocket->isConnected();
+	}
+
+	QStringList QuantConnectionManager::Symbols() const
+	{
+		QStringList symbols;
+		for (const QuantOrderbook* orderbook : m_books)
+		{
+			if (!orderbook->Symbol().isEmpty() && !symbols.contains(orderbook->Symbol()))
+				symbols.append(orderbook->Symbol());
+		}
+		return symbols;
+	}
+
+	void QuantConnectionManager::OnConnected()
+	{
+		m_attempt = 0;
+		m_reconnect_timer.stop();
+		m_connected_since.start();
+
+		// The feed format may have changed since the books were added
+		for (QuantOrderbook* orderbook : m_books)
+			orderbook->SetDepthLimit(m_websocket->BookDepth());
+
+		// The subscriptions below cover every pending resync
+		m_resync_timer.stop();
+		m_pending_resyncs.clear();
+
+		// Each subscription is answered with a fresh snapshot
+		m_websocket->Subscribe(Symbols());
+		if (!m_top_channel.isEmpty())
+			m_websocket->Subscribe(Symbols(), m_top_channel);
+		SpendRequests(m_top_channel.isEmpty() ? 1.0 : 2.0);
+		emit connectionChanged(true);
+	}
+
+	void QuantConnectionManager::OnDisconnected()
+	{
+		// Books keep their last good state until the snapshots after the reconnect
+		for (QuantOrderbook* orderbook : m_books)
+		{
+			if (!m_recovering.contains(orderbook))
+				m_recovering[orderbook].start();
+			orderbook->SetStale(true);
+		}
+
+		emit connectionChanged(false);
+		ScheduleReconnect();
+	}
+
+	void QuantConnectionManager::ScheduleReconnect()
+	{
+		if (!m_running || m_reconnect_timer.isActive())
+			return;
+
+		// Exponential backoff with the upper half jittered, so clients restarted
+		// by the same outage do not reconnect in lockstep
+		const int ceiling = static_cast<int>(qMin<qint64>(max_backoff_ms, static_cast<qint64>(initial_backoff_ms) << qMin(m_attempt, 16)));
+		const int delay_ms = ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+
+		m_attempt++;
+		qWarning() << "WebSocket reconnect attempt" << m_attempt << "in" << delay_ms << "ms";
+		emit reconnectScheduled(m_attempt, delay_ms);
+
+		m_reconnect_timer.start(delay_ms);
+	}
+
+	void QuantConnectionManager::OnReconnect()
+	{
+		if (!m_running || isConnected())
+			return;
+
+		m_websocket->connect(m_url);
+	}
+
+	void QuantConnectionManager::OnWatchdog()
+	{
+		if (!isConnected())
+			return;
+
+		// Silence since the last frame, or since the connect when none arrived yet
+		const qint64 last_message = m_websocket->MillisecondsSinceLastMessage();
+		const qint64 silence = (last_message >= 0 && last_message < m_connected_since.elapsed()) ? last_message : m_connected_since.elapsed();
+
+		if (silence >= stall_timeout_ms)
+		{
+			qWarning() << "WebSocket feed stalled for" << silence << "ms, reconnecting";
+			m_websocket->disconnect();
+		}
+	}
+
+	void QuantConnectionManager::Resync(const QString& symbol)
+	{
+		for (QuantOrderbook* orderbook : m_books)
+		{
+			if (orderbook->Symbol() != symbol)
+				continue;
+
+			orderbook->SetStale(true);
+			ResyncBook(orderbook);
+		}
+	}
+
+	void QuantConnectionManager::ResyncBook(QuantOrderbook* orderbook)
+	{
+		if (!m_recovering.contains(orderbook))
+			m_recovering[orderbook].start();
+
+		// Resubscribing makes the venue send a new snapshot; feeds that only
+		// publish snapshots resynchronize on their next message anyway
+		if (isConnected() && !orderbook->Symbol().isEmpty() && !m_pending_resyncs.contains(orderbook->Symbol()))
+		{
+			m_pending_resyncs.append(orderbook->Symbol());
+			SendPendingResyncs();
+		}
+	}
+
+	void QuantConnectionManager::RefillRequests()
+	{
+		if (m_requests_per_second <= 0)
+			return;
+
+		const qint64 elapsed_ns = m_budget_clock.nsecsElapsed();
+		m_budget_clock.start();
+		m_request_budget = qMin(qMax<double>(m_requests_per_second, resync_requests), m_request_budget + elapsed_ns * 1e-9 * m_requests_per_second);
+	}
+
+	void QuantConnectionManager::SpendRequests(double requests)
+	{
+		// Requests that cannot wait may overdraw the budget, later resyncs make up for it
+		RefillRequests();
+		if (m_requests_per_second > 0)
+			m_request_budget -= requests;
+	}
+
+	void QuantConnectionManager::SendPendingResyncs()
+	{
+		if (!isConnected())
+		{
+			m_pending_resyncs.clear();
+			return;
+		}
+
+		RefillRequests();
+		while (!m_pending_resyncs.isEmpty() && (m_requests_per_second <= 0 || m_request_budget >= resync_requests))
+		{
+			const QString symbol = m_pending_resyncs.takeFirst();
+			m_websocket->Unsubscribe({ symbol });
+			m_websocket->Subscribe({ symbol });
+			SpendRequests(resync_requests);
+		}
+
+		if (!m_pending_resyncs.isEmpty() && !m_resync_timer.isActive())
+		{
+			const double missing = resync_requests - m_request_budget;
+			m_resync_timer.start(qMax(1, static_cast<int>(std::ceil(missing * 1000.0 / m_requests_per_second))));
+		}
+	}
+
+	void QuantConnectionManager::OnBookStaleChanged(QuantOrderbook* orderbook, bool stale)
+	{
+		if (stale)
+			return;
+
+		auto it = m_recovering.find(orderbook);
+		if (it == m_recovering.end())
+			return;
+
+		m_last_recovery_ms = it->elapsed();
+		m_recovery_count++;
+		m_recovering.erase(it);
+
+		qDebug() << "Orderbook" << orderbook->Symbol() << "recovered in" << m_last_recovery_ms << "ms";
+		emit recovered(orderbook->Symbol(), m_last_recovery_ms);
+	}
+}
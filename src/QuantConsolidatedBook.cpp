@@ -0,0 +1,296 @@
+#include "QuantConsolidatedBook.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "QuantCalculator.h"
+#include "QuantOrderbook.h"
+#include "QuantTracer.h"
+
+namespace
+{
+	// Budget left below this is rounding, not an unfilled order
+	constexpr double fill_epsilon_usd = 1e-9;
+
+	// Taker rate as a fraction, 0 for a venue without a fee schedule
+	double TakerRate(Quant::EXCHANGE_API exchange, Quant::FEE_TIER fee_tier)
+	{
+		const std::shared_ptr<const Quant::FeeSchedule> fees = Quant::GetFeeSchedule(exchange);
+		const int idx = static_cast<int>(fee_tier);
+		if (!fees || idx < 0 || idx >= Quant::fee_tier_count)
+			return 0.0;
+
+		return (*fees)[idx].taker / 100.0;
+	}
+
+	Quant::VenueFill& FillFor(QVector<Quant::VenueFill>& fills, Quant::EXCHANGE_API exchange)
+	{
+		for (Quant::VenueFill& fill : fills)
+		{
+			if (fill.exchange == exchange)
+				return fill;
+		}
+
+		Quant::VenueFill fill;
+		fill.exchange = exchange;
+		fills.append(fill);
+		return fills.last();
+	}
+}
+
+namespace Quant
+{
+	QuantConsolidatedBook::QuantConsolidatedBook(QObject* parent) : QObject(parent)
+	{
+	}
+
+	void QuantConsolidatedBook::AddVenue(QuantOrderbook* orderbook)
+	{
+		if (!orderbook || Find(orderbook))
+			return;
+
+		Venue venue;
+		venue.book = orderbook;
+		venue.id = m_next_venue_id++;
+		m_venues.push_back(std::move(venue));
+
+		QObject::connect(orderbook, &QuantOrderbook::orderbookUpdated, this, [this, orderbook]()
+			{
+				OnVenueUpdated(orderbook);
+			});
+		QObject::connect(orderbook, &QObject::destroyed, this, [this, orderbook]()
+			{
+				RemoveVenue(orderbook);
+			});
+
+		ReloadVenue(m_venues.back());
+		m_version++;
+		emit consolidatedUpdated();
+	}
+
+	void QuantConsolidatedBook::RemoveVenue(QuantOrderbook* orderbook)
+	{
+		Venue* venue = Find(orderbook);
+		if (!venue)
+			return;
+
+		QObject::disconnect(orderbook, nullptr, this, nullptr);
+		RemoveLevels(*venue);
+		m_venues.erase(m_venues.begin() + (venue - m_venues.data()));
+
+		m_version++;
+		emit consolidatedUpdated();
+	}
+
+	void QuantConsolidatedBook::SetFeeTier(FEE_TIER fee_tier)
+	{
+		if (fee_tier == m_fee_tier)
+			return;
+
+		// Every effective price moves
+		m_fee_tier = fee_tier;
+		for (Venue& venue : m_venues)
+			ReloadVenue(venue);
+
+		m_version++;
+		emit consolidatedUpdated();
+	}
+
+	QuantConsolidatedBook::Venue* QuantConsolidatedBook::Find(const QuantOrderbook* orderbook)
+	{
+		for (Venue& venue : m_venues)
+		{
+			if (venue.book == orderbook)
+				return &venue;
+		}
+		return nullptr;
+	}
+
+	QuantConsolidatedBook::LevelKey QuantConsolidatedBook::KeyOf(const Venue& venue, bool is_bids, double price) const
+	{
+		// Selling into a bid nets the fee out, buying an ask pays it on top
+		const double effective_price = is_bids ? price * (1.0 - venue.taker_rate) : price * (1.0 + venue.taker_rate);
+		return LevelKey{ effective_price, venue.id };
+	}
+
+	void QuantConsolidatedBook::OnVenueUpdated(QuantOrderbook* orderbook)
+	{
+		Venue* venue = Find(orderbook);
+		if (!venue)
+			return;
+
+		QUANT_TRACE_SCOPE("consolidate", "book");
+
+		// A new instrument moves every effective price; a snapshot only the levels that differ from the venue's
+		if (orderbook->Exchange() != venue->exchange)
+			ReloadVenue(*venue);
+		else if (orderbook->LastUpdateWasSnapshot())
+		{
+			const BookView view = orderbook->View();
+			DiffSide(*venue, true, view.bids);
+			DiffSide(*venue, false, view.asks);
+		}
+		else
+		{
+			for (const BookLevel& level : orderbook->LastBidChanges())
+				SetLevel(*venue, true, level);
+			for (const BookLevel& level : orderbook->LastAskChanges())
+				SetLevel(*venue, false, level);
+		}
+
+		m_version++;
+		emit consolidatedUpdated();
+	}
+
+	void QuantConsolidatedBook::ReloadVenue(Venue& venue)
+	{
+		RemoveLevels(venue);
+
+		venue.exchange = venue.book->Exchange();
+		venue.taker_rate = TakerRate(venue.exchange, m_fee_tier);
+
+		const BookView view = venue.book->View();
+		for (const BookLevel& level : view.bids)
+			SetLevel(venue, true, level);
+		for (const BookLevel& level : view.asks)
+			SetLevel(venue, false, level);
+	}
+
+	void QuantConsolidatedBook::DiffSide(Venue& venue, bool is_bids, const BookSide& levels)
+	{
+		QHash<double, double>& amounts = is_bids ? venue.bids : venue.asks;
+
+		m_snapshot_prices.clear();
+		for (const BookLevel& level : levels)
+		{
+			m_snapshot_prices.insert(level.price);
+			const auto it = amounts.constFind(level.price);
+			if (it == amounts.cend() || it.value() != level.amount)
+				SetLevel(venue, is_bids, level);
+		}
+
+		// Levels the snapshot no longer lists
+		Side& side = is_bids ? m_bids : m_asks;
+		for (auto it = amounts.begin(); it != amounts.end();)
+		{
+			if (m_snapshot_prices.contains(it.key()))
+			{
+				++it;
+				continue;
+			}
+
+			side.erase(KeyOf(venue, is_bids, it.key()));
+			it = amounts.erase(it);
+		}
+	}
+
+	void QuantConsolidatedBook::RemoveLevels(Venue& venue)
+	{
+		for (auto it = venue.bids.cbegin(); it != venue.bids.cend(); ++it)
+			m_bids.erase(KeyOf(venue, true, it.key()));
+		for (auto it = venue.asks.cbegin(); it != venue.asks.cend(); ++it)
+			m_asks.erase(KeyOf(venue, false, it.key()));
+
+		venue.bids.clear();
+		venue.asks.clear();
+	}
+
+	void QuantConsolidatedBook::SetLevel(Venue& venue, bool is_bids, const BookLevel& level)
+	{
+		Side& side = is_bids ? m_bids : m_asks;
+		QHash<double, double>& amounts = is_bids ? venue.bids : venue.asks;
+		const LevelKey key = KeyOf(venue, is_bids, level.price);
+
+		if (level.amount <= 0.0)
+		{
+			if (amounts.remove(level.price))
+				side.erase(key);
+			return;
+		}
+
+		ConsolidatedLevel& consolidated = side[key];
+		consolidated.effective_price = key.effective_price;
+		consolidated.price = level.price;
+		consolidated.amount = level.amount;
+		consolidated.exchange = venue.exchange;
+		amounts.insert(level.price, level.amount);
+	}
+
+	ConsolidatedLevel QuantConsolidatedBook::BestBid() const
+	{
+		return m_bids.empty() ? ConsolidatedLevel() : m_bids.begin()->second;
+	}
+
+	ConsolidatedLevel QuantConsolidatedBook::BestAsk() const
+	{
+		return m_asks.empty() ? ConsolidatedLevel() : m_asks.begin()->second;
+	}
+
+	void QuantConsolidatedBook::CopyLevels(bool is_bids, QVector<ConsolidatedLevel>& out, int max_levels) const
+	{
+		const Side& side = is_bids ? m_bids : m_asks;
+		const int size = static_cast<int>(side.size());
+		const int limit = max_levels > 0 ? std::min(max_levels, size) : size;
+
+		out.clear();
+		out.reserve(limit);
+		for (auto it = side.cbegin(); it != side.cend() && out.size() < limit; ++it)
+			out.append(it->second);
+	}
+
+	SweepResult QuantConsolidatedBook::SweepCost(ORDER_SIDE side, double usd_amount) const
+	{
+		QUANT_TRACE_SCOPE("sweep_cost", "estimator");
+
+		SweepResult result;
+		const bool is_buy = side == ORDER_SIDE::BUY;
+		const Side& levels = is_buy ? m_asks : m_bids;
+		if (usd_amount <= 0.0 || levels.empty())
+		{
+			result.unfilled_usd = qMax(0.0, usd_amount);
+			return result;
+		}
+
+		// Fees are linear in the notional, so taking levels by effective price is the cheapest split
+		double remaining = usd_amount;
+		for (auto it = levels.cbegin(); it != levels.cend() && remaining > fill_epsilon_usd; ++it)
+		{
+			const ConsolidatedLevel& level = it->second;
+
+			// A buy's budget pays the fee, a sell's target is the notional
+			const double unit_cost = is_buy ? level.effective_price : level.price;
+			const double quantity = std::min(level.amount, remaining / unit_cost);
+			const double notional = quantity * level.price;
+			const double fees = is_buy ? quantity * (level.effective_price - level.price) : quantity * (level.price - level.effective_price);
+
+			VenueFill& fill = FillFor(result.fills, level.exchange);
+			fill.quantity += quantity;
+			fill.notional += notional;
+			fill.fees += fees;
+
+			result.quantity += quantity;
+			result.notional += notional;
+			result.fees += fees;
+			remaining -= quantity * unit_cost;
+		}
+
+		result.unfilled_usd = remaining > fill_epsilon_usd ? remaining : 0.0;
+		if (result.quantity <= 0.0)
+			return result;
+
+		result.average_price = result.notional / result.quantity;
+
+		// Reference is the best raw price of any venue, whatever its fee
+		double reference = 0.0;
+		for (const Venue& venue : m_venues)
+		{
+			const double best = is_buy ? venue.book->BestAsk().price : venue.book->BestBid().price;
+			if (best > 0.0 && (reference == 0.0 || (is_buy ? best < reference : best > reference)))
+				reference = best;
+		}
+		if (reference > 0.0)
+			result.slippage = is_buy ? result.notional - result.quantity * reference : result.quantity * reference - result.notional;
+
+		return result;
+	}
+}
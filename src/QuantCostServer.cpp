@@ -0,0 +1,480 @@
+#include "QuantCostServer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QIODevice>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "QuantBookSnapshots.h"
+#include "QuantClock.h"
+#include "QuantMetrics.h"
+#include "QuantRuntimeProfile.h"
+
+namespace
+{
+	using namespace Quant;
+	namespace Format = CostServiceFormat;
+
+	// Distinct books a request usually names; more only cost an allocation
+	constexpr int request_books = 8;
+	constexpr int probe_timeout_ms = 100;
+
+	struct RequestBook
+	{
+		quint8 exchange = 0;
+		char symbol[Format::symbol_size + 1] = {};
+		std::shared_ptr<const BookSnapshot> snapshot;
+		BookView view;
+		const BookFeatures* features = nullptr;
+	};
+
+	bool ValidQuery(const Format::Query& query)
+	{
+		return query.exchange > static_cast<quint8>(EXCHANGE_API::NONE) && query.exchange <= static_cast<quint8>(EXCHANGE_API::MEXC)
+			&& query.order_side <= static_cast<quint8>(ORDER_SIDE::SELL)
+			&& query.order_type <= static_cast<quint8>(ORDER_TYPE::TRAILING_STOP_LIMIT)
+			&& query.fee_tier <= static_cast<quint8>(FEE_TIER::VIP_9)
+			&& query.size_unit <= Format::BASE
+			&& std::isfinite(query.size) && query.size > 0.0;
+	}
+
+	QByteArray BusyResponse(quint64 request_id)
+	{
+		Format::ResponseHeader header;
+		header.request_id = request_id;
+		header.status = Format::BUSY;
+		return QByteArray(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+}
+
+namespace Quant
+{
+	QuantCostServer::QuantCostServer(const CostServerConfig& config, const QuantBookSnapshots* snapshots, QObject* parent)
+		: QObject(parent), m_config(config), m_snapshots(snapshots)
+	{
+		m_config.workers = qMax(1, m_config.workers);
+		m_config.max_pending = qMax(1, m_config.max_pending);
+
+		for (const EXCHANGE_API exchange : { EXCHANGE_API::OKX, EXCHANGE_API::BINANCE, EXCHANGE_API::COINBASE, EXCHANGE_API::MEXC })
+		{
+			m_kernels[static_cast<int>(exchange)].calculator = ResolveKernels(exchange);
+			m_kernels[static_cast<int>(exchange)].fees = GetFeeSchedule(exchange);
+		}
+
+		QuantMetricsRegistry& registry = QuantMetricsRegistry::Instance();
+		m_queries = &registry.Counter("quant_cost_queries_total", "Cost queries answered by the cost service.");
+		m_served = &registry.Counter("quant_cost_requests_total", "Cost service requests by outcome.", "outcome=\"served\"");
+		m_refused = &registry.Counter("quant_cost_requests_total", "Cost service requests by outcome.", "outcome=\"busy\"");
+		m_latency = &registry.Histogram("quant_cost_request_latency_seconds", "From a request's arrival to its response being written.");
+	}
+
+	QuantCostServer::~QuantCostServer()
+	{
+		Stop();
+	}
+
+	bool QuantCostServer::Start()
+	{
+		if (IsRunning())
+			return true;
+
+		m_io_thread = new QThread();
+		m_io_thread->setObjectName("cost-io");
+		m_io = new QObject();
+		m_io->moveToThread(m_io_thread);
+		m_io_thread->start();
+
+		bool listening = false;
+		QMetaObject::invokeMethod(m_io, [this, &listening]() { listening = Listen(); }, Qt::BlockingQueuedConnection);
+		if (!listening)
+		{
+			Stop();
+			return false;
+		}
+
+		m_stopping.store(false);
+		for (int worker = 0; worker < m_config.workers; worker++)
+			m_workers.emplace_back(&QuantCostServer::WorkerLoop, this);
+		return true;
+	}
+
+	void QuantCostServer::Stop()
+	{
+		if (!m_io_thread)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_ready_mutex);
+			m_stopping.store(true);
+		}
+		m_ready_condition.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+		m_workers.clear();
+		m_ready.clear();
+		m_ready_count.store(0);
+
+		// Responses still queued to the I/O thread are dropped with it
+		QMetaObject::invokeMethod(m_io, [this]() { Close(); }, Qt::BlockingQueuedConnection);
+		m_io_thread->quit();
+		m_io_thread->wait();
+		delete m_io;
+		delete m_io_thread;
+		m_io = nullptr;
+		m_io_thread = nullptr;
+	}
+
+	bool QuantCostServer::Listen()
+	{
+		bool listening = false;
+
+		if (!m_config.socket_name.isEmpty())
+		{
+			// A socket file left by a crashed run is removed, one with a live server behind it is not
+			QLocalSocket probe;
+			probe.connectToServer(m_config.socket_name);
+			if (probe.waitForConnected(probe_timeout_ms))
+				qWarning() << "Cost service: another process serves" << m_config.socket_name;
+			else
+			{
+				QLocalServer::removeServer(m_config.socket_name);
+
+				auto* local_server = new QLocalServer(m_io);
+				local_server->setSocketOptions(QLocalServer::UserAccessOption);
+				if (local_server->listen(m_config.socket_name))
+				{
+					m_socket_path = local_server->fullServerName();
+					listening = true;
+					QObject::connect(local_server, &QLocalServer::newConnection, m_io, [this, local_server]()
+						{
+							while (QLocalSocket* socket = local_server->nextPendingConnection())
+								Accept(socket);
+						});
+				}
+				else
+					qWarning() << "Cost service: cannot listen on" << m_config.socket_name << local_server->errorString();
+			}
+		}
+
+		if (m_config.tcp_port != 0)
+		{
+			auto* tcp_server = new QTcpServer(m_io);
+			if (tcp_server->listen(QHostAddress::LocalHost, m_config.tcp_port))
+			{
+				m_tcp_port = tcp_server->serverPort();
+				listening = true;
+				QObject::connect(tcp_server, &QTcpServer::newConnection, m_io, [this, tcp_server]()
+					{
+						while (QTcpSocket* socket = tcp_server->nextPendingConnection())
+						{
+							// Small frames; Nagle would hold responses back for the next ACK
+							socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+							Accept(socket);
+						}
+					});
+			}
+			else
+				qWarning() << "Cost service: cannot listen on port" << m_config.tcp_port << tcp_server->errorString();
+		}
+
+		if (listening)
+			qInfo() << "Cost service: listening on" << (m_socket_path.isEmpty() ? QString("-") : m_socket_path) << "tcp" << m_tcp_port;
+		return listening;
+	}
+
+	void QuantCostServer::Close()
+	{
+		// Aborting emits disconnected, which edits the client list
+		std::vector<std::shared_ptr<Client>> clients;
+		clients.swap(m_clients);
+		for (const std::shared_ptr<Client>& client : clients)
+		{
+			if (!client->socket)
+				continue;
+
+			QObject::disconnect(client->socket, nullptr, m_io, nullptr);
+			client->socket->close();
+			client->socket = nullptr;
+		}
+
+		for (QObject* child : m_io->children())
+		{
+			if (auto* local_server = qobject_cast<QLocalServer*>(child))
+				local_server->close();
+			else if (auto* tcp_server = qobject_cast<QTcpServer*>(child))
+				tcp_server->close();
+		}
+	}
+
+	void QuantCostServer::Accept(QIODevice* socket)
+	{
+		auto client = std::make_shared<Client>();
+		client->socket = socket;
+		m_clients.push_back(client);
+
+		QObject::connect(socket, &QIODevice::readyRead, m_io, [this, client]() { OnReadyRead(client); });
+		if (auto* local_socket = qobject_cast<QLocalSocket*>(socket))
+			QObject::connect(local_socket, &QLocalSocket::disconnected, m_io, [this, client]() { OnDisconnected(client); });
+		else if (auto* tcp_socket = qobject_cast<QTcpSocket*>(socket))
+			QObject::connect(tcp_socket, &QTcpSocket::disconnected, m_io, [this, client]() { OnDisconnected(client); });
+	}
+
+	void QuantCostServer::OnDisconnected(const std::shared_ptr<Client>& client)
+	{
+		// Requests already queued are still evaluated, their responses dropped
+		if (client->socket)
+			client->socket->deleteLater();
+		client->socket = nullptr;
+		m_clients.erase(std::remove(m_clients.begin(), m_clients.end(), client), m_clients.end());
+	}
+
+	void QuantCostServer::OnReadyRead(const std::shared_ptr<Client>& client)
+	{
+		if (!client->socket)
+			return;
+
+		const qint64 received_ns = QuantClock::SteadyNs();
+		client->read_buffer.append(client->socket->readAll());
+
+		qsizetype offset = 0;
+		while (client->read_buffer.size() - offset >= static_cast<qsizetype>(sizeof(Format::RequestHeader)))
+		{
+			Format::RequestHeader header;
+			std::memcpy(&header, client->read_buffer.constData() + offset, sizeof(header));
+			if (header.magic != Format::request_magic || header.version != Format::version || header.query_count > Format::max_queries)
+			{
+				qWarning() << "Cost service: malformed request, closing the connection";
+				client->read_buffer.clear();
+				client->socket->close();
+				return;
+			}
+
+			const qsizetype frame_size = sizeof(header) + header.query_count * sizeof(Format::Query);
+			if (client->read_buffer.size() - offset < frame_size)
+				break;
+
+			Submit(client, Request{ client->read_buffer.mid(offset, frame_size), received_ns });
+			offset += frame_size;
+		}
+		client->read_buffer.remove(0, offset);
+	}
+
+	void QuantCostServer::Submit(const std::shared_ptr<Client>& client, Request request)
+	{
+		bool schedule = false;
+		{
+			std::lock_guard<std::mutex> lock(client->mutex);
+			if (static_cast<int>(client->pending.size()) >= m_config.max_pending)
+			{
+				// Responses go out in request order, so the refusal waits for the last accepted request
+				quint64 request_id = 0;
+				std::memcpy(&request_id, request.frame.constData() + offsetof(Format::RequestHeader, request_id), sizeof(request_id));
+				client->pending.back().refused_after.push_back(request_id);
+				m_refused->Add();
+				return;
+			}
+
+			client->pending.push_back(std::move(request));
+			schedule = !client->scheduled;
+			client->scheduled = true;
+		}
+
+		if (schedule)
+			Schedule(client);
+	}
+
+	void QuantCostServer::Write(Client& client, const QByteArray& response)
+	{
+		if (client.socket)
+			client.socket->write(response);
+	}
+
+	void QuantCostServer::Schedule(const std::shared_ptr<Client>& client)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ready_mutex);
+			m_ready.push_back(client);
+			m_ready_count.fetch_add(1, std::memory_order_release);
+		}
+		m_ready_condition.notify_one();
+	}
+
+	std::shared_ptr<QuantCostServer::Client> QuantCostServer::NextClient()
+	{
+		// Only a worker alone on its pinned core spins; the others would take turns burning a shared one
+		if (QuantRuntimeProfile::SpinsCurrentThread())
+		{
+			while (!m_stopping.load(std::memory_order_relaxed))
+			{
+				if (m_ready_count.load(std::memory_order_acquire) > 0)
+				{
+					std::lock_guard<std::mutex> lock(m_ready_mutex);
+					if (!m_ready.empty())
+					{
+						std::shared_ptr<Client> client = std::move(m_ready.front());
+						m_ready.pop_front();
+						m_ready_count.fetch_sub(1, std::memory_order_relaxed);
+						return client;
+					}
+				}
+				CpuRelax();
+			}
+			return nullptr;
+		}
+
+		std::unique_lock<std::mutex> lock(m_ready_mutex);
+		m_ready_condition.wait(lock, [this]() { return m_stopping.load() || !m_ready.empty(); });
+		if (m_stopping.load())
+			return nullptr;
+
+		std::shared_ptr<Client> client = std::move(m_ready.front());
+		m_ready.pop_front();
+		m_ready_count.fetch_sub(1, std::memory_order_relaxed);
+		return client;
+	}
+
+	void QuantCostServer::WorkerLoop()
+	{
+		QuantRuntimeProfile::PinCurrentThread(THREAD_ROLE::CALCULATOR);
+
+		while (std::shared_ptr<Client> client = NextClient())
+		{
+			// Scheduled clients have a request; only this worker takes from the client until it is rescheduled
+			Request request;
+			{
+				std::lock_guard<std::mutex> lock(client->mutex);
+				request = std::move(client->pending.front());
+				client->pending.pop_front();
+			}
+
+			QByteArray response = Process(request.frame);
+			for (quint64 refused_id : request.refused_after)
+				response.append(BusyResponse(refused_id));
+			Deliver(client, std::move(response), request.received_ns);
+
+			// One request per turn, then back of the line behind the other clients
+			bool more = false;
+			{
+				std::lock_guard<std::mutex> lock(client->mutex);
+				more = !client->pending.empty();
+				client->scheduled = more;
+			}
+			if (more)
+				Schedule(client);
+		}
+	}
+
+	QByteArray QuantCostServer::Process(const QByteArray& frame)
+	{
+		Format::RequestHeader request;
+		std::memcpy(&request, frame.constData(), sizeof(request));
+
+		Format::ResponseHeader header;
+		header.request_id = request.request_id;
+		header.result_count = request.query_count;
+
+		QByteArray response(sizeof(header) + request.query_count * sizeof(Format::Result), Qt::Uninitialized);
+		std::memcpy(response.data(), &header, sizeof(header));
+
+		std::vector<RequestBook> books;
+		books.reserve(request_books);
+
+		const char* queries = frame.constData() + sizeof(request);
+		char* results = response.data() + sizeof(header);
+		for (int idx = 0; idx < request.query_count; idx++)
+		{
+			Format::Query query;
+			std::memcpy(&query, queries + idx * sizeof(query), sizeof(query));
+
+			Format::Result result;
+			const Kernels* kernels = ValidQuery(query) ? &m_kernels[query.exchange] : nullptr;
+			if (!kernels)
+				result.status = Format::INVALID_QUERY;
+			else if (!kernels->calculator.evaluate || !kernels->fees)
+				result.status = Format::UNSUPPORTED_EXCHANGE;
+			else
+			{
+				char symbol[Format::symbol_size + 1] = {};
+				std::memcpy(symbol, query.symbol, Format::symbol_size);
+
+				// Every query on the same book in this request sees the same version
+				RequestBook* book = nullptr;
+				for (RequestBook& cached : books)
+				{
+					if (cached.exchange == query.exchange && std::strcmp(cached.symbol, symbol) == 0)
+					{
+						book = &cached;
+						break;
+					}
+				}
+				if (!book)
+				{
+					book = &books.emplace_back();
+					book->exchange = query.exchange;
+					std::memcpy(book->symbol, symbol, sizeof(symbol));
+					book->snapshot = m_snapshots->Latest(static_cast<EXCHANGE_API>(query.exchange), symbol);
+					if (book->snapshot)
+					{
+						book->view = book->snapshot->View();
+						book->features = &book->snapshot->Features(kernels->calculator.compute_features);
+					}
+				}
+
+				const double usd_amount = query.size_unit == Format::BASE ? query.size * (book->features ? book->features->mid_price : 0.0) : query.size;
+				if (!book->snapshot)
+					result.status = Format::UNKNOWN_BOOK;
+				else if (book->view.bids.empty() || book->view.asks.empty() || usd_amount <= 0.0)
+					result.status = Format::EMPTY_BOOK;
+				else
+				{
+					CalculationInput input;
+					input.order_type = static_cast<ORDER_TYPE>(query.order_type);
+					input.order_side = static_cast<ORDER_SIDE>(query.order_side);
+					input.fee_tier = static_cast<FEE_TIER>(query.fee_tier);
+					input.usd_amount = usd_amount;
+
+					const CalculationOutput output = kernels->calculator.evaluate(input, book->view, *kernels->fees, *book->features);
+
+					result.liquidity_exhausted = output.liquidity_exhausted ? 1 : 0;
+					result.stale = book->snapshot->stale ? 1 : 0;
+					result.book_version = book->snapshot->version;
+					result.book_timestamp_ns = book->snapshot->timestamp_ns;
+					result.usd_amount = usd_amount;
+					result.fees = output.fees;
+					result.slippage = output.slippage;
+					result.market_impact = output.market_impact;
+					result.market_order_cost = output.market_order_cost;
+					result.net_cost = output.net_cost;
+					result.crypto_amount = output.crypto_amount;
+					result.maker_ratio = output.maker_ratio;
+					result.volatility = output.volatility;
+					result.unfilled_usd = output.unfilled_usd;
+				}
+			}
+
+			std::memcpy(results + idx * sizeof(result), &result, sizeof(result));
+		}
+
+		m_queries->Add(request.query_count);
+		return response;
+	}
+
+	void QuantCostServer::Deliver(const std::shared_ptr<Client>& client, QByteArray response, qint64 received_ns)
+	{
+		m_served->Add();
+		QMetaObject::invokeMethod(m_io, [this, client, response = std::move(response), received_ns]()
+			{
+				Write(*client, response);
+				m_latency->Observe(QuantClock::SteadyNs() - received_ns);
+			}, Qt::QueuedConnection);
+	}
+}
@@ -0,0 +1,360 @@
+#include "QuantDepthChart.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+
+#include "QuantOrderbook.h"
+#include "QuantTracer.h"
+
+namespace
+{
+	using namespace Quant;
+
+	constexpr int vertices_per_rect = 6;
+	constexpr float area_alpha = 0.35f;
+	constexpr float bar_alpha = 0.9f;
+	constexpr double bar_height_ratio = 0.35; // Tallest level bar, as a fraction of the height
+	constexpr float min_bar_width = 1.0f;
+
+	// Headroom of the axis and scales, so that small moves of the book do not rescale every level
+	constexpr double axis_margin = 0.1;   // Of the displayed price span, added on each side when rescaling
+	constexpr double scale_margin = 0.25; // Of the tallest value, added on top when rescaling
+	constexpr double min_fill = 0.5;      // Rescale once the book uses less of the axis or a scale than this
+
+	// Limit that still fits value with headroom, or a new one
+	double Rescaled(double limit, double value, double margin, bool force)
+	{
+		if (!force && value <= limit && value >= limit * min_fill)
+			return limit;
+		return std::max(value * (1.0 + margin), 1e-12);
+	}
+
+	enum CHILD_NODE
+	{
+		DEPTH_AREA = 0,
+		LEVEL_BARS = 1,
+	};
+
+	struct Color
+	{
+		uchar r, g, b, a;
+	};
+
+	// QSGVertexColorMaterial expects premultiplied alpha
+	Color Premultiplied(const QColor& color, float alpha)
+	{
+		const float a = static_cast<float>(color.alphaF()) * alpha;
+		return { uchar(color.red() * a), uchar(color.green() * a), uchar(color.blue() * a), uchar(255 * a) };
+	}
+
+	QSGGeometryNode* MakeNode()
+	{
+		auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+		geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+		geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+
+		auto* node = new QSGGeometryNode;
+		node->setGeometry(geometry);
+		node->setMaterial(new QSGVertexColorMaterial);
+		node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+		return node;
+	}
+
+	// Writes the two triangles of a rectangle, returns false when they were already there
+	bool SetRect(QSGGeometry::ColoredPoint2D* vertices, float left, float top, float right, float bottom, const Color& color)
+	{
+		const float xs[vertices_per_rect] = { left, right, left, left, right, right };
+		const float ys[vertices_per_rect] = { top, top, bottom, bottom, top, bottom };
+
+		bool changed = false;
+		for (int idx = 0; idx < vertices_per_rect; idx++)
+		{
+			QSGGeometry::ColoredPoint2D& vertex = vertices[idx];
+			if (vertex.x == xs[idx] && vertex.y == ys[idx] && vertex.r == color.r && vertex.g == color.g && vertex.b == color.b && vertex.a == color.a)
+				continue;
+
+			vertex.set(xs[idx], ys[idx], color.r, color.g, color.b, color.a);
+			changed = true;
+		}
+		return changed;
+	}
+
+	bool Resize(QSGGeometryNode* node, int vertex_count)
+	{
+		QSGGeometry* geometry = node->geometry();
+		if (geometry->vertexCount() == vertex_count)
+			return false;
+
+		geometry->allocate(vertex_count);
+		return true;
+	}
+}
+
+namespace Quant
+{
+	QuantDepthChart::QuantDepthChart(QQuickItem* parent) : QQuickItem(parent)
+	{
+		setFlag(ItemHasContents, true);
+	}
+
+	QObject* QuantDepthChart::Orderbook() const
+	{
+		return m_orderbook;
+	}
+
+	void QuantDepthChart::SetOrderbook(QObject* orderbook)
+	{
+		QuantOrderbook* book = qobject_cast<QuantOrderbook*>(orderbook);
+		if (book == m_orderbook)
+			return;
+
+		if (m_orderbook)
+			QObject::disconnect(m_orderbook, nullptr, this, nullptr);
+
+		m_orderbook = book;
+
+		if (m_orderbook)
+			QObject::connect(m_orderbook, &QuantOrderbook::orderbookUpdated, this, &QuantDepthChart::OnOrderbookUpdated);
+
+		Invalidate();
+		emit orderbookChanged();
+	}
+
+	void QuantDepthChart::SetMaxLevels(int max_levels)
+	{
+		max_levels = qMax(0, max_levels);
+		if (max_levels == m_max_levels)
+			return;
+
+		m_max_levels = max_levels;
+		Invalidate();
+		emit maxLevelsChanged();
+	}
+
+	void QuantDepthChart::SetBidColor(const QColor& color)
+	{
+		if (color == m_bid_color)
+			return;
+
+		m_bid_color = color;
+		Invalidate();
+		emit colorsChanged();
+	}
+
+	void QuantDepthChart::SetAskColor(const QColor& color)
+	{
+		if (color == m_ask_color)
+			return;
+
+		m_ask_color = color;
+		Invalidate();
+		emit colorsChanged();
+	}
+
+	void QuantDepthChart::OnOrderbookUpdated()
+	{
+		// Coalesced by the window into at most one updatePolish() per frame
+		polish();
+	}
+
+	void QuantDepthChart::Invalidate()
+	{
+		m_dirty = true;
+		polish();
+	}
+
+	void QuantDepthChart::MarkChanged(int first, int last)
+	{
+		if (first > last)
+			return;
+
+		m_changed_first = qMin(m_changed_first, first);
+		m_changed_last = qMax(m_changed_last, last);
+	}
+
+	void QuantDepthChart::geometryChange(const QRectF& new_geometry, const QRectF& old_geometry)
+	{
+		QQuickItem::geometryChange(new_geometry, old_geometry);
+		if (new_geometry.size() != old_geometry.size())
+			Invalidate();
+	}
+
+	void QuantDepthChart::updatePolish()
+	{
+		const quint64 version = m_orderbook ? m_orderbook->Version() : 0;
+		if (!m_dirty && version == m_laid_out_version)
+			return;
+
+		QUANT_TRACE_SCOPE("depth_chart_layout", "ui");
+		const bool relayout = m_dirty;
+		m_dirty = false;
+		m_laid_out_version = version;
+
+		// GUI thread, which owns the book
+		const BookView book = m_orderbook ? m_orderbook->View() : BookView();
+		const int bid_count = m_max_levels > 0 ? qMin(m_max_levels, book.bids.size) : book.bids.size;
+		const int ask_count = m_max_levels > 0 ? qMin(m_max_levels, book.asks.size) : book.asks.size;
+
+		const float w = static_cast<float>(width());
+		const float h = static_cast<float>(height());
+
+		const bool visible = w > 0 && h > 0 && bid_count + ask_count > 0;
+		m_next_rects.resize(visible ? bid_count + ask_count : 0);
+		m_axis_valid = m_axis_valid && visible && !relayout;
+
+		if (visible)
+		{
+			// Price axis over the deepest displayed bid to the deepest displayed ask, with a margin
+			const double low = bid_count > 0 ? book.bids[bid_count - 1].price : book.asks[0].price;
+			const double high = ask_count > 0 ? book.asks[ask_count - 1].price : book.bids[0].price;
+			const double span = high > low ? high - low : std::max(std::abs(high), 1.0) * 1e-6;
+			const double axis_span = m_axis_high - m_axis_low;
+			if (!m_axis_valid || low < m_axis_low || high > m_axis_high || span < axis_span * min_fill)
+			{
+				m_axis_low = low - span * axis_margin;
+				m_axis_high = high + span * axis_margin;
+			}
+
+			const double low_edge = m_axis_low;
+			const double x_scale = w / (m_axis_high - m_axis_low);
+			auto x_of = [low_edge, x_scale](double price) { return static_cast<float>((price - low_edge) * x_scale); };
+
+			double bid_total = 0.0;
+			double ask_total = 0.0;
+			double largest_level = 0.0;
+			for (int idx = 0; idx < bid_count; idx++)
+			{
+				bid_total += book.bids[idx].amount;
+				largest_level = std::max(largest_level, book.bids[idx].amount);
+			}
+			for (int idx = 0; idx < ask_count; idx++)
+			{
+				ask_total += book.asks[idx].amount;
+				largest_level = std::max(largest_level, book.asks[idx].amount);
+			}
+
+			m_depth_max = Rescaled(m_depth_max, std::max(bid_total, ask_total), scale_margin, !m_axis_valid);
+			m_bar_max = Rescaled(m_bar_max, largest_level, scale_margin, !m_axis_valid);
+			m_axis_valid = true;
+
+			const double depth_scale = h / m_depth_max;
+			const double bar_scale = h * bar_height_ratio / m_bar_max;
+
+			// Bids step down and to the left from the best bid
+			double cumulative = 0.0;
+			for (int idx = 0; idx < bid_count; idx++)
+			{
+				const BookLevel& level = book.bids[idx];
+				cumulative += level.amount;
+
+				LevelRects& rects = m_next_rects[idx];
+				rects.right = x_of(level.price);
+				rects.left = idx + 1 < bid_count ? x_of(book.bids[idx + 1].price) : 0.0f;
+				rects.top = h - static_cast<float>(cumulative * depth_scale);
+				rects.bar_left = rects.right - min_bar_width;
+				rects.bar_right = rects.right;
+				rects.bar_top = h - static_cast<float>(level.amount * bar_scale);
+			}
+
+			// Asks step up and to the right from the best ask
+			cumulative = 0.0;
+			for (int idx = 0; idx < ask_count; idx++)
+			{
+				const BookLevel& level = book.asks[idx];
+				cumulative += level.amount;
+
+				LevelRects& rects = m_next_rects[bid_count + idx];
+				rects.left = x_of(level.price);
+				rects.right = idx + 1 < ask_count ? x_of(book.asks[idx + 1].price) : w;
+				rects.top = h - static_cast<float>(cumulative * depth_scale);
+				rects.bar_left = rects.left;
+				rects.bar_right = rects.left + min_bar_width;
+				rects.bar_top = h - static_cast<float>(level.amount * bar_scale);
+			}
+		}
+
+		const int count = static_cast<int>(m_next_rects.size());
+		if (relayout || count != static_cast<int>(m_rects.size()) || bid_count != m_bid_count || h != m_height)
+		{
+			MarkChanged(0, count - 1);
+		}
+		else
+		{
+			for (int idx = 0; idx < count; idx++)
+			{
+				if (!(m_next_rects[idx] == m_rects[idx]))
+					MarkChanged(idx, idx);
+			}
+		}
+
+		m_rects.swap(m_next_rects);
+		m_bid_count = visible ? bid_count : 0;
+		m_height = h;
+
+		if (m_changed_first <= m_changed_last)
+			update();
+	}
+
+	QSGNode* QuantDepthChart::updatePaintNode(QSGNode* old_node, UpdatePaintNodeData*)
+	{
+		const int count = static_cast<int>(m_rects.size());
+
+		QSGNode* root = old_node;
+		if (!root)
+		{
+			root = new QSGNode;
+			root->appendChildNode(MakeNode());
+			root->appendChildNode(MakeNode());
+			MarkChanged(0, count - 1);
+		}
+
+		auto* area_node = static_cast<QSGGeometryNode*>(root->childAtIndex(DEPTH_AREA));
+		auto* bars_node = static_cast<QSGGeometryNode*>(root->childAtIndex(LEVEL_BARS));
+
+		// Reallocation drops the old vertices
+		const bool area_resized = Resize(area_node, count * vertices_per_rect);
+		const bool bars_resized = Resize(bars_node, count * vertices_per_rect);
+		if (area_resized || bars_resized)
+			MarkChanged(0, count - 1);
+
+		const int first = m_changed_first;
+		const int last = qMin(m_changed_last, count - 1);
+		m_changed_first = std::numeric_limits<int>::max();
+		m_changed_last = -1;
+
+		bool area_changed = area_resized;
+		bool bars_changed = bars_resized;
+		if (first <= last)
+		{
+			QUANT_TRACE_SCOPE("depth_chart_sync", "ui");
+
+			// Only the layout is read here; the GUI thread is blocked during the sync
+			const Color bid_area = Premultiplied(m_bid_color, area_alpha);
+			const Color ask_area = Premultiplied(m_ask_color, area_alpha);
+			const Color bid_bar = Premultiplied(m_bid_color, bar_alpha);
+			const Color ask_bar = Premultiplied(m_ask_color, bar_alpha);
+
+			QSGGeometry::ColoredPoint2D* area = area_node->geometry()->vertexDataAsColoredPoint2D();
+			QSGGeometry::ColoredPoint2D* bars = bars_node->geometry()->vertexDataAsColoredPoint2D();
+
+			for (int idx = first; idx <= last; idx++)
+			{
+				const LevelRects& rects = m_rects[idx];
+				const bool is_bid = idx < m_bid_count;
+				const int offset = idx * vertices_per_rect;
+				area_changed |= SetRect(area + offset, rects.left, rects.top, rects.right, m_height, is_bid ? bid_area : ask_area);
+				bars_changed |= SetRect(bars + offset, rects.bar_left, rects.bar_top, rects.bar_right, m_height, is_bid ? bid_bar : ask_bar);
+			}
+		}
+
+		if (area_changed)
+			area_node->markDirty(QSGNode::DirtyGeometry);
+		if (bars_changed)
+			bars_node->markDirty(QSGNode::DirtyGeometry);
+
+		return root;
+	}
+}
@@ -0,0 +1,915 @@
+#include "QuantFeedAdapter.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "QuantJsonCursor.h"
+
+namespace
+{
+	using Quant::BookLevel;
+	using Quant::DECODE_STATUS;
+	using Quant::FeedMessage;
+	using Quant::JsonCursor;
+
+	// Channels as named by the application (OKX's names)
+	constexpr const char* bbo_channel = "bbo-tbt";
+	constexpr const char* books5_channel = "books5";
+
+	QString ToQString(std::string_view text)
+	{
+		return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+	}
+
+	bool IsTopOfBookChannel(std::string_view channel)
+	{
+		return channel == bbo_channel || channel == books5_channel;
+	}
+
+	bool IsFiltered(const QString& symbol, const QString& symbol_filter)
+	{
+		return !symbol_filter.isEmpty() && !symbol.isEmpty() && symbol != symbol_filter;
+	}
+
+	// ["price", "amount", ...], extra fields (order counts) are skipped
+	bool ReadLevelArray(JsonCursor& cursor, BookLevel& level)
+	{
+		if (!cursor.EnterArray())
+			return false;
+		if (!cursor.NextElement() || !cursor.ReadDouble(level.price))
+			return false;
+		if (!cursor.NextElement() || !cursor.ReadDouble(level.amount))
+			return false;
+
+		while (cursor.NextElement())
+			cursor.SkipValue();
+		return !cursor.Failed();
+	}
+
+	bool ReadLevels(JsonCursor& cursor, QVector<BookLevel>& levels)
+	{
+		if (!cursor.EnterArray())
+			return false;
+
+		BookLevel level;
+		while (cursor.NextElement())
+		{
+			if (!ReadLevelArray(cursor, level))
+				return false;
+			levels.append(level);
+		}
+		return !cursor.Failed();
+	}
+
+	// The best levels of a parsed message become a top-of-book update
+	DECODE_STATUS ToTopOfBook(FeedMessage& message)
+	{
+		if (message.bids.isEmpty() || message.asks.isEmpty())
+			return DECODE_STATUS::INVALID;
+
+		message.is_top_of_book = true;
+		message.best_bid = message.bids.first();
+		message.best_ask = message.asks.first();
+		message.bids.clear();
+		message.asks.clear();
+		return message.best_bid.price > 0.0 && message.best_ask.price > 0.0 ? DECODE_STATUS::VALID : DECODE_STATUS::INVALID;
+	}
+
+	// Deltas may touch a single side, snapshots need both
+	DECODE_STATUS CheckSides(const FeedMessage& message)
+	{
+		if (message.is_delta)
+			return (message.asks.isEmpty() && message.bids.isEmpty()) ? DECODE_STATUS::INVALID : DECODE_STATUS::VALID;
+
+		return (message.asks.isEmpty() || message.bids.isEmpty()) ? DECODE_STATUS::INVALID : DECODE_STATUS::VALID;
+	}
+
+	// BTC-USDT -> BTCUSDT
+	QString CompactSymbol(const QString& instrument)
+	{
+		QString symbol = instrument.toUpper();
+		symbol.remove('-');
+		return symbol;
+	}
+
+	QByteArray ToCompactJson(const QJsonObject& object)
+	{
+		return QJsonDocument(object).toJson(QJsonDocument::Compact);
+	}
+}
+
+namespace Quant
+{
+	void FeedDecoderState::Track(const QString& venue_symbol, const QString& instrument)
+	{
+		instruments.insert(venue_symbol, instrument);
+	}
+
+	void FeedDecoderState::Reset(const QString& instrument)
+	{
+		last_seq_id.remove(instrument);
+		synced.remove(instrument);
+		connection_gap.remove(instrument);
+	}
+
+	void FeedDecoderState::ResetConnection()
+	{
+		last_seq_id.clear();
+		synced.clear();
+		connection_seq_id = -1;
+		connection_gap.clear();
+	}
+
+	/**
+	 * OKX v5:
+	 *  {"arg": {"channel": "books", "instId": "BTC-USDT"}, "action": "snapshot",
+	 *   "data": [{"asks": [["p", "s", "0", "n"]], "bids": [...], "seqId": 2, "prevSeqId": 1}]}
+	 * Snapshots carry prevSeqId -1. An update without changes only repeats the
+	 * sequence id and is dropped.
+	 */
+	template <>
+	struct FeedAdapter<EXCHANGE_API::OKX>
+	{
+		// seqId is the venue's own, per instrument; redundant connections can be matched on it
+		static constexpr bool shared_sequence = true;
+
+		// The books channel sends the full 400 levels
+		static constexpr int book_depth = 0;
+
+		static bool ReadData(JsonCursor& cursor, std::vector<FeedMessage>& messages)
+		{
+			if (!cursor.EnterArray())
+				return false;
+
+			std::string_view key;
+			while (cursor.NextElement())
+			{
+				FeedMessage message;
+				if (!cursor.EnterObject())
+					return false;
+
+				while (cursor.NextMember(key))
+				{
+					if (key == "bids")
+						ReadLevels(cursor, message.bids);
+					else if (key == "asks")
+						ReadLevels(cursor, message.asks);
+					else if (key == "seqId")
+						cursor.ReadInteger(message.seq_id);
+					else if (key == "prevSeqId")
+						cursor.ReadInteger(message.prev_seq_id);
+					else
+						cursor.SkipValue();
+				}
+				messages.push_back(std::move(message));
+			}
+			return !cursor.Failed();
+		}
+
+		static DECODE_STATUS Decode(QByteArrayView payload, const QString& symbol_filter, FeedDecoderState&, std::vector<FeedMessage>& out)
+		{
+			JsonCursor cursor(payload.data(), payload.data() + payload.size());
+			if (!cursor.EnterObject())
+				return DECODE_STATUS::INVALID;
+
+			std::vector<FeedMessage> messages;
+			QString symbol;
+			bool is_event = false;
+			bool is_delta = false;
+			bool is_top_of_book = false;
+
+			std::string_view key;
+			std::string_view text;
+			while (cursor.NextMember(key))
+			{
+				if (key == "arg")
+				{
+					cursor.EnterObject();
+					while (cursor.NextMember(key))
+					{
+						if (key == "channel" && cursor.ReadString(text))
+							is_top_of_book = IsTopOfBookChannel(text);
+						else if (key == "instId" && cursor.ReadString(text))
+							symbol = ToQString(text);
+						else
+							cursor.SkipValue();
+					}
+				}
+				else if (key == "action" && cursor.ReadString(text))
+					is_delta = text == "update";
+				else if (key == "data")
+					ReadData(cursor, messages);
+				else
+				{
+					is_event = is_event || key == "event";
+					cursor.SkipValue();
+				}
+			}
+
+			if (cursor.Failed())
+				return DECODE_STATUS::INVALID;
+			if (is_event || messages.empty() || IsFiltered(symbol, symbol_filter))
+				return DECODE_STATUS::FILTERED;
+
+			DECODE_STATUS status = DECODE_STATUS::FILTERED;
+			for (FeedMessage& message : messages)
+			{
+				message.symbol = symbol;
+				message.is_delta = is_delta;
+
+				if (is_delta && message.bids.isEmpty() && message.asks.isEmpty())
+					continue;
+
+				const DECODE_STATUS message_status = is_top_of_book ? ToTopOfBook(message) : CheckSides(message);
+				if (message_status != DECODE_STATUS::VALID)
+					return message_status;
+
+				out.push_back(std::move(message));
+				status = DECODE_STATUS::VALID;
+			}
+			return status;
+		}
+
+		static QByteArray Subscribe(bool subscribe, const QStringList& instruments, const QString& channel)
+		{
+			QJsonArray args;
+			for (const QString& instrument : instruments)
+			{
+				QJsonObject arg;
+				arg["channel"] = channel;
+				arg["instId"] = instrument;
+				args.append(arg);
+			}
+
+			QJsonObject request;
+			request["op"] = subscribe ? "subscribe" : "unsubscribe";
+			request["args"] = args;
+			return ToCompactJson(request);
+		}
+
+		static QString VenueSymbol(const QString& instrument) { return instrument; }
+	};
+
+	/**
+	 * The original flat format:
+	 *  {"symbol": "...", "action": "update", "seqId": 2, "prevSeqId": 1, "bids": [["p", "s"]], "asks": [...]}
+	 * Messages without "action" are full snapshots; "channel": "bbo-tbt" or "books5"
+	 * marks a top-of-book message.
+	 */
+	template <>
+	struct FeedAdapter<EXCHANGE_API::NONE>
+	{
+		// seqId comes from the feed itself; redundant connections can be matched on it
+		static constexpr bool shared_sequence = true;
+
+		// Snapshots hold every level the sender has
+		static constexpr int book_depth = 0;
+
+		static DECODE_STATUS Decode(QByteArrayView payload, const QString& symbol_filter, FeedDecoderState&, std::vector<FeedMessage>& out)
+		{
+			JsonCursor cursor(payload.data(), payload.data() + payload.size());
+			if (!cursor.EnterObject())
+				return DECODE_STATUS::INVALID;
+
+			FeedMessage message;
+			bool is_event = false;
+			bool is_top_of_book = false;
+
+			std::string_view key;
+			std::string_view text;
+			while (cursor.NextMember(key))
+			{
+				if (key == "symbol" && cursor.ReadString(text))
+					message.symbol = ToQString(text);
+				else if (key == "bids")
+					ReadLevels(cursor, message.bids);
+				else if (key == "asks")
+					ReadLevels(cursor, message.asks);
+				else if (key == "action" && cursor.ReadString(text))
+					message.is_delta = text == "update";
+				else if (key == "seqId")
+					cursor.ReadInteger(message.seq_id);
+				else if (key == "prevSeqId")
+					cursor.ReadInteger(message.prev_seq_id);
+				else if (key == "channel" && cursor.ReadString(text))
+					is_top_of_book = IsTopOfBookChannel(text);
+				else
+				{
+					// Subscription acknowledgements and other control events carry no book
+					is_event = is_event || key == "event";
+					cursor.SkipValue();
+				}
+			}
+
+			if (cursor.Failed())
+				return DECODE_STATUS::INVALID;
+			if (is_event || IsFiltered(message.symbol, symbol_filter))
+				return DECODE_STATUS::FILTERED;
+
+			const DECODE_STATUS status = is_top_of_book ? ToTopOfBook(message) : CheckSides(message);
+			if (status == DECODE_STATUS::VALID)
+				out.push_back(std::move(message));
+			return status;
+		}
+
+		static QByteArray Subscribe(bool subscribe, const QStringList& instruments, const QString& channel)
+		{
+			return FeedAdapter<EXCHANGE_API::OKX>::Subscribe(subscribe, instruments, channel);
+		}
+
+		static QString VenueSymbol(const QString& instrument) { return instrument; }
+	};
+
+	/**
+	 * Binance combined streams:
+	 *  {"stream": "btcusdt@depth@100ms", "data": {"e": "depthUpdate", "s": "BTCUSDT", "U": 11, "u": 12, "b": [...], "a": [...]}}
+	 *  {"stream": "btcusdt@depth20@100ms", "data": {"lastUpdateId": 10, "bids": [...], "asks": [...]}}
+	 *  {"stream": "btcusdt@bookTicker", "data": {"u": 12, "s": "BTCUSDT", "b": "p", "B": "q", "a": "p", "A": "q"}}
+	 *
+	 * The first depth20 book after a subscription is the snapshot. Diffs ending at or
+	 * before its lastUpdateId are already in it; the first one after it has to
+	 * straddle it (U <= lastUpdateId + 1), and from then on each U follows the
+	 * previous u. A diff that does not chain reports the broken link as its
+	 * prevSeqId, so the book sees the gap and resynchronizes.
+	 *
+	 * The partial stream holds 20 levels and no REST snapshot is taken, so nothing
+	 * past them is ever seeded: books are capped at 20 levels, and every later
+	 * depth20 book that is not behind the diffs already applied reseeds them, so
+	 * levels that move into the top 20 are filled in within 100ms.
+	 */
+	template <>
+	struct FeedAdapter<EXCHANGE_API::BINANCE>
+	{
+		// Update ids are the venue's, per symbol; redundant connections can be matched on it
+		static constexpr bool shared_sequence = true;
+
+		// All the partial stream carries; there is no REST snapshot behind it
+		static constexpr int book_depth = 20;
+
+		struct Frame
+		{
+			QString venue_symbol;
+			std::string_view stream_kind;    // After the '@' of the stream name
+			bool is_ack = false;
+			bool is_depth_update = false;
+			bool is_ticker = false;
+			qint64 first_id = -1;            // U
+			qint64 last_id = -1;             // u
+			qint64 last_update_id = -1;      // Partial books
+			QVector<BookLevel> bids;
+			QVector<BookLevel> asks;
+			BookLevel best_bid;
+			BookLevel best_ask;
+		};
+
+		// Depth levels for "b"/"a" in diffs, a price string in book tickers
+		static void ReadSideOrPrice(JsonCursor& cursor, QVector<BookLevel>& levels, double& price)
+		{
+			if (cursor.Peek() == '[')
+				ReadLevels(cursor, levels);
+			else
+				cursor.ReadDouble(price);
+		}
+
+		static void ReadMember(std::string_view key, JsonCursor& cursor, Frame& frame)
+		{
+			std::string_view text;
+			if (key == "e" && cursor.ReadString(text))
+				frame.is_depth_update = text == "depthUpdate";
+			else if (key == "s" && cursor.ReadString(text))
+				frame.venue_symbol = ToQString(text);
+			else if (key == "U")
+				cursor.ReadInteger(frame.first_id);
+			else if (key == "u")
+				cursor.ReadInteger(frame.last_id);
+			else if (key == "lastUpdateId")
+				cursor.ReadInteger(frame.last_update_id);
+			else if (key == "b" || key == "bids")
+				ReadSideOrPrice(cursor, frame.bids, frame.best_bid.price);
+			else if (key == "a" || key == "asks")
+				ReadSideOrPrice(cursor, frame.asks, frame.best_ask.price);
+			else if (key == "B")
+				frame.is_ticker = cursor.ReadDouble(frame.best_bid.amount);
+			else if (key == "A")
+				frame.is_ticker = cursor.ReadDouble(frame.best_ask.amount);
+			else
+			{
+				frame.is_ack = frame.is_ack || key == "result";
+				cursor.SkipValue();
+			}
+		}
+
+		static DECODE_STATUS Decode(QByteArrayView payload, const QString& symbol_filter, FeedDecoderState& state, std::vector<FeedMessage>& out)
+		{
+			JsonCursor cursor(payload.data(), payload.data() + payload.size());
+			if (!cursor.EnterObject())
+				return DECODE_STATUS::INVALID;
+
+			Frame frame;
+			std::string_view key;
+			std::string_view stream;
+			while (cursor.NextMember(key))
+			{
+				if (key == "stream")
+					cursor.ReadString(stream);
+				else if (key == "data")
+				{
+					// Combined streams wrap the raw payload
+					cursor.EnterObject();
+					while (cursor.NextMember(key))
+						ReadMember(key, cursor, frame);
+				}
+				else
+					ReadMember(key, cursor, frame);
+			}
+
+			if (cursor.Failed())
+				return DECODE_STATUS::INVALID;
+			if (frame.is_ack)
+				return DECODE_STATUS::FILTERED;
+
+			// Partial books only name their symbol in the stream
+			const size_t at = stream.find('@');
+			if (at != std::string_view::npos)
+			{
+				if (frame.venue_symbol.isEmpty())
+					frame.venue_symbol = ToQString(stream.substr(0, at)).toUpper();
+				frame.stream_kind = stream.substr(at + 1);
+			}
+
+			FeedMessage message;
+			message.symbol = state.Instrument(frame.venue_symbol);
+			if (IsFiltered(message.symbol, symbol_filter))
+				return DECODE_STATUS::FILTERED;
+
+			if (frame.is_ticker)
+			{
+				message.is_top_of_book = true;
+				message.seq_id = frame.last_id;
+				message.best_bid = frame.best_bid;
+				message.best_ask = frame.best_ask;
+				out.push_back(std::move(message));
+				return DECODE_STATUS::VALID;
+			}
+
+			message.bids = std::move(frame.bids);
+			message.asks = std::move(frame.asks);
+
+			if (frame.last_update_id >= 0)
+				return DecodePartial(frame, state, message, out);
+			if (frame.is_depth_update)
+				return DecodeDiff(frame, state, message, out);
+			return DECODE_STATUS::FILTERED;
+		}
+
+		static DECODE_STATUS DecodePartial(const Frame& frame, FeedDecoderState& state, FeedMessage& message, std::vector<FeedMessage>& out)
+		{
+			if (frame.stream_kind.substr(0, 6) == "depth5")
+			{
+				const DECODE_STATUS status = ToTopOfBook(message);
+				if (status == DECODE_STATUS::VALID)
+					out.push_back(std::move(message));
+				return status;
+			}
+
+			// A book older than the diffs already applied would roll the symbol back
+			if (state.synced.contains(message.symbol) && frame.last_update_id < state.last_seq_id.value(message.symbol, -1))
+				return DECODE_STATUS::FILTERED;
+
+			message.seq_id = frame.last_update_id;
+			const DECODE_STATUS status = CheckSides(message);
+			if (status != DECODE_STATUS::VALID)
+				return status;
+
+			state.synced.insert(message.symbol);
+			state.last_seq_id.insert(message.symbol, frame.last_update_id);
+			out.push_back(std::move(message));
+			return DECODE_STATUS::VALID;
+		}
+
+		static DECODE_STATUS DecodeDiff(const Frame& frame, FeedDecoderState& state, FeedMessage& message, std::vector<FeedMessage>& out)
+		{
+			// Waiting for the snapshot, or already part of it
+			if (!state.synced.contains(message.symbol))
+				return DECODE_STATUS::FILTERED;
+
+			const qint64 last = state.last_seq_id.value(message.symbol, -1);
+			if (frame.last_id <= last)
+				return DECODE_STATUS::FILTERED;
+
+			message.is_delta = true;
+			message.seq_id = frame.last_id;
+			message.prev_seq_id = frame.first_id <= last + 1 ? last : frame.first_id - 1;
+			state.last_seq_id.insert(message.symbol, frame.last_id);
+
+			const DECODE_STATUS status = CheckSides(message);
+			if (status == DECODE_STATUS::VALID)
+				out.push_back(std::move(message));
+			return status;
+		}
+
+		static QByteArray Subscribe(bool subscribe, const QStringList& instruments, const QString& channel)
+		{
+			QJsonArray params;
+			for (const QString& instrument : instruments)
+			{
+				const QString stream = VenueSymbol(instrument).toLower();
+				if (channel == bbo_channel)
+					params.append(stream + "@bookTicker");
+				else if (channel == books5_channel)
+					params.append(stream + "@depth5@100ms");
+				else
+				{
+					params.append(stream + "@depth20@100ms");
+					params.append(stream + "@depth@100ms");
+				}
+			}
+
+			QJsonObject request;
+			request["method"] = subscribe ? "SUBSCRIBE" : "UNSUBSCRIBE";
+			request["params"] = params;
+			request["id"] = 1;
+			return ToCompactJson(request);
+		}
+
+		static QString VenueSymbol(const QString& instrument) { return CompactSymbol(instrument); }
+	};
+
+	/**
+	 * Coinbase Advanced Trade:
+	 *  {"channel": "l2_data", "sequence_num": 4, "events": [{"type": "update", "product_id": "BTC-USD",
+	 *   "updates": [{"side": "bid", "price_level": "p", "new_quantity": "q"}]}]}
+	 *  {"channel": "ticker", "sequence_num": 5, "events": [{"tickers": [{"product_id": "BTC-USD",
+	 *   "best_bid": "p", "best_bid_quantity": "q", "best_ask": "p", "best_ask_quantity": "q"}]}]}
+	 *
+	 * sequence_num counts every message of the connection, whatever its channel or
+	 * product. After a hole in it, each product's next update names the missing
+	 * number as its predecessor; its book never saw that number, so it resynchronizes.
+	 */
+	template <>
+	struct FeedAdapter<EXCHANGE_API::COINBASE>
+	{
+		// sequence_num counts the frames of this connection only, so redundant connections cannot be matched on it
+		static constexpr bool shared_sequence = false;
+
+		// The level2 snapshot is the full book
+		static constexpr int book_depth = 0;
+
+		struct Event
+		{
+			bool is_snapshot = false;
+			QString product;
+			QVector<BookLevel> bids;
+			QVector<BookLevel> asks;
+			std::vector<FeedMessage> tickers;
+		};
+
+		static void ReadUpdates(JsonCursor& cursor, Event& event)
+		{
+			std::string_view key;
+			std::string_view text;
+			cursor.EnterArray();
+			while (cursor.NextElement())
+			{
+				bool is_bid = true;
+				BookLevel level;
+				cursor.EnterObject();
+				while (cursor.NextMember(key))
+				{
+					if (key == "side" && cursor.ReadString(text))
+						is_bid = text == "bid";
+					else if (key == "price_level")
+						cursor.ReadDouble(level.price);
+					else if (key == "new_quantity")
+						cursor.ReadDouble(level.amount);
+					else
+						cursor.SkipValue();
+				}
+
+				// Snapshots list standing levels only
+				if (event.is_snapshot && level.amount <= 0.0)
+					continue;
+				(is_bid ? event.bids : event.asks).append(level);
+			}
+		}
+
+		static void ReadTickers(JsonCursor& cursor, Event& event)
+		{
+			std::string_view key;
+			std::string_view text;
+			cursor.EnterArray();
+			while (cursor.NextElement())
+			{
+				FeedMessage ticker;
+				ticker.is_top_of_book = true;
+				cursor.EnterObject();
+				while (cursor.NextMember(key))
+				{
+					if (key == "product_id" && cursor.ReadString(text))
+						ticker.symbol = ToQString(text);
+					else if (key == "best_bid")
+						cursor.ReadDouble(ticker.best_bid.price);
+					else if (key == "best_bid_quantity")
+						cursor.ReadDouble(ticker.best_bid.amount);
+					else if (key == "best_ask")
+						cursor.ReadDouble(ticker.best_ask.price);
+					else if (key == "best_ask_quantity")
+						cursor.ReadDouble(ticker.best_ask.amount);
+					else
+						cursor.SkipValue();
+				}
+				event.tickers.push_back(std::move(ticker));
+			}
+		}
+
+		static void ReadEvents(JsonCursor& cursor, std::vector<Event>& events)
+		{
+			std::string_view key;
+			std::string_view text;
+			cursor.EnterArray();
+			while (cursor.NextElement())
+			{
+				Event event;
+				cursor.EnterObject();
+				while (cursor.NextMember(key))
+				{
+					// "type" precedes "updates" on the wire
+					if (key == "type" && cursor.ReadString(text))
+						event.is_snapshot = text == "snapshot";
+					else if (key == "product_id" && cursor.ReadString(text))
+						event.product = ToQString(text);
+					else if (key == "updates")
+						ReadUpdates(cursor, event);
+					else if (key == "tickers")
+						ReadTickers(cursor, event);
+					else
+						cursor.SkipValue();
+				}
+				events.push_back(std::move(event));
+			}
+		}
+
+		static DECODE_STATUS Decode(QByteArrayView payload, const QString& symbol_filter, FeedDecoderState& state, std::vector<FeedMessage>& out)
+		{
+			JsonCursor cursor(payload.data(), payload.data() + payload.size());
+			if (!cursor.EnterObject())
+				return DECODE_STATUS::INVALID;
+
+			std::vector<Event> events;
+			qint64 seq_id = -1;
+			bool is_book = false;
+
+			std::string_view key;
+			std::string_view text;
+			while (cursor.NextMember(key))
+			{
+				if (key == "channel" && cursor.ReadString(text))
+					is_book = text == "l2_data" || text == "ticker";
+				else if (key == "sequence_num")
+					cursor.ReadInteger(seq_id);
+				else if (key == "events")
+					ReadEvents(cursor, events);
+				else
+					cursor.SkipValue();
+			}
+
+			if (cursor.Failed())
+				return DECODE_STATUS::INVALID;
+
+			// Every message advances the connection's sequence, books or not
+			if (seq_id >= 0)
+			{
+				if (state.connection_seq_id >= 0 && seq_id != state.connection_seq_id + 1)
+				{
+					for (auto it = state.last_seq_id.cbegin(); it != state.last_seq_id.cend(); ++it)
+						state.connection_gap.insert(it.key());
+				}
+				state.connection_seq_id = seq_id;
+			}
+
+			if (!is_book)
+				return DECODE_STATUS::FILTERED;
+
+			const size_t count_before = out.size();
+			for (Event& event : events)
+			{
+				for (FeedMessage& ticker : event.tickers)
+				{
+					if (IsFiltered(ticker.symbol, symbol_filter))
+						continue;
+					if (ticker.best_bid.price <= 0.0 || ticker.best_ask.price <= 0.0)
+						return DECODE_STATUS::INVALID;
+
+					ticker.seq_id = seq_id;
+					out.push_back(std::move(ticker));
+				}
+
+				if (event.product.isEmpty() || IsFiltered(event.product, symbol_filter) || !event.tickers.empty())
+					continue;
+
+				FeedMessage message;
+				message.symbol = event.product;
+				message.bids = std::move(event.bids);
+				message.asks = std::move(event.asks);
+				message.seq_id = seq_id;
+				message.is_delta = !event.is_snapshot;
+
+				if (message.is_delta)
+				{
+					message.prev_seq_id = state.connection_gap.contains(message.symbol) ? seq_id - 1 : state.last_seq_id.value(message.symbol, -1);
+					if (message.bids.isEmpty() && message.asks.isEmpty())
+						continue;
+				}
+				else if (CheckSides(message) != DECODE_STATUS::VALID)
+					return DECODE_STATUS::INVALID;
+
+				state.connection_gap.remove(message.symbol);
+				state.last_seq_id.insert(message.symbol, seq_id);
+				out.push_back(std::move(message));
+			}
+
+			return out.size() > count_before ? DECODE_STATUS::VALID : DECODE_STATUS::FILTERED;
+		}
+
+		static QByteArray Subscribe(bool subscribe, const QStringList& instruments, const QString& channel)
+		{
+			QJsonArray products;
+			for (const QString& instrument : instruments)
+				products.append(instrument);
+
+			QJsonObject request;
+			request["type"] = subscribe ? "subscribe" : "unsubscribe";
+			request["product_ids"] = products;
+			request["channel"] = (channel == bbo_channel || channel == books5_channel) ? "ticker" : "level2";
+			return ToCompactJson(request);
+		}
+
+		static QString VenueSymbol(const QString& instrument) { return instrument; }
+	};
+
+	/**
+	 * MEXC v3 JSON streams:
+	 *  {"c": "spot@public.limit.depth.v3.api@BTCUSDT@20", "s": "BTCUSDT",
+	 *   "d": {"asks": [{"p": "p", "v": "q"}], "bids": [...], "r": "3407459756"}}
+	 *  {"c": "spot@public.bookTicker.v3.api@BTCUSDT", "s": "BTCUSDT", "d": {"b": "p", "B": "q", "a": "p", "A": "q"}}
+	 * Limit-depth books are complete snapshots versioned by "r".
+	 */
+	template <>
+	struct FeedAdapter<EXCHANGE_API::MEXC>
+	{
+		// Versions are the venue's, per symbol; redundant connections can be matched on it
+		static constexpr bool shared_sequence = true;
+
+		// Books are subscribed at 20 levels, each a complete snapshot of them
+		static constexpr int book_depth = 20;
+
+		static bool ReadLevelObjects(JsonCursor& cursor, QVector<BookLevel>& levels)
+		{
+			std::string_view key;
+			if (!cursor.EnterArray())
+				return false;
+
+			while (cursor.NextElement())
+			{
+				BookLevel level;
+				cursor.EnterObject();
+				while (cursor.NextMember(key))
+				{
+					if (key == "p")
+						cursor.ReadDouble(level.price);
+					else if (key == "v")
+						cursor.ReadDouble(level.amount);
+					else
+						cursor.SkipValue();
+				}
+				levels.append(level);
+			}
+			return !cursor.Failed();
+		}
+
+		static DECODE_STATUS Decode(QByteArrayView payload, const QString& symbol_filter, FeedDecoderState& state, std::vector<FeedMessage>& out)
+		{
+			JsonCursor cursor(payload.data(), payload.data() + payload.size());
+			if (!cursor.EnterObject())
+				return DECODE_STATUS::INVALID;
+
+			FeedMessage message;
+			std::string_view channel;
+			std::string_view key;
+			std::string_view text;
+			while (cursor.NextMember(key))
+			{
+				if (key == "c")
+					cursor.ReadString(channel);
+				else if (key == "s" && cursor.ReadString(text))
+					message.symbol = state.Instrument(ToQString(text));
+				else if (key == "d")
+				{
+					cursor.EnterObject();
+					while (cursor.NextMember(key))
+					{
+						if (key == "bids")
+							ReadLevelObjects(cursor, message.bids);
+						else if (key == "asks")
+							ReadLevelObjects(cursor, message.asks);
+						else if (key == "r")
+							cursor.ReadInteger(message.seq_id);
+						else if (key == "b")
+							cursor.ReadDouble(message.best_bid.price);
+						else if (key == "B")
+							cursor.ReadDouble(message.best_bid.amount);
+						else if (key == "a")
+							cursor.ReadDouble(message.best_ask.price);
+						else if (key == "A")
+							cursor.ReadDouble(message.best_ask.amount);
+						else
+							cursor.SkipValue();
+					}
+				}
+				else
+					cursor.SkipValue();
+			}
+
+			// Acknowledgements have no channel
+			if (cursor.Failed())
+				return DECODE_STATUS::INVALID;
+			if (channel.empty() || IsFiltered(message.symbol, symbol_filter))
+				return DECODE_STATUS::FILTERED;
+
+			DECODE_STATUS status = DECODE_STATUS::FILTERED;
+			if (channel.find("bookTicker") != std::string_view::npos)
+			{
+				message.is_top_of_book = true;
+				status = message.best_bid.price > 0.0 && message.best_ask.price > 0.0 ? DECODE_STATUS::VALID : DECODE_STATUS::INVALID;
+			}
+			else if (channel.find("limit.depth") != std::string_view::npos)
+			{
+				const bool is_top_of_book = channel.size() >= 2 && channel.substr(channel.size() - 2) == "@5";
+				status = is_top_of_book ? ToTopOfBook(message) : CheckSides(message);
+			}
+
+			if (status == DECODE_STATUS::VALID)
+				out.push_back(std::move(message));
+			return status;
+		}
+
+		static QByteArray Subscribe(bool subscribe, const QStringList& instruments, const QString& channel)
+		{
+			QJsonArray params;
+			for (const QString& instrument : instruments)
+			{
+				const QString symbol = VenueSymbol(instrument);
+				if (channel == bbo_channel)
+					params.append("spot@public.bookTicker.v3.api@" + symbol);
+				else if (channel == books5_channel)
+					params.append("spot@public.limit.depth.v3.api@" + symbol + "@5");
+				else
+					params.append("spot@public.limit.depth.v3.api@" + symbol + "@20");
+			}
+
+			QJsonObject request;
+			request["method"] = subscribe ? "SUBSCRIPTION" : "UNSUBSCRIPTION";
+			request["params"] = params;
+			return ToCompactJson(request);
+		}
+
+		static QString VenueSymbol(const QString& instrument) { return CompactSymbol(instrument); }
+	};
+
+	namespace
+	{
+		template <EXCHANGE_API Venue>
+		FeedAdapterFns MakeFeedAdapter()
+		{
+			return { &FeedAdapter<Venue>::Decode, &FeedAdapter<Venue>::Subscribe, &FeedAdapter<Venue>::VenueSymbol, FeedAdapter<Venue>::shared_sequence,
+				FeedAdapter<Venue>::book_depth };
+		}
+	}
+
+	FeedAdapterFns ResolveFeedAdapter(EXCHANGE_API exchange)
+	{
+		switch (exchange)
+		{
+		case EXCHANGE_API::OKX: return MakeFeedAdapter<EXCHANGE_API::OKX>();
+		case EXCHANGE_API::BINANCE: return MakeFeedAdapter<EXCHANGE_API::BINANCE>();
+		case EXCHANGE_API::COINBASE: return MakeFeedAdapter<EXCHANGE_API::COINBASE>();
+		case EXCHANGE_API::MEXC: return MakeFeedAdapter<EXCHANGE_API::MEXC>();
+		default: return MakeFeedAdapter<EXCHANGE_API::NONE>();
+		}
+	}
+
+	EXCHANGE_API StringToFeedFormat(const QString& format)
+	{
+		const QString name = format.trimmed().toLower();
+		if (name == "okx")
+			return EXCHANGE_API::OKX;
+		if (name == "binance")
+			return EXCHANGE_API::BINANCE;
+		if (name == "coinbase")
+			return EXCHANGE_API::COINBASE;
+		if (name == "mexc")
+			return EXCHANGE_API::MEXC;
+		return EXCHANGE_API::NONE;
+	}
+}
@@ -0,0 +1,178 @@
+#include "QuantFeedArbiter.h"
+
+#include "QuantMetrics.h"
+
+namespace
+{
+	constexpr quint64 top_of_book_salt = 0x9E3779B97F4A7C15ull;
+
+	// Upper bound of the bucket holding the given fraction of the samples
+	qint64 Quantile(const Quant::MetricHistogram& histogram, double fraction)
+	{
+		const quint64 count = histogram.Count();
+		if (count == 0)
+			return 0;
+
+		const std::vector<qint64>& bounds = histogram.Bounds();
+		const quint64 rank = static_cast<quint64>(fraction * static_cast<double>(count - 1)) + 1;
+		quint64 seen = 0;
+		for (size_t bucket = 0; bucket < bounds.size(); bucket++)
+		{
+			seen += histogram.BucketCount(bucket);
+			if (seen >= rank)
+				return bounds[bucket];
+		}
+		return bounds.empty() ? 0 : bounds.back();
+	}
+}
+
+namespace Quant
+{
+	QuantFeedArbiter::QuantFeedArbiter() : m_slots(new Slot[slot_capacity])
+	{
+		static_assert((slot_capacity & (slot_capacity - 1)) == 0, "slot capacity must be a power of two");
+		static_assert((win_history & (win_history - 1)) == 0, "win history must be a power of two");
+		static_assert((forward_window & (forward_window - 1)) == 0, "forward window must be a power of two");
+
+		// Every connection has its own arbiter and lines; a label per arbiter keeps their series, and Stats(), apart
+		static std::atomic<int> next_connection{ 0 };
+		m_connection = next_connection.fetch_add(1, std::memory_order_relaxed);
+
+		QuantMetricsRegistry& registry = QuantMetricsRegistry::Instance();
+		for (int line = 0; line < max_lines; line++)
+		{
+			const QString label = QString("connection=\"%1\",line=\"%2\"").arg(m_connection).arg(line);
+			m_lines[line].won = &registry.Counter("quant_feed_line_messages_total", "Messages per redundant feed line and outcome.", label + ",outcome=\"won\"");
+			m_lines[line].duplicates = &registry.Counter("quant_feed_line_messages_total", "Messages per redundant feed line and outcome.", label + ",outcome=\"duplicate\"");
+			m_lines[line].lag = &registry.Histogram("quant_feed_line_lag_seconds", "How far a line trailed the line that won the same message.", label);
+		}
+	}
+
+	QuantFeedArbiter::~QuantFeedArbiter() = default;
+
+	quint64 QuantFeedArbiter::KeyOf(const QString& symbol, bool is_top_of_book)
+	{
+		// FNV-1a over the UTF-16 code units
+		quint64 hash = 14695981039346656037ull;
+		for (const QChar ch : symbol)
+		{
+			hash ^= ch.unicode();
+			hash *= 1099511628211ull;
+		}
+		if (is_top_of_book)
+			hash ^= top_of_book_salt;
+		return hash != 0 ? hash : 1;
+	}
+
+	QuantFeedArbiter::Slot* QuantFeedArbiter::Find(quint64 key)
+	{
+		constexpr quint64 mask = slot_capacity - 1;
+		for (quint64 probe = 0; probe < slot_capacity; probe++)
+		{
+			Slot& slot = m_slots[(key + probe) & mask];
+			quint64 current = slot.key.load(std::memory_order_acquire);
+			if (current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+				return &slot;
+			if (current == key)
+				return &slot;
+		}
+		return nullptr;
+	}
+
+	bool QuantFeedArbiter::Accept(int line, const FeedMessage& message, bool sequenced, qint64 arrival_ns)
+	{
+		if (line < 0 || line >= max_lines)
+			return false;
+
+		Slot* slot = sequenced && message.seq_id >= 0 ? Find(KeyOf(message.symbol, message.is_top_of_book)) : nullptr;
+		if (!slot)
+			return line == ActiveLine();
+
+		LineMetrics& metrics = m_lines[line];
+		const qint64 seq_id = message.seq_id;
+		qint64 last = slot->last_seq_id.load(std::memory_order_acquire);
+		if (last < 0 || seq_id > last - forward_window)
+		{
+			// The entry holds an older number until this one is claimed, the same number once it is
+			std::atomic<qint64>& entry = slot->forwarded[seq_id & (forward_window - 1)];
+			qint64 claimed = entry.load(std::memory_order_acquire);
+			while (claimed < seq_id)
+			{
+				if (entry.compare_exchange_weak(claimed, seq_id, std::memory_order_acq_rel))
+				{
+					while (seq_id > last && !slot->last_seq_id.compare_exchange_weak(last, seq_id, std::memory_order_acq_rel))
+					{
+					}
+
+					RecordWin(*slot, seq_id, arrival_ns);
+					metrics.won->Add();
+					return true;
+				}
+			}
+		}
+
+		metrics.duplicates->Add();
+		qint64 win_ns = 0;
+		if (WinTime(*slot, message.seq_id, win_ns))
+			metrics.lag->Observe(qMax<qint64>(0, arrival_ns - win_ns));
+		return false;
+	}
+
+	void QuantFeedArbiter::RecordWin(Slot& slot, qint64 seq_id, qint64 arrival_ns)
+	{
+		// Invalidated while the time changes, so a reader never pairs it with the wrong sequence number
+		WinRecord& record = slot.wins[seq_id & (win_history - 1)];
+		record.seq_id.store(-1);
+		record.arrival_ns.store(arrival_ns);
+		record.seq_id.store(seq_id);
+	}
+
+	bool QuantFeedArbiter::WinTime(const Slot& slot, qint64 seq_id, qint64& arrival_ns) const
+	{
+		const WinRecord& record = slot.wins[seq_id & (win_history - 1)];
+		if (record.seq_id.load() != seq_id)
+			return false;
+		arrival_ns = record.arrival_ns.load();
+		return record.seq_id.load() == seq_id;
+	}
+
+	void QuantFeedArbiter::ClearSlot(Slot& slot)
+	{
+		for (std::atomic<qint64>& entry : slot.forwarded)
+			entry.store(-1, std::memory_order_relaxed);
+		slot.last_seq_id.store(-1, std::memory_order_release);
+	}
+
+	void QuantFeedArbiter::Reset(const QString& symbol)
+	{
+		for (const bool is_top_of_book : { false, true })
+		{
+			if (Slot* slot = Find(KeyOf(symbol, is_top_of_book)))
+				ClearSlot(*slot);
+		}
+	}
+
+	void QuantFeedArbiter::ResetAll()
+	{
+		for (int idx = 0; idx < slot_capacity; idx++)
+			ClearSlot(m_slots[idx]);
+	}
+
+	FeedLineStats QuantFeedArbiter::Stats(int line) const
+	{
+		FeedLineStats stats;
+		if (line < 0 || line >= max_lines)
+			return stats;
+
+		const LineMetrics& metrics = m_lines[line];
+		stats.won = metrics.won->Value();
+		stats.duplicates = metrics.duplicates->Value();
+		if (stats.won + stats.duplicates > 0)
+			stats.win_rate = static_cast<double>(stats.won) / static_cast<double>(stats.won + stats.duplicates);
+
+		stats.lag_samples = metrics.lag->Count();
+		stats.lag_p50_ns = Quantile(*metrics.lag, 0.50);
+		stats.lag_p99_ns = Quantile(*metrics.lag, 0.99);
+		return stats;
+	}
+}
@@ -0,0 +1,493 @@
+#include "QuantFeedQueue.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <QMap>
+#include <QStringList>
+
+#include "QuantMetrics.h"
+#include "QuantRuntimeProfile.h"
+#include "QuantTracer.h"
+
+namespace
+{
+	/**
+	 * Applies the level changes on top of base, the later entry wins. Merging into a
+	 * snapshot drops emptied levels; merging two deltas keeps the zero amounts since
+	 * they still have to remove levels from the book.
+	 */
+	QVector<Quant::BookLevel> MergeSide(const QVector<Quant::BookLevel>& base, const QVector<Quant::BookLevel>& changes, bool is_bids, bool keep_removals)
+	{
+		QMap<double, double> levels;
+
+		auto apply = [&levels, keep_removals](const Quant::BookLevel& level)
+			{
+				if (!keep_removals && level.amount <= 0.0)
+					levels.remove(level.price);
+				else
+					levels.insert(level.price, level.amount);
+			};
+
+		for (const Quant::BookLevel& level : base)
+			apply(level);
+		for (const Quant::BookLevel& level : changes)
+			apply(level);
+
+		// Sides stay in book order: bids descending, asks ascending
+		QVector<Quant::BookLevel> merged;
+		merged.reserve(levels.size());
+		for (auto it = levels.cbegin(); it != levels.cend(); ++it)
+			merged.append({ it.key(), it.value() });
+
+		if (is_bids)
+			std::reverse(merged.begin(), merged.end());
+		return merged;
+	}
+
+	// The delta continues the pending message's sequence; without both ids a skipped message could not be told apart
+	bool Continues(const Quant::FeedMessage& pending, const Quant::FeedMessage& delta)
+	{
+		return pending.seq_id >= 0 && delta.prev_seq_id >= 0 && delta.prev_seq_id == pending.seq_id;
+	}
+}
+
+namespace Quant
+{
+	QuantFeedQueue::QuantFeedQueue(QObject* parent) : QObject(parent)
+	{
+		m_clock.start();
+
+		// A spinning thread polls the producers' rings instead of sleeping until a drain is posted
+		m_busy_poll = QuantRuntimeProfile::SpinsCurrentThread();
+		if (m_busy_poll)
+		{
+			m_poll_timer.setInterval(0);
+			QObject::connect(&m_poll_timer, &QTimer::timeout, this, &QuantFeedQueue::PollHandoffs);
+			m_poll_timer.start();
+		}
+	}
+
+	QuantFeedQueue::~QuantFeedQueue()
+	{
+		// Messages that will never be drained leave the gauge with the queue
+		PipelineMetrics::Get().feed_queue_depth.Add(-m_depth);
+	}
+
+	void QuantFeedQueue::SetDefaultPolicy(BACKPRESSURE_POLICY policy, const BackpressureLimits& limits)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_default_policy = policy;
+		m_default_limits = limits;
+
+		for (SymbolQueue& queue : m_queues)
+		{
+			if (queue.has_own_policy)
+				continue;
+
+			queue.policy = policy;
+			queue.limits = limits;
+		}
+	}
+
+	void QuantFeedQueue::SetProducerCount(int count)
+	{
+		if (!m_busy_poll)
+			return;
+
+		// Existing rings stay, a producer may be using them
+		for (int producer = 0; producer < qMin(count, max_producers); producer++)
+		{
+			if (!m_rings[producer])
+				m_rings[producer] = std::make_unique<HandoffRing>(ring_capacity);
+		}
+	}
+
+	void QuantFeedQueue::SetPolicy(const QString& symbol, BACKPRESSURE_POLICY policy, const BackpressureLimits& limits)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		SymbolQueue& queue = QueueFor(symbol);
+		queue.policy = policy;
+		queue.limits = limits;
+		queue.has_own_policy = true;
+	}
+
+	QuantFeedQueue::SymbolQueue& QuantFeedQueue::QueueFor(const QString& symbol)
+	{
+		auto it = m_queues.find(symbol);
+		if (it == m_queues.end())
+		{
+			SymbolQueue queue;
+			queue.policy = m_default_policy;
+			queue.limits = m_default_limits;
+			it = m_queues.insert(symbol, std::move(queue));
+		}
+		return *it;
+	}
+
+	bool QuantFeedQueue::ExceedsLimits(const SymbolQueue& queue, qint64 now_ns) const
+	{
+		if (queue.pending.empty())
+			return false;
+
+		return static_cast<int>(queue.pending.size()) > queue.limits.max_depth
+			|| now_ns - queue.pending.front().received_ns > queue.limits.max_staleness_ms * 1000000ll;
+	}
+
+	void QuantFeedQueue::Conflate(FeedMessage& pending, const FeedMessage& delta) const
+	{
+		// A snapshot stays a snapshot, a chain of deltas becomes one delta spanning it
+		const bool keep_removals = pending.is_delta;
+		pending.bids = MergeSide(pending.bids, delta.bids, true, keep_removals);
+		pending.asks = MergeSide(pending.asks, delta.asks, false, keep_removals);
+		pending.seq_id = delta.seq_id;
+	}
+
+	bool QuantFeedQueue::FillGap(SymbolQueue& queue, FeedMessage& message)
+	{
+		if (!message.is_delta || message.seq_id < 0)
+			return false;
+
+		auto follower = std::find_if(queue.pending.begin(), queue.pending.end(),
+			[&message](const FeedMessage& pending) { return pending.is_delta && pending.prev_seq_id == message.seq_id; });
+		if (follower == queue.pending.end())
+			return false;
+
+		auto filled = queue.pending.insert(follower, std::move(message));
+		if (queue.policy != BACKPRESSURE_POLICY::CONFLATE)
+			return true;
+
+		// The run closes up on both sides: into the message before it, then the follower into the run
+		qint64 merged = 0;
+		if (filled != queue.pending.begin() && Continues(*std::prev(filled), *filled))
+		{
+			Conflate(*std::prev(filled), *filled);
+			filled = std::prev(queue.pending.erase(filled));
+			merged++;
+		}
+
+		auto next = std::next(filled);
+		if (next != queue.pending.end() && Continues(*filled, *next))
+		{
+			Conflate(*filled, *next);
+			queue.pending.erase(next);
+			merged++;
+		}
+
+		queue.stats.conflated += merged;
+		m_conflated += merged;
+		PipelineMetrics::Get().feed_conflated.Add(static_cast<quint64>(merged));
+		return true;
+	}
+
+	void QuantFeedQueue::Push(FeedMessage message, int producer)
+	{
+		const qint64 now_ns = m_clock.nsecsElapsed();
+		message.received_ns = now_ns;
+
+		// Busy polling: the queue's thread takes it from the producer's ring
+		HandoffRing* ring = producer >= 0 && producer < max_producers ? m_rings[producer].get() : nullptr;
+		if (ring)
+		{
+			HandOff(*ring, std::move(message));
+			return;
+		}
+
+		const QString symbol = message.symbol;
+		bool schedule_drain = false;
+		bool request_resync = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			request_resync = Enqueue(std::move(message), now_ns);
+
+			if (!m_drain_scheduled)
+			{
+				m_drain_scheduled = true;
+				schedule_drain = true;
+			}
+		}
+
+		if (request_resync)
+			emit resyncRequested(symbol);
+
+		// One drain serves everything queued until it runs
+		if (schedule_drain)
+			QMetaObject::invokeMethod(this, &QuantFeedQueue::Drain, Qt::QueuedConnection);
+	}
+
+	void QuantFeedQueue::HandOff(HandoffRing& ring, FeedMessage message)
+	{
+		// The queue's thread may be waiting for this one to finish, so a full ring drops rather than waits
+		const quint64 head = ring.head.load(std::memory_order_relaxed);
+		if (head - ring.tail.load(std::memory_order_acquire) > ring.mask)
+		{
+			PipelineMetrics::Get().feed_dropped.Add();
+			if (message.is_top_of_book)
+				return;
+
+			std::lock_guard<std::mutex> lock(ring.overflow_mutex);
+			ring.overflow_symbols.insert(message.symbol);
+			ring.overflowed.store(true, std::memory_order_release);
+			return;
+		}
+
+		ring.slots[head & ring.mask] = std::move(message);
+		ring.head.store(head + 1, std::memory_order_release);
+	}
+
+	void QuantFeedQueue::PollHandoffs()
+	{
+		QStringList resyncs;
+		bool received = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			const qint64 now_ns = m_clock.nsecsElapsed();
+
+			for (const std::unique_ptr<HandoffRing>& ring : m_rings)
+			{
+				if (!ring)
+					continue;
+
+				// Before the ring's messages, so the deltas handed over after the loss are dropped too
+				if (ring->overflowed.exchange(false, std::memory_order_acquire))
+				{
+					QSet<QString> symbols;
+					{
+						std::lock_guard<std::mutex> overflow_lock(ring->overflow_mutex);
+						symbols.swap(ring->overflow_symbols);
+					}
+
+					for (const QString& symbol : symbols)
+					{
+						SymbolQueue& queue = QueueFor(symbol);
+						const int pending = static_cast<int>(queue.pending.size());
+						queue.pending.clear();
+						queue.awaiting_snapshot = true;
+						queue.stats.depth = 0;
+						queue.stats.resyncs++;
+						queue.stats.dropped += pending;
+						m_dropped += pending;
+						m_depth -= pending;
+						PipelineMetrics::Get().feed_dropped.Add(static_cast<quint64>(pending));
+						PipelineMetrics::Get().feed_queue_depth.Add(-pending);
+						resyncs.append(symbol);
+					}
+					received = true;
+				}
+
+				const quint64 tail = ring->tail.load(std::memory_order_relaxed);
+				const quint64 head = ring->head.load(std::memory_order_acquire);
+				for (quint64 idx = tail; idx != head; idx++)
+				{
+					FeedMessage& message = ring->slots[idx & ring->mask];
+					const QString symbol = message.symbol;
+					if (Enqueue(std::move(message), now_ns))
+						resyncs.append(symbol);
+				}
+				ring->tail.store(head, std::memory_order_release);
+				received = received || head != tail;
+			}
+		}
+
+		for (const QString& symbol : resyncs)
+			emit resyncRequested(symbol);
+
+		if (received)
+			Drain();
+	}
+
+	bool QuantFeedQueue::Enqueue(FeedMessage message, qint64 now_ns)
+	{
+		if (message.is_top_of_book)
+		{
+			EnqueueTopOfBook(std::move(message));
+			return false;
+		}
+
+		bool request_resync = false;
+		SymbolQueue& queue = QueueFor(message.symbol);
+		queue.stats.enqueued++;
+
+		// After a drop, deltas cannot apply until the next snapshot
+		if (message.is_delta && queue.awaiting_snapshot)
+		{
+			queue.stats.dropped++;
+			m_dropped++;
+			PipelineMetrics::Get().feed_dropped.Add();
+			return false;
+		}
+		if (!message.is_delta)
+			queue.awaiting_snapshot = false;
+
+		const int depth_before = static_cast<int>(queue.pending.size());
+
+		// A late copy of a skipped message goes back in order, whatever the policy
+		if (!FillGap(queue, message))
+		{
+			switch (queue.policy)
+			{
+			case BACKPRESSURE_POLICY::CONFLATE:
+			{
+				/**
+				 * A snapshot supersedes everything pending. A delta merges into the last
+				 * pending message only when it continues its sequence; after a skipped
+				 * message it stays on its own, so the book still sees the gap. Deltas
+				 * without ids only merge once the queue is at its depth limit.
+				 */
+				const bool merges = !queue.pending.empty()
+					&& (!message.is_delta || Continues(queue.pending.back(), message)
+						|| (static_cast<int>(queue.pending.size()) >= queue.limits.max_depth
+							&& (queue.pending.back().seq_id < 0 || message.prev_seq_id < 0)));
+
+				if (!merges)
+					queue.pending.push_back(std::move(message));
+				else
+				{
+					const qint64 merged = message.is_delta ? 1 : static_cast<qint64>(queue.pending.size());
+					if (message.is_delta)
+						Conflate(queue.pending.back(), message);
+					else
+					{
+						queue.pending.clear();
+						queue.pending.push_back(std::move(message));
+					}
+
+					queue.stats.conflated += merged;
+					m_conflated += merged;
+					PipelineMetrics::Get().feed_conflated.Add(static_cast<quint64>(merged));
+				}
+				break;
+			}
+
+			case BACKPRESSURE_POLICY::KEEP_ALL:
+				queue.pending.push_back(std::move(message));
+				break;
+
+			case BACKPRESSURE_POLICY::DROP_RESYNC:
+			{
+				const bool is_snapshot = !message.is_delta;
+				queue.pending.push_back(std::move(message));
+
+				if (ExceedsLimits(queue, now_ns))
+				{
+					// A fresh snapshot supersedes the backlog, otherwise ask for one
+					const qint64 dropped = static_cast<qint64>(queue.pending.size()) - (is_snapshot ? 1 : 0);
+					if (is_snapshot)
+						queue.pending.erase(queue.pending.begin(), queue.pending.end() - 1);
+					else
+					{
+						queue.pending.clear();
+						queue.awaiting_snapshot = true;
+						queue.stats.resyncs++;
+						request_resync = true;
+					}
+
+					queue.stats.dropped += dropped;
+					m_dropped += dropped;
+					PipelineMetrics::Get().feed_dropped.Add(static_cast<quint64>(dropped));
+				}
+				break;
+			}
+			}
+		}
+
+		// The gauge sums the queues of every connection, each adds its own change
+		queue.stats.depth = static_cast<int>(queue.pending.size());
+		const int depth_change = queue.stats.depth - depth_before;
+		m_depth += depth_change;
+		PipelineMetrics::Get().feed_queue_depth.Add(depth_change);
+		return request_resync;
+	}
+
+	void QuantFeedQueue::EnqueueTopOfBook(FeedMessage message)
+	{
+		SymbolQueue& queue = QueueFor(message.symbol);
+		queue.stats.enqueued++;
+
+		// Only the latest best bid/ask matters, whatever the policy
+		if (queue.has_top)
+			queue.stats.top_conflated++;
+		queue.top = std::move(message);
+		queue.has_top = true;
+	}
+
+	void QuantFeedQueue::Drain()
+	{
+		QUANT_TRACE_SCOPE("queue_drain", "feed");
+		std::vector<FeedMessage> batch;
+		std::vector<FeedMessage> tops;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_drain_scheduled = false;
+			batch.reserve(m_depth);
+
+			for (SymbolQueue& queue : m_queues)
+			{
+				queue.stats.delivered += static_cast<qint64>(queue.pending.size());
+				queue.stats.depth = 0;
+
+				for (FeedMessage& message : queue.pending)
+					batch.push_back(std::move(message));
+				queue.pending.clear();
+
+				if (queue.has_top)
+				{
+					queue.stats.top_delivered++;
+					tops.push_back(std::move(queue.top));
+					queue.has_top = false;
+				}
+			}
+			PipelineMetrics::Get().feed_queue_depth.Add(-m_depth);
+			m_depth = 0;
+		}
+
+		PipelineMetrics& metrics = PipelineMetrics::Get();
+		for (const FeedMessage& message : batch)
+		{
+			metrics.queue_latency.Observe(m_clock.nsecsElapsed() - message.received_ns);
+
+			if (message.is_delta)
+				emit deltaReady(message.bids, message.asks, message.seq_id, message.prev_seq_id, message.symbol);
+			else
+				emit snapshotReady(message.bids, message.asks, message.seq_id, message.symbol);
+		}
+
+		// After the book messages, so the freshest best levels are applied last
+		for (const FeedMessage& message : tops)
+		{
+			metrics.queue_latency.Observe(m_clock.nsecsElapsed() - message.received_ns);
+			emit topOfBookReady(message.symbol, message.best_bid, message.best_ask);
+		}
+
+		emit statsChanged();
+	}
+
+	int QuantFeedQueue::QueueDepth() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_depth;
+	}
+
+	qint64 QuantFeedQueue::ConflatedCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_conflated;
+	}
+
+	qint64 QuantFeedQueue::DroppedCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_dropped;
+	}
+
+	FeedQueueStats QuantFeedQueue::Stats(const QString& symbol) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_queues.constFind(symbol);
+		return it != m_queues.constEnd() ? it->stats : FeedQueueStats();
+	}
+}
@@ -0,0 +1,253 @@
+#include "QuantIngest.h"
+
+#include <QDebug>
+#include <QThread>
+
+#include "QuantConnectionManager.h"
+#include "QuantOrderbook.h"
+#include "QuantRuntimeProfile.h"
+#include "QuantScenarioEngine.h"
+#include "QuantTracer.h"
+#include "QuantWebSocket.h"
+
+namespace
+{
+	// FNV-1a; qHash is seeded per process, this has to give the same answer every run
+	quint32 SymbolHash(const QString& symbol)
+	{
+		quint32 hash = 2166136261u;
+		for (const char ch : symbol.toUtf8())
+		{
+			hash ^= static_cast<quint8>(ch);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+}
+
+namespace Quant
+{
+	QuantIngestShard::QuantIngestShard(int index, QObject* parent)
+		: QObject(parent), m_index(index)
+	{
+	}
+
+	void QuantIngestShard::Init()
+	{
+		QuantTracer::SetThreadName("ingest");
+		QuantRuntimeProfile::PinCurrentThread(THREAD_ROLE::BOOK);
+
+		// Created here, so the socket, its queue and their timers belong to this thread
+		m_websocket = new QuantWebSocket(this);
+		m_connection_manager = new QuantConnectionManager(m_websocket, this);
+
+		QObject::connect(m_websocket, &QuantWebSocket::orderbookUpdated, this, &QuantIngestShard::OnSnapshot);
+		QObject::connect(m_websocket, &QuantWebSocket::orderbookDeltaReceived, this, &QuantIngestShard::OnDelta);
+		QObject::connect(m_websocket, &QuantWebSocket::topOfBookUpdated, this, &QuantIngestShard::OnTopOfBook);
+		QObject::connect(m_websocket, &QuantWebSocket::error, this, [this](const QString& error)
+			{
+				qWarning() << "Ingest connection" << m_index << "error:" << error;
+			});
+		QObject::connect(m_websocket->Queue(), &QuantFeedQueue::resyncRequested, m_connection_manager, &QuantConnectionManager::Resync);
+
+		// Passes run on this thread alone; the connections already evaluate side by side
+		m_scenario_engine = new QuantScenarioEngine(this, 1);
+	}
+
+	QuantOrderbook* QuantIngestShard::AddSymbol(EXCHANGE_API exchange, const QString& symbol, int depth)
+	{
+		if (QuantOrderbook* existing = m_books.value(symbol))
+			return existing;
+
+		QuantOrderbook* orderbook = new QuantOrderbook(this);
+		orderbook->SetInstrument(exchange, symbol);
+		orderbook->SetDepth(depth);
+		m_books.insert(symbol, orderbook);
+
+		m_connection_manager->AddBook(orderbook);
+		m_scenario_engine->AddOrderbook(orderbook);
+		return orderbook;
+	}
+
+	void QuantIngestShard::SetFeedSettings(const QString& top_channel, BACKPRESSURE_POLICY policy, const BackpressureLimits& limits, int requests_per_second)
+	{
+		m_websocket->Queue()->SetDefaultPolicy(policy, limits);
+		m_connection_manager->SetTopOfBookChannel(top_channel);
+		m_connection_manager->SetRequestRateLimit(requests_per_second);
+	}
+
+	void QuantIngestShard::LoadScenarios(const QString& path)
+	{
+		m_scenario_engine->ClearScenarios();
+		m_scenario_engine->LoadScenarios(path);
+	}
+
+	void QuantIngestShard::Start(const QString& url, const QStringList& redundant_urls, EXCHANGE_API format)
+	{
+		m_connection_manager->Stop();
+		m_websocket->SetRedundantUrls(redundant_urls);
+		m_websocket->SetFeedFormat(format);
+		m_connection_manager->Start(url);
+	}
+
+	void QuantIngestShard::Stop()
+	{
+		m_connection_manager->Stop();
+	}
+
+	void QuantIngestShard::Shutdown()
+	{
+		// The engine reads the books, it stops before they go
+		delete m_scenario_engine;
+		m_scenario_engine = nullptr;
+
+		// The manager holds the socket and the books, it goes first
+		m_connection_manager->Stop();
+		delete m_connection_manager;
+		m_connection_manager = nullptr;
+
+		delete m_websocket;
+		m_websocket = nullptr;
+
+		qDeleteAll(m_books);
+		m_books.clear();
+	}
+
+	void QuantIngestShard::OnSnapshot(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, const QString& symbol)
+	{
+		if (QuantOrderbook* orderbook = m_books.value(symbol))
+			orderbook->updateOrderbook(bids, asks, seq_id);
+	}
+
+	void QuantIngestShard::OnDelta(const QVector<Quant::BookLevel>& bids, const QVector<Quant::BookLevel>& asks, qint64 seq_id, qint64 prev_seq_id, const QString& symbol)
+	{
+		if (QuantOrderbook* orderbook = m_books.value(symbol))
+			orderbook->applyDelta(bids, asks, seq_id, prev_seq_id);
+	}
+
+	void QuantIngestShard::OnTopOfBook(const QString& symbol, const Quant::BookLevel& best_bid, const Quant::BookLevel& best_ask)
+	{
+		if (QuantOrderbook* orderbook = m_books.value(symbol))
+			orderbook->updateTopOfBook(symbol, best_bid, best_ask);
+	}
+
+	QuantIngest::QuantIngest(int connection_count, QObject* parent) : QObject(parent)
+	{
+		const int count = qMax(1, connection_count);
+		m_shards.resize(count);
+
+		for (int i = 0; i < count; i++)
+		{
+			Shard& shard = m_shards[i];
+			shard.thread = new QThread();
+			shard.thread->setObjectName(QString("ingest-%1").arg(i));
+			shard.worker = new QuantIngestShard(i);
+			shard.worker->moveToThread(shard.thread);
+			shard.thread->start();
+
+			QMetaObject::invokeMethod(shard.worker, &QuantIngestShard::Init, Qt::BlockingQueuedConnection);
+		}
+	}
+
+	QuantIngest::~QuantIngest()
+	{
+		for (Shard& shard : m_shards)
+		{
+			QMetaObject::invokeMethod(shard.worker, &QuantIngestShard::Shutdown, Qt::BlockingQueuedConnection);
+			shard.thread->quit();
+			shard.thread->wait();
+
+			// The thread has finished, so its objects can go from here
+			delete shard.worker;
+			delete shard.thread;
+		}
+	}
+
+	int QuantIngest::ConnectionFor(const QString& symbol, int connection_count)
+	{
+		if (connection_count <= 1)
+			return 0;
+		return static_cast<int>(SymbolHash(symbol) % static_cast<quint32>(connection_count));
+	}
+
+	QuantOrderbook* QuantIngest::AddSymbol(EXCHANGE_API exchange, const QString& symbol, int depth)
+	{
+		if (symbol.isEmpty())
+			return nullptr;
+		if (QuantOrderbook* existing = m_books.value(symbol))
+			return existing;
+
+		Shard& shard = m_shards[ConnectionFor(symbol, ConnectionCount())];
+		QuantIngestShard* worker = shard.worker;
+
+		QuantOrderbook* orderbook = nullptr;
+		QMetaObject::invokeMethod(worker, [&]()
+			{
+				orderbook = worker->AddSymbol(exchange, symbol, depth);
+			}, Qt::BlockingQueuedConnection);
+
+		shard.symbols.append(symbol);
+		m_books.insert(symbol, orderbook);
+		return orderbook;
+	}
+
+	QStringList QuantIngest::Symbols(int connection) const
+	{
+		if (connection < 0 || connection >= ConnectionCount())
+			return {};
+		return m_shards[connection].symbols;
+	}
+
+	void QuantIngest::SetFeedSettings(const QString& top_channel, BACKPRESSURE_POLICY policy, const BackpressureLimits& limits, int requests_per_second)
+	{
+		for (const Shard& shard : m_shards)
+		{
+			QuantIngestShard* worker = shard.worker;
+			QMetaObject::invokeMethod(worker, [=]()
+				{
+					worker->SetFeedSettings(top_channel, policy, limits, requests_per_second);
+				}, Qt::QueuedConnection);
+		}
+	}
+
+	void QuantIngest::LoadScenarios(const QString& path)
+	{
+		for (const Shard& shard : m_shards)
+		{
+			QuantIngestShard* worker = shard.worker;
+			QMetaObject::invokeMethod(worker, [=]()
+				{
+					worker->LoadScenarios(path);
+				}, Qt::QueuedConnection);
+		}
+	}
+
+	QuantScenarioEngine* QuantIngest::ScenarioEngine(int connection) const
+	{
+		if (connection < 0 || connection >= ConnectionCount())
+			return nullptr;
+		return m_shards[connection].worker->ScenarioEngine();
+	}
+
+	void QuantIngest::Start(const QString& url, const QStringList& redundant_urls, EXCHANGE_API format)
+	{
+		for (const Shard& shard : m_shards)
+		{
+			// A connection without symbols would only hold a socket open
+			if (shard.symbols.isEmpty())
+				continue;
+
+			QuantIngestShard* worker = shard.worker;
+			QMetaObject::invokeMethod(worker, [=]()
+				{
+					worker->Start(url, redundant_urls, format);
+				}, Qt::QueuedConnection);
+		}
+	}
+
+	void QuantIngest::Stop()
+	{
+		for (const Shard& shard : m_shards)
+			QMetaObject::invokeMethod(shard.worker, &QuantIngestShard::Stop, Qt::BlockingQueuedConnection);
+	}
+}
@@ -2,8 +2,6 @@
 
 #include <QDebug>
 
-#include "QuantOKXCalculator.h"
-
 namespace Quant
 {
 	// Enum converter implementation
@@ -31,6 +29,22 @@ namespace Quant
 		return ORDER_TYPE::MARKET; // Default case
 	}
 
+	QString EnumConverter::OrderSideToString(ORDER_SIDE side)
+	{
+		switch (side)
+		{
+		case ORDER_SIDE::BUY: return "buy";
+		case ORDER_SIDE::SELL: return "sell";
+		default: return "Unknown";
+		}
+	}
+
+	ORDER_SIDE EnumConverter::StringToOrderSide(const QString& str)
+	{
+		if (str == "sell") return ORDER_SIDE::SELL;
+		return ORDER_SIDE::BUY; // Default case
+	}
+
 	QString EnumConverter::FeeTierToString(FEE_TIER tier)
 	{
 		switch (tier)
@@ -117,6 +131,11 @@ namespace Quant
 		return QStringList() << "market" << "limit" << "stop_loss" << "take_profit" << "trailing_stop_market" << "trailing_stop_limit";
 	}
 
+	QStringList EnumConverter::GetAllOrderSides()
+	{
+		return QStringList() << "buy" << "sell";
+	}
+
 	QStringList EnumConverter::GetAllSpotAssets()
 	{
 		return QStringList() << "BTC-USDT-SWAP" << "ETH-USDT-SWAP" << "SOL-USDT-SWAP"
@@ -175,13 +194,26 @@ namespace Quant
 		SetOrderType(EnumConverter::StringToOrderType(order_type));
 	}
 
+	void QuantInputHandler::SetOrderSide(ORDER_SIDE order_side)
+	{
+		if (order_side == m_order_side)
+			return;
+
+		m_order_side = order_side;
+		emit OrderSideChanged();
+	}
+
+	void QuantInputHandler::SetOrderSideString(const QString& order_side)
+	{
+		SetOrderSide(EnumConverter::StringToOrderSide(order_side));
+	}
+
 	void QuantInputHandler::SetFeeTier(FEE_TIER fee_tier)
 	{
 		if (fee_tier == m_fee_tier)
 			return;
 
 		m_fee_tier = fee_tier;
-		qDebug() << EnumConverter::FeeTierToString(m_fee_tier);
 
 		emit FeeTierChanged();
 	}
@@ -223,9 +255,7 @@ namespace Quant
 		if (enabled == m_volatility_enabled)
 			return;
 
-		qDebug() << "Volatility state: " << enabled;
 		m_volatility_enabled = enabled;
-		QuantOKXCalculator::SetVolatilityEnabled(enabled);
 
 		emit VolatilityEnabledChanged();
 	}
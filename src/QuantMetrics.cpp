@@ -0,0 +1,204 @@
+#include "QuantMetrics.h"
+
+#include <QSet>
+
+namespace
+{
+	QByteArray MetricName(const QString& name, const char* suffix, const QString& labels, const QString& extra_label = QString())
+	{
+		QString all_labels = labels;
+		if (!extra_label.isEmpty())
+			all_labels = all_labels.isEmpty() ? extra_label : all_labels + QLatin1Char(',') + extra_label;
+
+		QString text = name + QLatin1String(suffix);
+		if (!all_labels.isEmpty())
+			text += QLatin1Char('{') + all_labels + QLatin1Char('}');
+		return text.toUtf8();
+	}
+
+	QByteArray Seconds(qint64 ns)
+	{
+		return QByteArray::number(ns / 1.0e9, 'g', 9);
+	}
+}
+
+namespace Quant
+{
+	MetricHistogram::MetricHistogram(std::vector<qint64> bounds_ns)
+		: m_bounds_ns(std::move(bounds_ns)), m_buckets(new std::atomic<quint64>[m_bounds_ns.size() + 1])
+	{
+		for (size_t bucket = 0; bucket <= m_bounds_ns.size(); bucket++)
+			m_buckets[bucket].store(0, std::memory_order_relaxed);
+	}
+
+	void MetricHistogram::Observe(qint64 value_ns)
+	{
+		size_t bucket = 0;
+		while (bucket < m_bounds_ns.size() && value_ns > m_bounds_ns[bucket])
+			bucket++;
+
+		m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		m_sum_ns.fetch_add(static_cast<quint64>(qMax<qint64>(0, value_ns)), std::memory_order_relaxed);
+	}
+
+	quint64 MetricHistogram::Count() const
+	{
+		quint64 count = 0;
+		for (size_t bucket = 0; bucket <= m_bounds_ns.size(); bucket++)
+			count += BucketCount(bucket);
+		return count;
+	}
+
+	std::vector<qint64> MetricHistogram::LatencyBounds()
+	{
+		std::vector<qint64> bounds;
+		for (qint64 decade = 1000; decade <= 100000000; decade *= 10)
+		{
+			bounds.push_back(decade);
+			bounds.push_back(decade * 5 / 2);
+			bounds.push_back(decade * 5);
+		}
+		bounds.push_back(1000000000);
+		return bounds;
+	}
+
+	QuantMetricsRegistry& QuantMetricsRegistry::Instance()
+	{
+		static QuantMetricsRegistry registry;
+		return registry;
+	}
+
+	void* QuantMetricsRegistry::Find(METRIC_TYPE type, const QString& name, const QString& labels) const
+	{
+		for (const Entry& entry : m_entries)
+		{
+			if (entry.type == type && entry.name == name && entry.labels == labels)
+				return entry.metric;
+		}
+		return nullptr;
+	}
+
+	MetricCounter& QuantMetricsRegistry::Counter(const QString& name, const QString& help, const QString& labels)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (void* metric = Find(METRIC_TYPE::COUNTER, name, labels))
+			return *static_cast<MetricCounter*>(metric);
+
+		m_counters.emplace_back();
+		m_entries.push_back({ METRIC_TYPE::COUNTER, name, help, labels, &m_counters.back() });
+		return m_counters.back();
+	}
+
+	MetricGauge& QuantMetricsRegistry::Gauge(const QString& name, const QString& help, const QString& labels)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (void* metric = Find(METRIC_TYPE::GAUGE, name, labels))
+			return *static_cast<MetricGauge*>(metric);
+
+		m_gauges.emplace_back();
+		m_entries.push_back({ METRIC_TYPE::GAUGE, name, help, labels, &m_gauges.back() });
+		return m_gauges.back();
+	}
+
+	MetricHistogram& QuantMetricsRegistry::Histogram(const QString& name, const QString& help, const QString& labels)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (void* metric = Find(METRIC_TYPE::HISTOGRAM, name, labels))
+			return *static_cast<MetricHistogram*>(metric);
+
+		m_histograms.emplace_back(MetricHistogram::LatencyBounds());
+		m_entries.push_back({ METRIC_TYPE::HISTOGRAM, name, help, labels, &m_histograms.back() });
+		return m_histograms.back();
+	}
+
+	QByteArray QuantMetricsRegistry::Expose() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		QByteArray out;
+		out.reserve(16 * 1024);
+
+		// Series of one name have to be contiguous, after a single HELP and TYPE
+		QSet<QString> done;
+		for (const Entry& first : m_entries)
+		{
+			if (done.contains(first.name))
+				continue;
+			done.insert(first.name);
+
+			const char* type = first.type == METRIC_TYPE::COUNTER ? "counter" : first.type == METRIC_TYPE::GAUGE ? "gauge" : "histogram";
+			out += "# HELP " + first.name.toUtf8() + ' ' + first.help.toUtf8() + '\n';
+			out += "# TYPE " + first.name.toUtf8() + ' ' + type + '\n';
+
+			for (const Entry& entry : m_entries)
+			{
+				if (entry.name != first.name)
+					continue;
+
+				switch (entry.type)
+				{
+				case METRIC_TYPE::COUNTER:
+					out += MetricName(entry.name, "", entry.labels) + ' ' + QByteArray::number(static_cast<MetricCounter*>(entry.metric)->Value()) + '\n';
+					break;
+
+				case METRIC_TYPE::GAUGE:
+					out += MetricName(entry.name, "", entry.labels) + ' ' + QByteArray::number(static_cast<MetricGauge*>(entry.metric)->Value()) + '\n';
+					break;
+
+				case METRIC_TYPE::HISTOGRAM:
+				{
+					const MetricHistogram& histogram = *static_cast<MetricHistogram*>(entry.metric);
+					quint64 cumulative = 0;
+					for (size_t bucket = 0; bucket < histogram.Bounds().size(); bucket++)
+					{
+						cumulative += histogram.BucketCount(bucket);
+						const QString le = QString("le=\"%1\"").arg(QString::fromLatin1(Seconds(histogram.Bounds()[bucket])));
+						out += MetricName(entry.name, "_bucket", entry.labels, le) + ' ' + QByteArray::number(cumulative) + '\n';
+					}
+					cumulative += histogram.BucketCount(histogram.Bounds().size());
+
+					out += MetricName(entry.name, "_bucket", entry.labels, "le=\"+Inf\"") + ' ' + QByteArray::number(cumulative) + '\n';
+					out += MetricName(entry.name, "_sum", entry.labels) + ' ' + Seconds(static_cast<qint64>(histogram.SumNs())) + '\n';
+					out += MetricName(entry.name, "_count", entry.labels) + ' ' + QByteArray::number(cumulative) + '\n';
+					break;
+				}
+				}
+			}
+		}
+		return out;
+	}
+
+	PipelineMetrics& PipelineMetrics::Get()
+	{
+		static PipelineMetrics metrics = []()
+			{
+				QuantMetricsRegistry& registry = QuantMetricsRegistry::Instance();
+				const QString stage_help = "Time spent per pipeline stage.";
+
+				return PipelineMetrics{
+					registry.Counter("quant_feed_messages_received_total", "WebSocket messages received."),
+					registry.Counter("quant_feed_messages_filtered_total", "Messages without a book for this client (events, other symbols)."),
+					registry.Counter("quant_feed_decode_errors_total", "Messages that failed to parse or lacked bids/asks."),
+					registry.Counter("quant_book_updates_total", "Book updates applied.", "kind=\"snapshot\""),
+					registry.Counter("quant_book_updates_total", "Book updates applied.", "kind=\"delta\""),
+					registry.Counter("quant_book_updates_total", "Book updates applied.", "kind=\"top_of_book\""),
+					registry.Counter("quant_book_sequence_gaps_total", "Deltas that did not follow the book's sequence id."),
+					registry.Counter("quant_feed_conflated_total", "Messages merged into a pending one by the backpressure queue."),
+					registry.Counter("quant_feed_dropped_total", "Messages dropped by the backpressure queue."),
+					registry.Gauge("quant_feed_queue_depth", "Messages waiting to be drained, over every feed connection."),
+					registry.Counter("quant_socket_events_total", "WebSocket state changes.", "event=\"connected\""),
+					registry.Counter("quant_socket_events_total", "WebSocket state changes.", "event=\"disconnected\""),
+					registry.Counter("quant_socket_events_total", "WebSocket state changes.", "event=\"error\""),
+					registry.Counter("quant_calculations_total", "Cost calculations performed."),
+					registry.Counter("quant_calculations_coalesced_total", "Book updates folded into an already scheduled calculation."),
+					registry.Counter("quant_calculation_cache_hits_total", "Calculations that reused memoized work.", "tier=\"features\""),
+					registry.Counter("quant_calculation_cache_hits_total", "Calculations that reused memoized work.", "tier=\"result\""),
+					registry.Histogram("quant_stage_latency_seconds", stage_help, "stage=\"decode\""),
+					registry.Histogram("quant_stage_latency_seconds", stage_help, "stage=\"queue\""),
+					registry.Histogram("quant_stage_latency_seconds", stage_help, "stage=\"book_apply\""),
+					registry.Histogram("quant_stage_latency_seconds", stage_help, "stage=\"calculation\""),
+				};
+			}();
+		return metrics;
+	}
+}
@@ -0,0 +1,83 @@
+#include "QuantMetricsServer.h"
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpSocket>
+
+#include "QuantMetrics.h"
+#include "QuantTracer.h"
+
+namespace
+{
+	QByteArray Response(const QByteArray& status, const QByteArray& content_type, const QByteArray& body, const QByteArray& headers = QByteArray())
+	{
+		return "HTTP/1.1 " + status + "\r\n" + headers
+			+ "Content-Type: " + content_type + "\r\n"
+			"Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+			"Connection: close\r\n\r\n" + body;
+	}
+}
+
+namespace Quant
+{
+	QuantMetricsServer::QuantMetricsServer(QObject* parent)
+		: QObject(parent)
+	{
+		QObject::connect(&m_server, &QTcpServer::newConnection, this, &QuantMetricsServer::OnNewConnection);
+	}
+
+	bool QuantMetricsServer::Listen(quint16 port)
+	{
+		if (!m_server.listen(QHostAddress::LocalHost, port))
+		{
+			qWarning() << "Metrics server: cannot listen on port" << port << m_server.errorString();
+			return false;
+		}
+		return true;
+	}
+
+	void QuantMetricsServer::OnNewConnection()
+	{
+		while (QTcpSocket* socket = m_server.nextPendingConnection())
+		{
+			QObject::connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { OnReadyRead(socket); });
+			QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		}
+	}
+
+	void QuantMetricsServer::OnReadyRead(QTcpSocket* socket)
+	{
+		// Only the request line matters, the headers are left unread
+		if (!socket->canReadLine())
+		{
+			if (socket->bytesAvailable() > max_request_bytes)
+				socket->abort();
+			return;
+		}
+
+		const QList<QByteArray> request = socket->readLine().trimmed().split(' ');
+		QObject::disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+		const QByteArray method = request.size() >= 2 ? request[0] : QByteArray();
+		const QByteArray path = request.size() >= 2 ? request[1].split('?').first() : QByteArray();
+
+		// Reads are GETs; toggling the tracer changes state, so it only answers a POST
+		const bool is_read = path == "/metrics" || path == "/trace";
+		const bool is_toggle = path == "/trace/start" || path == "/trace/stop";
+		if ((is_read && method != "GET") || (is_toggle && method != "POST"))
+			socket->write(Response("405 Method Not Allowed", "text/plain; charset=utf-8", "Method not allowed\n", is_read ? "Allow: GET\r\n" : "Allow: POST\r\n"));
+		else if (path == "/metrics")
+			socket->write(Response("200 OK", "text/plain; version=0.0.4; charset=utf-8", QuantMetricsRegistry::Instance().Expose()));
+		else if (path == "/trace")
+			socket->write(Response("200 OK", "application/json", QuantTracer::ExportChromeTrace()));
+		else if (is_toggle)
+		{
+			QuantTracer::SetEnabled(path == "/trace/start");
+			socket->write(Response("200 OK", "text/plain; charset=utf-8", QuantTracer::IsEnabled() ? "tracing\n" : "stopped\n"));
+		}
+		else
+			socket->write(Response("404 Not Found", "text/plain; charset=utf-8", "Not found\n"));
+
+		socket->disconnectFromHost();
+	}
+}
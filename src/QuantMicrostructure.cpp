@@ -0,0 +1,171 @@
+#include "QuantMicrostructure.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr qint64 bucket_ns = Quant::QuantMicrostructure::window_ns / Quant::QuantMicrostructure::window_buckets;
+	constexpr double window_seconds = Quant::QuantMicrostructure::window_ns / 1.0e9;
+
+	bool SameLevel(const Quant::BookLevel& lhs, const Quant::BookLevel& rhs)
+	{
+		return lhs.price == rhs.price && lhs.amount == rhs.amount;
+	}
+}
+
+namespace Quant
+{
+	void QuantMicrostructure::Reset()
+	{
+		m_buckets = {};
+		m_totals = {};
+		m_head = 0;
+		m_head_epoch = -1;
+		m_bid_before = {};
+		m_ask_before = {};
+		m_changed_levels = 0;
+		m_features = {};
+	}
+
+	void QuantMicrostructure::BeginUpdate(const BookLevel& best_bid, const BookLevel& best_ask, qint64 now_ns)
+	{
+		Advance(now_ns);
+		m_bid_before = best_bid;
+		m_ask_before = best_ask;
+		m_changed_levels = 0;
+	}
+
+	void QuantMicrostructure::OnLevel(bool is_bid, double price, double previous_amount, double amount)
+	{
+		m_changed_levels++;
+
+		const double change = amount - previous_amount;
+		if (change == 0.0)
+			return;
+
+		// Bands are measured from the side's best before the update; an empty side takes every level
+		const double reference = is_bid ? m_bid_before.price : m_ask_before.price;
+		for (int depth = 1; depth < FlowFeatures::ofi_depths; depth++)
+		{
+			const double band = ofi_band_bps[depth] / 1.0e4;
+			const bool in_band = reference <= 0.0 || (is_bid ? price >= reference * (1.0 - band) : price <= reference * (1.0 + band));
+			if (!in_band)
+				continue;
+
+			Add(OFI_0 + depth, is_bid ? change : -change);
+			Add(GROSS_0 + depth, std::abs(change));
+		}
+	}
+
+	void QuantMicrostructure::EndUpdate(const BookLevel& best_bid, const BookLevel& best_ask, bool is_snapshot)
+	{
+		const bool had_both = m_bid_before.price > 0.0 && m_ask_before.price > 0.0;
+		const bool has_both = best_bid.price > 0.0 && best_ask.price > 0.0;
+
+		/**
+		 * Best-level order flow imbalance, Cont, Kukanov and Stoikov (2014):
+		 *   e = 1{Pb' >= Pb} qb' - 1{Pb' <= Pb} qb - 1{Pa' <= Pa} qa' + 1{Pa' >= Pa} qa
+		 * A bid that rises or grows and an ask that rises or shrinks push it up.
+		 */
+		if (had_both && has_both)
+		{
+			const double bid_flow = (best_bid.price >= m_bid_before.price ? best_bid.amount : 0.0)
+				- (best_bid.price <= m_bid_before.price ? m_bid_before.amount : 0.0);
+			const double ask_flow = (best_ask.price <= m_ask_before.price ? best_ask.amount : 0.0)
+				- (best_ask.price >= m_ask_before.price ? m_ask_before.amount : 0.0);
+
+			Add(OFI_0, bid_flow - ask_flow);
+			Add(GROSS_0, std::abs(bid_flow) + std::abs(ask_flow));
+		}
+
+		// What left the best queues: part of a queue that stays best, or all of a queue that is gone
+		if (m_bid_before.price > 0.0)
+		{
+			if (best_bid.price == m_bid_before.price)
+				Add(BID_DEPLETED, std::max(0.0, m_bid_before.amount - best_bid.amount));
+			else if (best_bid.price < m_bid_before.price)
+				Add(BID_DEPLETED, m_bid_before.amount);
+		}
+		if (m_ask_before.price > 0.0)
+		{
+			if (best_ask.price == m_ask_before.price)
+				Add(ASK_DEPLETED, std::max(0.0, m_ask_before.amount - best_ask.amount));
+			else if (best_ask.price > m_ask_before.price || best_ask.price <= 0.0)
+				Add(ASK_DEPLETED, m_ask_before.amount);
+		}
+
+		if (!SameLevel(best_bid, m_bid_before) || !SameLevel(best_ask, m_ask_before))
+			Add(QUOTE_UPDATES, 1.0);
+		Add(LEVEL_UPDATES, is_snapshot ? 1.0 : m_changed_levels);
+
+		Publish(best_bid, best_ask);
+	}
+
+	void QuantMicrostructure::Advance(qint64 now_ns)
+	{
+		const qint64 epoch = now_ns / bucket_ns;
+		if (m_head_epoch < 0 || epoch - m_head_epoch >= window_buckets)
+		{
+			// First update, or the whole window expired since the last one
+			m_buckets = {};
+			m_totals = {};
+			m_head = 0;
+			m_head_epoch = epoch;
+			return;
+		}
+
+		for (; m_head_epoch < epoch; m_head_epoch++)
+		{
+			m_head = (m_head + 1) % window_buckets;
+			for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+				m_totals[channel] -= m_buckets[m_head][channel];
+			m_buckets[m_head] = {};
+
+			// Subtracting leaves rounding behind; re-summing once per lap keeps it from building up
+			if (m_head == 0)
+			{
+				m_totals = {};
+				for (const Bucket& bucket : m_buckets)
+				{
+					for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+						m_totals[channel] += bucket[channel];
+				}
+			}
+		}
+	}
+
+	void QuantMicrostructure::Add(int channel, double value)
+	{
+		m_buckets[m_head][channel] += value;
+		m_totals[channel] += value;
+	}
+
+	void QuantMicrostructure::Publish(const BookLevel& best_bid, const BookLevel& best_ask)
+	{
+		FlowFeatures& features = m_features;
+
+		for (int depth = 0; depth < FlowFeatures::ofi_depths; depth++)
+		{
+			const double gross = m_totals[GROSS_0 + depth];
+			features.ofi[depth] = m_totals[OFI_0 + depth];
+			features.ofi_normalized[depth] = gross > 0.0 ? std::clamp(features.ofi[depth] / gross, -1.0, 1.0) : 0.0;
+		}
+
+		const double queued = best_bid.amount + best_ask.amount;
+		const bool has_both = best_bid.price > 0.0 && best_ask.price > 0.0;
+		features.microprice = (has_both && queued > 0.0)
+			? (best_bid.price * best_ask.amount + best_ask.price * best_bid.amount) / queued
+			: 0.0;
+
+		features.bid_depletion_rate = m_totals[BID_DEPLETED] / window_seconds;
+		features.ask_depletion_rate = m_totals[ASK_DEPLETED] / window_seconds;
+		features.bid_turnover = best_bid.amount > 0.0 ? features.bid_depletion_rate / best_bid.amount : 0.0;
+		features.ask_turnover = best_ask.amount > 0.0 ? features.ask_depletion_rate / best_ask.amount : 0.0;
+
+		features.quote_intensity = m_totals[QUOTE_UPDATES] / window_seconds;
+		features.update_intensity = m_totals[LEVEL_UPDATES] / window_seconds;
+
+		features.valid = has_both && m_totals[LEVEL_UPDATES] > 0.0;
+	}
+}
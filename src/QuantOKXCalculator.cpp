@@ -4,12 +4,9 @@
 
 namespace Quant
 {
-	bool QuantOKXCalculator::m_is_volatility_enabled = false;
-	double QuantOKXCalculator::m_process_time_ms = 0.0;
-
 	namespace
 	{
-		int orderbook_depth_num = 10; // Number of levels to consider for depth calculation
+		using Calculator = QuantCalculator<OKXPolicy>;
 
 		struct ItemType
 		{
@@ -17,37 +14,34 @@ namespace Quant
 			static constexpr const char* amount = "amount";
 		};
 
-		void BestEntries(QVariantList& entries, bool is_bids = true)
+		// Unboxes QML entries once into typed levels, optionally sorted best level first
+		QVector<BookLevel> ToLevels(const QVariantList& entries, bool sort = false, bool is_bids = true)
 		{
-			// Sort the entries based on price
-			std::sort(entries.begin(), entries.end(),
-				[is_bids](const QVariant& a, const QVariant& b)
-				{
-					double price_a = a.toMap()[ItemType::price].toDouble();
-					double price_b = b.toMap()[ItemType::price].toDouble();
-
-					// Sort by price in descending order for bids and ascending for asks
-					return (is_bids) ? (price_a > price_b) : (price_a < price_b);
-				});
-		}
+			QVector<BookLevel> levels;
+			levels.reserve(entries.size());
 
-		void BestEntryPrice(const QVariantList& entries, double& best_price, bool is_bid = true)
-		{
-			for (const QVariant entry : entries)
+			for (const QVariant& entry : entries)
 			{
-				double entry_price = entry.toMap()[ItemType::price].toDouble();
-				if (is_bid)
-				{
-					if (entry_price > best_price)
-						best_price = entry_price;
-				}
-				else
-				{
-					if (entry_price < best_price)
-						best_price = entry_price;
-				}
+				const QVariantMap level = entry.toMap();
+				levels.append({ level[ItemType::price].toDouble(), level[ItemType::amount].toDouble() });
+			}
 
+			if (sort)
+			{
+				std::sort(levels.begin(), levels.end(),
+					[is_bids](const BookLevel& a, const BookLevel& b)
+					{
+						// Sort by price in descending order for bids and ascending for asks
+						return (is_bids) ? (a.price > b.price) : (a.price < b.price);
+					});
 			}
+
+			return levels;
+		}
+
+		BookSide ToSide(const QVector<BookLevel>& levels)
+		{
+			return { levels.constData(), static_cast<int>(levels.size()) };
 		}
 	}
 
@@ -58,17 +52,12 @@ namespace Quant
 
 	void QuantOKXCalculator::InitializeFeeRates()
 	{
-		// Initialize OKX fee rates based on documentation (maker, taker) in percentage
-		m_fee_rates[FEE_TIER::VIP_0] = qMakePair(0.0800, 0.1000);
-		m_fee_rates[FEE_TIER::VIP_1] = qMakePair(0.0700, 0.0900);
-		m_fee_rates[FEE_TIER::VIP_2] = qMakePair(0.0650, 0.0800);
-		m_fee_rates[FEE_TIER::VIP_3] = qMakePair(0.0600, 0.0750);
-		m_fee_rates[FEE_TIER::VIP_4] = qMakePair(0.0550, 0.0700);
-		m_fee_rates[FEE_TIER::VIP_5] = qMakePair(0.0500, 0.0600);
-		m_fee_rates[FEE_TIER::VIP_6] = qMakePair(0.0450, 0.0550);
-		m_fee_rates[FEE_TIER::VIP_7] = qMakePair(0.0400, 0.0500);
-		m_fee_rates[FEE_TIER::VIP_8] = qMakePair(0.0350, 0.0450);
-		m_fee_rates[FEE_TIER::VIP_9] = qMakePair(0.0300, 0.0400);
+		// OKX fee rates (maker, taker) in percentage come from OKXPolicy
+		for (int tier = 0; tier < fee_tier_count; tier++)
+		{
+			const FeeRate rates = OKXPolicy::fee_schedule[tier];
+			m_fee_rates[static_cast<FEE_TIER>(tier)] = qMakePair(rates.maker, rates.taker);
+		}
 	}
 
 	QuantOKXCalculator::price_amount_pair QuantOKXCalculator::GetFeeRates(FEE_TIER tier) const
@@ -111,66 +100,14 @@ namespace Quant
 		if (bids.isEmpty() || asks.isEmpty())
 			return 0.0;
 
-		auto new_bids = bids;
-		auto new_asks = asks;
-
-		// Sort bids and asks to get the best prices
-		BestEntries(new_bids, true);
-		BestEntries(new_asks, false);
-
-		// get best bid and ask prices
-		double best_bid = new_bids.isEmpty() ? 0.0 : new_bids.first().toMap()[ItemType::price].toDouble();
-		double best_ask = new_asks.isEmpty() ? std::numeric_limits<double>::max() : new_asks.first().toMap()[ItemType::price].toDouble();
-
-		if (best_bid <= 0 || best_ask <= 0 || best_ask == std::numeric_limits<double>::max())
-			return 0.0;
-
-		// Calculate mid price
-		double mid_price = (best_bid + best_ask) / 2.0;
-
-		// Calculate bid-ask spread as percentage of mid-price (implicit cost )
-		double spread = (best_ask - best_bid) / mid_price;
-
-		// Calculate order-book depth (sum of top 10 bids and asks)
-		double bid_depth = 0.0;
-		double ask_depth = 0.0;
-
-		int levels = qMin(orderbook_depth_num, new_bids.size());
-		for (int i = 0; i < levels; i++)
-		{
-			bid_depth += new_bids[i].toMap()[ItemType::amount].toDouble();
-		}
-
-		levels = qMin(orderbook_depth_num, new_asks.size());
-		for (int i = 0; i < levels; i++)
-		{
-			ask_depth += new_asks[i].toMap()[ItemType::amount].toDouble();
-		}
-
-		/**
-		* Measure order books imbalance supply-demand asymmetry
-		* Measure the relative difference between the buying pressure (bid_depth) and selling pressure (ask_depth)
-		* The result always between 0 and 1.
-		*	- 0 means prefectly balanced order book (bid_depth == ask_depth)
-		*	- 1 means all orders are on one side (bid_depth == 0 or ask_depth == 0)
-		* High imbalancec often correlates with directional price movement and volatility
-		*
-		* When the imbalance value is closer to 0:
-		*	•	This generally indicates a stable, liquid market with good price consensus
-		*
-		* When the imbalance value is closer to 1:
-		*	•	The order book is heavily one-sided, which can indicate potential volatility
-		*	•	Two scenarios can cause this:
-		*		1.	If bid_depth ≈ 0: Few buy orders remain, suggesting either strong bearish sentiment or that buyers have withdrawn from the market
-		*		2.	If ask_depth ≈ 0: Few sell orders remain, suggesting either strong bullish sentiment or that sellers have withdrawn from the market
-		*/
-		// Calculate order imbalance (measures supply/demand asymmetry)
-		double imbalance = qAbs(bid_depth - ask_depth) / (bid_depth + ask_depth);
+		const QVector<BookLevel> bid_levels = ToLevels(bids, true, true);
+		const QVector<BookLevel> ask_levels = ToLevels(asks, true, false);
 
-		// Combine factors for volatility estimate
-		double volatility = (spread * 2.0 + imbalance * 1.5) * 100.0; // Convert to percentage
+		BookView book;
+		book.bids = ToSide(bid_levels);
+		book.asks = ToSide(ask_levels);
 
-		return volatility;
+		return Calculator::ComputeFeatures(book).volatility;
 	}
 
 	/**
@@ -200,14 +137,8 @@ namespace Quant
 	 */
 	double QuantOKXCalculator::CalculateFees(double order_amount, FEE_TIER tier, bool is_taker)
 	{
-		// Get fee rate
-		price_amount_pair rates = GetFeeRates(tier);
-
-		// Apply Maker/Taker fee rate 
-		double fee_rate = is_taker ? rates.second : rates.first;
-
-		// Return fee as percentage
-		return fee_rate;
+		Q_UNUSED(order_amount);
+		return Calculator::CalculateFees(tier, is_taker, OKXPolicy::fee_schedule);
 	}
 
 	/**
@@ -239,25 +170,9 @@ namespace Quant
 	 */
 	double QuantOKXCalculator::CalculateMarketOrderCost(double quantity, const QVariantList& orderbook)
 	{
-		double total_cost = 0.0;
-		double remaining_quantity = quantity;
-
-		// Loop through the orderbook levels until it filled
-		for (int i = 0; i<orderbook.size() && remaining_quantity > 0; i++)
-		{
-			QVariantMap level = orderbook[i].toMap();
-			double price = level[ItemType::price].toDouble();
-			double available_amount = level[ItemType::amount].toDouble();
-
-			double executed_amount = qMin(remaining_quantity, available_amount);
-			double cost_at_this_level = executed_amount * price;
-
-			total_cost += cost_at_this_level;
-			remaining_quantity -= executed_amount;
-		}
-
-		// Return cost per unit
-		return (quantity > 0) ? total_cost / quantity : 0.0;
+		// The levels are walked in the order they are given
+		const QVector<BookLevel> levels = ToLevels(orderbook);
+		return Calculator::CalculateMarketOrderCost(quantity, ToSide(levels));
 	}
 
 	/**
@@ -289,24 +204,14 @@ namespace Quant
 	 */
 	double QuantOKXCalculator::CalculateSlippage(double quantity, const QVariantList& bids, const QVariantList& asks, ORDER_TYPE order_type, ORDER_SIDE side)
 	{
-		if (order_type != ORDER_TYPE::MARKET)
-			return 0.0;
-
-		// Calculate theoretical execution price
-		// When buying, we consider the ask side. when selling, we consider the bid side. 
-		double market_cost = CalculateMarketOrderCost(quantity, (side == ORDER_SIDE::BUY) ? asks : bids);
+		const QVector<BookLevel> bid_levels = ToLevels(bids, true, true);
+		const QVector<BookLevel> ask_levels = ToLevels(asks, true, false);
 
-		// Get reference price (best bid or ask)
-		double reference_price = (side == ORDER_SIDE::BUY) ? asks.first().toMap()[ItemType::price].toDouble() : bids.first().toMap()[ItemType::price].toDouble();
+		BookView book;
+		book.bids = ToSide(bid_levels);
+		book.asks = ToSide(ask_levels);
 
-		// Calculate slippage as percentage
-		double slippage = 0.0;
-		if (side == ORDER_SIDE::BUY)
-			slippage = ((market_cost - reference_price) / reference_price) * 100.0;
-		else
-			slippage = ((reference_price - market_cost) / reference_price) * 100.0;
-
-		return qMax(0.0, slippage);
+		return Calculator::CalculateSlippage(quantity, book, order_type, side);
 	}
 
 	/**
@@ -346,35 +251,20 @@ namespace Quant
 	 */
 	double QuantOKXCalculator::CalculateMarketImpact(double quantity, double volatility, const QVariantList& bids, const QVariantList& asks)
 	{
-		// When user enable the volatility slider, use the provided value
-		// Otherwise, calculate the volatility from the orderbook
-		double effective_volatility = volatility;
-		if (!m_is_volatility_enabled)
-		{
-			effective_volatility = CalculateVolatilityFromOrderbook(bids, asks);
-		}
-
-		// Simplified Almgre-chriss market impact model
-		double sigma = effective_volatility / 100.0; // Convert percentage to decimal
+		const QVector<BookLevel> bid_levels = ToLevels(bids, true, true);
+		const QVector<BookLevel> ask_levels = ToLevels(asks, true, false);
 
-		// Calculate total market depth volume
-		double market_depth = 0.0;
-		for (const QVariant& item : asks)
-			market_depth += item.toMap()[ItemType::amount].toDouble();
+		BookView book;
+		book.bids = ToSide(bid_levels);
+		book.asks = ToSide(ask_levels);
 
-		// Placeholder for average daily volume (ADV)- this should be replaced with actual ADV data
-		// In a real implementation, this would be fetched from a reliable source with historical data
-		double average_daily_volume = market_depth * 24.0; // Assuming 24 hours of trading
+		const BookFeatures features = Calculator::ComputeFeatures(book);
 
-		// Impact coefficient
-		const double c = 0.1; // This is a constant that can be adjusted based on empirical data
-
-		// Calculate impact
-		double impact = 0.0;
-		if (market_depth > 0 && average_daily_volume > 0)
-			impact = c * sigma * qSqrt(quantity / market_depth) * (quantity / average_daily_volume);
+		// When user enable the volatility slider, use the provided value
+		// Otherwise, calculate the volatility from the orderbook
+		const double effective_volatility = m_is_volatility_enabled ? volatility : features.volatility;
 
-		return impact;
+		return Calculator::CalculateMarketImpact(quantity, effective_volatility, features);
 	}
 
 	/**
@@ -405,73 +295,14 @@ namespace Quant
 		if (bids.isEmpty() || asks.isEmpty())
 			return 0.0;
 
-		auto new_bids = bids;
-		auto new_asks = asks;
-
-		// Sort bids and asks to get the best prices
-		BestEntries(new_bids, true);
-		BestEntries(new_asks, false);
+		const QVector<BookLevel> bid_levels = ToLevels(bids, true, true);
+		const QVector<BookLevel> ask_levels = ToLevels(asks, true, false);
 
-		// get best bid and ask prices
-		double best_bid = new_bids.isEmpty() ? 0.0 : new_bids.first().toMap()[ItemType::price].toDouble();
-		double best_ask = new_asks.isEmpty() ? std::numeric_limits<double>::max() : new_asks.first().toMap()[ItemType::price].toDouble();
-
-		if (best_bid <= 0 || best_ask <= 0 || best_ask == std::numeric_limits<double>::max())
-			return 0.0;
+		BookView book;
+		book.bids = ToSide(bid_levels);
+		book.asks = ToSide(ask_levels);
 
-		// Calculate mid price
-		double mid_price = (best_bid + best_ask) / 2.0;
-
-		// Calculate bid-ask spread as percentage of mid-price (implicit cost )
-		double spread = (best_ask - best_bid) / mid_price;
-
-		// Calculate order-book depth (sum of top 10 bids and asks)
-		double bid_depth = 0.0;
-		double ask_depth = 0.0;
-
-		for (const auto entity : new_bids)
-		{
-			bid_depth += entity.toMap()[ItemType::amount].toDouble();
-		}
-
-		for (const auto entity : new_asks)
-		{
-			ask_depth += entity.toMap()[ItemType::amount].toDouble();
-		}
-
-		double imbalance = qAbs(bid_depth - ask_depth) / (bid_depth + ask_depth);
-
-		/**
-		 * Logistic function: 1 / (1 + e^(-x)) <-- ()
-		 * where x = β₀ + β₁*spread + β₂*imbalance <-- ()
-		 *
-		 * Model interpretation:
-		 *  - β₀ = 0.5 (intercept/base probability)
-		 *  - β₁ = -2.0 (spread coefficient, negative because wider spreads favor taker orders)
-		 *  - β₂ = 1.5 (imbalance coefficient, positive because imbalance may create maker opportunities)
-		 *
-		 * Output probability interpretation:
-		 *  - Values near 1.0: Strong conditions for maker orders
-		 *  - Values near 0.5: Neutral conditions (either strategy viable)
-		 *  - Values near 0.0: Strong conditions for taker orders
-		 * 
-		 * These coefficients (β₀, β₁, β₂) are placeholders and should be replaced with actual values from a trained model.
-		 * Here we're using arbitrary values base on domain knowledge for demonstration purposes.
-		 **/
-		const double beta_0 = 0.5; // Intercept - the base level of maker ratio
-		const double beta_1 = -2.0; // Spread coefficient - negative because higher spread should lower the maker ratio
-		const double beta_2 = 1.5; // Imbalance coefficient - positive because higher imbalance should increase the maker ratio
-
-		double x = beta_0 + (beta_1 * spread) + (beta_2 * imbalance);
-		double maker_probability = 1.0 / (1.0 + std::exp(-x)); // Logistic function
-
-		return maker_probability;
-	}
-
-	QuantOKXCalculator& QuantOKXCalculator::get()
-	{
-		static QuantOKXCalculator instance; // Stack allocated, automatically destroyed
-		return instance;
+		return Calculator::ComputeFeatures(book).maker_ratio;
 	}
 
 }
\ No newline at end of file
@@ -1,23 +1,97 @@
-#include "QuantOrderBook.h"
+#include "QuantOrderbook.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "QuantClock.h"
+#include "QuantExchangePolicy.h"
+#include "QuantMetrics.h"
+#include "QuantTracer.h"
 
 namespace
 {
-    int levels_num = 50;
-	constexpr int preallocated_entries = 50;
+    // Levels reserved per side for a full-depth book; capacity only grows after that
+    constexpr int full_depth_capacity = 1024;
+
+    // The panel shows the top of the book whatever the stored depth
+    constexpr int panel_levels = 50;
+
+    // depth 0 keeps every level; the venue's levels are parsed already, only the empty ones are dropped
+    void CopySide(const QVector<Quant::BookLevel>& entries, QVector<Quant::BookLevel>& levels, int depth)
+    {
+        for (const Quant::BookLevel& level : entries)
+        {
+            if (depth > 0 && levels.size() >= depth)
+                break;
+            if (level.price > 0.0 && level.amount > 0.0)
+                levels.append(level);
+        }
+    }
+
+    // Ladder grid of the venue; prices off it still work through the ladder's overflow
+    double TickSize(Quant::EXCHANGE_API exchange)
+    {
+        switch (exchange)
+        {
+        case Quant::EXCHANGE_API::OKX: return Quant::OKXPolicy::tick_size;
+        case Quant::EXCHANGE_API::BINANCE: return Quant::BinancePolicy::tick_size;
+        case Quant::EXCHANGE_API::COINBASE: return Quant::CoinbasePolicy::tick_size;
+        case Quant::EXCHANGE_API::MEXC: return Quant::MEXCPolicy::tick_size;
+        default: return 0.01;
+        }
+    }
+
+    void LoadLadder(Quant::QuantPriceLadder& ladder, const QVector<Quant::BookLevel>& levels)
+    {
+        ladder.Clear();
+        for (const Quant::BookLevel& level : levels)
+            ladder.Set(level);
+    }
 
+    QString FormatNumber(double value)
+    {
+        QString text = QString::number(value, 'f', 8);
+        while (text.endsWith('0'))
+            text.chop(1);
+        if (text.endsWith('.'))
+            text.chop(1);
+        return text;
+    }
 }
 
 namespace Quant
 {
-    QuantOrderbook::QuantOrderbook(QObject *parent) : QObject(parent)
+    QuantOrderbook::QuantOrderbook(QObject *parent)
+        : QObject(parent), m_bid_ladder(true, TickSize(EXCHANGE_API::OKX)), m_ask_ladder(false, TickSize(EXCHANGE_API::OKX))
     {
-        // Reserve capacity in containers during construction
-        m_bid_entries.reserve(preallocated_entries);
-		m_ask_entries.reserve(preallocated_entries);
+        SetDepth(0);
     }
 
-    void QuantOrderbook::updateOrderbook(const QJsonArray &bids, const QJsonArray &asks)
+    void QuantOrderbook::SetDepth(int depth)
     {
+        m_requested_depth = qMax(0, depth);
+        m_depth = m_depth_limit > 0 && (m_requested_depth == 0 || m_requested_depth > m_depth_limit) ? m_depth_limit : m_requested_depth;
+
+        // Reserve capacity up front so updates don't reallocate
+        const int capacity = m_depth > 0 ? m_depth : full_depth_capacity;
+        m_bid_levels.reserve(capacity);
+        m_ask_levels.reserve(capacity);
+    }
+
+    void QuantOrderbook::SetDepthLimit(int levels)
+    {
+        m_depth_limit = qMax(0, levels);
+        SetDepth(m_requested_depth);
+    }
+
+    void QuantOrderbook::updateOrderbook(const QVector<BookLevel> &bids, const QVector<BookLevel> &asks, qint64 seq_id)
+    {
+        QUANT_TRACE_SCOPE("book_snapshot", "book");
+        QElapsedTimer apply_timer;
+        apply_timer.start();
+
         // Input validation
         if (bids.isEmpty())
 			qWarning() << "Empty bids array received";
@@ -25,104 +99,238 @@ namespace Quant
         if (asks.isEmpty())
 			qWarning() << "Empty asks array received";
 
+        // The flow sees the snapshot as one update from the best levels it replaces
+        m_flow.BeginUpdate(m_bid_ladder.Best(), m_ask_ladder.Best(), QuantClock::SteadyNs());
+
     	// Clear previous data
-        m_bid_entries.clear();
-        m_ask_entries.clear();
+        m_bid_levels.clear();
+        m_ask_levels.clear();
+
+        CopySide(bids, m_bid_levels, m_depth);
+        CopySide(asks, m_ask_levels, m_depth);
+
+        // Exchanges publish sorted sides; only pay for a sort when they don't
+        if (!std::is_sorted(m_bid_levels.begin(), m_bid_levels.end(), BidOrder))
+            std::sort(m_bid_levels.begin(), m_bid_levels.end(), BidOrder);
+        if (!std::is_sorted(m_ask_levels.begin(), m_ask_levels.end(), AskOrder))
+            std::sort(m_ask_levels.begin(), m_ask_levels.end(), AskOrder);
+
+        // Deltas apply to the ladders from here on
+        LoadLadder(m_bid_ladder, m_bid_levels);
+        LoadLadder(m_ask_ladder, m_ask_levels);
+        m_levels_dirty = false;
+        m_bid_changes.clear();
+        m_ask_changes.clear();
+        m_last_was_snapshot = true;
+
+        m_seq_id = seq_id;
+        m_has_snapshot = true;
+        m_version++;
+        m_flow.EndUpdate(m_bid_ladder.Best(), m_ask_ladder.Best(), true);
+
+        PipelineMetrics& metrics = PipelineMetrics::Get();
+        metrics.book_snapshots.Add();
+        metrics.book_apply_latency.Observe(apply_timer.nsecsElapsed());
 
-        // Process bids
-        for (unsigned int idx = 0; idx < qMin(levels_num, bids.size()); idx++)
+        SetStale(false);
+        emit orderbookUpdated();
+
+        if (!m_top_from_channel)
+            SetTop(m_bid_ladder.Best(), m_ask_ladder.Best());
+    }
+
+    void QuantOrderbook::applyDelta(const QVector<BookLevel> &bids, const QVector<BookLevel> &asks, qint64 seq_id, qint64 prev_seq_id)
+    {
+        // Waiting for a snapshot to resynchronize
+        if (m_is_stale)
+            return;
+
+        // A delta only applies on top of a snapshot, and on top of the message it follows when both carry ids
+        const bool sequenced = m_seq_id >= 0 && prev_seq_id >= 0;
+        if (!m_has_snapshot || (sequenced && prev_seq_id != m_seq_id))
         {
-            const QJsonValue bid_value = bids.at(idx);
-            if (!bid_value.isArray())
-            {
-                qWarning() << "Invalid bid entry format at index " << idx;
-                continue;
-			}
-
-            const QJsonArray bid_entry = bid_value.toArray();
-            if (bid_entry.size() < 2)
-            {
-	            qWarning() << "Invalid bid entry size at index " << idx;
-				continue;
-            }
-
-
-            OrderEntry item;
-            item.price = bid_entry[PRICE].toString();
-            item.amount = bid_entry[AMOUNT].toString();
-            m_bid_entries.append(item);
+            qWarning() << "Orderbook sequence gap: expected" << m_seq_id << "received" << prev_seq_id;
+            PipelineMetrics::Get().sequence_gaps.Add();
+            SetStale(true);
+            emit sequenceGap(m_seq_id, prev_seq_id);
+            return;
         }
 
-        // Process Asks
-        for (unsigned int idx = 0; idx < qMin(levels_num, asks.size()); idx++)
+        QUANT_TRACE_SCOPE("book_delta", "book");
+        QElapsedTimer apply_timer;
+        apply_timer.start();
+
+        // One direct-mapped slot per level; the sorted sides are rebuilt when read
+        m_flow.BeginUpdate(m_bid_ladder.Best(), m_ask_ladder.Best(), QuantClock::SteadyNs());
+        for (const BookLevel& level : bids)
         {
-            const QJsonValue ask_value = asks.at(idx);
-            if (!ask_value.isArray())
-            {
-                qWarning() << "Invalid ask entry format at index " << idx;
-                continue;
-            }
-
-            const QJsonArray ask_entry = ask_value.toArray();
-            if (ask_entry.size() < 2)
-            {
-                qWarning() << "Invalid ask entry size at index " << idx;
-                continue;
-			}
-
-            OrderEntry item;
-             item.price = ask_entry[PRICE].toString();
-             item.amount = ask_entry[AMOUNT].toString();
-            m_ask_entries.append(item);
+            m_flow.OnLevel(true, level.price, m_bid_ladder.AmountAt(level.price), level.amount);
+            m_bid_ladder.Set(level);
         }
+        for (const BookLevel& level : asks)
+        {
+            m_flow.OnLevel(false, level.price, m_ask_ladder.AmountAt(level.price), level.amount);
+            m_ask_ladder.Set(level);
+        }
+        m_flow.EndUpdate(m_bid_ladder.Best(), m_ask_ladder.Best(), false);
+
+        m_bid_changes = bids;
+        m_ask_changes = asks;
+        m_last_was_snapshot = false;
+
+        m_levels_dirty = true;
+
+        m_seq_id = seq_id;
+        m_version++;
+
+        PipelineMetrics& metrics = PipelineMetrics::Get();
+        metrics.book_deltas.Add();
+        metrics.book_apply_latency.Observe(apply_timer.nsecsElapsed());
 
         emit orderbookUpdated();
+
+        if (!m_top_from_channel)
+            SetTop(m_bid_ladder.Best(), m_ask_ladder.Best());
+    }
+
+    void QuantOrderbook::updateTopOfBook(const QString& symbol, const BookLevel& best_bid, const BookLevel& best_ask)
+    {
+        if (!m_symbol.isEmpty() && symbol != m_symbol)
+            return;
+
+        // From here on the channel owns the top of book, the deep updates no longer move it
+        m_top_from_channel = true;
+        PipelineMetrics::Get().book_top_updates.Add();
+        SetTop(best_bid, best_ask);
+    }
+
+    void QuantOrderbook::resetTopOfBook()
+    {
+        if (!m_top_from_channel)
+            return;
+
+        m_top_from_channel = false;
+        SetTop(m_bid_ladder.Best(), m_ask_ladder.Best());
+    }
+
+    void QuantOrderbook::SetTop(const BookLevel& bid, const BookLevel& ask)
+    {
+        if (bid.price == m_top.bid.price && bid.amount == m_top.bid.amount
+            && ask.price == m_top.ask.price && ask.amount == m_top.ask.amount)
+            return;
+
+        m_top.bid = bid;
+        m_top.ask = ask;
+
+        // A one-sided book has no mid
+        const bool has_both = bid.price > 0.0 && ask.price > 0.0;
+        m_top.mid_price = has_both ? (bid.price + ask.price) / 2.0 : 0.0;
+        m_top.spread = has_both ? (ask.price - bid.price) / m_top.mid_price : 0.0;
+        m_top.version++;
+
+        emit topOfBookUpdated();
+    }
+
+    void QuantOrderbook::Materialize() const
+    {
+        if (!m_levels_dirty)
+            return;
+
+        // A capped book shows its best levels
+        m_bid_ladder.CopyLevels(m_bid_levels, m_depth);
+        m_ask_ladder.CopyLevels(m_ask_levels, m_depth);
+        m_levels_dirty = false;
     }
 
     QVariantList QuantOrderbook::getBids() const
     {
-        if (m_bid_entries.empty())
+        Materialize();
+        if (m_bid_levels.empty())
 			qWarning() << "Bids are empty";
 
-        return entriesAsVariantList(m_bid_entries);
+        return entriesAsVariantList(m_bid_levels);
     }
 
     QVariantList QuantOrderbook::getAsks() const
     {
-        if (m_ask_entries.empty())
+        Materialize();
+        if (m_ask_levels.empty())
             qWarning() << "Asks are empty";
 
-        return entriesAsVariantList(m_ask_entries);
+        return entriesAsVariantList(m_ask_levels);
     }
 
-    QVariantList QuantOrderbook::entriesAsVariantList(const QVector<OrderEntry>& entries, bool reverse) const
+    void QuantOrderbook::SetStale(bool stale)
     {
-        QVariantList result;
-        result.reserve(entries.size());
+        if (stale == m_is_stale)
+            return;
+
+        m_is_stale = stale;
+
+        // The top-of-book channel went down with the feed; the resync snapshot takes over until it resumes
+        if (m_is_stale)
+            m_top_from_channel = false;
 
-    	if (reverse)
-    	{
+        emit staleChanged(m_is_stale);
+    }
+
+    void QuantOrderbook::SetInstrument(EXCHANGE_API exchange, const QString& symbol)
+    {
+        m_exchange = exchange;
+        m_symbol = symbol;
+        m_flow.Reset();
 
-    		for (auto it = entries.rbegin(); it != entries.rend(); ++it)
-		    {
-	            QVariantMap item;
-				item["price"] = it->price;
-	            item["amount"] = it->amount;
-				result.append(item);
-	        }
+        // Levels of another instrument are meaningless; the book stays empty and stale until the next snapshot
+        m_bid_ladder = QuantPriceLadder(true, TickSize(exchange));
+        m_ask_ladder = QuantPriceLadder(false, TickSize(exchange));
+        m_bid_levels.clear();
+        m_ask_levels.clear();
+        m_levels_dirty = false;
+        m_bid_changes.clear();
+        m_ask_changes.clear();
+        m_last_was_snapshot = true;
+        m_seq_id = -1;
+        m_has_snapshot = false;
+
+        // Caches and snapshots keyed on the version must not take this for the previous book
+        m_version++;
+
+        m_top_from_channel = false;
+        SetTop(BookLevel(), BookLevel());
+        SetStale(true);
+    }
+
+    BookView QuantOrderbook::View() const
+    {
+        Materialize();
 
+        BookView view;
+        view.bids = { m_bid_levels.constData(), static_cast<int>(m_bid_levels.size()) };
+        view.asks = { m_ask_levels.constData(), static_cast<int>(m_ask_levels.size()) };
+        view.version = m_version;
+        view.flow = &m_flow.Features();
+        return view;
+    }
+
+    QVariantList QuantOrderbook::entriesAsVariantList(const QVector<BookLevel>& entries, bool reverse) const
+    {
+        // Only the levels the panel shows are converted for QML
+        const qsizetype count = qMin<qsizetype>(panel_levels, entries.size());
+
+        QVariantList result;
+        result.reserve(count);
+
+        for (qsizetype idx = 0; idx < count; idx++)
+        {
+            const BookLevel& entry = entries[reverse ? count - 1 - idx : idx];
+
+            QVariantMap item;
+            item["price"] = FormatNumber(entry.price);
+            item["amount"] = FormatNumber(entry.amount);
+            result.append(item);
         }
-        else
-            for (const auto& entry : entries)
-            {
-                QVariantMap item;
-                item["price"] = entry.price;
-                item["amount"] = entry.amount;
-                result.append(item);
-            }
 
         return result;
     }
 
-
-}
\ No newline at end of file
+}
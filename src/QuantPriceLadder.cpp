@@ -0,0 +1,333 @@
+#include "QuantPriceLadder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtAlgorithms>
+
+namespace
+{
+	// A price within this fraction of a tick from the grid is on it
+	constexpr double grid_tolerance = 1e-6;
+	constexpr qint64 word_bits = 64;
+
+	qint64 AlignDown(qint64 tick)
+	{
+		return tick >= 0 ? tick / word_bits * word_bits : -((-tick + word_bits - 1) / word_bits) * word_bits;
+	}
+
+	qint64 WindowSize(int window_ticks)
+	{
+		// Power of two, whole bitmap words
+		qint64 window = word_bits;
+		while (window < window_ticks)
+			window <<= 1;
+		return window;
+	}
+}
+
+namespace Quant
+{
+	QuantPriceLadder::QuantPriceLadder(bool is_bids, double tick_size, int window_ticks)
+		: m_is_bids(is_bids), m_tick_size(tick_size), m_window(WindowSize(window_ticks))
+	{
+		m_mask = m_window - 1;
+		m_slots.resize(static_cast<size_t>(m_window));
+		m_occupied.resize(static_cast<size_t>(m_window / word_bits), 0);
+	}
+
+	void QuantPriceLadder::Clear()
+	{
+		std::fill(m_occupied.begin(), m_occupied.end(), 0);
+		m_overflow.clear();
+		m_ring_count = 0;
+		m_has_ring_best = false;
+		m_size = 0;
+		m_anchored = false;
+	}
+
+	bool QuantPriceLadder::ToTick(double price, qint64& tick) const
+	{
+		if (m_tick_size <= 0.0 || !std::isfinite(price) || price <= 0.0)
+			return false;
+
+		const double ticks = price / m_tick_size;
+		tick = std::llround(ticks);
+		return std::abs(ticks - static_cast<double>(tick)) <= grid_tolerance;
+	}
+
+	bool QuantPriceLadder::IsOccupied(qint64 tick) const
+	{
+		const qint64 slot = tick & m_mask;
+		return (m_occupied[slot / word_bits] >> (slot % word_bits)) & 1;
+	}
+
+	void QuantPriceLadder::Set(const BookLevel& level)
+	{
+		qint64 tick = 0;
+		if (!ToTick(level.price, tick))
+		{
+			SetInOverflow(level);
+			return;
+		}
+
+		// The first level anchors the window
+		if (!m_anchored)
+		{
+			if (level.amount <= 0.0)
+				return;
+
+			m_base_tick = AlignDown(tick - m_window / 2);
+			m_anchored = true;
+		}
+
+		if (InWindow(tick))
+			SetInRing(tick, level);
+		else
+			SetInOverflow(level);
+
+		MaybeRecenter();
+	}
+
+	void QuantPriceLadder::SetInRing(qint64 tick, const BookLevel& level)
+	{
+		const qint64 slot = tick & m_mask;
+		quint64& word = m_occupied[slot / word_bits];
+		const quint64 bit = quint64(1) << (slot % word_bits);
+		const bool occupied = word & bit;
+
+		if (level.amount <= 0.0)
+		{
+			if (!occupied)
+				return;
+
+			word &= ~bit;
+			m_ring_count--;
+			m_size--;
+
+			if (tick == m_ring_best_tick)
+				RescanRingBest();
+			return;
+		}
+
+		m_slots[slot] = level;
+		if (!occupied)
+		{
+			word |= bit;
+			m_ring_count++;
+			m_size++;
+		}
+
+		if (!m_has_ring_best || BetterTick(tick, m_ring_best_tick))
+		{
+			m_ring_best_tick = tick;
+			m_has_ring_best = true;
+		}
+	}
+
+	void QuantPriceLadder::SetInOverflow(const BookLevel& level)
+	{
+		auto order = [this](const BookLevel& a, const BookLevel& b) { return BetterPrice(a.price, b.price); };
+		auto it = std::lower_bound(m_overflow.begin(), m_overflow.end(), level, order);
+		const bool found = it != m_overflow.end() && it->price == level.price;
+
+		if (level.amount <= 0.0)
+		{
+			if (found)
+			{
+				m_overflow.erase(it);
+				m_size--;
+			}
+		}
+		else if (found)
+			it->amount = level.amount;
+		else
+		{
+			m_overflow.insert(it, level);
+			m_size++;
+		}
+	}
+
+	bool QuantPriceLadder::NextWorse(qint64 from_tick, qint64& found) const
+	{
+		const qint64 window_end = m_base_tick + m_window;
+
+		if (m_is_bids)
+		{
+			// Bids get worse downwards
+			for (qint64 tick = std::min(from_tick, window_end - 1); tick >= m_base_tick; )
+			{
+				const qint64 slot = tick & m_mask;
+				const int bit = static_cast<int>(slot % word_bits);
+				quint64 word = m_occupied[slot / word_bits];
+				if (bit < word_bits - 1)
+					word &= (quint64(1) << (bit + 1)) - 1;
+
+				if (word)
+				{
+					found = tick - bit + (word_bits - 1 - qCountLeadingZeroBits(word));
+					return true;
+				}
+				tick -= bit + 1;
+			}
+		}
+		else
+		{
+			// Asks get worse upwards
+			for (qint64 tick = std::max(from_tick, m_base_tick); tick < window_end; )
+			{
+				const qint64 slot = tick & m_mask;
+				const int bit = static_cast<int>(slot % word_bits);
+				const quint64 word = m_occupied[slot / word_bits] & ~((quint64(1) << bit) - 1);
+
+				if (word)
+				{
+					found = tick - bit + qCountTrailingZeroBits(word);
+					return true;
+				}
+				tick += word_bits - bit;
+			}
+		}
+		return false;
+	}
+
+	void QuantPriceLadder::RescanRingBest()
+	{
+		if (m_ring_count == 0)
+		{
+			m_has_ring_best = false;
+			return;
+		}
+
+		const qint64 from = m_is_bids ? m_base_tick + m_window - 1 : m_base_tick;
+		m_has_ring_best = NextWorse(from, m_ring_best_tick);
+	}
+
+	BookLevel QuantPriceLadder::Best() const
+	{
+		const bool has_overflow = !m_overflow.empty();
+		if (!m_has_ring_best)
+			return has_overflow ? m_overflow.front() : BookLevel();
+
+		const BookLevel& ring_best = m_slots[m_ring_best_tick & m_mask];
+		if (has_overflow && BetterPrice(m_overflow.front().price, ring_best.price))
+			return m_overflow.front();
+		return ring_best;
+	}
+
+	double QuantPriceLadder::AmountAt(double price) const
+	{
+		qint64 tick = 0;
+		if (ToTick(price, tick) && InWindow(tick))
+			return IsOccupied(tick) ? m_slots[tick & m_mask].amount : 0.0;
+
+		auto order = [this](const BookLevel& a, const BookLevel& b) { return BetterPrice(a.price, b.price); };
+		auto it = std::lower_bound(m_overflow.begin(), m_overflow.end(), BookLevel{ price, 0.0 }, order);
+		return (it != m_overflow.end() && it->price == price) ? it->amount : 0.0;
+	}
+
+	void QuantPriceLadder::CopyLevels(QVector<BookLevel>& out, int max_levels) const
+	{
+		out.clear();
+		const int limit = max_levels > 0 ? std::min(max_levels, m_size) : m_size;
+
+		// Merge of the ring (walked through the bitmap) and the overflow, both best first
+		qint64 tick = 0;
+		bool has_ring = m_has_ring_best;
+		if (has_ring)
+			tick = m_ring_best_tick;
+
+		auto overflow = m_overflow.cbegin();
+		while (out.size() < limit)
+		{
+			const bool has_overflow = overflow != m_overflow.cend();
+			if (!has_ring && !has_overflow)
+				break;
+
+			if (has_ring && (!has_overflow || !BetterPrice(overflow->price, m_slots[tick & m_mask].price)))
+			{
+				out.append(m_slots[tick & m_mask]);
+				has_ring = NextWorse(m_is_bids ? tick - 1 : tick + 1, tick);
+			}
+			else
+			{
+				out.append(*overflow);
+				++overflow;
+			}
+		}
+	}
+
+	void QuantPriceLadder::MaybeRecenter()
+	{
+		if (m_size == 0)
+			return;
+
+		qint64 best_tick = 0;
+		if (!ToTick(Best().price, best_tick))
+			return;
+
+		// Hysteresis: only a best price outside the central half moves the window
+		const qint64 quarter = m_window / 4;
+		if (best_tick >= m_base_tick + quarter && best_tick < m_base_tick + m_window - quarter)
+			return;
+
+		Recenter(best_tick);
+	}
+
+	void QuantPriceLadder::Recenter(qint64 center_tick)
+	{
+		const qint64 new_base = AlignDown(center_tick - m_window / 2);
+		if (new_base == m_base_tick)
+			return;
+
+		const qint64 old_base = m_base_tick;
+		auto in_new_window = [new_base, this](qint64 tick) { return tick >= new_base && tick < new_base + m_window; };
+
+		// Ring levels that fall outside the new window spill into the overflow
+		std::vector<BookLevel> spilled;
+		for (size_t word_idx = 0; word_idx < m_occupied.size(); word_idx++)
+		{
+			quint64 word = m_occupied[word_idx];
+			while (word)
+			{
+				const int bit = qCountTrailingZeroBits(word);
+				word &= word - 1;
+
+				const qint64 slot = static_cast<qint64>(word_idx) * word_bits + bit;
+				const qint64 tick = old_base + ((slot - old_base) & m_mask);
+				if (in_new_window(tick))
+					continue;
+
+				spilled.push_back(m_slots[slot]);
+				m_occupied[word_idx] &= ~(quint64(1) << bit);
+				m_ring_count--;
+			}
+		}
+
+		m_base_tick = new_base;
+
+		// Overflow levels now inside the window move into their slots
+		auto moved = std::remove_if(m_overflow.begin(), m_overflow.end(), [this](const BookLevel& level)
+			{
+				qint64 tick = 0;
+				if (!ToTick(level.price, tick) || !InWindow(tick))
+					return false;
+
+				const qint64 slot = tick & m_mask;
+				m_slots[slot] = level;
+				m_occupied[slot / word_bits] |= quint64(1) << (slot % word_bits);
+				m_ring_count++;
+				return true;
+			});
+		m_overflow.erase(moved, m_overflow.end());
+
+		if (!spilled.empty())
+		{
+			m_overflow.insert(m_overflow.end(), spilled.begin(), spilled.end());
+			std::sort(m_overflow.begin(), m_overflow.end(), [this](const BookLevel& a, const BookLevel& b) { return BetterPrice(a.price, b.price); });
+		}
+
+		RescanRingBest();
+		m_recenters++;
+	}
+}
@@ -0,0 +1,375 @@
+#include "QuantPropagator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr double min_decay_seconds = 1e-9;
+
+	int FftSize(int count)
+	{
+		// Linear convolution of two count-long sequences without wrap-around
+		int size = 1;
+		while (size < 2 * count)
+			size <<= 1;
+		return size;
+	}
+
+	// Decay candidates of Calibrate() when none are given: 1 s to 10 min, evenly spaced in log
+	constexpr double calibration_min_decay = 1.0;
+	constexpr double calibration_max_decay = 600.0;
+	constexpr int calibration_decay_steps = 25;
+
+	bool SameShape(const Quant::PropagatorParams& lhs, const Quant::PropagatorParams& rhs)
+	{
+		return lhs.kernel == rhs.kernel && lhs.decay_seconds == rhs.decay_seconds && lhs.exponent == rhs.exponent;
+	}
+}
+
+namespace Quant
+{
+	QuantPropagator::QuantPropagator(const PropagatorParams& params)
+	{
+		SetParams(params);
+	}
+
+	void QuantPropagator::SetParams(const PropagatorParams& params)
+	{
+		PropagatorParams next = params;
+		next.decay_seconds = std::max(next.decay_seconds, min_decay_seconds);
+		next.volume_scale = next.volume_scale > 0.0 ? next.volume_scale : 1.0;
+
+		const bool same_shape = SameShape(next, m_params);
+		const bool same_scaling = next.volume_exponent == m_params.volume_exponent && next.volume_scale == m_params.volume_scale;
+		if (!same_shape)
+		{
+			m_spectrum_count = 0;
+			m_lags_count = 0;
+		}
+
+		// Live fills were scaled and decayed with the old parameters
+		m_params = next;
+		if (!same_shape || !same_scaling)
+			ResetFills();
+	}
+
+	double QuantPropagator::UnitKernel(double lag_seconds) const
+	{
+		if (m_params.kernel == PROPAGATOR_KERNEL::EXPONENTIAL)
+			return std::exp(-lag_seconds / m_params.decay_seconds);
+		return std::pow(1.0 + lag_seconds / m_params.decay_seconds, -m_params.exponent);
+	}
+
+	double QuantPropagator::Kernel(double lag_seconds) const
+	{
+		return m_params.strength * UnitKernel(lag_seconds);
+	}
+
+	double QuantPropagator::ScaledVolume(double volume) const
+	{
+		if (volume == 0.0)
+			return 0.0;
+
+		const double scaled = std::pow(std::abs(volume) / m_params.volume_scale, m_params.volume_exponent);
+		return volume > 0.0 ? scaled : -scaled;
+	}
+
+	PROPAGATOR_METHOD QuantPropagator::Resolve(PROPAGATOR_METHOD method, int count) const
+	{
+		const bool exponential = m_params.kernel == PROPAGATOR_KERNEL::EXPONENTIAL;
+		if (method == PROPAGATOR_METHOD::RECURSIVE && !exponential)
+			method = PROPAGATOR_METHOD::AUTO;
+
+		if (method != PROPAGATOR_METHOD::AUTO)
+			return method;
+		if (exponential)
+			return PROPAGATOR_METHOD::RECURSIVE;
+		return count >= fft_threshold ? PROPAGATOR_METHOD::FFT : PROPAGATOR_METHOD::DIRECT;
+	}
+
+	void QuantPropagator::ImpactPath(const double* volumes, int count, double slice_seconds, double* impact, PROPAGATOR_METHOD method)
+	{
+		if (count <= 0)
+			return;
+
+		m_scaled.resize(count);
+		for (int idx = 0; idx < count; idx++)
+			m_scaled[idx] = ScaledVolume(volumes[idx]);
+
+		switch (Resolve(method, count))
+		{
+		case PROPAGATOR_METHOD::RECURSIVE: Recursive(m_scaled.data(), count, slice_seconds, impact); break;
+		case PROPAGATOR_METHOD::FFT: Convolve(m_scaled.data(), count, slice_seconds, impact); break;
+		default: Direct(m_scaled.data(), count, slice_seconds, impact); break;
+		}
+
+		for (int idx = 0; idx < count; idx++)
+			impact[idx] *= m_params.strength;
+	}
+
+	double QuantPropagator::ScheduleCost(const double* volumes, int count, double slice_seconds, PROPAGATOR_METHOD method)
+	{
+		if (count <= 0)
+			return 0.0;
+
+		m_impact.resize(count);
+		ImpactPath(volumes, count, slice_seconds, m_impact.data(), method);
+
+		double cost = 0.0;
+		for (int idx = 0; idx < count; idx++)
+			cost += volumes[idx] * m_impact[idx];
+		return cost;
+	}
+
+	double QuantPropagator::UniformScheduleCost(double quantity, int slices, double slice_seconds, PROPAGATOR_METHOD method)
+	{
+		if (slices <= 0)
+			return 0.0;
+
+		m_volumes.assign(slices, quantity / slices);
+		return ScheduleCost(m_volumes.data(), slices, slice_seconds, method);
+	}
+
+	void QuantPropagator::Direct(const double* scaled, int count, double slice_seconds, double* impact)
+	{
+		if (m_lags_count < count || m_lags_slice_seconds != slice_seconds)
+		{
+			m_lags.resize(count);
+			for (int lag = 0; lag < count; lag++)
+				m_lags[lag] = UnitKernel(lag * slice_seconds);
+			m_lags_count = count;
+			m_lags_slice_seconds = slice_seconds;
+		}
+
+		for (int idx = 0; idx < count; idx++)
+		{
+			double sum = 0.5 * scaled[idx];
+			for (int earlier = 0; earlier < idx; earlier++)
+				sum += m_lags[idx - earlier] * scaled[earlier];
+			impact[idx] = sum;
+		}
+	}
+
+	void QuantPropagator::Recursive(const double* scaled, int count, double slice_seconds, double* impact) const
+	{
+		// With G(k dt) = a^k, the impact of the earlier slices decays by a per slice and gains the last one
+		const double decay = std::exp(-slice_seconds / m_params.decay_seconds);
+		double earlier = 0.0;
+		for (int idx = 0; idx < count; idx++)
+		{
+			impact[idx] = earlier + 0.5 * scaled[idx];
+			earlier = decay * (earlier + scaled[idx]);
+		}
+	}
+
+	void QuantPropagator::Convolve(const double* scaled, int count, double slice_seconds, double* impact)
+	{
+		PrepareSpectrum(count, slice_seconds);
+
+		const int size = static_cast<int>(m_kernel_spectrum.size());
+		m_signal.assign(size, std::complex<double>());
+		for (int idx = 0; idx < count; idx++)
+			m_signal[idx] = scaled[idx];
+
+		Transform(m_signal, false);
+		for (int idx = 0; idx < size; idx++)
+		{
+			// Written out: std::complex's operator* checks for infinities on every product
+			const double re = m_signal[idx].real() * m_kernel_spectrum[idx].real() - m_signal[idx].imag() * m_kernel_spectrum[idx].imag();
+			const double im = m_signal[idx].real() * m_kernel_spectrum[idx].imag() + m_signal[idx].imag() * m_kernel_spectrum[idx].real();
+			m_signal[idx] = { re, im };
+		}
+		Transform(m_signal, true);
+
+		for (int idx = 0; idx < count; idx++)
+			impact[idx] = m_signal[idx].real() / size;
+	}
+
+	void QuantPropagator::PrepareSpectrum(int count, double slice_seconds)
+	{
+		if (m_spectrum_count == count && m_spectrum_slice_seconds == slice_seconds)
+			return;
+
+		const int size = FftSize(count);
+		if (static_cast<int>(m_bit_reversed.size()) != size)
+		{
+			int bits = 0;
+			while ((1 << bits) < size)
+				bits++;
+
+			m_bit_reversed.resize(size);
+			for (int idx = 0; idx < size; idx++)
+			{
+				int reversed = 0;
+				for (int bit = 0; bit < bits; bit++)
+					reversed |= ((idx >> bit) & 1) << (bits - 1 - bit);
+				m_bit_reversed[idx] = reversed;
+			}
+
+			const double pi = std::acos(-1.0);
+			m_twiddles.resize(size / 2);
+			for (int idx = 0; idx < size / 2; idx++)
+				m_twiddles[idx] = std::polar(1.0, -2.0 * pi * idx / size);
+		}
+
+		// Half the kernel at lag 0 for the slice's own volume, as in Direct()
+		m_kernel_spectrum.assign(size, std::complex<double>());
+		m_kernel_spectrum[0] = 0.5;
+		for (int lag = 1; lag < count; lag++)
+			m_kernel_spectrum[lag] = UnitKernel(lag * slice_seconds);
+		Transform(m_kernel_spectrum, false);
+
+		m_spectrum_count = count;
+		m_spectrum_slice_seconds = slice_seconds;
+	}
+
+	void QuantPropagator::Transform(std::vector<std::complex<double>>& data, bool inverse) const
+	{
+		// Iterative radix-2 Cooley-Tukey; the inverse is left unscaled
+		const int size = static_cast<int>(data.size());
+		for (int idx = 0; idx < size; idx++)
+		{
+			if (idx < m_bit_reversed[idx])
+				std::swap(data[idx], data[m_bit_reversed[idx]]);
+		}
+
+		for (int length = 2; length <= size; length <<= 1)
+		{
+			const int half = length / 2;
+			const int stride = size / length;
+			for (int start = 0; start < size; start += length)
+			{
+				for (int k = 0; k < half; k++)
+				{
+					const std::complex<double>& twiddle = m_twiddles[k * stride];
+					const double w_re = twiddle.real();
+					const double w_im = inverse ? -twiddle.imag() : twiddle.imag();
+
+					std::complex<double>& even = data[start + k];
+					std::complex<double>& odd = data[start + k + half];
+					const double t_re = odd.real() * w_re - odd.imag() * w_im;
+					const double t_im = odd.real() * w_im + odd.imag() * w_re;
+					odd = { even.real() - t_re, even.imag() - t_im };
+					even = { even.real() + t_re, even.imag() + t_im };
+				}
+			}
+		}
+	}
+
+	void QuantPropagator::RecordFill(double volume, double time_seconds)
+	{
+		const double scaled = ScaledVolume(volume);
+
+		if (m_params.kernel == PROPAGATOR_KERNEL::EXPONENTIAL)
+		{
+			m_live_impact = m_live_impact * std::exp(-(time_seconds - m_live_time) / m_params.decay_seconds) + scaled;
+			m_live_time = time_seconds;
+			return;
+		}
+
+		if (static_cast<int>(m_fill_times.size()) < max_history)
+		{
+			m_fill_times.push_back(time_seconds);
+			m_fill_scaled.push_back(scaled);
+			return;
+		}
+
+		// The oldest fill has decayed the most; it makes room for the new one
+		m_fill_times[m_fill_next] = time_seconds;
+		m_fill_scaled[m_fill_next] = scaled;
+		m_fill_next = (m_fill_next + 1) % max_history;
+	}
+
+	double QuantPropagator::ImpactAt(double time_seconds) const
+	{
+		if (m_params.kernel == PROPAGATOR_KERNEL::EXPONENTIAL)
+			return m_params.strength * m_live_impact * std::exp(-std::max(0.0, time_seconds - m_live_time) / m_params.decay_seconds);
+
+		double impact = 0.0;
+		for (size_t idx = 0; idx < m_fill_times.size(); idx++)
+		{
+			if (m_fill_times[idx] <= time_seconds)
+				impact += UnitKernel(time_seconds - m_fill_times[idx]) * m_fill_scaled[idx];
+		}
+		return m_params.strength * impact;
+	}
+
+	PropagatorFit QuantPropagator::Calibrate(const PropagatorParams& shape, const std::vector<PropagatorFill>& fills,
+		const std::vector<PriceObservation>& path, const std::vector<double>& decay_candidates)
+	{
+		PropagatorFit fit;
+		fit.observations = static_cast<int>(path.size());
+		if (fills.empty() || path.empty())
+			return fit;
+
+		std::vector<double> decays = decay_candidates;
+		if (decays.empty())
+		{
+			const double step = std::log(calibration_max_decay / calibration_min_decay) / (calibration_decay_steps - 1);
+			for (int idx = 0; idx < calibration_decay_steps; idx++)
+				decays.push_back(calibration_min_decay * std::exp(step * idx));
+		}
+
+		double moves_squared = 0.0;
+		for (const PriceObservation& observation : path)
+			moves_squared += observation.price_move * observation.price_move;
+
+		// Unit-strength model; the impact at each observation is then strength * unit
+		PropagatorParams params = shape;
+		params.strength = 1.0;
+		QuantPropagator model(params);
+
+		std::vector<double> unit(path.size());
+		for (double decay : decays)
+		{
+			params.decay_seconds = decay;
+			model.SetParams(params);
+
+			for (size_t obs = 0; obs < path.size(); obs++)
+			{
+				double impact = 0.0;
+				for (const PropagatorFill& fill : fills)
+				{
+					if (fill.time_seconds <= path[obs].time_seconds)
+						impact += model.UnitKernel(path[obs].time_seconds - fill.time_seconds) * model.ScaledVolume(fill.volume);
+				}
+				unit[obs] = impact;
+			}
+
+			double xx = 0.0;
+			double xy = 0.0;
+			for (size_t obs = 0; obs < path.size(); obs++)
+			{
+				xx += unit[obs] * unit[obs];
+				xy += unit[obs] * path[obs].price_move;
+			}
+			if (xx <= 0.0 || xy <= 0.0)
+				continue;
+
+			// Least squares in the strength alone; the residual is sum(y^2) - xy^2 / xx
+			const double strength = xy / xx;
+			const double residual = std::max(0.0, moves_squared - xy * strength);
+			if (fit.valid && residual >= fit.residual)
+				continue;
+
+			fit.valid = true;
+			fit.params = model.Params();
+			fit.params.strength = strength;
+			fit.residual = residual;
+		}
+
+		if (fit.valid)
+			fit.r_squared = moves_squared > 0.0 ? 1.0 - fit.residual / moves_squared : 1.0;
+		return fit;
+	}
+
+	void QuantPropagator::ResetFills()
+	{
+		m_live_impact = 0.0;
+		m_live_time = 0.0;
+		m_fill_times.clear();
+		m_fill_scaled.clear();
+		m_fill_next = 0;
+	}
+}
@@ -0,0 +1,247 @@
+#include "QuantResultsJournal.h"
+
+#include <chrono>
+#include <cstring>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using namespace Quant;
+
+	constexpr int idle_sleep_ms = 1;
+
+	quint64 RingCapacity(int requested)
+	{
+		quint64 capacity = 1;
+		while (capacity < static_cast<quint64>(qMax(2, requested)))
+			capacity <<= 1;
+		return capacity;
+	}
+}
+
+namespace Quant
+{
+	QuantResultsJournal::QuantResultsJournal(const ResultsJournalConfig& config)
+		: m_config(config)
+	{
+		const quint64 capacity = RingCapacity(m_config.capacity);
+		m_ring.resize(capacity);
+		m_mask = capacity - 1;
+	}
+
+	QuantResultsJournal::~QuantResultsJournal()
+	{
+		Stop();
+	}
+
+	bool QuantResultsJournal::Start()
+	{
+		if (m_running.load())
+			return true;
+
+		if (!QDir().mkpath(m_config.directory))
+		{
+			qWarning() << "Results journal: cannot create" << m_config.directory;
+			return false;
+		}
+
+		const QString name = "results-" + QDateTime::currentDateTimeUtc().toString("yyyyMMdd-HHmmss") + JournalFormat::file_suffix;
+		m_file.setFileName(QDir(m_config.directory).filePath(name));
+		if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qWarning() << "Results journal: cannot open" << m_file.fileName();
+			return false;
+		}
+
+		m_block = QByteArray(JournalFormat::block_size, '\0');
+		m_block_offset = 0;
+		m_block_records = 0;
+
+		m_running.store(true);
+		m_writer = std::thread(&QuantResultsJournal::WriterLoop, this);
+		return true;
+	}
+
+	void QuantResultsJournal::Stop()
+	{
+		if (!m_running.exchange(false))
+			return;
+
+		// The writer drains what is left before leaving
+		if (m_writer.joinable())
+			m_writer.join();
+
+		m_file.close();
+	}
+
+	bool QuantResultsJournal::Append(const JournalFormat::JournalRecord& record)
+	{
+		const quint64 head = m_head.load(std::memory_order_relaxed);
+		const quint64 tail = m_tail.load(std::memory_order_acquire);
+
+		if (head - tail > m_mask)
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_ring[head & m_mask] = record;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	int QuantResultsJournal::Drain()
+	{
+		const quint64 tail = m_tail.load(std::memory_order_relaxed);
+		const quint64 head = m_head.load(std::memory_order_acquire);
+
+		for (quint64 idx = tail; idx < head; idx++)
+		{
+			const JournalFormat::JournalRecord& record = m_ring[idx & m_mask];
+
+			auto* header = reinterpret_cast<JournalFormat::BlockHeader*>(m_block.data());
+			if (m_block_records == 0)
+				header->first_timestamp_ns = record.timestamp_ns;
+
+			std::memcpy(m_block.data() + sizeof(JournalFormat::BlockHeader) + m_block_records * sizeof(JournalFormat::JournalRecord), &record, sizeof(record));
+			header->last_timestamp_ns = record.timestamp_ns;
+			m_block_records++;
+
+			if (m_block_records == JournalFormat::records_per_block)
+				WriteBlock();
+		}
+
+		// Frees the slots for the producer
+		m_tail.store(head, std::memory_order_release);
+		return static_cast<int>(head - tail);
+	}
+
+	bool QuantResultsJournal::WriteBlock()
+	{
+		auto* header = reinterpret_cast<JournalFormat::BlockHeader*>(m_block.data());
+		header->magic = JournalFormat::magic;
+		header->version = JournalFormat::version;
+		header->record_size = sizeof(JournalFormat::JournalRecord);
+		header->record_count = static_cast<quint32>(m_block_records);
+
+		// A partial block is rewritten in place until it fills
+		const bool written = m_file.seek(m_block_offset) && m_file.write(m_block) == m_block.size();
+		if (!written)
+			qWarning() << "Results journal: write failed" << m_file.errorString();
+
+		m_written.store(m_block_offset / JournalFormat::block_size * JournalFormat::records_per_block + m_block_records, std::memory_order_relaxed);
+
+		if (m_block_records == JournalFormat::records_per_block)
+		{
+			m_block_offset += JournalFormat::block_size;
+			m_block_records = 0;
+			m_block.fill('\0');
+		}
+		return written;
+	}
+
+	void QuantResultsJournal::Sync()
+	{
+		m_file.flush();
+#ifdef Q_OS_WIN
+		_commit(m_file.handle());
+#else
+		::fsync(m_file.handle());
+#endif
+	}
+
+	void QuantResultsJournal::WriterLoop()
+	{
+		QElapsedTimer since_flush;
+		QElapsedTimer since_sync;
+		since_flush.start();
+		since_sync.start();
+
+		bool dirty = false;
+		while (true)
+		{
+			const bool running = m_running.load(std::memory_order_acquire);
+			const int drained = Drain();
+			dirty = dirty || drained > 0;
+
+			if (dirty && (!running || since_flush.elapsed() >= m_config.flush_interval_ms))
+			{
+				if (m_block_records > 0)
+					WriteBlock();
+				dirty = false;
+				since_flush.restart();
+			}
+
+			if (!running || since_sync.elapsed() >= m_config.fsync_interval_ms)
+			{
+				Sync();
+				since_sync.restart();
+			}
+
+			if (!running)
+				break;
+
+			if (drained == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(idle_sleep_ms));
+		}
+	}
+
+	QuantResultsJournalReader::QuantResultsJournalReader(const QString& path)
+		: m_file(path)
+	{
+		if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < JournalFormat::block_size)
+			return;
+
+		m_block_count = m_file.size() / JournalFormat::block_size;
+		m_data = m_file.map(0, m_block_count * JournalFormat::block_size);
+		if (!m_data)
+			return;
+
+		m_valid = true;
+		for (qint64 block = 0; block < m_block_count; block++)
+		{
+			JournalFormat::BlockHeader header;
+			std::memcpy(&header, m_data + block * JournalFormat::block_size, sizeof(header));
+			if (header.magic != JournalFormat::magic || header.version != JournalFormat::version)
+			{
+				m_valid = false;
+				return;
+			}
+			m_record_count += header.record_count;
+		}
+	}
+
+	bool QuantResultsJournalReader::ForEach(const std::function<void(const JournalFormat::JournalRecord&)>& callback) const
+	{
+		if (!m_valid)
+			return false;
+
+		JournalFormat::JournalRecord record;
+		for (qint64 block = 0; block < m_block_count; block++)
+		{
+			const uchar* data = m_data + block * JournalFormat::block_size;
+
+			JournalFormat::BlockHeader header;
+			std::memcpy(&header, data, sizeof(header));
+			if (header.record_size != sizeof(JournalFormat::JournalRecord) || header.record_count > static_cast<quint32>(JournalFormat::records_per_block))
+				return false;
+
+			for (quint32 idx = 0; idx < header.record_count; idx++)
+			{
+				std::memcpy(&record, data + sizeof(header) + idx * sizeof(record), sizeof(record));
+				callback(record);
+			}
+		}
+		return true;
+	}
+}
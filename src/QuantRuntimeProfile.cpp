@@ -0,0 +1,266 @@
+#include "QuantRuntimeProfile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+
+#ifdef Q_OS_LINUX
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+	using namespace Quant;
+
+	// Written by Apply() before any pipeline thread starts, read-only afterwards
+	RuntimeProfileConfig profile_config;
+
+	std::mutex report_mutex;
+	RuntimeProfileReport report;
+
+	std::atomic<int> next_core[thread_role_count];
+	std::atomic<int> pinned[thread_role_count];
+	std::atomic<int> pin_failures[thread_role_count];
+
+	// Threads pinned to each core; the first one may spin there
+	constexpr int max_cores = 1024;
+	std::atomic<int> core_threads[max_cores];
+
+	thread_local bool thread_pinned = false;
+	thread_local bool thread_spins = false;
+
+	const char* RoleName(int role)
+	{
+		switch (static_cast<THREAD_ROLE>(role))
+		{
+		case THREAD_ROLE::INGEST: return "ingest";
+		case THREAD_ROLE::BOOK: return "book";
+		case THREAD_ROLE::CALCULATOR: return "calculator";
+		}
+		return "unknown";
+	}
+
+#ifdef Q_OS_LINUX
+	// "2-5,7" as listed under /sys/devices/system/cpu
+	QVector<int> ParseCpuList(const QString& list)
+	{
+		QVector<int> cpus;
+		for (const QString& part : list.trimmed().split(',', Qt::SkipEmptyParts))
+		{
+			const QStringList bounds = part.split('-');
+			bool first_ok = false;
+			bool last_ok = false;
+			const int first = bounds.value(0).toInt(&first_ok);
+			const int last = bounds.size() > 1 ? bounds.value(1).toInt(&last_ok) : first;
+			if (!first_ok || (bounds.size() > 1 && !last_ok))
+				continue;
+
+			for (int cpu = first; cpu <= last; cpu++)
+				cpus.append(cpu);
+		}
+		return cpus;
+	}
+
+	// Touches a stack frame and the heap reserve, and keeps the heap from shrinking back
+	void Prefault(int prefault_mb)
+	{
+		constexpr size_t stack_bytes = 256 * 1024;
+		volatile char stack[stack_bytes];
+		for (size_t offset = 0; offset < stack_bytes; offset += 4096)
+			stack[offset] = 0;
+
+		if (prefault_mb <= 0)
+			return;
+
+		// Freed memory stays with the allocator instead of going back to the kernel
+		mallopt(M_TRIM_THRESHOLD, -1);
+		mallopt(M_MMAP_MAX, 0);
+
+		const size_t heap_bytes = static_cast<size_t>(prefault_mb) * 1024 * 1024;
+		if (char* reserve = static_cast<char*>(malloc(heap_bytes)))
+		{
+			std::memset(reserve, 0, heap_bytes);
+			free(reserve);
+		}
+	}
+#endif
+}
+
+namespace Quant
+{
+	std::atomic<bool> QuantRuntimeProfile::s_enabled{ false };
+
+	bool QuantRuntimeProfile::Apply(const RuntimeProfileConfig& config)
+	{
+		std::lock_guard<std::mutex> lock(report_mutex);
+		report = RuntimeProfileReport();
+		report.enabled = config.low_latency;
+		if (!config.low_latency)
+			return false;
+
+#ifdef Q_OS_LINUX
+		report.supported = true;
+		profile_config = config;
+
+		// Cores the scheduler would actually give us, and the ones kept away from other tasks
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		const bool known_affinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+		QVector<int> isolated;
+		QFile isolated_file("/sys/devices/system/cpu/isolated");
+		if (isolated_file.open(QIODevice::ReadOnly))
+			isolated = ParseCpuList(QString::fromLatin1(isolated_file.readAll()));
+
+		for (const QVector<int>& cores : profile_config.cores)
+		{
+			for (int core : cores)
+			{
+				if (core < 0 || core >= CPU_SETSIZE || (known_affinity && !CPU_ISSET(core, &allowed)))
+				{
+					if (!report.unavailable_cores.contains(core))
+						report.unavailable_cores.append(core);
+				}
+				else if (!isolated.contains(core) && !report.shared_cores.contains(core))
+					report.shared_cores.append(core);
+			}
+		}
+
+		if (config.lock_memory)
+		{
+			if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+			{
+				report.memory_locked = true;
+				Prefault(config.prefault_mb);
+			}
+			else
+				report.memory_error = QString::fromLocal8Bit(strerror(errno));
+		}
+
+		s_enabled.store(true, std::memory_order_release);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void QuantRuntimeProfile::PinCurrentThread(THREAD_ROLE role)
+	{
+		if (thread_pinned || !IsEnabled())
+			return;
+		thread_pinned = true;
+
+#ifdef Q_OS_LINUX
+		const int idx = static_cast<int>(role);
+		const QVector<int>& cores = profile_config.cores[idx];
+		if (cores.isEmpty())
+			return;
+
+		const int core = cores[next_core[idx].fetch_add(1, std::memory_order_relaxed) % cores.size()];
+		if (core < 0 || core >= CPU_SETSIZE)
+		{
+			pin_failures[idx].fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		CPU_SET(core, &cpu_set);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+		{
+			pin_failures[idx].fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		pinned[idx].fetch_add(1, std::memory_order_relaxed);
+
+		// A spinner never yields its core, so only the first thread there may be one
+		const bool first_on_core = core < max_cores && core_threads[core].fetch_add(1, std::memory_order_relaxed) == 0;
+		thread_spins = profile_config.busy_poll && first_on_core;
+#endif
+	}
+
+	bool QuantRuntimeProfile::SpinsCurrentThread()
+	{
+		return thread_spins;
+	}
+
+	int QuantRuntimeProfile::CoreCount(THREAD_ROLE role)
+	{
+		if (!IsEnabled())
+			return 0;
+		return static_cast<int>(profile_config.cores[static_cast<int>(role)].size());
+	}
+
+	RuntimeProfileReport QuantRuntimeProfile::Report()
+	{
+		std::lock_guard<std::mutex> lock(report_mutex);
+		RuntimeProfileReport current = report;
+		for (int role = 0; role < thread_role_count; role++)
+		{
+			current.pinned[role] = pinned[role].load(std::memory_order_relaxed);
+			current.pin_failures[role] = pin_failures[role].load(std::memory_order_relaxed);
+		}
+		return current;
+	}
+
+	void QuantRuntimeProfile::LogReport()
+	{
+		const RuntimeProfileReport current = Report();
+		if (!current.enabled)
+			return;
+
+		if (!current.supported)
+		{
+			qWarning() << "Low-latency profile: only supported on Linux, running with the default scheduling";
+			return;
+		}
+
+		bool isolated = true;
+		for (int role = 0; role < thread_role_count; role++)
+		{
+			const QVector<int>& cores = profile_config.cores[role];
+			if (cores.isEmpty())
+			{
+				qInfo() << "Low-latency profile:" << RoleName(role) << "threads are not pinned";
+				continue;
+			}
+
+			qInfo() << "Low-latency profile:" << RoleName(role) << "cores" << cores << "pinned" << current.pinned[role]
+				<< "threads," << current.pin_failures[role] << "failed";
+			isolated = isolated && current.pin_failures[role] == 0;
+		}
+
+		if (!current.unavailable_cores.isEmpty())
+		{
+			qWarning() << "Low-latency profile: cores outside the process affinity" << current.unavailable_cores;
+			isolated = false;
+		}
+		if (!current.shared_cores.isEmpty())
+		{
+			qWarning() << "Low-latency profile: cores not isolated from the scheduler (isolcpus)" << current.shared_cores;
+			isolated = false;
+		}
+
+		if (profile_config.lock_memory)
+		{
+			if (current.memory_locked)
+				qInfo() << "Low-latency profile: memory locked," << profile_config.prefault_mb << "MB prefaulted";
+			else
+			{
+				qWarning() << "Low-latency profile: mlockall failed:" << current.memory_error << "(needs CAP_IPC_LOCK or a higher RLIMIT_MEMLOCK)";
+				isolated = false;
+			}
+		}
+
+		qInfo() << "Low-latency profile:" << (profile_config.busy_poll ? "busy polling" : "blocking hand-offs") << "-"
+			<< (isolated ? "isolation succeeded" : "isolation incomplete");
+	}
+}
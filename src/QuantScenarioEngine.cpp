@@ -0,0 +1,278 @@
+#include "QuantScenarioEngine.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "QuantInputHandler.h"
+#include "QuantOrderbook.h"
+
+namespace
+{
+	using namespace Quant;
+
+	QString GroupKey(EXCHANGE_API exchange, const QString& symbol)
+	{
+		return EnumConverter::ExchangeToString(exchange) + QLatin1Char('/') + symbol;
+	}
+
+	template <typename ExchangePolicy>
+	void EvaluateRange(const ScenarioGroup& group, int begin, int end, const BookView& book, const BookFeatures& features)
+	{
+		using Calculator = QuantCalculator<ExchangePolicy>;
+		const FeeSchedule& fees = *group.fee_schedule;
+		ScenarioColumns& results = group.results;
+
+		for (int idx = begin; idx < end; idx++)
+		{
+			CalculationInput input;
+			input.order_type = static_cast<ORDER_TYPE>(group.order_type[idx]);
+			input.order_side = static_cast<ORDER_SIDE>(group.order_side[idx]);
+			input.fee_tier = static_cast<FEE_TIER>(group.fee_tier[idx]);
+			input.usd_amount = group.usd_amount[idx];
+			input.volatility_enabled = group.volatility_enabled[idx] != 0;
+			input.volatility = group.volatility[idx];
+
+			const CalculationOutput output = Calculator::Evaluate(input, book, fees, features);
+
+			results.volatility[idx] = output.volatility;
+			results.fees[idx] = output.fees;
+			results.slippage[idx] = output.slippage;
+			results.market_impact[idx] = output.market_impact;
+			results.net_cost[idx] = output.net_cost;
+			results.crypto_amount[idx] = output.crypto_amount;
+			results.maker_ratio[idx] = output.maker_ratio;
+			results.liquidity_exhausted[idx] = output.liquidity_exhausted ? 1 : 0;
+			results.unfilled_usd[idx] = output.unfilled_usd;
+		}
+	}
+
+	template <typename ExchangePolicy>
+	void BindKernels(ScenarioGroup& group)
+	{
+		group.compute_features = &QuantCalculator<ExchangePolicy>::ComputeFeatures;
+		group.evaluate = &EvaluateRange<ExchangePolicy>;
+	}
+
+	bool ResolveKernels(ScenarioGroup& group)
+	{
+		switch (group.exchange)
+		{
+		case EXCHANGE_API::OKX: BindKernels<OKXPolicy>(group); break;
+		case EXCHANGE_API::BINANCE: BindKernels<BinancePolicy>(group); break;
+		case EXCHANGE_API::COINBASE: BindKernels<CoinbasePolicy>(group); break;
+		case EXCHANGE_API::MEXC: BindKernels<MEXCPolicy>(group); break;
+		default: return false;
+		}
+
+		group.fee_schedule = GetFeeSchedule(group.exchange);
+		return group.fee_schedule != nullptr;
+	}
+}
+
+namespace Quant
+{
+	void ScenarioColumns::Resize(size_t count)
+	{
+		volatility.assign(count, 0.0);
+		fees.assign(count, 0.0);
+		slippage.assign(count, 0.0);
+		market_impact.assign(count, 0.0);
+		net_cost.assign(count, 0.0);
+		crypto_amount.assign(count, 0.0);
+		maker_ratio.assign(count, 0.0);
+		liquidity_exhausted.assign(count, 0);
+		unfilled_usd.assign(count, 0.0);
+		book_version = 0;
+	}
+
+	QuantScenarioEngine::QuantScenarioEngine(QObject* parent, int worker_count) : QObject(parent), m_pool(worker_count)
+	{
+	}
+
+	ScenarioId QuantScenarioEngine::AddScenario(const Scenario& scenario)
+	{
+		const ScenarioId id = m_next_id++;
+		m_scenarios.insert(id, scenario);
+		m_dirty = true;
+		return id;
+	}
+
+	bool QuantScenarioEngine::RemoveScenario(ScenarioId id)
+	{
+		if (m_scenarios.remove(id) == 0)
+			return false;
+
+		m_dirty = true;
+		return true;
+	}
+
+	void QuantScenarioEngine::ClearScenarios()
+	{
+		m_scenarios.clear();
+		m_dirty = true;
+	}
+
+	/**
+	 * Expected file format:
+	 *  [
+	 *    { "exchange": "OKX", "symbol": "BTC-USDT-SWAP", "side": "sell", "order_type": "market",
+	 *      "fee_tier": "VIP 2", "usd_amount": 250000, "volatility": 1.5 },
+	 *    ...
+	 *  ]
+	 * "volatility" is optional; when present it overrides the book estimate.
+	 */
+	int QuantScenarioEngine::LoadScenarios(const QString& path)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly))
+			return 0;
+
+		const QJsonDocument json_doc = QJsonDocument::fromJson(file.readAll());
+		if (!json_doc.isArray())
+		{
+			qWarning() << "Scenario file is not a JSON array:" << path;
+			return 0;
+		}
+
+		int added = 0;
+		for (const QJsonValue& value : json_doc.array())
+		{
+			const QJsonObject json_obj = value.toObject();
+
+			Scenario scenario;
+			scenario.exchange = EnumConverter::StringToExchange(json_obj["exchange"].toString());
+			scenario.symbol = json_obj["symbol"].toString();
+			scenario.order_type = EnumConverter::StringToOrderType(json_obj["order_type"].toString());
+			scenario.order_side = json_obj["side"].toString() == "sell" ? ORDER_SIDE::SELL : ORDER_SIDE::BUY;
+			scenario.fee_tier = EnumConverter::StringToFeeTier(json_obj["fee_tier"].toString());
+			scenario.usd_amount = json_obj["usd_amount"].toDouble();
+			scenario.volatility_enabled = json_obj.contains("volatility");
+			scenario.volatility = json_obj["volatility"].toDouble();
+
+			if (scenario.symbol.isEmpty() || scenario.usd_amount <= 0.0)
+				continue;
+
+			AddScenario(scenario);
+			added++;
+		}
+
+		return added;
+	}
+
+	void QuantScenarioEngine::SetOrderbook(QuantOrderbook* orderbook)
+	{
+		for (QuantOrderbook* followed : m_orderbooks)
+			QObject::disconnect(followed, nullptr, this, nullptr);
+		m_orderbooks.clear();
+
+		AddOrderbook(orderbook);
+	}
+
+	void QuantScenarioEngine::AddOrderbook(QuantOrderbook* orderbook)
+	{
+		if (!orderbook || m_orderbooks.contains(orderbook))
+			return;
+
+		m_orderbooks.append(orderbook);
+
+		QObject::connect(orderbook, &QuantOrderbook::orderbookUpdated, this, [this, orderbook]()
+			{
+				OnOrderbookUpdated(orderbook);
+			});
+		QObject::connect(orderbook, &QObject::destroyed, this, [this, orderbook]()
+			{
+				m_orderbooks.removeAll(orderbook);
+			});
+	}
+
+	void QuantScenarioEngine::Compile()
+	{
+		m_groups.clear();
+		m_group_index.clear();
+
+		for (auto it = m_scenarios.cbegin(); it != m_scenarios.cend(); ++it)
+		{
+			const Scenario& scenario = it.value();
+			const QString key = GroupKey(scenario.exchange, scenario.symbol);
+
+			auto found = m_group_index.constFind(key);
+			if (found == m_group_index.cend())
+			{
+				ScenarioGroup group;
+				group.exchange = scenario.exchange;
+				group.symbol = scenario.symbol;
+				if (!ResolveKernels(group))
+				{
+					qWarning() << "Scenario engine: no calculator for" << key;
+					continue;
+				}
+
+				found = m_group_index.insert(key, static_cast<int>(m_groups.size()));
+				m_groups.push_back(std::move(group));
+			}
+
+			ScenarioGroup& group = m_groups[found.value()];
+			group.ids.push_back(it.key());
+			group.order_type.push_back(static_cast<quint8>(scenario.order_type));
+			group.order_side.push_back(static_cast<quint8>(scenario.order_side));
+			group.fee_tier.push_back(static_cast<quint8>(scenario.fee_tier));
+			group.volatility_enabled.push_back(scenario.volatility_enabled ? 1 : 0);
+			group.usd_amount.push_back(scenario.usd_amount);
+			group.volatility.push_back(scenario.volatility);
+		}
+
+		for (ScenarioGroup& group : m_groups)
+			group.results.Resize(group.ids.size());
+
+		m_dirty = false;
+	}
+
+	void QuantScenarioEngine::Evaluate(EXCHANGE_API exchange, const QString& symbol, const BookView& book)
+	{
+		if (m_dirty)
+			Compile();
+
+		const auto found = m_group_index.constFind(GroupKey(exchange, symbol));
+		if (found == m_group_index.cend())
+			return;
+
+		const ScenarioGroup& group = m_groups[found.value()];
+		if (group.results.book_version == book.version && book.version != 0)
+			return;
+
+		// Book features are shared by every scenario of the group
+		const BookFeatures features = group.compute_features(book);
+
+		const int count = static_cast<int>(group.ids.size());
+		const int chunks = (count + chunk_size - 1) / chunk_size;
+
+		m_pool.Run(chunks, [&group, &book, &features, count](int chunk)
+			{
+				const int begin = chunk * chunk_size;
+				group.evaluate(group, begin, qMin(begin + chunk_size, count), book, features);
+			});
+
+		group.results.book_version = book.version;
+		emit ResultsUpdated(symbol, book.version);
+	}
+
+	const ScenarioGroup* QuantScenarioEngine::Group(EXCHANGE_API exchange, const QString& symbol)
+	{
+		if (m_dirty)
+			Compile();
+
+		const auto found = m_group_index.constFind(GroupKey(exchange, symbol));
+		return found == m_group_index.cend() ? nullptr : &m_groups[found.value()];
+	}
+
+	void QuantScenarioEngine::OnOrderbookUpdated(QuantOrderbook* orderbook)
+	{
+		if (m_scenarios.isEmpty())
+			return;
+
+		Evaluate(orderbook->Exchange(), orderbook->Symbol(), orderbook->View());
+	}
+}
@@ -0,0 +1,276 @@
+#include "QuantShmPublisher.h"
+
+#include <new>
+
+#include <QCoreApplication>
+#include <QDebug>
+
+#include "QuantClock.h"
+#include "QuantMetrics.h"
+#include "QuantOrderbook.h"
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using namespace Quant;
+
+	quint64 SlotCount(int requested)
+	{
+		quint64 count = 1;
+		while (count < static_cast<quint64>(qMax(2, requested)))
+			count <<= 1;
+		return count;
+	}
+
+	// Symbols are ASCII; copied without a temporary byte array, NUL padded
+	void CopySymbol(const QString& symbol, char (&out)[ShmFormat::symbol_size])
+	{
+		const int length = qMin<int>(symbol.size(), ShmFormat::symbol_size - 1);
+		for (int idx = 0; idx < length; idx++)
+			out[idx] = symbol[idx].toLatin1();
+	}
+
+	quint32 CopySide(const BookSide& side, ShmFormat::Level (&out)[ShmFormat::max_depth])
+	{
+		const int count = qMin(side.size, ShmFormat::max_depth);
+		for (int idx = 0; idx < count; idx++)
+		{
+			out[idx].price = side[idx].price;
+			out[idx].amount = side[idx].amount;
+		}
+		return static_cast<quint32>(count);
+	}
+
+#ifdef Q_OS_UNIX
+	// A segment left behind by a crashed run is reclaimed, one of a running publisher is not
+	bool OwnedByLiveWriter(const QByteArray& name)
+	{
+		const int fd = shm_open(name.constData(), O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+
+		ShmFormat::SegmentHeader* header = nullptr;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= ShmFormat::segment_header_size)
+		{
+			void* mapping = mmap(nullptr, ShmFormat::segment_header_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (mapping != MAP_FAILED)
+				header = static_cast<ShmFormat::SegmentHeader*>(mapping);
+		}
+		close(fd);
+		if (!header)
+			return false;
+
+		const pid_t pid = static_cast<pid_t>(header->writer_pid);
+		munmap(header, ShmFormat::segment_header_size);
+		return pid > 0 && pid != getpid() && (kill(pid, 0) == 0 || errno == EPERM);
+	}
+#endif
+}
+
+namespace Quant
+{
+	QuantShmPublisher::QuantShmPublisher(const ShmPublisherConfig& config, QObject* parent)
+		: QObject(parent), m_config(config)
+	{
+		m_books.name = "/" + m_config.prefix + ShmFormat::books_suffix;
+		m_books.kind = ShmFormat::BOOK;
+		m_results.name = "/" + m_config.prefix + ShmFormat::results_suffix;
+		m_results.kind = ShmFormat::RESULT;
+
+		QuantMetricsRegistry& registry = QuantMetricsRegistry::Instance();
+		m_books.published = &registry.Counter("quant_shm_records_total", "Records published to shared memory.", "segment=\"books\"");
+		m_results.published = &registry.Counter("quant_shm_records_total", "Records published to shared memory.", "segment=\"results\"");
+	}
+
+	QuantShmPublisher::~QuantShmPublisher()
+	{
+		Stop();
+	}
+
+	bool QuantShmPublisher::Start()
+	{
+		if (IsRunning())
+			return true;
+
+		if (!OpenSegment(m_books, m_config.book_slots, sizeof(ShmFormat::BookRecord))
+			|| !OpenSegment(m_results, m_config.result_slots, sizeof(ShmFormat::ResultRecord)))
+		{
+			Stop();
+			return false;
+		}
+
+		m_running.store(true, std::memory_order_relaxed);
+		qInfo() << "Shared memory: publishing to" << m_books.name << "and" << m_results.name;
+		return true;
+	}
+
+	void QuantShmPublisher::Stop()
+	{
+		m_running.store(false, std::memory_order_relaxed);
+		CloseSegment(m_books);
+		CloseSegment(m_results);
+	}
+
+	bool QuantShmPublisher::OpenSegment(Segment& segment, int slots, std::size_t record_size)
+	{
+#ifdef Q_OS_UNIX
+		const QByteArray name = segment.name.toUtf8();
+		const quint64 slot_count = SlotCount(slots);
+		const quint64 slot_size = ShmFormat::SlotSize(record_size);
+		const std::size_t size = ShmFormat::SegmentSize(slot_count, slot_size);
+
+		int fd = shm_open(name.constData(), O_RDWR | O_CREAT | O_EXCL, 0644);
+		if (fd < 0 && errno == EEXIST)
+		{
+			if (OwnedByLiveWriter(name))
+			{
+				qWarning() << "Shared memory:" << segment.name << "is published by another running process";
+				return false;
+			}
+
+			// Readers of the stale segment keep their mapping, new ones get ours
+			shm_unlink(name.constData());
+			fd = shm_open(name.constData(), O_RDWR | O_CREAT | O_EXCL, 0644);
+		}
+		if (fd < 0)
+		{
+			qWarning() << "Shared memory: cannot create" << segment.name << strerror(errno);
+			return false;
+		}
+
+		if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+		{
+			qWarning() << "Shared memory: cannot size" << segment.name << strerror(errno);
+			close(fd);
+			shm_unlink(name.constData());
+			return false;
+		}
+
+		void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (mapping == MAP_FAILED)
+		{
+			qWarning() << "Shared memory: cannot map" << segment.name << strerror(errno);
+			shm_unlink(name.constData());
+			return false;
+		}
+
+		// Slots start zeroed; the magic goes in last, readers reject the header until then
+		auto* header = new (mapping) ShmFormat::SegmentHeader();
+		header->magic = 0;
+		header->record_kind = segment.kind;
+		header->record_size = static_cast<quint32>(record_size);
+		header->slot_count = slot_count;
+		header->slot_size = slot_size;
+		header->writer_pid = QCoreApplication::applicationPid();
+		header->created_ns = QuantClock::WallNs();
+		std::atomic_thread_fence(std::memory_order_release);
+		header->magic = ShmFormat::magic;
+
+		std::lock_guard<std::mutex> lock(segment.write_mutex);
+		segment.mapping = mapping;
+		segment.size = size;
+		return true;
+#else
+		Q_UNUSED(slots);
+		Q_UNUSED(record_size);
+		qWarning() << "Shared memory: publishing needs a POSIX system," << segment.name << "not created";
+		return false;
+#endif
+	}
+
+	void QuantShmPublisher::CloseSegment(Segment& segment)
+	{
+		std::lock_guard<std::mutex> lock(segment.write_mutex);
+		if (!segment.mapping)
+			return;
+
+#ifdef Q_OS_UNIX
+		munmap(segment.mapping, segment.size);
+		shm_unlink(segment.name.toUtf8().constData());
+#endif
+		segment.mapping = nullptr;
+		segment.size = 0;
+	}
+
+	void QuantShmPublisher::AddOrderbook(QuantOrderbook* orderbook)
+	{
+		// Direct, so the record is copied before the book takes its next update
+		QObject::connect(orderbook, &QuantOrderbook::orderbookUpdated, this, [this, orderbook]()
+			{
+				PublishBook(*orderbook);
+			}, Qt::DirectConnection);
+	}
+
+	void QuantShmPublisher::PublishBook(const QuantOrderbook& orderbook)
+	{
+		if (!IsRunning())
+			return;
+
+		const BookView view = orderbook.View();
+
+		ShmFormat::BookRecord record;
+		record.timestamp_ns = QuantClock::WallNs();
+		record.version = view.version;
+		record.seq_id = orderbook.SequenceId();
+		record.exchange = static_cast<quint8>(orderbook.Exchange());
+		record.stale = orderbook.isStale() ? 1 : 0;
+		record.truncated = view.bids.size > ShmFormat::max_depth || view.asks.size > ShmFormat::max_depth ? 1 : 0;
+		record.bid_count = CopySide(view.bids, record.bids);
+		record.ask_count = CopySide(view.asks, record.asks);
+		CopySymbol(orderbook.Symbol(), record.symbol);
+
+		Write(m_books, &record, sizeof(record));
+	}
+
+	void QuantShmPublisher::PublishResult(const QString& symbol, const JournalFormat::JournalRecord& result)
+	{
+		if (!IsRunning())
+			return;
+
+		ShmFormat::ResultRecord record;
+		record.timestamp_ns = result.timestamp_ns;
+		record.book_version = result.book_version;
+		CopySymbol(symbol, record.symbol);
+		record.exchange = result.exchange;
+		record.order_type = result.order_type;
+		record.order_side = result.order_side;
+		record.fee_tier = result.fee_tier;
+		record.volatility_enabled = result.volatility_enabled;
+		record.liquidity_exhausted = result.liquidity_exhausted;
+		record.usd_amount = result.usd_amount;
+		record.input_volatility = result.input_volatility;
+		record.volatility = result.volatility;
+		record.fees = result.fees;
+		record.slippage = result.slippage;
+		record.market_impact = result.market_impact;
+		record.market_order_cost = result.market_order_cost;
+		record.net_cost = result.net_cost;
+		record.crypto_amount = result.crypto_amount;
+		record.maker_ratio = result.maker_ratio;
+		record.processing_time_ms = result.processing_time_ms;
+
+		Write(m_results, &record, sizeof(record));
+	}
+
+	void QuantShmPublisher::Write(Segment& segment, const void* record, std::size_t record_size)
+	{
+		{
+			std::lock_guard<std::mutex> lock(segment.write_mutex);
+			if (!segment.mapping)
+				return;
+			ShmFormat::WriteRecord(segment.mapping, record, record_size);
+		}
+		segment.published->Add();
+	}
+}
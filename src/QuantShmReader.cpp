@@ -0,0 +1,189 @@
+#include "QuantShmReader.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define QUANT_SHM_POSIX 1
+#endif
+
+namespace
+{
+	using namespace Quant;
+
+	constexpr int latest_attempts = 4;
+
+	std::size_t RecordSize(ShmFormat::RECORD_KIND kind)
+	{
+		return kind == ShmFormat::BOOK ? sizeof(ShmFormat::BookRecord) : sizeof(ShmFormat::ResultRecord);
+	}
+
+	const ShmFormat::SegmentHeader& HeaderOf(const void* segment)
+	{
+		return *static_cast<const ShmFormat::SegmentHeader*>(segment);
+	}
+}
+
+namespace Quant
+{
+	QuantShmReader::~QuantShmReader()
+	{
+		Close();
+	}
+
+	bool QuantShmReader::Open(const std::string& name, ShmFormat::RECORD_KIND kind)
+	{
+		Close();
+		m_name = name;
+		m_kind = kind;
+		m_error.clear();
+
+#ifdef QUANT_SHM_POSIX
+		const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+		{
+			m_error = "cannot open " + name + ": " + strerror(errno);
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < ShmFormat::segment_header_size)
+		{
+			m_error = name + " is not initialized yet";
+			close(fd);
+			return false;
+		}
+
+		void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (mapping == MAP_FAILED)
+		{
+			m_error = "cannot map " + name + ": " + strerror(errno);
+			return false;
+		}
+
+		// The writer fills the header before anything else, a reader racing it retries
+		const ShmFormat::SegmentHeader& header = HeaderOf(mapping);
+		const std::size_t record_size = RecordSize(kind);
+		const bool valid = header.magic == ShmFormat::magic && header.version == ShmFormat::version
+			&& header.record_kind == kind && header.record_size == record_size
+			&& header.slot_count > 0 && (header.slot_count & (header.slot_count - 1)) == 0
+			&& header.slot_size >= ShmFormat::SlotSize(record_size) && header.slot_size % 64 == 0
+			&& ShmFormat::SegmentSize(header.slot_count, header.slot_size) <= static_cast<std::size_t>(info.st_size);
+		if (!valid)
+		{
+			m_error = name + " has an unknown layout or record kind";
+			munmap(mapping, static_cast<std::size_t>(info.st_size));
+			return false;
+		}
+
+		m_segment = mapping;
+		m_mapped_size = static_cast<std::size_t>(info.st_size);
+		m_slot_count = header.slot_count;
+		m_writer_pid = header.writer_pid;
+		m_inode = static_cast<std::uint64_t>(info.st_ino);
+		m_skipped = 0;
+		SeekToNewest();
+		return true;
+#else
+		m_error = "shared-memory segments need a POSIX system";
+		return false;
+#endif
+	}
+
+	void QuantShmReader::Close()
+	{
+#ifdef QUANT_SHM_POSIX
+		if (m_segment)
+			munmap(const_cast<void*>(m_segment), m_mapped_size);
+#endif
+		m_segment = nullptr;
+		m_mapped_size = 0;
+		m_position = 0;
+	}
+
+	bool QuantShmReader::IsReplaced() const
+	{
+#ifdef QUANT_SHM_POSIX
+		if (!m_segment)
+			return false;
+
+		// Unlinked by a writer that stopped, or a new segment under the same name
+		const int fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+			return true;
+
+		struct stat info;
+		const bool replaced = fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_ino) != m_inode;
+		close(fd);
+		return replaced;
+#else
+		return false;
+#endif
+	}
+
+	std::uint64_t QuantShmReader::Published() const
+	{
+		return m_segment ? HeaderOf(m_segment).head.load(std::memory_order_acquire) : 0;
+	}
+
+	void QuantShmReader::SeekToOldest()
+	{
+		const std::uint64_t head = Published();
+		m_position = head > m_slot_count ? head - m_slot_count : 0;
+	}
+
+	void QuantShmReader::SeekToNewest()
+	{
+		m_position = Published();
+	}
+
+	bool QuantShmReader::NextRecord(ShmFormat::RECORD_KIND kind, void* record, std::size_t record_size)
+	{
+		if (!m_segment || kind != m_kind)
+			return false;
+
+		while (true)
+		{
+			switch (ShmFormat::ReadRecord(m_segment, m_position, record, record_size))
+			{
+			case ShmFormat::READ_OK:
+				m_position++;
+				return true;
+
+			case ShmFormat::READ_EMPTY:
+				return false;
+
+			case ShmFormat::READ_LAPPED:
+			{
+				// Jump to the oldest record still in the ring; the one under the writer right now is lost as well
+				const std::uint64_t head = Published();
+				const std::uint64_t oldest = head > m_slot_count ? head - m_slot_count : 0;
+				const std::uint64_t resume = oldest > m_position ? oldest : m_position + 1;
+				m_skipped += resume - m_position;
+				m_position = resume;
+				break;
+			}
+			}
+		}
+	}
+
+	bool QuantShmReader::LatestRecord(ShmFormat::RECORD_KIND kind, void* record, std::size_t record_size) const
+	{
+		if (!m_segment || kind != m_kind)
+			return false;
+
+		for (int attempt = 0; attempt < latest_attempts; attempt++)
+		{
+			const std::uint64_t head = Published();
+			if (head == 0)
+				return false;
+			if (ShmFormat::ReadRecord(m_segment, head - 1, record, record_size) == ShmFormat::READ_OK)
+				return true;
+		}
+		return false;
+	}
+}
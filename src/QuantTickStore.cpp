@@ -0,0 +1,446 @@
+#include "QuantTickStore.h"
+
+#include <chrono>
+#include <cmath>
+
+#include <QDebug>
+#include <QDir>
+
+#include "QuantClock.h"
+#include "QuantExchangePolicy.h"
+#include "QuantInputHandler.h"
+#include "QuantOrderbook.h"
+
+namespace
+{
+	using namespace Quant;
+
+	// Tolerance of the grid check, far below any quoted decimal
+	constexpr double grid_tolerance = 1e-6;
+	constexpr double finest_grid = 1e-12;
+
+	// The writer also wakes this often to seal the blocks of books that went quiet
+	constexpr int idle_wait_ms = 100;
+
+	template <typename ExchangePolicy>
+	void PolicyGrid(double& tick_size, double& size_quantum)
+	{
+		tick_size = ExchangePolicy::tick_size;
+		size_quantum = ExchangePolicy::lot_size;
+	}
+
+	void DefaultGrid(EXCHANGE_API exchange, double& tick_size, double& size_quantum)
+	{
+		switch (exchange)
+		{
+		case EXCHANGE_API::OKX: PolicyGrid<OKXPolicy>(tick_size, size_quantum); break;
+		case EXCHANGE_API::BINANCE: PolicyGrid<BinancePolicy>(tick_size, size_quantum); break;
+		case EXCHANGE_API::COINBASE: PolicyGrid<CoinbasePolicy>(tick_size, size_quantum); break;
+		case EXCHANGE_API::MEXC: PolicyGrid<MEXCPolicy>(tick_size, size_quantum); break;
+		default:
+			tick_size = 0.01;
+			size_quantum = 0.00000001;
+			break;
+		}
+	}
+
+	bool OnGrid(double value, double step, qint64& steps)
+	{
+		steps = std::llround(value / step);
+		return std::fabs(steps * step - value) <= step * grid_tolerance;
+	}
+}
+
+namespace Quant
+{
+	QuantTickStore::QuantTickStore(const TickStoreConfig& config, QObject* parent)
+		: QObject(parent), m_config(config)
+	{
+		m_config.chunk_seconds = qMax<qint64>(1, m_config.chunk_seconds);
+		m_config.keyframe_interval_ms = qMax<qint64>(1, m_config.keyframe_interval_ms);
+		m_config.max_pending = qMax(1, m_config.max_pending);
+	}
+
+	QuantTickStore::~QuantTickStore()
+	{
+		Stop();
+	}
+
+	bool QuantTickStore::Start()
+	{
+		if (m_config.root.isEmpty())
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_running)
+			return true;
+
+		m_running = true;
+		m_writer = std::thread(&QuantTickStore::WriterLoop, this);
+		return true;
+	}
+
+	void QuantTickStore::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_running)
+				return;
+			m_running = false;
+		}
+
+		// The writer records what is queued and seals every block before leaving
+		m_wake.notify_one();
+		if (m_writer.joinable())
+			m_writer.join();
+	}
+
+	void QuantTickStore::SetOrderbook(QuantOrderbook* orderbook)
+	{
+		if (m_orderbook)
+			QObject::disconnect(m_orderbook, nullptr, this, nullptr);
+
+		m_orderbook = orderbook;
+		if (m_orderbook)
+			QObject::connect(m_orderbook, &QuantOrderbook::orderbookUpdated, this, &QuantTickStore::OnOrderbookUpdated);
+	}
+
+	void QuantTickStore::OnOrderbookUpdated()
+	{
+		Append(m_orderbook->Exchange(), m_orderbook->Symbol(), QuantClock::WallNs(), m_orderbook->View());
+	}
+
+	bool QuantTickStore::Append(EXCHANGE_API exchange, const QString& symbol, qint64 timestamp_ns, const BookView& book)
+	{
+		if (symbol.isEmpty())
+			return false;
+
+		bool wake = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_running)
+				return false;
+
+			if (m_pending_count >= static_cast<size_t>(m_config.max_pending))
+			{
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			// Slots keep their capacity from one swap to the next
+			if (m_pending_count == m_pending.size())
+				m_pending.emplace_back();
+
+			PendingBook& pending = m_pending[m_pending_count++];
+			pending.exchange = exchange;
+			pending.symbol = symbol;
+			pending.timestamp_ns = timestamp_ns;
+			pending.bids.assign(book.bids.begin(), book.bids.end());
+			pending.asks.assign(book.asks.begin(), book.asks.end());
+			wake = m_pending_count == 1;
+		}
+
+		if (wake)
+			m_wake.notify_one();
+		return true;
+	}
+
+	void QuantTickStore::WriterLoop()
+	{
+		while (true)
+		{
+			bool running = true;
+			size_t count = 0;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait_for(lock, std::chrono::milliseconds(idle_wait_ms), [this]() { return m_pending_count > 0 || !m_running; });
+
+				running = m_running;
+				count = m_pending_count;
+				m_pending.swap(m_writing);
+				m_pending_count = 0;
+			}
+
+			for (size_t idx = 0; idx < count; idx++)
+				Record(m_writing[idx]);
+
+			if (!running)
+				break;
+
+			SealExpiredBlocks(QuantClock::WallNs());
+		}
+
+		for (auto& stream : m_streams)
+			CloseChunk(*stream.second);
+	}
+
+	QuantTickStore::Stream& QuantTickStore::StreamFor(EXCHANGE_API exchange, const QString& symbol)
+	{
+		const QString exchange_name = EnumConverter::ExchangeToString(exchange);
+		const QString key = exchange_name + QLatin1Char('/') + symbol;
+
+		auto it = m_streams.find(key);
+		if (it == m_streams.end())
+		{
+			auto stream = std::make_unique<Stream>();
+			stream->directory = TickStoreFormat::StreamDirectory(m_config.root, exchange_name, symbol);
+
+			DefaultGrid(exchange, stream->default_tick_size, stream->default_size_quantum);
+			if (m_config.tick_size > 0.0)
+				stream->default_tick_size = m_config.tick_size;
+			if (m_config.size_quantum > 0.0)
+				stream->default_size_quantum = m_config.size_quantum;
+
+			it = m_streams.emplace(key, std::move(stream)).first;
+		}
+		return *it->second;
+	}
+
+	int QuantTickStore::ToGrid(const std::vector<BookLevel>& side, double tick_size, double size_quantum, TickSide& out)
+	{
+		out.clear();
+		out.reserve(side.size());
+
+		int fit = FITS;
+		for (const BookLevel& level : side)
+		{
+			TickLevel tick_level;
+			if (!OnGrid(level.price, tick_size, tick_level.ticks))
+				fit |= PRICE_OFF_GRID;
+			if (!OnGrid(level.amount, size_quantum, tick_level.quanta) || tick_level.quanta <= 0)
+				fit |= SIZE_OFF_GRID;
+			out.push_back(tick_level);
+		}
+		return fit;
+	}
+
+	void QuantTickStore::DiffSide(const TickSide& previous, const TickSide& next, bool is_bids, TickSide& changes)
+	{
+		changes.clear();
+
+		// Both sides are in book order; walk them together
+		auto before = [is_bids](qint64 a, qint64 b) { return is_bids ? a > b : a < b; };
+
+		size_t prev_idx = 0;
+		size_t next_idx = 0;
+		while (prev_idx < previous.size() || next_idx < next.size())
+		{
+			if (next_idx == next.size() || (prev_idx < previous.size() && before(previous[prev_idx].ticks, next[next_idx].ticks)))
+			{
+				changes.push_back({ previous[prev_idx].ticks, 0 });
+				prev_idx++;
+			}
+			else if (prev_idx == previous.size() || before(next[next_idx].ticks, previous[prev_idx].ticks))
+			{
+				changes.push_back(next[next_idx]);
+				next_idx++;
+			}
+			else
+			{
+				if (previous[prev_idx].quanta != next[next_idx].quanta)
+					changes.push_back(next[next_idx]);
+				prev_idx++;
+				next_idx++;
+			}
+		}
+	}
+
+	void QuantTickStore::EncodeSide(Stream& stream, const TickSide& levels, qint64 reference_ticks)
+	{
+		QByteArray& prices = stream.columns[TickStoreFormat::PRICES];
+		QByteArray& sizes = stream.columns[TickStoreFormat::SIZES];
+		for (const TickLevel& level : levels)
+		{
+			TickStoreFormat::AppendVarint(prices, TickStoreFormat::ZigZag(level.ticks - reference_ticks));
+			TickStoreFormat::AppendVarint(sizes, static_cast<quint64>(level.quanta));
+			reference_ticks = level.ticks;
+		}
+	}
+
+	bool QuantTickStore::OpenChunk(Stream& stream, qint64 timestamp_ns, double tick_size, double size_quantum)
+	{
+		CloseChunk(stream);
+
+		if (!QDir().mkpath(stream.directory))
+		{
+			qWarning() << "Tick store: cannot create" << stream.directory;
+			return false;
+		}
+
+		const QString chunk_path = stream.directory + QLatin1Char('/') + TickStoreFormat::ChunkFileName(timestamp_ns);
+		const QString index_path = stream.directory + QLatin1Char('/') + TickStoreFormat::IndexFileName(timestamp_ns);
+
+		stream.chunk = std::make_unique<QFile>(chunk_path);
+		stream.index = std::make_unique<QFile>(index_path);
+		if (!stream.chunk->open(QIODevice::WriteOnly | QIODevice::Truncate) || !stream.index->open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qWarning() << "Tick store: cannot open" << chunk_path;
+			stream.chunk.reset();
+			stream.index.reset();
+			return false;
+		}
+
+		stream.header = TickStoreFormat::ChunkHeader();
+		stream.header.tick_size = tick_size;
+		stream.header.size_quantum = size_quantum;
+		stream.header.start_ns = timestamp_ns;
+		stream.chunk->write(reinterpret_cast<const char*>(&stream.header), sizeof(stream.header));
+
+		const qint64 partition_ns = m_config.chunk_seconds * 1000000000ll;
+		stream.chunk_bytes = sizeof(stream.header);
+		stream.partition_end_ns = (timestamp_ns / partition_ns + 1) * partition_ns;
+
+		// A new chunk starts with a new block, and so with a keyframe
+		stream.bids.clear();
+		stream.asks.clear();
+
+		m_bytes_written.fetch_add(sizeof(stream.header), std::memory_order_relaxed);
+		return true;
+	}
+
+	void QuantTickStore::CloseChunk(Stream& stream)
+	{
+		SealBlock(stream);
+
+		if (stream.chunk)
+			stream.chunk->close();
+		if (stream.index)
+			stream.index->close();
+
+		stream.chunk.reset();
+		stream.index.reset();
+	}
+
+	bool QuantTickStore::SealBlock(Stream& stream)
+	{
+		TickStoreFormat::BlockHeader& block = stream.block;
+		if (block.record_count == 0)
+			return true;
+
+		bool written = false;
+		if (stream.chunk)
+		{
+			for (int column = 0; column < TickStoreFormat::COLUMN_COUNT; column++)
+				block.column_bytes[column] = static_cast<quint32>(stream.columns[column].size());
+
+			// The block goes out whole, readers never see half of one before the end of the chunk
+			written = stream.chunk->write(reinterpret_cast<const char*>(&block), sizeof(block)) == sizeof(block);
+			for (int column = 0; column < TickStoreFormat::COLUMN_COUNT && written; column++)
+				written = stream.chunk->write(stream.columns[column]) == stream.columns[column].size();
+
+			if (written)
+			{
+				const TickStoreFormat::IndexEntry entry{ block.first_timestamp_ns, stream.chunk_bytes };
+				stream.index->write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+				const qint64 bytes = TickStoreFormat::BlockBytes(block);
+				stream.chunk_bytes += bytes;
+				m_bytes_written.fetch_add(bytes + static_cast<qint64>(sizeof(entry)), std::memory_order_relaxed);
+
+				stream.chunk->flush();
+				stream.index->flush();
+			}
+			else
+				qWarning() << "Tick store: write failed in" << stream.directory << stream.chunk->errorString();
+		}
+
+		block = TickStoreFormat::BlockHeader();
+		for (QByteArray& column : stream.columns)
+			column.resize(0);
+		return written;
+	}
+
+	void QuantTickStore::SealExpiredBlocks(qint64 now_ns)
+	{
+		const qint64 interval_ns = m_config.keyframe_interval_ms * 1000000ll;
+		for (auto& stream : m_streams)
+		{
+			if (stream.second->block.record_count > 0 && now_ns - stream.second->block.first_timestamp_ns >= interval_ns)
+				SealBlock(*stream.second);
+		}
+	}
+
+	void QuantTickStore::Record(const PendingBook& book)
+	{
+		Stream& stream = StreamFor(book.exchange, book.symbol);
+
+		double tick_size = stream.chunk ? stream.header.tick_size : stream.default_tick_size;
+		double size_quantum = stream.chunk ? stream.header.size_quantum : stream.default_size_quantum;
+
+		// Refine the grid until every level is exact
+		bool grid_changed = false;
+		while (true)
+		{
+			const int fit = ToGrid(book.bids, tick_size, size_quantum, stream.next_bids) | ToGrid(book.asks, tick_size, size_quantum, stream.next_asks);
+			if (fit == FITS)
+				break;
+
+			const bool refine_price = (fit & PRICE_OFF_GRID) && tick_size > finest_grid;
+			const bool refine_size = (fit & SIZE_OFF_GRID) && size_quantum > finest_grid;
+			if (!refine_price && !refine_size)
+			{
+				qWarning() << "Tick store: book of" << book.symbol << "does not fit any grid";
+				return;
+			}
+
+			if (refine_price)
+				tick_size /= 10.0;
+			if (refine_size)
+				size_quantum /= 10.0;
+
+			grid_changed = true;
+		}
+
+		if (grid_changed)
+		{
+			stream.default_tick_size = tick_size;
+			stream.default_size_quantum = size_quantum;
+		}
+
+		if (!stream.chunk || grid_changed || book.timestamp_ns >= stream.partition_end_ns)
+		{
+			if (!OpenChunk(stream, book.timestamp_ns, tick_size, size_quantum))
+				return;
+		}
+
+		// A block spans one keyframe interval; the next record starts another with a keyframe
+		TickStoreFormat::BlockHeader& block = stream.block;
+		if (block.record_count > 0 && book.timestamp_ns - block.first_timestamp_ns >= m_config.keyframe_interval_ms * 1000000ll)
+			SealBlock(stream);
+
+		const bool keyframe = block.record_count == 0;
+		if (keyframe)
+		{
+			block.first_timestamp_ns = book.timestamp_ns;
+			stream.last_timestamp_ns = book.timestamp_ns;
+		}
+
+		TickStoreFormat::AppendVarint(stream.columns[TickStoreFormat::TIMESTAMPS], TickStoreFormat::ZigZag(book.timestamp_ns - stream.last_timestamp_ns));
+
+		QByteArray& counts = stream.columns[TickStoreFormat::COUNTS];
+		if (keyframe)
+		{
+			TickStoreFormat::AppendVarint(counts, stream.next_bids.size());
+			TickStoreFormat::AppendVarint(counts, stream.next_asks.size());
+			EncodeSide(stream, stream.next_bids, 0);
+			EncodeSide(stream, stream.next_asks, 0);
+		}
+		else
+		{
+			DiffSide(stream.bids, stream.next_bids, true, stream.bid_changes);
+			DiffSide(stream.asks, stream.next_asks, false, stream.ask_changes);
+
+			TickStoreFormat::AppendVarint(counts, stream.bid_changes.size());
+			TickStoreFormat::AppendVarint(counts, stream.ask_changes.size());
+			EncodeSide(stream, stream.bid_changes, stream.bids.empty() ? 0 : stream.bids.front().ticks);
+			EncodeSide(stream, stream.ask_changes, stream.asks.empty() ? 0 : stream.asks.front().ticks);
+		}
+
+		block.record_count++;
+		block.last_timestamp_ns = book.timestamp_ns;
+		stream.last_timestamp_ns = book.timestamp_ns;
+
+		stream.bids.swap(stream.next_bids);
+		stream.asks.swap(stream.next_asks);
+	}
+}
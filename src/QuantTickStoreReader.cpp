@@ -0,0 +1,374 @@
+#include "QuantTickStoreReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QDir>
+#include <QFile>
+
+namespace
+{
+	using namespace Quant;
+
+	bool BidOrder(const BookLevel& a, const BookLevel& b) { return a.price > b.price; }
+	bool AskOrder(const BookLevel& a, const BookLevel& b) { return a.price < b.price; }
+
+	// Sets one level of a sorted side: updates, inserts, or removes it when the amount is 0
+	void ApplyLevel(QVector<BookLevel>& levels, const BookLevel& level, bool is_bids)
+	{
+		auto it = std::lower_bound(levels.begin(), levels.end(), level, is_bids ? BidOrder : AskOrder);
+		const bool found = it != levels.end() && it->price == level.price;
+
+		if (level.amount <= 0.0)
+		{
+			if (found)
+				levels.erase(it);
+		}
+		else if (found)
+			it->amount = level.amount;
+		else
+			levels.insert(it, level);
+	}
+
+	// Chunk and index mapped read-only for the duration of a query
+	class MappedChunk
+	{
+	public:
+		bool Open(const QString& chunk_path, const QString& index_path)
+		{
+			m_chunk.setFileName(chunk_path);
+			if (!m_chunk.open(QIODevice::ReadOnly) || m_chunk.size() < static_cast<qint64>(sizeof(TickStoreFormat::ChunkHeader)))
+				return false;
+
+			m_size = m_chunk.size();
+			m_data = m_chunk.map(0, m_size);
+			if (!m_data)
+				return false;
+
+			std::memcpy(&m_header, m_data, sizeof(m_header));
+			if (m_header.magic != TickStoreFormat::magic || m_header.version != TickStoreFormat::version
+				|| m_header.tick_size <= 0.0 || m_header.size_quantum <= 0.0)
+				return false;
+
+			// The index is optional, without it decoding starts at the first record
+			m_index_file.setFileName(index_path);
+			if (m_index_file.open(QIODevice::ReadOnly))
+			{
+				const qint64 count = m_index_file.size() / static_cast<qint64>(sizeof(TickStoreFormat::IndexEntry));
+				if (count > 0)
+				{
+					const uchar* index = m_index_file.map(0, count * sizeof(TickStoreFormat::IndexEntry));
+					if (index)
+					{
+						m_index = reinterpret_cast<const TickStoreFormat::IndexEntry*>(index);
+						m_index_count = count;
+					}
+				}
+			}
+			return true;
+		}
+
+		// Offset of the last block starting at or before the time
+		qint64 SeekOffset(qint64 timestamp_ns) const
+		{
+			const qint64 first_record = sizeof(TickStoreFormat::ChunkHeader);
+			if (!m_index_count)
+				return first_record;
+
+			const TickStoreFormat::IndexEntry* end = m_index + m_index_count;
+			const TickStoreFormat::IndexEntry* it = std::upper_bound(m_index, end, timestamp_ns,
+				[](qint64 value, const TickStoreFormat::IndexEntry& entry) { return value < entry.timestamp_ns; });
+
+			if (it == m_index)
+				return first_record;
+
+			const qint64 offset = (it - 1)->offset;
+			return (offset >= first_record && offset < m_size) ? offset : first_record;
+		}
+
+		const uchar* Data() const { return m_data; }
+		qint64 Size() const { return m_size; }
+		const TickStoreFormat::ChunkHeader& Header() const { return m_header; }
+
+	private:
+		QFile m_chunk;
+		QFile m_index_file;
+		const uchar* m_data = nullptr;
+		qint64 m_size = 0;
+		TickStoreFormat::ChunkHeader m_header;
+		const TickStoreFormat::IndexEntry* m_index = nullptr;
+		qint64 m_index_count = 0;
+	};
+
+	class ChunkDecoder
+	{
+	public:
+		ChunkDecoder(const MappedChunk& chunk, qint64 offset)
+			: m_data(chunk.Data()), m_size(chunk.Size()), m_next_block(offset),
+			m_tick_size(chunk.Header().tick_size), m_size_quantum(chunk.Header().size_quantum)
+		{
+		}
+
+		// Time of the next record without consuming it; only its timestamp column is read
+		bool Peek(qint64& timestamp_ns)
+		{
+			if (!m_remaining && !LoadBlock())
+				return false;
+
+			const uchar* cursor = m_column[TickStoreFormat::TIMESTAMPS];
+			quint64 value = 0;
+			if (!TickStoreFormat::ReadVarint(cursor, m_column_end[TickStoreFormat::TIMESTAMPS], value))
+				return false;
+
+			timestamp_ns = RecordTime(value);
+			return true;
+		}
+
+		// Applies the next record to the book, false at the end or on a damaged block
+		bool Next(StoredBook& book)
+		{
+			if (!m_remaining && !LoadBlock())
+				return false;
+
+			quint64 timestamp = 0;
+			quint64 bid_count = 0;
+			quint64 ask_count = 0;
+			if (!Read(TickStoreFormat::TIMESTAMPS, timestamp) || !Read(TickStoreFormat::COUNTS, bid_count) || !Read(TickStoreFormat::COUNTS, ask_count))
+				return false;
+
+			// Every level takes at least one byte in each of the price and size columns
+			const quint64 levels_left = static_cast<quint64>(m_column_end[TickStoreFormat::SIZES] - m_column[TickStoreFormat::SIZES]);
+			if (bid_count + ask_count > levels_left)
+				return false;
+
+			const bool keyframe = m_remaining == m_block.record_count;
+			if (keyframe)
+			{
+				book.bids.clear();
+				book.asks.clear();
+			}
+
+			if (!DecodeSide(bid_count, keyframe, true, book.bids) || !DecodeSide(ask_count, keyframe, false, book.asks))
+				return false;
+
+			m_timestamp_ns = RecordTime(timestamp);
+			m_remaining--;
+
+			book.timestamp_ns = m_timestamp_ns;
+			return true;
+		}
+
+	private:
+		// Points the columns at the next block; a block running past the end is still being written
+		bool LoadBlock()
+		{
+			if (m_next_block + static_cast<qint64>(sizeof(TickStoreFormat::BlockHeader)) > m_size)
+				return false;
+
+			std::memcpy(&m_block, m_data + m_next_block, sizeof(m_block));
+			const qint64 bytes = TickStoreFormat::BlockBytes(m_block);
+			if (m_block.magic != TickStoreFormat::block_magic || m_block.record_count == 0 || m_next_block + bytes > m_size)
+				return false;
+
+			const uchar* cursor = m_data + m_next_block + sizeof(TickStoreFormat::BlockHeader);
+			for (int column = 0; column < TickStoreFormat::COLUMN_COUNT; column++)
+			{
+				m_column[column] = cursor;
+				cursor += m_block.column_bytes[column];
+				m_column_end[column] = cursor;
+			}
+
+			m_next_block += bytes;
+			m_remaining = m_block.record_count;
+			return true;
+		}
+
+		bool Read(int column, quint64& value)
+		{
+			return TickStoreFormat::ReadVarint(m_column[column], m_column_end[column], value);
+		}
+
+		qint64 RecordTime(quint64 value) const
+		{
+			const qint64 previous = m_remaining == m_block.record_count ? m_block.first_timestamp_ns : m_timestamp_ns;
+			return previous + TickStoreFormat::UnZigZag(value);
+		}
+
+		bool DecodeSide(quint64 count, bool keyframe, bool is_bids, QVector<BookLevel>& levels)
+		{
+			qint64 reference_ticks = (keyframe || levels.isEmpty()) ? 0 : std::llround(levels.front().price / m_tick_size);
+			if (keyframe)
+				levels.reserve(static_cast<qsizetype>(count));
+
+			for (quint64 idx = 0; idx < count; idx++)
+			{
+				quint64 price = 0;
+				quint64 quanta = 0;
+				if (!Read(TickStoreFormat::PRICES, price) || !Read(TickStoreFormat::SIZES, quanta))
+					return false;
+
+				reference_ticks += TickStoreFormat::UnZigZag(price);
+				const BookLevel level{ reference_ticks * m_tick_size, static_cast<double>(quanta) * m_size_quantum };
+
+				// Keyframes are written in book order
+				if (keyframe)
+					levels.append(level);
+				else
+					ApplyLevel(levels, level, is_bids);
+			}
+			return true;
+		}
+
+	private:
+		const uchar* m_data;
+		qint64 m_size;
+		qint64 m_next_block;
+		double m_tick_size;
+		double m_size_quantum;
+
+		TickStoreFormat::BlockHeader m_block;
+		const uchar* m_column[TickStoreFormat::COLUMN_COUNT] = {};
+		const uchar* m_column_end[TickStoreFormat::COLUMN_COUNT] = {};
+		quint32 m_remaining = 0; // Records left in the block
+		qint64 m_timestamp_ns = 0;
+	};
+}
+
+namespace Quant
+{
+	BookView StoredBook::View() const
+	{
+		BookView view;
+		view.bids = { bids.constData(), static_cast<int>(bids.size()) };
+		view.asks = { asks.constData(), static_cast<int>(asks.size()) };
+		return view;
+	}
+
+	QuantTickStoreReader::QuantTickStoreReader(const QString& directory) : m_directory(directory)
+	{
+		Refresh();
+	}
+
+	QuantTickStoreReader::QuantTickStoreReader(const QString& root, const QString& exchange, const QString& symbol)
+		: QuantTickStoreReader(TickStoreFormat::StreamDirectory(root, exchange, symbol))
+	{
+	}
+
+	void QuantTickStoreReader::Refresh()
+	{
+		m_chunks.clear();
+
+		const QDir directory(m_directory);
+		const QStringList names = directory.entryList({ QString("*") + TickStoreFormat::chunk_suffix }, QDir::Files, QDir::Name);
+		for (const QString& name : names)
+		{
+			bool valid = false;
+			const qint64 start_ns = name.left(name.size() - static_cast<int>(qstrlen(TickStoreFormat::chunk_suffix))).toLongLong(&valid);
+			if (!valid)
+				continue;
+
+			m_chunks.append({ start_ns, directory.filePath(name), directory.filePath(TickStoreFormat::IndexFileName(start_ns)) });
+		}
+	}
+
+	void QuantTickStoreReader::Walk(qint64 from_ns, qint64 to_ns, bool include_preceding, const std::function<bool(const StoredBook& book)>& visit) const
+	{
+		if (m_chunks.isEmpty() || to_ns < from_ns)
+			return;
+
+		// Last chunk starting at or before from, later chunks start inside the range
+		auto first = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), from_ns,
+			[](qint64 value, const ChunkFile& chunk) { return value < chunk.start_ns; });
+		if (first != m_chunks.cbegin())
+			--first;
+
+		StoredBook book;
+		bool has_book = false;
+		bool preceding_done = !include_preceding;
+
+		for (auto chunk = first; chunk != m_chunks.cend() && chunk->start_ns <= to_ns; ++chunk)
+		{
+			MappedChunk mapped;
+			if (!mapped.Open(chunk->chunk_path, chunk->index_path))
+				continue;
+
+			ChunkDecoder decoder(mapped, chunk == first ? mapped.SeekOffset(from_ns) : sizeof(TickStoreFormat::ChunkHeader));
+
+			qint64 next_ns = 0;
+			while (decoder.Peek(next_ns))
+			{
+				if (next_ns > to_ns)
+				{
+					if (!preceding_done && has_book)
+						visit(book);
+					return;
+				}
+
+				// The book as it stood when the range began
+				if (next_ns >= from_ns && !preceding_done)
+				{
+					preceding_done = true;
+					if (has_book && !visit(book))
+						return;
+				}
+
+				if (!decoder.Next(book))
+					break;
+				has_book = true;
+
+				if (book.timestamp_ns >= from_ns && !visit(book))
+					return;
+			}
+		}
+
+		if (!preceding_done && has_book)
+			visit(book);
+	}
+
+	bool QuantTickStoreReader::BookAt(qint64 timestamp_ns, StoredBook& book) const
+	{
+		bool found = false;
+		Walk(timestamp_ns, timestamp_ns, true, [&book, &found](const StoredBook& stored)
+			{
+				book = stored;
+				found = true;
+				return true;
+			});
+		return found;
+	}
+
+	qint64 QuantTickStoreReader::Scan(qint64 from_ns, qint64 to_ns, const ScanFn& callback) const
+	{
+		qint64 count = 0;
+		Walk(from_ns, to_ns, false, [&callback, &count](const StoredBook& stored)
+			{
+				callback(stored.timestamp_ns, stored.View());
+				count++;
+				return true;
+			});
+		return count;
+	}
+
+	QVector<SpreadDepthSample> QuantTickStoreReader::SpreadDepth(qint64 from_ns, qint64 to_ns, int depth_levels) const
+	{
+		QVector<SpreadDepthSample> samples;
+
+		Scan(from_ns, to_ns, [&samples, depth_levels](qint64 timestamp_ns, const BookView& book)
+			{
+				SpreadDepthSample sample;
+				sample.timestamp_ns = timestamp_ns;
+				if (!book.bids.empty() && !book.asks.empty())
+					sample.spread = book.asks[0].price - book.bids[0].price;
+
+				for (int idx = 0; idx < qMin(depth_levels, book.bids.size); idx++)
+					sample.bid_depth += book.bids[idx].amount;
+				for (int idx = 0; idx < qMin(depth_levels, book.asks.size); idx++)
+					sample.ask_depth += book.asks[idx].amount;
+
+				samples.append(sample);
+			});
+
+		return samples;
+	}
+}
@@ -0,0 +1,188 @@
+#include "QuantTracer.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QFile>
+
+#include "QuantClock.h"
+
+namespace
+{
+	using namespace Quant;
+
+	constexpr quint64 ring_mask = QuantTracer::ring_capacity - 1;
+	static_assert((QuantTracer::ring_capacity & ring_mask) == 0, "ring capacity must be a power of two");
+
+	struct TraceEvent
+	{
+		const char* name = nullptr;
+		const char* category = nullptr;
+		qint64 begin_ns = 0;
+		qint64 end_ns = 0;
+	};
+
+	// Written by its thread only; the exporter validates what it copied against head
+	struct ThreadRing
+	{
+		int thread_id = 0;
+		std::atomic<const char*> name{ nullptr };
+		std::atomic<quint64> head{ 0 };
+		TraceEvent events[QuantTracer::ring_capacity];
+	};
+
+	// Rings are never freed, so an export never reads freed memory; an exited thread's ring goes to the next new one
+	std::mutex rings_mutex;
+	std::vector<std::unique_ptr<ThreadRing>> rings;
+	std::vector<ThreadRing*> free_rings;
+	int next_thread_id = 0;
+
+	// Hands the ring back when its thread exits
+	struct LocalRingHolder
+	{
+		ThreadRing* ring = nullptr;
+
+		~LocalRingHolder()
+		{
+			if (!ring)
+				return;
+
+			std::lock_guard<std::mutex> lock(rings_mutex);
+			free_rings.push_back(ring);
+		}
+	};
+
+	thread_local LocalRingHolder local_ring;
+
+	ThreadRing* LocalRing()
+	{
+		if (!local_ring.ring)
+		{
+			std::lock_guard<std::mutex> lock(rings_mutex);
+			if (free_rings.empty())
+			{
+				rings.push_back(std::make_unique<ThreadRing>());
+				local_ring.ring = rings.back().get();
+			}
+			else
+			{
+				// The exited thread's spans go with it; the exporter holds the lock, so it never sees the reset
+				local_ring.ring = free_rings.back();
+				free_rings.pop_back();
+				local_ring.ring->head.store(0, std::memory_order_relaxed);
+				local_ring.ring->name.store(nullptr, std::memory_order_relaxed);
+			}
+			local_ring.ring->thread_id = ++next_thread_id;
+		}
+		return local_ring.ring;
+	}
+
+	void AppendMicroseconds(QByteArray& out, qint64 ns)
+	{
+		out += QByteArray::number(ns / 1000);
+		out += '.';
+		out += QByteArray::number(ns % 1000).rightJustified(3, '0');
+	}
+}
+
+namespace Quant
+{
+	std::atomic<bool> QuantTracer::s_enabled{ false };
+
+	void QuantTracer::SetEnabled(bool enabled)
+	{
+		s_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	qint64 QuantTracer::Now()
+	{
+		return QuantClock::SteadyNs();
+	}
+
+	void QuantTracer::Record(const char* name, const char* category, qint64 begin_ns, qint64 end_ns)
+	{
+		ThreadRing* ring = LocalRing();
+		const quint64 head = ring->head.load(std::memory_order_relaxed);
+
+		TraceEvent& event = ring->events[head & ring_mask];
+		event.name = name;
+		event.category = category;
+		event.begin_ns = begin_ns;
+		event.end_ns = end_ns;
+
+		ring->head.store(head + 1, std::memory_order_release);
+	}
+
+	void QuantTracer::SetThreadName(const char* name)
+	{
+		LocalRing()->name.store(name, std::memory_order_relaxed);
+	}
+
+	QByteArray QuantTracer::ExportChromeTrace()
+	{
+		QByteArray out;
+		out.reserve(1024 * 1024);
+		out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		bool first = true;
+		auto separator = [&out, &first]()
+			{
+				if (!first)
+					out += ",\n";
+				first = false;
+			};
+
+		std::vector<TraceEvent> copy(ring_capacity);
+
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		for (const std::unique_ptr<ThreadRing>& ring : rings)
+		{
+			const QByteArray tid = QByteArray::number(ring->thread_id);
+			const char* thread_name = ring->name.load(std::memory_order_relaxed);
+
+			separator();
+			out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"";
+			out += thread_name ? QByteArray(thread_name) : "thread-" + tid;
+			out += "\"}}";
+
+			const quint64 head = ring->head.load(std::memory_order_acquire);
+			const quint64 begin = head > static_cast<quint64>(ring_capacity) ? head - ring_capacity : 0;
+			for (quint64 idx = begin; idx < head; idx++)
+				copy[idx - begin] = ring->events[idx & ring_mask];
+
+			// Slots the thread reused while we copied are torn, skip them
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const quint64 head_after = ring->head.load(std::memory_order_relaxed);
+			const quint64 valid_from = head_after >= static_cast<quint64>(ring_capacity) ? qMax(begin, head_after - ring_capacity + 1) : begin;
+
+			for (quint64 idx = valid_from; idx < head; idx++)
+			{
+				const TraceEvent& event = copy[idx - begin];
+				separator();
+				out += "{\"name\":\"";
+				out += event.name;
+				out += "\",\"cat\":\"";
+				out += event.category;
+				out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+				AppendMicroseconds(out, event.begin_ns);
+				out += ",\"dur\":";
+				AppendMicroseconds(out, qMax<qint64>(0, event.end_ns - event.begin_ns));
+				out += '}';
+			}
+		}
+
+		out += "]}\n";
+		return out;
+	}
+
+	bool QuantTracer::Dump(const QString& path)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			return false;
+
+		const QByteArray trace = ExportChromeTrace();
+		return file.write(trace) == trace.size();
+	}
+}
@@ -2,142 +2,380 @@
 
 #include <QtConcurrent/QtConcurrent>
 
-namespace
+#include "QuantMetrics.h"
+#include "QuantRuntimeProfile.h"
+#include "QuantTracer.h"
+
+namespace Quant
 {
-	struct MessageType
+	QuantWebSocket::QuantWebSocket(QObject* parent): QObject(parent)
 	{
-		const char* orderbook = "orderbook";
-		const char* ticker = "ticker";
-		const char* trades = "trades";
-		const char* orderbook_update = "orderbook_update";
-	};
+		m_adapter = ResolveFeedAdapter(m_feed_format);
+		m_clock.start();
+
+		// Book messages reach listeners through the backpressure queue
+		QObject::connect(&m_queue, &QuantFeedQueue::snapshotReady, this, &QuantWebSocket::orderbookUpdated);
+		QObject::connect(&m_queue, &QuantFeedQueue::deltaReady, this, &QuantWebSocket::orderbookDeltaReceived);
+		QObject::connect(&m_queue, &QuantFeedQueue::topOfBookReady, this, &QuantWebSocket::topOfBookUpdated);
+
+		m_line_watchdog.setInterval(line_watchdog_interval_ms);
+		QObject::connect(&m_line_watchdog, &QTimer::timeout, this, &QuantWebSocket::OnLineWatchdog);
 
-	struct OrderbookUpdateType
+		ResizeLines(1);
+	}
+
+	QuantWebSocket::~QuantWebSocket()
 	{
-		static constexpr const char* bids = "bids";
-		static constexpr const char* asks = "asks";
-	};
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+		{
+			QObject::disconnect(&line->socket, nullptr, this, nullptr);
+			if (line->connected)
+				line->socket.close();
+		}
+
+		// Pending parses still reference the queue
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+			line->parse_pool.waitForDone();
+	}
 
-	bool processDocument(const QJsonDocument json_doc, QJsonArray& bids, QJsonArray& asks)
+	void QuantWebSocket::ResizeLines(int count)
 	{
-		if (json_doc.isNull())
+		const bool was_connected = isConnected();
+		while (static_cast<int>(m_lines.size()) > count)
 		{
-			return false;
+			std::unique_ptr<FeedLine>& line = m_lines.back();
+			QObject::disconnect(&line->socket, nullptr, this, nullptr);
+			line->reconnect_timer.stop();
+			line->socket.abort();
+			line->parse_pool.waitForDone();
+			m_lines.pop_back();
 		}
-		if (!json_doc.isObject())
+
+		if (was_connected)
 		{
-			return false;
+			UpdateActiveLine();
+			if (!isConnected())
+				emit disconnected();
 		}
 
-		QJsonObject json_obj = json_doc.object();
-		bids = json_obj[OrderbookUpdateType::bids].toArray();
-		asks = json_obj[OrderbookUpdateType::asks].toArray();
-	
-		return !(asks.isEmpty() || bids.isEmpty());
+		// Under busy polling each line hands its messages to the queue through its own ring
+		m_queue.SetProducerCount(count);
+
+		while (static_cast<int>(m_lines.size()) < count)
+		{
+			m_lines.push_back(std::make_unique<FeedLine>());
+			FeedLine* line = m_lines.back().get();
+			line->index = static_cast<int>(m_lines.size()) - 1;
+
+			// A single parsing thread per line keeps its messages in arrival order
+			line->parse_pool.setMaxThreadCount(1);
+
+			// A pinned parsing thread has to stay the parsing thread, so it never expires
+			if (QuantRuntimeProfile::IsEnabled())
+			{
+				line->parse_pool.setExpiryTimeout(-1);
+				QtConcurrent::run(&line->parse_pool, []
+					{
+						QuantRuntimeProfile::PinCurrentThread(THREAD_ROLE::INGEST);
+					});
+			}
+
+			line->reconnect_timer.setSingleShot(true);
+			QObject::connect(&line->reconnect_timer, &QTimer::timeout, this, [this, line]()
+				{
+					if (m_running && line->socket.state() == QAbstractSocket::UnconnectedState)
+						line->socket.open(QUrl(line->url));
+				});
+
+			QObject::connect(&line->socket, &QWebSocket::connected, this, [this, line]() { OnLineConnected(*line); });
+			QObject::connect(&line->socket, &QWebSocket::disconnected, this, [this, line]() { OnLineDisconnected(*line); });
+			QObject::connect(&line->socket, &QWebSocket::textMessageReceived, this, [this, line](const QString& message) { OnLineMessage(*line, message); });
+			QObject::connect(&line->socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::errorOccurred), this, [this, line](QAbstractSocket::SocketError) { OnLineError(*line); });
+		}
 	}
-}
 
-namespace Quant
-{
-	QuantWebSocket::QuantWebSocket(QObject* parent): QObject(parent), m_is_connected(false) 
+	void QuantWebSocket::connect(const QString& url)
 	{
-		// Connect websocket signal to slots
-		QObject::connect(&m_webSocket, &QWebSocket::connected, this, &QuantWebSocket::onConnected);
-		QObject::connect(&m_webSocket, &QWebSocket::disconnected, this, &QuantWebSocket::onDisconnected);
-		QObject::connect(&m_webSocket, &QWebSocket::textMessageReceived, this, &QuantWebSocket::onTextMessageReceived);
-		QObject::connect(&m_webSocket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::errorOccurred), this, &QuantWebSocket::onError);
+		m_url = url;
+		m_running = true;
+		ResizeLines(1 + static_cast<int>(m_redundant_urls.size()));
+
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+		{
+			line->url = line->index == 0 ? m_url : m_redundant_urls[line->index - 1];
+			if (line->socket.state() == QAbstractSocket::UnconnectedState)
+				line->socket.open(QUrl(line->url));
+		}
+
+		if (m_lines.size() > 1)
+			m_line_watchdog.start();
 	}
 
-	QuantWebSocket::~QuantWebSocket()
+	void QuantWebSocket::disconnect()
 	{
-		if (m_is_connected)
+		m_running = false;
+		m_line_watchdog.stop();
+
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
 		{
-			m_webSocket.close();
+			line->reconnect_timer.stop();
+			if (line->connected)
+				line->socket.close();
+			else
+				line->socket.abort();
 		}
 	}
 
-	void QuantWebSocket::connect(const QString& url)
+	bool QuantWebSocket::isConnected() const
 	{
-		//qDebug() << "Connecting to WebSocket endpoint:" << url;
-		m_webSocket.open(QUrl(url));
+		return ConnectedLineCount() > 0;
 	}
 
-	void QuantWebSocket::disconnect()
+	int QuantWebSocket::ConnectedLineCount() const
+	{
+		int count = 0;
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+			count += line->connected ? 1 : 0;
+		return count;
+	}
+
+	void QuantWebSocket::SetRedundantUrls(const QStringList& urls)
+	{
+		m_redundant_urls = urls;
+
+		// The arbiter keeps a fixed number of lines
+		while (1 + m_redundant_urls.size() > QuantFeedArbiter::max_lines)
+			m_redundant_urls.removeLast();
+	}
+
+	void QuantWebSocket::SetFeedFormat(EXCHANGE_API format)
 	{
-		if (m_is_connected)
+		m_feed_format = format;
+		m_adapter = ResolveFeedAdapter(format);
+
+		// Frames already queued were decoded with the old adapter; its state is of no use to the new one
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
 		{
-			m_webSocket.close();
+			FeedLine* line_ptr = line.get();
+			QtConcurrent::run(&line->parse_pool, [line_ptr]
+				{
+					line_ptr->decoder_state = FeedDecoderState();
+				});
 		}
 	}
 
-	bool QuantWebSocket::isConnected() const
+	void QuantWebSocket::Subscribe(const QStringList& symbols, const QString& channel)
 	{
-		return m_is_connected;
+		SendOperation(true, symbols, channel);
 	}
 
-	void QuantWebSocket::onConnected()
+	void QuantWebSocket::Unsubscribe(const QStringList& symbols, const QString& channel)
 	{
-		m_is_connected = true;
-		qDebug() << "WebSocket connected";
-		emit connected();
+		SendOperation(false, symbols, channel);
 	}
- 
-	void QuantWebSocket::onDisconnected()
+
+	void QuantWebSocket::SendOperation(bool subscribe, const QStringList& symbols, const QString& channel)
 	{
-		m_is_connected = false;
-		qDebug() << "WebSocket disconnected";
-		emit disconnected();
+		if (!isConnected() || symbols.isEmpty())
+			return;
+
+		QStringList& tracked = m_subscriptions[channel];
+		for (const QString& symbol : symbols)
+		{
+			if (!subscribe)
+				tracked.removeAll(symbol);
+			else if (!tracked.contains(symbol))
+				tracked.append(symbol);
+
+			// The venue may start the symbol's sequence over with the new snapshot
+			if (subscribe)
+				m_arbiter.Reset(symbol);
+		}
+
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+		{
+			if (line->connected)
+				SendLineOperation(*line, subscribe, symbols, channel);
+		}
 	}
 
-	void QuantWebSocket::onTextMessageReceived(const QString& message)
+	void QuantWebSocket::SendLineOperation(FeedLine& line, bool subscribe, const QStringList& symbols, const QString& channel)
 	{
-		// Parsing JSON on the Working Thread
-		QtConcurrent::run([this, message_copy = message]
+		// Queued ahead of the venue's answer, so the decoder starts the symbols' sequences over before it
+		FeedLine* line_ptr = &line;
+		QtConcurrent::run(&line.parse_pool, [line_ptr, symbols, venue_symbol = m_adapter.venue_symbol]
 			{
-
-				// Parse the JSON response
-				QByteArray message_buffer = message_copy.toUtf8();
-				QJsonParseError parse_error;
-
-				QJsonDocument json_doc = QJsonDocument::fromJson(message_buffer, &parse_error);
-				if (m_parse_error.error != QJsonParseError::NoError)
+				for (const QString& symbol : symbols)
 				{
-					// Thread-safe error handling
-					QMetaObject::invokeMethod(this, [this]()
-						{
-							emit error("Invalid JSON response (not an object)");
-						}, Qt::QueuedConnection);
-					return;
+					line_ptr->decoder_state.Track(venue_symbol(symbol), symbol);
+					line_ptr->decoder_state.Reset(symbol);
 				}
+			});
 
-				// Update on the main thread
-				QMetaObject::invokeMethod(this, [this, doc = std::move(json_doc)]()
-					{
-						QJsonArray bids, asks;
-						if (!processDocument(doc, bids, asks))
-						{
-							emit error("Invalid JSON response (missing bids/asks)");
-							return;
-						}
+		line.socket.sendTextMessage(QString::fromUtf8(m_adapter.subscribe(subscribe, symbols, channel)));
+	}
+
+	qint64 QuantWebSocket::MillisecondsSinceLastMessage() const
+	{
+		qint64 silence = -1;
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+		{
+			if (line->last_message.isValid() && (silence < 0 || line->last_message.elapsed() < silence))
+				silence = line->last_message.elapsed();
+		}
+		return silence;
+	}
 
-						// Forward data to listeners
-						emit orderbookUpdated(bids, asks);
-					}, Qt::QueuedConnection);
+	void QuantWebSocket::OnLineConnected(FeedLine& line)
+	{
+		const bool first = !isConnected();
+		line.connected = true;
 
+		// Counts as traffic, so a line that never delivers anything is also seen stalling
+		line.last_message.start();
 
+		FeedLine* line_ptr = &line;
+		QtConcurrent::run(&line.parse_pool, [line_ptr]
+			{
+				line_ptr->decoder_state.ResetConnection();
 			});
 
-		
-		
+		PipelineMetrics::Get().socket_connects.Add();
+		UpdateActiveLine();
+
+		// The first line starts a new session, whose subscriptions come from the connection manager;
+		// a later one joins the running session
+		if (first)
+		{
+			m_arbiter.ResetAll();
+			emit connected();
+			return;
+		}
+
+		for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it)
+		{
+			if (!it.value().isEmpty())
+				SendLineOperation(line, true, it.value(), it.key());
+		}
+	}
+
+	void QuantWebSocket::OnLineDisconnected(FeedLine& line)
+	{
+		if (!line.connected)
+			return;
+
+		line.connected = false;
+		PipelineMetrics::Get().socket_disconnects.Add();
+		UpdateActiveLine();
 
-		
+		// The other lines carry the feed meanwhile; with none left the connection manager takes over
+		if (isConnected())
+		{
+			if (m_running)
+				line.reconnect_timer.start(line_reconnect_ms);
+			return;
+		}
 
+		emit disconnected();
 	}
 
-	void QuantWebSocket::onError(QAbstractSocket::SocketError error)
+	void QuantWebSocket::OnLineError(FeedLine& line)
 	{
-		qDebug() << "WebSocket error: " << m_webSocket.errorString();
-		emit this->error(m_webSocket.errorString());
+		PipelineMetrics::Get().socket_errors.Add();
+
+		// A redundant line that fails to open retries on its own while the feed is up
+		if (!line.connected && isConnected() && m_running)
+			line.reconnect_timer.start(line_reconnect_ms);
+
+		emit error(line.socket.errorString());
 	}
 
-}
\ No newline at end of file
+	void QuantWebSocket::OnLineWatchdog()
+	{
+		if (ConnectedLineCount() < 2)
+			return;
+
+		// A line is stalled only if another one is still receiving; a silent feed is the connection manager's call
+		bool any_live = false;
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+			any_live = any_live || (line->connected && line->last_message.elapsed() < line_stall_ms);
+		if (!any_live)
+			return;
+
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+		{
+			if (line->connected && line->last_message.elapsed() >= line_stall_ms)
+			{
+				qWarning() << "Feed line" << line->index << "stalled for" << line->last_message.elapsed() << "ms, reconnecting it";
+				line->socket.abort();
+			}
+		}
+	}
+
+	void QuantWebSocket::UpdateActiveLine()
+	{
+		// Unsequenced messages come from the first connected line
+		for (const std::unique_ptr<FeedLine>& line : m_lines)
+		{
+			if (line->connected)
+			{
+				m_arbiter.SetActiveLine(line->index);
+				return;
+			}
+		}
+	}
+
+	void QuantWebSocket::OnLineMessage(FeedLine& line, const QString& message)
+	{
+		QUANT_TRACE_SCOPE("socket_receive", "feed");
+		const qint64 arrival_ns = m_clock.nsecsElapsed();
+		line.last_message.start();
+		PipelineMetrics::Get().messages_received.Add();
+
+		// A single line forwards everything, several go through the arbiter
+		const bool arbitrate = m_lines.size() > 1;
+
+		// Decoding on the line's parsing thread, with the adapter of the venue behind the endpoint
+		FeedLine* line_ptr = &line;
+		QtConcurrent::run(&line.parse_pool, [this, line_ptr, message_copy = message, symbol_filter = m_symbol_filter, decode = m_adapter.decode,
+			shared_sequence = m_adapter.shared_sequence, arbitrate, arrival_ns]
+			{
+				if (QuantTracer::IsEnabled())
+					QuantTracer::SetThreadName("feed-parse");
+				QUANT_TRACE_SCOPE("json_decode", "feed");
+
+				PipelineMetrics& metrics = PipelineMetrics::Get();
+				QElapsedTimer decode_timer;
+				decode_timer.start();
+
+				const QByteArray message_buffer = message_copy.toUtf8();
+				std::vector<FeedMessage> messages;
+				const DECODE_STATUS status = decode(message_buffer, symbol_filter, line_ptr->decoder_state, messages);
+				metrics.decode_latency.Observe(decode_timer.nsecsElapsed());
+
+				if (status == DECODE_STATUS::FILTERED)
+				{
+					metrics.messages_filtered.Add();
+					return;
+				}
+
+				if (status == DECODE_STATUS::INVALID)
+				{
+					metrics.decode_errors.Add();
+					// Thread-safe error handling
+					QMetaObject::invokeMethod(this, [this]()
+						{
+							emit error("Invalid feed message (malformed JSON or missing bids/asks)");
+						}, Qt::QueuedConnection);
+					return;
+				}
+
+				// Delivered on the queue's thread by its next drain or poll; a copy another line already brought is dropped
+				for (FeedMessage& message : messages)
+				{
+					if (!arbitrate || m_arbiter.Accept(line_ptr->index, message, shared_sequence, arrival_ns))
+						m_queue.Push(std::move(message), line_ptr->index);
+				}
+			});
+	}
+}
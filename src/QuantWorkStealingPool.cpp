@@ -0,0 +1,201 @@
+#include "QuantWorkStealingPool.h"
+
+#include <QThread>
+
+#include "QuantRuntimeProfile.h"
+
+namespace
+{
+	constexpr quint64 PackRange(quint64 begin, quint64 end) { return (begin << 32) | end; }
+	constexpr quint64 RangeBegin(quint64 range) { return range >> 32; }
+	constexpr quint64 RangeEnd(quint64 range) { return range & 0xFFFFFFFFull; }
+}
+
+namespace Quant
+{
+	QuantWorkStealingPool::QuantWorkStealingPool(int worker_count)
+	{
+		m_worker_count = worker_count > 0 ? worker_count : qMax(1, QThread::idealThreadCount());
+
+		// Under the low-latency profile, one thread per calculator core besides the caller
+		const int calculator_cores = QuantRuntimeProfile::CoreCount(THREAD_ROLE::CALCULATOR);
+		if (calculator_cores > 0)
+			m_worker_count = qMin(m_worker_count, calculator_cores + 1);
+
+		m_ranges.reset(new WorkRange[m_worker_count]);
+
+		m_threads.reserve(m_worker_count - 1);
+		for (int worker = 1; worker < m_worker_count; worker++)
+			m_threads.emplace_back(&QuantWorkStealingPool::WorkerLoop, this, worker);
+	}
+
+	QuantWorkStealingPool::~QuantWorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+
+		for (std::thread& thread : m_threads)
+			thread.join();
+	}
+
+	void QuantWorkStealingPool::Run(int task_count, const std::function<void(int)>& task)
+	{
+		if (task_count <= 0)
+			return;
+
+		// Small passes are not worth waking anyone
+		if (task_count == 1 || m_worker_count == 1)
+		{
+			for (int idx = 0; idx < task_count; idx++)
+				task(idx);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			// Even split, the first ranges take the remainder
+			const int share = task_count / m_worker_count;
+			const int remainder = task_count % m_worker_count;
+			int begin = 0;
+			for (int worker = 0; worker < m_worker_count; worker++)
+			{
+				const int end = begin + share + (worker < remainder ? 1 : 0);
+				m_ranges[worker].range.store(PackRange(begin, end), std::memory_order_relaxed);
+				begin = end;
+			}
+
+			m_task = &task;
+			m_active = m_worker_count - 1;
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		Drain(0);
+
+		// Workers may still be finishing a stolen task
+		if (QuantRuntimeProfile::SpinsCurrentThread())
+		{
+			while (m_active.load(std::memory_order_acquire) != 0)
+				CpuRelax();
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return m_active == 0; });
+		m_task = nullptr;
+	}
+
+	bool QuantWorkStealingPool::PopFront(int worker, int& task)
+	{
+		std::atomic<quint64>& range = m_ranges[worker].range;
+		quint64 current = range.load(std::memory_order_acquire);
+
+		while (RangeBegin(current) < RangeEnd(current))
+		{
+			const quint64 next = PackRange(RangeBegin(current) + 1, RangeEnd(current));
+			if (range.compare_exchange_weak(current, next, std::memory_order_acq_rel))
+			{
+				task = static_cast<int>(RangeBegin(current));
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool QuantWorkStealingPool::StealBack(int victim, int& task)
+	{
+		std::atomic<quint64>& range = m_ranges[victim].range;
+		quint64 current = range.load(std::memory_order_acquire);
+
+		while (RangeBegin(current) < RangeEnd(current))
+		{
+			const quint64 next = PackRange(RangeBegin(current), RangeEnd(current) - 1);
+			if (range.compare_exchange_weak(current, next, std::memory_order_acq_rel))
+			{
+				task = static_cast<int>(RangeEnd(current) - 1);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void QuantWorkStealingPool::Drain(int worker)
+	{
+		const std::function<void(int)>& task_fn = *m_task;
+		int task = 0;
+
+		for (;;)
+		{
+			if (PopFront(worker, task))
+			{
+				task_fn(task);
+				continue;
+			}
+
+			// Own range is empty, steal from the others
+			bool stolen = false;
+			for (int offset = 1; offset < m_worker_count && !stolen; offset++)
+				stolen = StealBack((worker + offset) % m_worker_count, task);
+
+			// No task is ever added during a pass, so empty ranges mean we are done
+			if (!stolen)
+				return;
+
+			task_fn(task);
+		}
+	}
+
+	bool QuantWorkStealingPool::WaitForPass(quint64& seen_generation, bool spin)
+	{
+		if (spin)
+		{
+			for (;;)
+			{
+				if (m_stop.load(std::memory_order_acquire))
+					return false;
+
+				// Bumped after the ranges and the task are stored, so they are visible once it changes
+				const quint64 generation = m_generation.load(std::memory_order_acquire);
+				if (generation != seen_generation)
+				{
+					seen_generation = generation;
+					return true;
+				}
+				CpuRelax();
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this, seen_generation] { return m_stop || m_generation != seen_generation; });
+		if (m_stop)
+			return false;
+		seen_generation = m_generation;
+		return true;
+	}
+
+	void QuantWorkStealingPool::WorkerLoop(int worker)
+	{
+		QuantRuntimeProfile::PinCurrentThread(THREAD_ROLE::CALCULATOR);
+		const bool spin = QuantRuntimeProfile::SpinsCurrentThread();
+		quint64 seen_generation = 0;
+
+		for (;;)
+		{
+			if (!WaitForPass(seen_generation, spin))
+				return;
+
+			Drain(worker);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_active--;
+			}
+			m_done.notify_one();
+		}
+	}
+}
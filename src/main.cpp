@@ -2,27 +2,74 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QtQml/qqml.h>
+#include <QQuickWindow>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QUrl>
 
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "QuantOrderbook.h"
 #include "QuantWebSocket.h"
+#include "QuantConnectionManager.h"
 #include "QuantInputHandler.h"
 #include "QuantConstants.h"
 #include "QuantCalculatorAPI.h"
+#include "QuantScenarioEngine.h"
+#include "QuantTickStore.h"
+#include "QuantResultsJournal.h"
+#include "QuantMetricsServer.h"
+#include "QuantTracer.h"
+#include "QuantConfig.h"
+#include "QuantDepthChart.h"
+#include "QuantConsolidatedBook.h"
+#include "QuantIngest.h"
+#include "QuantRuntimeProfile.h"
+#include "QuantShmPublisher.h"
+#include "QuantBookSnapshots.h"
+#include "QuantCostServer.h"
 
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
     QQmlApplicationEngine engine;
 
+    // Scene-graph items used by the panels
+    qmlRegisterType<Quant::QuantDepthChart>("Quant", 1, 0, "QuantDepthChart");
+
+    // Span timeline, also toggled at runtime through the metrics server
+    Quant::QuantTracer::SetEnabled(qEnvironmentVariableIntValue("QUANT_TRACE") != 0);
+    Quant::QuantTracer::SetThreadName("gui");
+
+    // Environment and config.json, read once and reloaded when the file changes
+    Quant::QuantConfig config;
+    config.Load();
+    const std::shared_ptr<const Quant::ConfigSnapshot> startup_config = Quant::QuantConfig::Current();
+
+    // Opt-in low-latency profile; must run before the pipeline threads start. The GUI thread drains the selected book
+    Quant::QuantRuntimeProfile::Apply(startup_config->runtime);
+    Quant::QuantRuntimeProfile::PinCurrentThread(Quant::THREAD_ROLE::BOOK);
+    if (startup_config->runtime.low_latency)
+    {
+        // Parsing threads pin themselves when they start, so report once they have
+        QTimer::singleShot(1000, &app, []()
+            {
+                Quant::QuantRuntimeProfile::LogReport();
+            });
+    }
+
     // Create orderbook instance
     Quant::QuantOrderbook orderbook;
     engine.rootContext()->setContextProperty("QuantOrderbookModel", &orderbook);
 
 	// Create input handler instance
 	Quant::QuantInputHandler input_handler;
+	input_handler.SetVolatility(startup_config->volatility);
+	input_handler.SetVolatilityEnabled(startup_config->volatility_enabled);
 	engine.rootContext()->setContextProperty("QuantInputModel", &input_handler);
 
 	// Create calculator API instance
@@ -35,19 +82,173 @@ int main(int argc, char *argv[])
     calculator_api.SetOrderbook(&orderbook);
 
     // Initialize the calculator interface
-	calculator_api.selectedExchange();
+	calculator_api.ResolveExchange();
+
+	// Every calculation result of the session, written in the background
+	Quant::ResultsJournalConfig journal_config;
+	journal_config.directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal";
+	Quant::QuantResultsJournal results_journal(journal_config);
+	if (results_journal.Start())
+		calculator_api.SetJournal(&results_journal);
+
+	// The feed serves the selected instrument
+	const QString symbol = startup_config->symbols.isEmpty() ? input_handler.SelectedAssetString() : startup_config->symbols.first();
+	orderbook.SetInstrument(input_handler.SelectedExchange(), symbol);
+	orderbook.SetDepth(startup_config->DepthFor(symbol));
+
+	// Standing risk scenarios, re-evaluated on every book update
+	const QString scenario_path = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/scenarios.json";
+	Quant::QuantScenarioEngine scenario_engine(nullptr, startup_config->scenario_threads);
+	scenario_engine.LoadScenarios(scenario_path);
+	scenario_engine.SetOrderbook(&orderbook);
+
+	// Opt-in book history, encoded and written on the store's own thread
+	Quant::TickStoreConfig tick_store_config = startup_config->tick_store;
+	if (tick_store_config.root.isEmpty())
+		tick_store_config.root = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/ticks";
+	Quant::QuantTickStore tick_store(tick_store_config);
+	if (tick_store_config.enabled && tick_store.Start())
+		tick_store.SetOrderbook(&orderbook);
+
+	// The instrument on the other configured venues, each over its own connection on the GUI thread
+	std::vector<std::unique_ptr<Quant::QuantOrderbook>> venue_books;
+	std::vector<std::unique_ptr<Quant::QuantWebSocket>> venue_sockets;
+	std::vector<std::unique_ptr<Quant::QuantConnectionManager>> venue_connections;
+	for (const Quant::VenueFeedConfig& venue : startup_config->venues)
+	{
+		const QString venue_symbol = venue.symbol.isEmpty() ? orderbook.Symbol() : venue.symbol;
+
+		auto venue_book = std::make_unique<Quant::QuantOrderbook>();
+		venue_book->SetInstrument(venue.exchange, venue_symbol);
+		venue_book->SetDepth(startup_config->DepthFor(venue_symbol));
+
+		auto venue_socket = std::make_unique<Quant::QuantWebSocket>();
+		venue_socket->SetFeedFormat(venue.exchange);
+		venue_socket->SetSymbolFilter(venue_symbol);
+		QObject::connect(venue_socket.get(), &Quant::QuantWebSocket::orderbookUpdated, venue_book.get(), &Quant::QuantOrderbook::updateOrderbook);
+		QObject::connect(venue_socket.get(), &Quant::QuantWebSocket::orderbookDeltaReceived, venue_book.get(), &Quant::QuantOrderbook::applyDelta);
+
+		auto venue_connection = std::make_unique<Quant::QuantConnectionManager>(venue_socket.get());
+		venue_connection->AddBook(venue_book.get());
+		venue_connection->SetRequestRateLimit(startup_config->requests_per_second);
+
+		venue_books.push_back(std::move(venue_book));
+		venue_sockets.push_back(std::move(venue_socket));
+		venue_connections.push_back(std::move(venue_connection));
+	}
+
+	// Cross-venue book of the instrument, fee-adjusted, swept by the calculator; only with two venues or more
+	std::unique_ptr<Quant::QuantConsolidatedBook> consolidated_book;
+	if (!venue_books.empty())
+	{
+		consolidated_book = std::make_unique<Quant::QuantConsolidatedBook>();
+		consolidated_book->SetFeeTier(input_handler.FeeTier());
+		consolidated_book->AddVenue(&orderbook);
+		for (const std::unique_ptr<Quant::QuantOrderbook>& venue_book : venue_books)
+			consolidated_book->AddVenue(venue_book.get());
+
+		QObject::connect(&input_handler, &Quant::QuantInputHandler::FeeTierChanged, consolidated_book.get(), [&]()
+			{
+				consolidated_book->SetFeeTier(input_handler.FeeTier());
+			});
+		calculator_api.SetConsolidatedBook(consolidated_book.get());
+	}
 
     // Create webSocket instance
     Quant::QuantWebSocket websocket;
 
+	websocket.SetFeedFormat(startup_config->feed_format);
+	websocket.SetRedundantUrls(startup_config->redundant_endpoints);
+
 	// Connect websocket signals to orderbook slots
+    websocket.SetSymbolFilter(orderbook.Symbol());
     QObject::connect(&websocket, &Quant::QuantWebSocket::orderbookUpdated, &orderbook, &Quant::QuantOrderbook::updateOrderbook);
+    QObject::connect(&websocket, &Quant::QuantWebSocket::orderbookDeltaReceived, &orderbook, &Quant::QuantOrderbook::applyDelta);
+    QObject::connect(&websocket, &Quant::QuantWebSocket::topOfBookUpdated, &orderbook, &Quant::QuantOrderbook::updateTopOfBook);
     QObject::connect(&websocket, &Quant::QuantWebSocket::error, &orderbook, 
         [](const QString &error)
         {
             qWarning() << "WebSocket error:" << error;
         });
 
+	// Reconnects, resubscribes and resynchronizes the book after gaps
+	Quant::QuantConnectionManager connection_manager(&websocket);
+	connection_manager.AddBook(&orderbook);
+	connection_manager.SetTopOfBookChannel(startup_config->top_of_book_channel);
+	connection_manager.SetRequestRateLimit(startup_config->requests_per_second);
+
+	// Slow consumers see the latest book instead of a growing backlog
+	websocket.Queue()->SetDefaultPolicy(startup_config->backpressure_policy, startup_config->backpressure_limits);
+	QObject::connect(websocket.Queue(), &Quant::QuantFeedQueue::resyncRequested, &connection_manager, &Quant::QuantConnectionManager::Resync);
+	engine.rootContext()->setContextProperty("QuantConnectionModel", &connection_manager);
+
+	// Books and results for other processes on the host; outlives the ingest threads that publish into it
+	Quant::QuantShmPublisher shm_publisher(startup_config->shm);
+	if (startup_config->shm.enabled && shm_publisher.Start())
+	{
+		shm_publisher.AddOrderbook(&orderbook);
+		calculator_api.SetPublisher(&shm_publisher);
+	}
+
+	// Cost queries from strategies, answered on the service's own threads from the latest book snapshots
+	Quant::QuantBookSnapshots book_snapshots;
+	Quant::QuantCostServer cost_server(startup_config->cost_service, &book_snapshots);
+	if (startup_config->cost_service.enabled)
+		book_snapshots.AddOrderbook(&orderbook);
+
+	// The other configured symbols, spread over their own connections and threads
+	std::unique_ptr<Quant::QuantIngest> ingest;
+	if (startup_config->ingest_connections > 0)
+	{
+		ingest = std::make_unique<Quant::QuantIngest>(startup_config->ingest_connections);
+		for (const QString& ingest_symbol : startup_config->symbols)
+		{
+			if (ingest_symbol == orderbook.Symbol())
+				continue;
+
+			Quant::QuantOrderbook* ingest_book = ingest->AddSymbol(input_handler.SelectedExchange(), ingest_symbol, startup_config->DepthFor(ingest_symbol));
+			if (shm_publisher.IsRunning())
+				shm_publisher.AddOrderbook(ingest_book);
+			if (startup_config->cost_service.enabled)
+				book_snapshots.AddOrderbook(ingest_book);
+		}
+		ingest->SetFeedSettings(startup_config->top_of_book_channel, startup_config->backpressure_policy, startup_config->backpressure_limits,
+			startup_config->requests_per_second);
+		ingest->LoadScenarios(scenario_path);
+	}
+
+	if (startup_config->cost_service.enabled)
+		cost_server.Start();
+
+	// Counters and stage latencies for Prometheus, at http://127.0.0.1:9464/metrics
+	Quant::QuantMetricsServer metrics_server;
+	metrics_server.Listen(startup_config->metrics_port);
+
+	// Settings that apply without a restart
+	QObject::connect(&config, &Quant::QuantConfig::configChanged, &app, [&]()
+		{
+			const std::shared_ptr<const Quant::ConfigSnapshot> current = Quant::QuantConfig::Current();
+			orderbook.SetDepth(current->DepthFor(orderbook.Symbol()));
+			websocket.Queue()->SetDefaultPolicy(current->backpressure_policy, current->backpressure_limits);
+			connection_manager.SetTopOfBookChannel(current->top_of_book_channel);
+			connection_manager.SetRequestRateLimit(current->requests_per_second);
+			for (const std::unique_ptr<Quant::QuantConnectionManager>& venue_connection : venue_connections)
+				venue_connection->SetRequestRateLimit(current->requests_per_second);
+			if (ingest)
+				ingest->SetFeedSettings(current->top_of_book_channel, current->backpressure_policy, current->backpressure_limits, current->requests_per_second);
+
+			if (current->socket_endpoint != connection_manager.Url() || current->feed_format != websocket.FeedFormat()
+				|| current->redundant_endpoints != websocket.RedundantUrls())
+			{
+				connection_manager.Stop();
+				websocket.SetFeedFormat(current->feed_format);
+				websocket.SetRedundantUrls(current->redundant_endpoints);
+				connection_manager.Start(current->socket_endpoint);
+				if (ingest)
+					ingest->Start(current->socket_endpoint, current->redundant_endpoints, current->feed_format);
+			}
+		});
+
 	// Load QML file
     const QUrl url(u"qrc:/Main/interface/main.qml"_qs);
 
@@ -61,8 +262,36 @@ int main(int argc, char *argv[])
         Qt::QueuedConnection);
 
     // Start Websocket connection
-    websocket.connect(Quant::QuantConstants::SOCKET_ENDPOINT);
+    connection_manager.Start(startup_config->socket_endpoint);
+	for (size_t idx = 0; idx < venue_connections.size(); idx++)
+		venue_connections[idx]->Start(startup_config->venues[static_cast<int>(idx)].endpoint);
+	if (ingest)
+		ingest->Start(startup_config->socket_endpoint, startup_config->redundant_endpoints, startup_config->feed_format);
 
     engine.load(url);
+
+    // QML refresh: scene graph sync through the swapped frame, on the render thread
+    if (!engine.rootObjects().isEmpty())
+    {
+        if (QQuickWindow* window = qobject_cast<QQuickWindow*>(engine.rootObjects().first()))
+        {
+            auto frame_begin_ns = std::make_shared<std::atomic<qint64>>(0);
+            QObject::connect(window, &QQuickWindow::beforeSynchronizing, window, [frame_begin_ns]()
+                {
+                    if (Quant::QuantTracer::IsEnabled())
+                    {
+                        Quant::QuantTracer::SetThreadName("qsg-render");
+                        frame_begin_ns->store(Quant::QuantTracer::Now(), std::memory_order_relaxed);
+                    }
+                }, Qt::DirectConnection);
+            QObject::connect(window, &QQuickWindow::frameSwapped, window, [frame_begin_ns]()
+                {
+                    const qint64 begin_ns = frame_begin_ns->exchange(0, std::memory_order_relaxed);
+                    if (begin_ns > 0 && Quant::QuantTracer::IsEnabled())
+                        Quant::QuantTracer::Record("qml_refresh", "ui", begin_ns, Quant::QuantTracer::Now());
+                }, Qt::DirectConnection);
+        }
+    }
+
     return app.exec();
 }
\ No newline at end of file
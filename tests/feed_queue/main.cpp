@@ -0,0 +1,225 @@
+// Checks that the feed queue's conflation keeps lost messages visible to the book:
+// contiguous deltas merge, a delta after a skipped one still trips the gap check,
+// and a redundant line's copy of the skipped message closes the gap. Under busy
+// polling the same messages go through the producers' rings, and a full ring
+// resynchronizes the symbol. Returns nonzero when a check fails.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+
+#include "QuantFeedArbiter.h"
+#include "QuantFeedQueue.h"
+#include "QuantOrderbook.h"
+#include "QuantRuntimeProfile.h"
+
+namespace
+{
+	using namespace Quant;
+
+	const QString symbol = QStringLiteral("BTC-USDT");
+
+	int failures = 0;
+
+	void Check(bool condition, const char* what)
+	{
+		if (!condition)
+		{
+			std::printf("FAIL: %s\n", what);
+			failures++;
+		}
+	}
+
+	FeedMessage Snapshot(qint64 seq_id)
+	{
+		FeedMessage message;
+		message.symbol = symbol;
+		message.bids = { { 100.0, 1.0 }, { 99.0, 2.0 } };
+		message.asks = { { 101.0, 1.0 }, { 102.0, 2.0 } };
+		message.seq_id = seq_id;
+		return message;
+	}
+
+	FeedMessage Delta(qint64 prev_seq_id, qint64 seq_id, double bid_amount)
+	{
+		FeedMessage message;
+		message.symbol = symbol;
+		message.bids = { { 100.0, bid_amount } };
+		message.is_delta = true;
+		message.seq_id = seq_id;
+		message.prev_seq_id = prev_seq_id;
+		return message;
+	}
+
+	struct Harness
+	{
+		QuantFeedQueue queue;
+		QuantOrderbook book;
+		int gaps = 0;
+		qint64 gap_expected = -1;
+		qint64 gap_received = -1;
+
+		Harness()
+		{
+			queue.SetDefaultPolicy(BACKPRESSURE_POLICY::CONFLATE);
+			QObject::connect(&queue, &QuantFeedQueue::snapshotReady, &book,
+				[this](const QVector<BookLevel>& bids, const QVector<BookLevel>& asks, qint64 seq_id) { book.updateOrderbook(bids, asks, seq_id); });
+			QObject::connect(&queue, &QuantFeedQueue::deltaReady, &book,
+				[this](const QVector<BookLevel>& bids, const QVector<BookLevel>& asks, qint64 seq_id, qint64 prev_seq_id) { book.applyDelta(bids, asks, seq_id, prev_seq_id); });
+			QObject::connect(&book, &QuantOrderbook::sequenceGap, &book,
+				[this](qint64 expected, qint64 received)
+				{
+					gaps++;
+					gap_expected = expected;
+					gap_received = received;
+				});
+		}
+
+		// Everything pushed so far is pending until the queue's drain (or poll) runs here
+		void Drain() { QCoreApplication::processEvents(); }
+	};
+
+	void CheckContiguousDeltasMerge()
+	{
+		Harness harness;
+		harness.queue.Push(Snapshot(10));
+		harness.queue.Push(Delta(10, 11, 3.0));
+		harness.queue.Push(Delta(11, 12, 4.0));
+		harness.Drain();
+
+		Check(harness.gaps == 0, "contiguous: no gap");
+		Check(harness.queue.Stats(symbol).conflated == 2, "contiguous: both deltas merged into the snapshot");
+		Check(harness.book.SequenceId() == 12, "contiguous: book at the last sequence id");
+		Check(harness.book.BestBid().amount == 4.0, "contiguous: book holds the latest level");
+	}
+
+	void CheckLostDeltaTripsGap()
+	{
+		Harness harness;
+		harness.queue.Push(Snapshot(10));
+		harness.Drain();
+
+		// 12 -> 13 is lost while the consumer is busy
+		harness.queue.Push(Delta(10, 11, 3.0));
+		harness.queue.Push(Delta(11, 12, 4.0));
+		harness.queue.Push(Delta(13, 14, 5.0));
+		harness.queue.Push(Delta(14, 15, 6.0));
+		harness.Drain();
+
+		Check(harness.gaps == 1, "lost delta: sequenceGap emitted");
+		Check(harness.gap_expected == 12 && harness.gap_received == 13, "lost delta: gap between 12 and 13");
+		Check(harness.book.isStale(), "lost delta: book waits for a snapshot");
+		Check(harness.queue.Stats(symbol).conflated == 2, "lost delta: only contiguous deltas merged");
+	}
+
+	void CheckRedundantLineFillsGap()
+	{
+		Harness harness;
+		QuantFeedArbiter arbiter;
+		auto deliver = [&harness, &arbiter](int line, FeedMessage message)
+			{
+				if (arbiter.Accept(line, message, true, 0))
+					harness.queue.Push(std::move(message));
+			};
+
+		deliver(0, Snapshot(10));
+		deliver(1, Snapshot(10));
+		harness.Drain();
+
+		// Line 0 is faster but skips 11 -> 12; line 1 brings every message later
+		deliver(0, Delta(10, 11, 3.0));
+		deliver(0, Delta(12, 13, 5.0));
+		deliver(1, Delta(10, 11, 3.0));
+		deliver(1, Delta(11, 12, 4.0));
+		deliver(1, Delta(12, 13, 5.0));
+		harness.Drain();
+
+		Check(arbiter.Stats(1).won == 1, "redundant line: only the skipped message forwarded from the slower line");
+		Check(arbiter.Stats(1).duplicates == 3, "redundant line: its other copies dropped");
+		Check(harness.gaps == 0, "redundant line: no gap");
+		Check(harness.book.SequenceId() == 13, "redundant line: book at the last sequence id");
+		Check(harness.book.BestBid().amount == 5.0, "redundant line: book holds the latest level");
+		Check(harness.queue.Stats(symbol).conflated == 2, "redundant line: the run closed up around the late copy");
+	}
+
+	void CheckSnapshotSupersedesBacklog()
+	{
+		Harness harness;
+		harness.queue.Push(Snapshot(10));
+		harness.Drain();
+
+		harness.queue.Push(Delta(10, 11, 3.0));
+		harness.queue.Push(Delta(13, 14, 5.0));
+		harness.queue.Push(Snapshot(20));
+		harness.Drain();
+
+		Check(harness.gaps == 0, "snapshot: backlog with a gap replaced");
+		Check(harness.book.SequenceId() == 20, "snapshot: book at the snapshot");
+	}
+
+	// Pins this thread for good, so it runs last; skipped where the thread cannot be pinned
+	void CheckBusyPollHandoff()
+	{
+		RuntimeProfileConfig profile;
+		profile.low_latency = true;
+		profile.lock_memory = false;
+		profile.cores[static_cast<int>(THREAD_ROLE::BOOK)] = { 0 };
+		QuantRuntimeProfile::Apply(profile);
+		QuantRuntimeProfile::PinCurrentThread(THREAD_ROLE::BOOK);
+		if (!QuantRuntimeProfile::SpinsCurrentThread())
+		{
+			std::printf("Busy polling unavailable here, handoff checks skipped\n");
+			return;
+		}
+
+		Harness harness;
+		harness.queue.SetProducerCount(1);
+		Check(harness.queue.IsBusyPolling(), "busy poll: queue polls its rings");
+
+		harness.queue.Push(Snapshot(10), 0);
+		harness.queue.Push(Delta(10, 11, 3.0), 0);
+		harness.queue.Push(Delta(11, 12, 4.0), 0);
+		harness.Drain();
+
+		Check(harness.gaps == 0, "busy poll: no gap");
+		Check(harness.queue.Stats(symbol).conflated == 2, "busy poll: handed-over deltas merged");
+		Check(harness.book.SequenceId() == 12, "busy poll: book at the last sequence id");
+
+		// More than a ring holds while the book thread is away
+		int resyncs = 0;
+		QObject::connect(&harness.queue, &QuantFeedQueue::resyncRequested, &harness.book, [&resyncs](const QString&) { resyncs++; });
+		for (qint64 seq_id = 12; seq_id < 12 + 5000; seq_id++)
+			harness.queue.Push(Delta(seq_id, seq_id + 1, 5.0), 0);
+		harness.Drain();
+
+		Check(resyncs == 1, "busy poll: full ring resynchronizes the symbol");
+		Check(harness.queue.Stats(symbol).resyncs == 1, "busy poll: resync counted");
+
+		// Deltas wait for the snapshot the resync brings
+		harness.queue.Push(Delta(5012, 5013, 6.0), 0);
+		harness.queue.Push(Snapshot(6000), 0);
+		harness.Drain();
+		Check(harness.book.SequenceId() == 6000, "busy poll: book back at the snapshot");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	CheckContiguousDeltasMerge();
+	CheckLostDeltaTripsGap();
+	CheckRedundantLineFillsGap();
+	CheckSnapshotSupersedesBacklog();
+	CheckBusyPollHandoff();
+
+	if (failures)
+	{
+		std::printf("%d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	std::printf("All feed queue checks passed\n");
+	return EXIT_SUCCESS;
+}
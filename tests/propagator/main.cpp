@@ -0,0 +1,171 @@
+// Checks that the propagator's direct sum, FFT convolution and recursion give the same
+// impact path, and that calibration recovers the parameters of a synthetic price path.
+// Returns nonzero when a check fails.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "QuantPropagator.h"
+
+namespace
+{
+	using namespace Quant;
+
+	constexpr double path_tolerance = 1e-9; // Of the largest impact on the path
+	const int slice_counts[] = { 1, 2, 7, 63, 64, 65, 300, 1000 };
+
+	int failures = 0;
+
+	void Check(bool condition, const char* what)
+	{
+		if (!condition)
+		{
+			std::printf("FAIL: %s\n", what);
+			failures++;
+		}
+	}
+
+	std::vector<double> RandomVolumes(std::mt19937& random, int count)
+	{
+		std::uniform_real_distribution<double> volume(-5.0, 10.0);
+		std::vector<double> volumes(count);
+		for (double& value : volumes)
+			value = volume(random);
+		return volumes;
+	}
+
+	double MaxDifference(const std::vector<double>& lhs, const std::vector<double>& rhs)
+	{
+		double largest = 0.0;
+		double difference = 0.0;
+		for (size_t idx = 0; idx < lhs.size(); idx++)
+		{
+			largest = std::max(largest, std::abs(lhs[idx]));
+			difference = std::max(difference, std::abs(lhs[idx] - rhs[idx]));
+		}
+		return largest > 0.0 ? difference / largest : difference;
+	}
+
+	std::vector<double> Path(QuantPropagator& propagator, const std::vector<double>& volumes, double slice_seconds, PROPAGATOR_METHOD method)
+	{
+		std::vector<double> impact(volumes.size());
+		propagator.ImpactPath(volumes.data(), static_cast<int>(volumes.size()), slice_seconds, impact.data(), method);
+		return impact;
+	}
+
+	void CheckMethodsAgree()
+	{
+		std::mt19937 random(7);
+
+		PropagatorParams power_law;
+		power_law.kernel = PROPAGATOR_KERNEL::POWER_LAW;
+		power_law.strength = 0.002;
+		power_law.decay_seconds = 20.0;
+		power_law.exponent = 0.6;
+		power_law.volume_scale = 50.0;
+
+		PropagatorParams exponential = power_law;
+		exponential.kernel = PROPAGATOR_KERNEL::EXPONENTIAL;
+
+		// One propagator per kernel across grids, so the cached lags and spectrum are exercised too
+		QuantPropagator power_law_propagator(power_law);
+		QuantPropagator exponential_propagator(exponential);
+		for (double slice_seconds : { 1.0, 2.5 })
+		{
+			for (int count : slice_counts)
+			{
+				const std::vector<double> volumes = RandomVolumes(random, count);
+
+				const std::vector<double> direct = Path(power_law_propagator, volumes, slice_seconds, PROPAGATOR_METHOD::DIRECT);
+				const std::vector<double> fft = Path(power_law_propagator, volumes, slice_seconds, PROPAGATOR_METHOD::FFT);
+				Check(MaxDifference(direct, fft) < path_tolerance, "power law: FFT matches the direct sum");
+
+				const std::vector<double> exp_direct = Path(exponential_propagator, volumes, slice_seconds, PROPAGATOR_METHOD::DIRECT);
+				const std::vector<double> exp_fft = Path(exponential_propagator, volumes, slice_seconds, PROPAGATOR_METHOD::FFT);
+				const std::vector<double> exp_recursive = Path(exponential_propagator, volumes, slice_seconds, PROPAGATOR_METHOD::RECURSIVE);
+				Check(MaxDifference(exp_direct, exp_fft) < path_tolerance, "exponential: FFT matches the direct sum");
+				Check(MaxDifference(exp_direct, exp_recursive) < path_tolerance, "exponential: recursion matches the direct sum");
+			}
+		}
+	}
+
+	// Buys every 2 s for a minute, then the mid observed every second for five minutes
+	void SyntheticPath(const PropagatorParams& truth, std::vector<PropagatorFill>& fills, std::vector<PriceObservation>& path)
+	{
+		for (int idx = 0; idx < 30; idx++)
+			fills.push_back({ 2.0 * idx, 5.0 + (idx % 3) });
+
+		QuantPropagator propagator(truth);
+		size_t recorded = 0;
+		for (int second = 0; second <= 300; second++)
+		{
+			for (; recorded < fills.size() && fills[recorded].time_seconds <= second; recorded++)
+				propagator.RecordFill(fills[recorded].volume, fills[recorded].time_seconds);
+			path.push_back({ static_cast<double>(second), propagator.ImpactAt(second) });
+		}
+	}
+
+	void CheckCalibration()
+	{
+		for (PROPAGATOR_KERNEL kernel : { PROPAGATOR_KERNEL::POWER_LAW, PROPAGATOR_KERNEL::EXPONENTIAL })
+		{
+			PropagatorParams truth;
+			truth.kernel = kernel;
+			truth.strength = 0.0015;
+			truth.decay_seconds = 30.0;
+			truth.volume_scale = 20.0;
+
+			std::vector<PropagatorFill> fills;
+			std::vector<PriceObservation> path;
+			SyntheticPath(truth, fills, path);
+
+			PropagatorParams shape = truth;
+			shape.strength = 1.0;
+			shape.decay_seconds = 1.0;
+
+			// The true decay among the candidates is recovered exactly
+			const PropagatorFit exact = QuantPropagator::Calibrate(shape, fills, path, { 5.0, 10.0, 30.0, 60.0, 120.0 });
+			Check(exact.valid, "calibration: fit found");
+			Check(exact.params.decay_seconds == truth.decay_seconds, "calibration: decay recovered");
+			Check(std::abs(exact.params.strength / truth.strength - 1.0) < 1e-9, "calibration: strength recovered");
+			Check(exact.r_squared > 1.0 - 1e-12, "calibration: exact fit explains the path");
+			Check(exact.observations == static_cast<int>(path.size()), "calibration: observations counted");
+
+			// On the default grid, the nearest candidates win and the strength follows
+			const PropagatorFit grid = QuantPropagator::Calibrate(shape, fills, path);
+			const double grid_step = std::pow(600.0, 1.0 / 24.0);
+			Check(grid.valid, "calibration: grid fit found");
+			Check(grid.params.decay_seconds > truth.decay_seconds / grid_step && grid.params.decay_seconds < truth.decay_seconds * grid_step,
+				"calibration: grid decay next to the true one");
+			Check(std::abs(grid.params.strength / truth.strength - 1.0) < 0.2, "calibration: grid strength close to the true one");
+			Check(grid.r_squared > 0.99, "calibration: grid fit explains the path");
+
+			// Moves against our fills are no impact of ours
+			std::vector<PriceObservation> against = path;
+			for (PriceObservation& observation : against)
+				observation.price_move = -observation.price_move;
+			Check(!QuantPropagator::Calibrate(shape, fills, against).valid, "calibration: no fit with a negative strength");
+		}
+
+		Check(!QuantPropagator::Calibrate(PropagatorParams(), {}, { { 1.0, 0.001 } }).valid, "calibration: no fit without fills");
+	}
+}
+
+int main()
+{
+	CheckMethodsAgree();
+	CheckCalibration();
+
+	if (failures)
+	{
+		std::printf("%d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	std::printf("All propagator checks passed\n");
+	return EXIT_SUCCESS;
+}
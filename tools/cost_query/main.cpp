@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QTextStream>
+
+#include "QuantCostServiceFormat.h"
+
+namespace
+{
+	namespace Format = Quant::CostServiceFormat;
+
+	constexpr int connect_timeout_ms = 2000;
+	constexpr int response_timeout_ms = 5000;
+
+	// Values of IQuantCalculatorAPI.h; the tool only needs the wire format
+	int IndexOf(const QStringList& names, const QString& name)
+	{
+		return static_cast<int>(names.indexOf(name.toUpper()));
+	}
+
+	const QStringList exchange_names = { "NONE", "OKX", "BINANCE", "COINBASE", "MEXC" };
+	const QStringList side_names = { "BUY", "SELL" };
+	const QStringList order_type_names = { "MARKET", "LIMIT", "STOP_LOSS", "TAKE_PROFIT", "TRAILING_STOP_MARKET", "TRAILING_STOP_LIMIT" };
+
+	const char* StatusName(quint8 status)
+	{
+		switch (status)
+		{
+		case Format::OK: return "OK";
+		case Format::UNKNOWN_BOOK: return "UNKNOWN_BOOK";
+		case Format::EMPTY_BOOK: return "EMPTY_BOOK";
+		case Format::UNSUPPORTED_EXCHANGE: return "UNSUPPORTED_EXCHANGE";
+		case Format::INVALID_QUERY: return "INVALID_QUERY";
+		case Format::BUSY: return "BUSY";
+		default: return "?";
+		}
+	}
+
+	bool ReadExactly(QIODevice& socket, char* data, qint64 size)
+	{
+		qint64 done = 0;
+		while (done < size)
+		{
+			if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(response_timeout_ms))
+				return false;
+
+			const qint64 read = socket.read(data + done, size - done);
+			if (read < 0)
+				return false;
+			done += read;
+		}
+		return true;
+	}
+
+	bool Flush(QIODevice& socket)
+	{
+		while (socket.bytesToWrite() > 0)
+		{
+			if (!socket.waitForBytesWritten(response_timeout_ms))
+				return false;
+		}
+		return true;
+	}
+
+	// One request and its response; results are left empty for a BUSY batch
+	bool RoundTrip(QIODevice& socket, quint64 request_id, const std::vector<Format::Query>& queries, Format::ResponseHeader& header, std::vector<Format::Result>& results)
+	{
+		Format::RequestHeader request;
+		request.query_count = static_cast<quint16>(queries.size());
+		request.request_id = request_id;
+
+		QByteArray frame(reinterpret_cast<const char*>(&request), sizeof(request));
+		frame.append(reinterpret_cast<const char*>(queries.data()), static_cast<qsizetype>(queries.size() * sizeof(Format::Query)));
+		socket.write(frame);
+		if (!Flush(socket))
+			return false;
+
+		if (!ReadExactly(socket, reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != Format::response_magic || header.request_id != request_id)
+			return false;
+
+		results.resize(header.result_count);
+		return ReadExactly(socket, reinterpret_cast<char*>(results.data()), static_cast<qint64>(results.size() * sizeof(Format::Result)));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("QuantCostQuery");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Asks the simulator's cost service for the cost of an order");
+	parser.addHelpOption();
+
+	const QCommandLineOption socket_option("socket", "Local socket name or path of the service.", "name", "quant-cost");
+	const QCommandLineOption tcp_option("tcp", "Loopback TCP port of the service, instead of the local socket.", "port");
+	const QCommandLineOption exchange_option("exchange", "Exchange name.", "name", "OKX");
+	const QCommandLineOption symbol_option("symbol", "Instrument.", "symbol", "BTC-USDT-SWAP");
+	const QCommandLineOption side_option("side", "buy or sell.", "side", "buy");
+	const QCommandLineOption size_option("size", "Order size.", "size", "1000");
+	const QCommandLineOption unit_option("unit", "quote (USD) or base (e.g. BTC).", "unit", "quote");
+	const QCommandLineOption fee_tier_option("fee-tier", "VIP fee tier, 0 to 9.", "tier", "0");
+	const QCommandLineOption order_type_option("order-type", "market, limit, stop_loss, take_profit, trailing_stop_market or trailing_stop_limit.", "type", "market");
+	const QCommandLineOption bench_option("bench", "Send this many requests and report throughput and round-trip latency.", "requests");
+	const QCommandLineOption batch_option("batch", "Queries per request.", "queries", "1");
+
+	parser.addOptions({ socket_option, tcp_option, exchange_option, symbol_option, side_option, size_option, unit_option,
+		fee_tier_option, order_type_option, bench_option, batch_option });
+	parser.process(app);
+
+	QTextStream out(stdout);
+	out.setRealNumberPrecision(12);
+
+	Format::Query query;
+	const QByteArray symbol = parser.value(symbol_option).toLatin1();
+	if (symbol.isEmpty() || symbol.size() > Format::symbol_size)
+	{
+		out << "Invalid symbol " << parser.value(symbol_option) << Qt::endl;
+		return 1;
+	}
+	std::memcpy(query.symbol, symbol.constData(), symbol.size());
+
+	const int exchange = IndexOf(exchange_names, parser.value(exchange_option));
+	const int side = IndexOf(side_names, parser.value(side_option));
+	const int order_type = IndexOf(order_type_names, parser.value(order_type_option));
+	const int fee_tier = parser.value(fee_tier_option).toInt();
+	bool size_ok = false;
+	query.size = parser.value(size_option).toDouble(&size_ok);
+	if (exchange <= 0 || side < 0 || order_type < 0 || fee_tier < 0 || fee_tier > 9 || !size_ok)
+	{
+		out << "Invalid exchange, side, order type, fee tier or size" << Qt::endl;
+		return 1;
+	}
+	query.exchange = static_cast<quint8>(exchange);
+	query.order_side = static_cast<quint8>(side);
+	query.order_type = static_cast<quint8>(order_type);
+	query.fee_tier = static_cast<quint8>(fee_tier);
+	query.size_unit = parser.value(unit_option).compare("base", Qt::CaseInsensitive) == 0 ? Format::BASE : Format::QUOTE;
+
+	const int batch = std::clamp(parser.value(batch_option).toInt(), 1, Format::max_queries);
+	const std::vector<Format::Query> queries(batch, query);
+
+	QLocalSocket local_socket;
+	QTcpSocket tcp_socket;
+	QIODevice* socket = nullptr;
+	if (parser.isSet(tcp_option))
+	{
+		tcp_socket.connectToHost("127.0.0.1", static_cast<quint16>(parser.value(tcp_option).toUInt()));
+		tcp_socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+		if (tcp_socket.waitForConnected(connect_timeout_ms))
+			socket = &tcp_socket;
+	}
+	else
+	{
+		local_socket.connectToServer(parser.value(socket_option));
+		if (local_socket.waitForConnected(connect_timeout_ms))
+			socket = &local_socket;
+	}
+	if (!socket)
+	{
+		out << "Cannot connect to the cost service" << Qt::endl;
+		return 1;
+	}
+
+	Format::ResponseHeader header;
+	std::vector<Format::Result> results;
+
+	if (!parser.isSet(bench_option))
+	{
+		if (!RoundTrip(*socket, 1, queries, header, results))
+		{
+			out << "No response from the cost service" << Qt::endl;
+			return 1;
+		}
+		if (header.status != Format::OK)
+		{
+			out << "Request refused: " << StatusName(header.status) << Qt::endl;
+			return 1;
+		}
+
+		const Format::Result& result = results.front();
+		out << "status," << StatusName(result.status) << Qt::endl
+			<< "book_version," << result.book_version << Qt::endl
+			<< "book_timestamp_ns," << result.book_timestamp_ns << Qt::endl
+			<< "stale," << result.stale << Qt::endl
+			<< "usd_amount," << result.usd_amount << Qt::endl
+			<< "crypto_amount," << result.crypto_amount << Qt::endl
+			<< "fees," << result.fees << Qt::endl
+			<< "slippage," << result.slippage << Qt::endl
+			<< "market_impact," << result.market_impact << Qt::endl
+			<< "market_order_cost," << result.market_order_cost << Qt::endl
+			<< "net_cost," << result.net_cost << Qt::endl
+			<< "maker_ratio," << result.maker_ratio << Qt::endl
+			<< "volatility," << result.volatility << Qt::endl
+			<< "liquidity_exhausted," << result.liquidity_exhausted << Qt::endl
+			<< "unfilled_usd," << result.unfilled_usd << Qt::endl;
+		return 0;
+	}
+
+	// One request in flight at a time: latency is the full round trip as a strategy sees it
+	const int requests = qMax(1, parser.value(bench_option).toInt());
+	std::vector<qint64> round_trips_ns;
+	round_trips_ns.reserve(requests);
+	int refused = 0;
+
+	QElapsedTimer total;
+	total.start();
+	for (int idx = 0; idx < requests; idx++)
+	{
+		QElapsedTimer round_trip;
+		round_trip.start();
+		if (!RoundTrip(*socket, static_cast<quint64>(idx) + 1, queries, header, results))
+		{
+			out << "No response to request " << idx + 1 << Qt::endl;
+			return 1;
+		}
+		round_trips_ns.push_back(round_trip.nsecsElapsed());
+		if (header.status == Format::BUSY)
+			refused++;
+	}
+	const double seconds = total.nsecsElapsed() / 1e9;
+
+	std::sort(round_trips_ns.begin(), round_trips_ns.end());
+	const auto percentile_us = [&round_trips_ns](double fraction)
+		{
+			const size_t idx = std::min(round_trips_ns.size() - 1, static_cast<size_t>(fraction * round_trips_ns.size()));
+			return round_trips_ns[idx] / 1e3;
+		};
+
+	out << "requests," << requests << Qt::endl
+		<< "queries_per_request," << batch << Qt::endl
+		<< "refused," << refused << Qt::endl
+		<< "requests_per_second," << requests / seconds << Qt::endl
+		<< "queries_per_second," << requests * static_cast<double>(batch) / seconds << Qt::endl
+		<< "p50_us," << percentile_us(0.50) << Qt::endl
+		<< "p99_us," << percentile_us(0.99) << Qt::endl
+		<< "max_us," << round_trips_ns.back() / 1e3 << Qt::endl;
+	return 0;
+}
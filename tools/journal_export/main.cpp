@@ -0,0 +1,169 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <vector>
+
+#include "QuantResultsJournal.h"
+
+namespace
+{
+	using Quant::JournalFormat::JournalRecord;
+
+	struct Column
+	{
+		const char* name;
+		const char* type;
+		std::vector<char> data;
+		void (*append)(std::vector<char>& data, const JournalRecord& record);
+	};
+
+	template <typename T>
+	void AppendValue(std::vector<char>& data, const T& value)
+	{
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		data.insert(data.end(), bytes, bytes + sizeof(T));
+	}
+
+#define JOURNAL_COLUMN(field, type_name) \
+	Column{ #field, type_name, {}, [](std::vector<char>& data, const JournalRecord& record) { AppendValue(data, record.field); } }
+
+	std::vector<Column> MakeColumns()
+	{
+		return {
+			JOURNAL_COLUMN(timestamp_ns, "int64"),
+			JOURNAL_COLUMN(book_version, "uint64"),
+			JOURNAL_COLUMN(symbol, "S32"),
+			JOURNAL_COLUMN(exchange, "uint8"),
+			JOURNAL_COLUMN(order_type, "uint8"),
+			JOURNAL_COLUMN(order_side, "uint8"),
+			JOURNAL_COLUMN(fee_tier, "uint8"),
+			JOURNAL_COLUMN(volatility_enabled, "uint8"),
+			JOURNAL_COLUMN(liquidity_exhausted, "uint8"),
+			JOURNAL_COLUMN(usd_amount, "float64"),
+			JOURNAL_COLUMN(input_volatility, "float64"),
+			JOURNAL_COLUMN(volatility, "float64"),
+			JOURNAL_COLUMN(fees, "float64"),
+			JOURNAL_COLUMN(slippage, "float64"),
+			JOURNAL_COLUMN(market_impact, "float64"),
+			JOURNAL_COLUMN(market_order_cost, "float64"),
+			JOURNAL_COLUMN(net_cost, "float64"),
+			JOURNAL_COLUMN(crypto_amount, "float64"),
+			JOURNAL_COLUMN(maker_ratio, "float64"),
+			JOURNAL_COLUMN(processing_time_ms, "float64"),
+		};
+	}
+
+#undef JOURNAL_COLUMN
+
+	bool ExportCsv(const Quant::QuantResultsJournalReader& reader, const QString& path)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+			return false;
+
+		QTextStream out(&file);
+		out.setRealNumberPrecision(12);
+		out << "timestamp_ns,book_version,symbol,exchange,order_type,order_side,fee_tier,volatility_enabled,liquidity_exhausted,usd_amount,input_volatility,"
+			"volatility,fees,slippage,market_impact,market_order_cost,net_cost,crypto_amount,maker_ratio,processing_time_ms\n";
+
+		return reader.ForEach([&out](const JournalRecord& record)
+			{
+				out << record.timestamp_ns << ',' << record.book_version << ','
+					<< QLatin1String(record.symbol, qstrnlen(record.symbol, Quant::JournalFormat::symbol_size)) << ','
+					<< int(record.exchange) << ',' << int(record.order_type) << ',' << int(record.order_side) << ','
+					<< int(record.fee_tier) << ',' << int(record.volatility_enabled) << ',' << int(record.liquidity_exhausted) << ','
+					<< record.usd_amount << ',' << record.input_volatility << ','
+					<< record.volatility << ',' << record.fees << ',' << record.slippage << ','
+					<< record.market_impact << ',' << record.market_order_cost << ',' << record.net_cost << ','
+					<< record.crypto_amount << ',' << record.maker_ratio << ',' << record.processing_time_ms << '\n';
+			});
+	}
+
+	// One little-endian binary file per field plus a schema, loadable with numpy.fromfile
+	bool ExportColumns(const Quant::QuantResultsJournalReader& reader, const QString& directory)
+	{
+		if (!QDir().mkpath(directory))
+			return false;
+
+		std::vector<Column> columns = MakeColumns();
+		const bool complete = reader.ForEach([&columns](const JournalRecord& record)
+			{
+				for (Column& column : columns)
+					column.append(column.data, record);
+			});
+
+		QJsonArray schema;
+		for (const Column& column : columns)
+		{
+			QFile file(QDir(directory).filePath(QString(column.name) + ".bin"));
+			if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+				return false;
+			file.write(column.data.data(), static_cast<qint64>(column.data.size()));
+
+			QJsonObject entry;
+			entry["name"] = column.name;
+			entry["type"] = column.type;
+			schema.append(entry);
+		}
+
+		QJsonObject manifest;
+		manifest["rows"] = reader.RecordCount();
+		manifest["columns"] = schema;
+
+		QFile schema_file(QDir(directory).filePath("schema.json"));
+		if (!schema_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			return false;
+		schema_file.write(QJsonDocument(manifest).toJson());
+		return complete;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("QuantJournalExport");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Exports a results journal to CSV or to one binary file per column");
+	parser.addHelpOption();
+	parser.addPositionalArgument("journal", "Journal file (.qrj).");
+
+	const QCommandLineOption csv_option("csv", "Write a CSV file.", "file");
+	const QCommandLineOption columns_option("columns", "Write one binary file per column into a directory.", "directory");
+	parser.addOptions({ csv_option, columns_option });
+	parser.process(app);
+
+	QTextStream err(stderr);
+	if (parser.positionalArguments().isEmpty() || (!parser.isSet(csv_option) && !parser.isSet(columns_option)))
+	{
+		parser.showHelp(1);
+	}
+
+	const Quant::QuantResultsJournalReader reader(parser.positionalArguments().first());
+	if (!reader.IsValid())
+	{
+		err << "Not a results journal: " << parser.positionalArguments().first() << Qt::endl;
+		return 1;
+	}
+
+	if (parser.isSet(csv_option) && !ExportCsv(reader, parser.value(csv_option)))
+	{
+		err << "CSV export failed" << Qt::endl;
+		return 1;
+	}
+
+	if (parser.isSet(columns_option) && !ExportColumns(reader, parser.value(columns_option)))
+	{
+		err << "Column export failed" << Qt::endl;
+		return 1;
+	}
+
+	err << reader.RecordCount() << " records exported" << Qt::endl;
+	return 0;
+}
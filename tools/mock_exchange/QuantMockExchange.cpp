@@ -0,0 +1,359 @@
+#include "QuantMockExchange.h"
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+namespace
+{
+	struct SymbolSpec
+	{
+		const char* symbol;
+		double mid_price;
+		double tick_size;
+	};
+
+	// Same instruments as the simulator's asset list, then generic ones
+	constexpr SymbolSpec known_symbols[] = {
+		{ "BTC-USDT-SWAP", 95000.0, 0.1 },
+		{ "ETH-USDT-SWAP", 3500.0, 0.01 },
+		{ "SOL-USDT-SWAP", 150.0, 0.01 },
+		{ "XRP-USDT-SWAP", 0.5, 0.0001 },
+		{ "ADA-USDT-SWAP", 0.7, 0.0001 },
+		{ "DOT-USDT-SWAP", 7.0, 0.001 },
+	};
+	constexpr int known_symbol_count = sizeof(known_symbols) / sizeof(known_symbols[0]);
+
+	QTextStream& out()
+	{
+		static QTextStream stream(stdout);
+		return stream;
+	}
+}
+
+namespace Quant
+{
+	QuantMockExchange::QuantMockExchange(const MockExchangeConfig& config, QObject* parent)
+		: QObject(parent), m_config(config), m_server("QuantMockExchange", QWebSocketServer::NonSecureMode), m_delay_random(config.seed), m_rate(config.rate)
+	{
+		for (int idx = 0; idx < qMax(1, m_config.symbol_count); idx++)
+		{
+			const SymbolSpec spec = idx < known_symbol_count
+				? known_symbols[idx]
+				: SymbolSpec{ nullptr, 100.0, 0.01 };
+			const QString symbol = spec.symbol ? QString(spec.symbol) : QString("SYN%1-USDT-SWAP").arg(idx);
+
+			m_books.push_back(std::make_unique<QuantSyntheticBook>(m_config.exchange, symbol, spec.mid_price, spec.tick_size, m_config.depth, m_config.seed + idx));
+		}
+
+		QObject::connect(&m_server, &QWebSocketServer::newConnection, this, &QuantMockExchange::OnNewConnection);
+		QObject::connect(&m_tick_timer, &QTimer::timeout, this, &QuantMockExchange::OnTick);
+		QObject::connect(&m_report_timer, &QTimer::timeout, this, &QuantMockExchange::OnReport);
+	}
+
+	QuantMockExchange::~QuantMockExchange()
+	{
+		m_server.close();
+		qDeleteAll(m_clients.keys());
+	}
+
+	bool QuantMockExchange::Start()
+	{
+		if (!m_config.replay_file.isEmpty() && !LoadReplay())
+			return false;
+
+		if (!m_server.listen(QHostAddress::LocalHost, m_config.port))
+		{
+			out() << "Mock exchange: cannot listen on port " << m_config.port << ": " << m_server.errorString() << Qt::endl;
+			return false;
+		}
+
+		out() << "Mock exchange: ws://127.0.0.1:" << m_server.serverPort()
+			<< " serving " << (m_replay.isEmpty() ? QString("%1 synthetic symbols").arg(m_books.size()) : QString("%1 replayed messages").arg(m_replay.size()))
+			<< " at " << m_rate << " msg/s" << Qt::endl;
+		if (m_config.delay_ms > 0 || m_config.jitter_ms > 0.0)
+			out() << "Mock exchange: injecting " << m_config.delay_ms << " ms delay, " << m_config.jitter_ms << " ms mean jitter" << Qt::endl;
+
+		if (m_config.align_start_s <= 0)
+		{
+			StartFeed();
+			return true;
+		}
+
+		// Servers started within the same period begin together
+		const qint64 period_ms = m_config.align_start_s * 1000ll;
+		const qint64 wait_ms = period_ms - QDateTime::currentMSecsSinceEpoch() % period_ms;
+		out() << "Mock exchange: feed starts in " << wait_ms << " ms" << Qt::endl;
+		QTimer::singleShot(static_cast<int>(wait_ms), Qt::PreciseTimer, this, &QuantMockExchange::StartFeed);
+		return true;
+	}
+
+	void QuantMockExchange::StartFeed()
+	{
+		m_feed_started = true;
+		m_clock.start();
+		m_tick_timer.setTimerType(Qt::PreciseTimer);
+		m_tick_timer.start(1);
+		m_report_timer.start(1000);
+	}
+
+	bool QuantMockExchange::LoadReplay()
+	{
+		QFile file(m_config.replay_file);
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			out() << "Mock exchange: cannot open replay file " << m_config.replay_file << Qt::endl;
+			return false;
+		}
+
+		while (!file.atEnd())
+		{
+			const QByteArray line = file.readLine().trimmed();
+			if (!line.isEmpty())
+				m_replay.append(line);
+		}
+
+		return !m_replay.isEmpty();
+	}
+
+	void QuantMockExchange::OnNewConnection()
+	{
+		while (QWebSocket* socket = m_server.nextPendingConnection())
+		{
+			QObject::connect(socket, &QWebSocket::textMessageReceived, this, &QuantMockExchange::OnTextMessage);
+			QObject::connect(socket, &QWebSocket::disconnected, this, &QuantMockExchange::OnClientDisconnected);
+			m_clients.insert(socket, Client());
+
+			out() << "Mock exchange: client connected, " << m_clients.size() << " total" << Qt::endl;
+
+			// Until it subscribes, a client receives every symbol
+			if (m_feed_started)
+				SendSnapshots(socket, QSet<QString>());
+		}
+	}
+
+	void QuantMockExchange::OnTextMessage(const QString& message)
+	{
+		QWebSocket* socket = qobject_cast<QWebSocket*>(sender());
+		auto client = m_clients.find(socket);
+		if (client == m_clients.end())
+			return;
+
+		const QJsonObject request = QJsonDocument::fromJson(message.toUtf8()).object();
+		const QString op = request["op"].toString();
+		if (op != "subscribe" && op != "unsubscribe")
+			return;
+
+		QSet<QString> symbols;
+		for (const QJsonValue& arg : request["args"].toArray())
+		{
+			const QString symbol = arg.toObject()["instId"].toString();
+			if (symbol.isEmpty())
+				continue;
+
+			symbols.insert(symbol);
+
+			QJsonObject ack;
+			ack["event"] = op;
+			ack["arg"] = arg;
+			socket->sendTextMessage(QString::fromUtf8(QJsonDocument(ack).toJson(QJsonDocument::Compact)));
+		}
+
+		if (op == "subscribe")
+		{
+			client->symbols.unite(symbols);
+			if (m_feed_started)
+				SendSnapshots(socket, symbols);
+		}
+		else
+			client->symbols.subtract(symbols);
+	}
+
+	void QuantMockExchange::OnClientDisconnected()
+	{
+		QWebSocket* socket = qobject_cast<QWebSocket*>(sender());
+		if (!socket)
+			return;
+
+		m_clients.remove(socket);
+		socket->deleteLater();
+
+		// Snapshots still held back for it
+		m_delayed.erase(std::remove_if(m_delayed.begin(), m_delayed.end(), [socket](const DelayedMessage& delayed)
+			{
+				return delayed.socket == socket;
+			}), m_delayed.end());
+		out() << "Mock exchange: client disconnected, " << m_clients.size() << " left" << Qt::endl;
+	}
+
+	void QuantMockExchange::SendSnapshots(QWebSocket* socket, const QSet<QString>& symbols)
+	{
+		// Replayed logs carry their own snapshots
+		if (!m_replay.isEmpty())
+			return;
+
+		for (const auto& book : m_books)
+		{
+			if (symbols.isEmpty() || symbols.contains(book->Symbol()))
+				Deliver(socket, book->Symbol(), book->Snapshot());
+		}
+	}
+
+	void QuantMockExchange::Broadcast(const QString& symbol, const QByteArray& message)
+	{
+		Deliver(nullptr, symbol, message);
+	}
+
+	void QuantMockExchange::Deliver(QWebSocket* socket, const QString& symbol, const QByteArray& message)
+	{
+		if (m_config.delay_ms > 0 || m_config.jitter_ms > 0.0)
+		{
+			qint64 delay_ns = m_config.delay_ms * 1000000ll;
+			if (m_config.jitter_ms > 0.0)
+				delay_ns += static_cast<qint64>(std::exponential_distribution<double>(1.0 / m_config.jitter_ms)(m_delay_random) * 1.0e6);
+
+			// A TCP stream keeps its order, so a message never overtakes the one before it
+			qint64 due_ns = m_clock.nsecsElapsed() + delay_ns;
+			if (!m_delayed.empty())
+				due_ns = qMax(due_ns, m_delayed.back().due_ns);
+
+			m_delayed.push_back({ due_ns, socket, symbol, message });
+			return;
+		}
+
+		const QString text = QString::fromUtf8(message);
+		if (socket)
+		{
+			socket->sendTextMessage(text);
+			return;
+		}
+
+		for (auto it = m_clients.begin(); it != m_clients.end(); ++it)
+		{
+			if (symbol.isEmpty() || it->symbols.isEmpty() || it->symbols.contains(symbol))
+				it.key()->sendTextMessage(text);
+		}
+	}
+
+	void QuantMockExchange::FlushDelayed(qint64 now_ns)
+	{
+		while (!m_delayed.empty() && m_delayed.front().due_ns <= now_ns)
+		{
+			const DelayedMessage delayed = std::move(m_delayed.front());
+			m_delayed.pop_front();
+
+			const QString text = QString::fromUtf8(delayed.message);
+			for (auto it = m_clients.begin(); it != m_clients.end(); ++it)
+			{
+				// A snapshot goes to its client only
+				if (delayed.socket ? it.key() == delayed.socket : (delayed.symbol.isEmpty() || it->symbols.isEmpty() || it->symbols.contains(delayed.symbol)))
+					it.key()->sendTextMessage(text);
+			}
+		}
+	}
+
+	void QuantMockExchange::SendNext()
+	{
+		if (!m_replay.isEmpty())
+		{
+			Broadcast(QString(), m_replay[m_next_replay]);
+			m_next_replay = (m_next_replay + 1) % m_replay.size();
+		}
+		else
+		{
+			QuantSyntheticBook& book = *m_books[m_next_book];
+			m_next_book = (m_next_book + 1) % static_cast<int>(m_books.size());
+
+			// Injected gap: the book moves on but the update is never sent
+			if (m_config.gap_every > 0 && (m_sent_total + 1) % m_config.gap_every == 0)
+				book.SkipSequence(m_config.levels_per_update);
+
+			const bool snapshot = m_config.snapshot_every > 0 && (m_sent_total + 1) % m_config.snapshot_every == 0;
+			Broadcast(book.Symbol(), snapshot ? book.Snapshot() : book.NextUpdate(m_config.levels_per_update));
+		}
+
+		m_sent_total++;
+		m_sent_since_report++;
+
+		// Injected disconnect of the oldest client
+		if (m_config.disconnect_every > 0 && m_sent_total % m_config.disconnect_every == 0 && !m_clients.isEmpty())
+		{
+			out() << "Mock exchange: injecting disconnect" << Qt::endl;
+			m_clients.begin().key()->close(QWebSocketProtocol::CloseCodeGoingAway, "Injected disconnect");
+		}
+	}
+
+	void QuantMockExchange::OnTick()
+	{
+		const qint64 now_ns = m_clock.nsecsElapsed();
+		const double elapsed_s = (now_ns - m_last_tick_ns) / 1.0e9;
+		m_last_tick_ns = now_ns;
+		FlushDelayed(now_ns);
+
+		// Credits accrue at the configured rate, at most one second of catch-up
+		m_credits = qMin(m_credits + m_rate * elapsed_s, qMax(1.0, m_rate));
+
+		if (m_config.burst_interval_ms > 0 && now_ns - m_last_burst_ns < m_config.burst_interval_ms * 1000000ll)
+			return;
+		m_last_burst_ns = now_ns;
+
+		// An aligned feed runs on the wall clock, clients or not
+		if (m_clients.isEmpty() && m_config.align_start_s <= 0)
+		{
+			m_credits = 0.0;
+			return;
+		}
+
+		while (m_credits >= 1.0)
+		{
+			SendNext();
+			m_credits -= 1.0;
+		}
+	}
+
+	qint64 QuantMockExchange::MaxBacklog() const
+	{
+		qint64 backlog = 0;
+		for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it)
+			backlog = qMax(backlog, it.key()->bytesToWrite());
+		return backlog;
+	}
+
+	void QuantMockExchange::OnReport()
+	{
+		const qint64 elapsed_ms = m_clock.elapsed();
+		const qint64 backlog = MaxBacklog();
+
+		out() << "t=" << elapsed_ms / 1000 << "s target=" << m_rate << " msg/s sent=" << m_sent_since_report
+			<< " msg/s clients=" << m_clients.size() << " backlog=" << backlog << " bytes" << Qt::endl;
+		m_sent_since_report = 0;
+
+		if (m_config.ramp_step > 0.0 && elapsed_ms - m_last_ramp_ms >= m_config.ramp_interval_s * 1000ll)
+		{
+			// A backlog that grew over the whole step means the client cannot keep up
+			if (backlog > m_config.backlog_limit_bytes && backlog > m_ramp_start_backlog)
+			{
+				out() << "Saturation: clients fall behind at " << m_rate << " msg/s, last sustained rate "
+					<< m_rate - m_config.ramp_step << " msg/s" << Qt::endl;
+				m_config.ramp_step = 0.0;
+				emit finished();
+				return;
+			}
+
+			m_rate += m_config.ramp_step;
+			m_last_ramp_ms = elapsed_ms;
+			m_ramp_start_backlog = backlog;
+		}
+
+		if (m_config.duration_s > 0 && elapsed_ms >= m_config.duration_s * 1000ll)
+		{
+			out() << "Mock exchange: sent " << m_sent_total << " messages in " << elapsed_ms / 1000.0 << " s" << Qt::endl;
+			emit finished();
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QtWebSockets/QWebSocket>
+#include <QtWebSockets/QWebSocketServer>
+
+#include "QuantSyntheticBook.h"
+
+namespace Quant
+{
+	struct MockExchangeConfig
+	{
+		quint16 port = 8765;
+		QString exchange = "OKX";
+
+		// Synthetic feed
+		int symbol_count = 1;
+		int depth = 50;
+		int levels_per_update = 4;
+		int snapshot_every = 0; // Periodic full snapshots, 0 disables
+		quint32 seed = 1;
+
+		// Captured log replay (one message per line), replaces the synthetic feed
+		QString replay_file;
+
+		// Average messages per second; with burst_interval_ms the messages accumulated
+		// since the last burst are released at once, 0 spreads them evenly
+		double rate = 1000.0;
+		int burst_interval_ms = 0;
+
+		// Saturation search: add ramp_step msg/s every ramp_interval_s until clients fall behind
+		double ramp_step = 0.0;
+		int ramp_interval_s = 5;
+		qint64 backlog_limit_bytes = 4 * 1024 * 1024;
+
+		// Fault injection, counted in sent messages, 0 disables
+		int disconnect_every = 0;
+		int gap_every = 0;
+
+		// Injected latency: every message waits delay_ms plus an exponential jitter
+		// with mean jitter_ms, in order
+		int delay_ms = 0;
+		double jitter_ms = 0.0;
+
+		// Starts the feed at the next multiple of align_start_s seconds of wall time and
+		// runs it with or without clients, so servers started with the same seed send
+		// the same sequence numbers at the same time; 0 starts right away
+		int align_start_s = 0;
+
+		// Run time in seconds, 0 runs until interrupted
+		int duration_s = 0;
+	};
+
+	/**
+	 * Local mock exchange for deterministic load testing
+	 *
+	 * Serves the documented L2 format over QWebSocketServer: a snapshot per symbol on
+	 * subscription followed by deltas, either from QuantSyntheticBook or replayed from
+	 * captured logs. Rate, burst pattern, depth and symbol count are configurable, and
+	 * disconnects, sequence gaps and latency can be injected.
+	 *
+	 * Two servers with the same seed, an aligned start and different injected
+	 * latency serve an A/B pair of the same feed for redundant-line testing.
+	 *
+	 * Clients may subscribe OKX style:
+	 *   {"op":"subscribe","args":[{"channel":"books","instId":"BTC-USDT-SWAP"}]}
+	 * Clients that never subscribe receive every symbol.
+	 *
+	 * Once per second the server prints the sent rate and the largest client backlog
+	 * (bytes queued in the socket). A backlog that keeps growing means the client
+	 * pipeline is saturated; with ramp_step set the server raises the rate until that
+	 * happens and reports the saturation point.
+	 */
+	class QuantMockExchange : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		explicit QuantMockExchange(const MockExchangeConfig& config, QObject* parent = nullptr);
+		~QuantMockExchange();
+
+	public:
+		bool Start();
+
+	signals:
+		void finished();
+
+	private slots:
+		void OnNewConnection();
+		void OnTextMessage(const QString& message);
+		void OnClientDisconnected();
+		void OnTick();
+		void OnReport();
+
+	private:
+		struct Client
+		{
+			QSet<QString> symbols; // Empty means every symbol
+		};
+
+		bool LoadReplay();
+		void SendNext();
+		void Broadcast(const QString& symbol, const QByteArray& message);
+		void Deliver(QWebSocket* socket, const QString& symbol, const QByteArray& message);
+		void FlushDelayed(qint64 now_ns);
+		void StartFeed();
+		void SendSnapshots(QWebSocket* socket, const QSet<QString>& symbols);
+		qint64 MaxBacklog() const;
+
+	private:
+		MockExchangeConfig m_config;
+		QWebSocketServer m_server;
+		QHash<QWebSocket*, Client> m_clients;
+
+		// Messages held back by the injected latency; no socket means every subscribed client
+		struct DelayedMessage
+		{
+			qint64 due_ns = 0;
+			QWebSocket* socket = nullptr;
+			QString symbol;
+			QByteArray message;
+		};
+		std::deque<DelayedMessage> m_delayed;
+		std::mt19937 m_delay_random;
+		bool m_feed_started = false;
+
+		std::vector<std::unique_ptr<QuantSyntheticBook>> m_books;
+		QList<QByteArray> m_replay;
+		int m_next_book = 0;
+		int m_next_replay = 0;
+
+		QTimer m_tick_timer;
+		QTimer m_report_timer;
+		QElapsedTimer m_clock;
+		qint64 m_last_tick_ns = 0;
+		double m_credits = 0.0;
+		qint64 m_last_burst_ns = 0;
+
+		double m_rate = 0.0;
+		qint64 m_sent_total = 0;
+		qint64 m_sent_since_report = 0;
+		qint64 m_last_ramp_ms = 0;
+		qint64 m_ramp_start_backlog = 0;
+	};
+}
@@ -0,0 +1,147 @@
+#include "QuantSyntheticBook.h"
+
+#include <cmath>
+
+#include <QDateTime>
+
+namespace Quant
+{
+	QuantSyntheticBook::QuantSyntheticBook(const QString& exchange, const QString& symbol, double mid_price, double tick_size, int depth, quint32 seed)
+		: m_exchange(exchange), m_symbol(symbol), m_tick_size(tick_size), m_depth(qMax(1, depth)), m_random(seed)
+	{
+		m_price_decimals = qMax(0, static_cast<int>(std::ceil(-std::log10(tick_size) - 1e-9)));
+
+		// Start with a one tick spread around the mid
+		const qint64 mid_ticks = static_cast<qint64>(std::llround(mid_price / tick_size));
+		for (int level = 0; level < m_depth; level++)
+		{
+			m_bids[mid_ticks - 1 - level] = RandomAmount();
+			m_asks[mid_ticks + level] = RandomAmount();
+		}
+	}
+
+	double QuantSyntheticBook::RandomAmount()
+	{
+		// Heavy-tailed sizes, rounded to 4 decimals like most venues
+		std::exponential_distribution<double> size(0.5);
+		return std::round((0.0001 + size(m_random)) * 10000.0) / 10000.0;
+	}
+
+	void QuantSyntheticBook::AppendLevel(QByteArray& out, qint64 ticks, double amount) const
+	{
+		if (!out.isEmpty())
+			out += ',';
+
+		out += "[\"";
+		out += QByteArray::number(ticks * m_tick_size, 'f', m_price_decimals);
+		out += "\",\"";
+		out += QByteArray::number(amount, 'f', 4);
+		out += "\"]";
+	}
+
+	QByteArray QuantSyntheticBook::Header(const char* action, qint64 prev_seq_id) const
+	{
+		QByteArray out;
+		out.reserve(256);
+		out += "{\"action\":\"";
+		out += action;
+		out += "\",\"timestamp\":\"";
+		out += QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toLatin1();
+		out += "\",\"exchange\":\"";
+		out += m_exchange.toLatin1();
+		out += "\",\"symbol\":\"";
+		out += m_symbol.toLatin1();
+		out += "\",\"seqId\":";
+		out += QByteArray::number(m_seq_id);
+		out += ",\"prevSeqId\":";
+		out += QByteArray::number(prev_seq_id);
+		return out;
+	}
+
+	QByteArray QuantSyntheticBook::Snapshot() const
+	{
+		QByteArray bids;
+		QByteArray asks;
+		for (const auto& level : m_bids)
+			AppendLevel(bids, level.first, level.second);
+		for (const auto& level : m_asks)
+			AppendLevel(asks, level.first, level.second);
+
+		return Header("snapshot", -1) + ",\"asks\":[" + asks + "],\"bids\":[" + bids + "]}";
+	}
+
+	template <typename Side>
+	void QuantSyntheticBook::MutateSide(Side& side, bool is_bids, QByteArray& changes)
+	{
+		if (side.empty())
+			return;
+
+		// Activity concentrates near the top of the book
+		std::geometric_distribution<int> level_pick(0.25);
+		std::uniform_real_distribution<double> action_pick(0.0, 1.0);
+
+		const int level = qMin(level_pick(m_random), static_cast<int>(side.size()) - 1);
+		auto it = side.begin();
+		std::advance(it, level);
+
+		const double action = action_pick(m_random);
+		if (action < 0.7)
+		{
+			// Amount change
+			it->second = RandomAmount();
+			AppendLevel(changes, it->first, it->second);
+		}
+		else if (action < 0.85 && side.size() > 1)
+		{
+			// Level removal
+			AppendLevel(changes, it->first, 0.0);
+			side.erase(it);
+		}
+		else
+		{
+			// New level one tick better than the chosen one, without crossing the book
+			const qint64 best_other = is_bids ? m_asks.begin()->first : m_bids.begin()->first;
+			const qint64 candidate = is_bids ? it->first + 1 : it->first - 1;
+			const bool crosses = is_bids ? candidate >= best_other : candidate <= best_other;
+			if (!crosses && side.find(candidate) == side.end())
+			{
+				const double amount = RandomAmount();
+				side[candidate] = amount;
+				AppendLevel(changes, candidate, amount);
+			}
+		}
+
+		// Keep the side at the configured depth
+		while (static_cast<int>(side.size()) > m_depth)
+		{
+			auto worst = std::prev(side.end());
+			AppendLevel(changes, worst->first, 0.0);
+			side.erase(worst);
+		}
+		while (static_cast<int>(side.size()) < m_depth)
+		{
+			const qint64 next = is_bids ? std::prev(side.end())->first - 1 : std::prev(side.end())->first + 1;
+			const double amount = RandomAmount();
+			side[next] = amount;
+			AppendLevel(changes, next, amount);
+		}
+	}
+
+	QByteArray QuantSyntheticBook::NextUpdate(int levels_changed)
+	{
+		QByteArray bids;
+		QByteArray asks;
+		std::bernoulli_distribution bid_side(0.5);
+
+		for (int change = 0; change < qMax(1, levels_changed); change++)
+		{
+			if (bid_side(m_random))
+				MutateSide(m_bids, true, bids);
+			else
+				MutateSide(m_asks, false, asks);
+		}
+
+		const qint64 prev_seq_id = m_seq_id++;
+		return Header("update", prev_seq_id) + ",\"asks\":[" + asks + "],\"bids\":[" + bids + "]}";
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <random>
+
+#include <QByteArray>
+#include <QString>
+
+namespace Quant
+{
+	/**
+	 * Deterministic synthetic L2 book for one symbol
+	 *
+	 * Prices are kept in integer ticks so levels never drift through rounding. Every
+	 * update touches a few levels near the top of the book (amount changes, removals
+	 * and new levels) without ever crossing the book, and keeps each side close to
+	 * the configured depth. Messages use the documented L2 JSON format with
+	 * "action", "seqId" and "prevSeqId".
+	 *
+	 * The same seed always produces the same message stream.
+	 */
+	class QuantSyntheticBook
+	{
+	public:
+		QuantSyntheticBook(const QString& exchange, const QString& symbol, double mid_price, double tick_size, int depth, quint32 seed);
+
+	public:
+		QByteArray Snapshot() const;
+		QByteArray NextUpdate(int levels_changed);
+
+		// Applies an update that is never sent, so the next update reports a gap
+		void SkipSequence(int levels_changed) { NextUpdate(levels_changed); }
+
+		const QString& Symbol() const { return m_symbol; }
+		qint64 SeqId() const { return m_seq_id; }
+
+	private:
+		using BidSide = std::map<qint64, double, std::greater<qint64>>;
+		using AskSide = std::map<qint64, double>;
+
+		template <typename Side>
+		void MutateSide(Side& side, bool is_bids, QByteArray& changes);
+
+		double RandomAmount();
+		void AppendLevel(QByteArray& out, qint64 ticks, double amount) const;
+		QByteArray Header(const char* action, qint64 prev_seq_id) const;
+
+	private:
+		QString m_exchange;
+		QString m_symbol;
+		double m_tick_size = 0.1;
+		int m_price_decimals = 1;
+		int m_depth = 50;
+
+		BidSide m_bids;
+		AskSide m_asks;
+
+		qint64 m_seq_id = 1;
+		std::mt19937 m_random;
+	};
+}
@@ -0,0 +1,68 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include "QuantMockExchange.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QuantMockExchange");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local mock exchange serving L2 order book snapshots and deltas over WebSocket");
+    parser.addHelpOption();
+
+    const QCommandLineOption port_option("port", "Listening port.", "port", "8765");
+    const QCommandLineOption exchange_option("exchange", "Exchange name put in messages.", "name", "OKX");
+    const QCommandLineOption symbols_option("symbols", "Number of synthetic symbols.", "count", "1");
+    const QCommandLineOption depth_option("depth", "Levels per side.", "levels", "50");
+    const QCommandLineOption levels_option("levels-per-update", "Levels changed per delta.", "levels", "4");
+    const QCommandLineOption snapshot_option("snapshot-every", "Send a full snapshot every N messages (0 = never).", "count", "0");
+    const QCommandLineOption seed_option("seed", "Random seed of the synthetic feed.", "seed", "1");
+    const QCommandLineOption replay_option("replay", "Replay captured messages (one JSON message per line).", "file");
+    const QCommandLineOption rate_option("rate", "Messages per second.", "rate", "1000");
+    const QCommandLineOption burst_option("burst-interval", "Release messages in bursts every N ms (0 = even).", "ms", "0");
+    const QCommandLineOption ramp_option("ramp-step", "Raise the rate by N msg/s per ramp interval until clients saturate.", "rate", "0");
+    const QCommandLineOption ramp_interval_option("ramp-interval", "Seconds per ramp step.", "seconds", "5");
+    const QCommandLineOption backlog_option("backlog-limit", "Client backlog in bytes that counts as saturated.", "bytes", "4194304");
+    const QCommandLineOption disconnect_option("disconnect-every", "Disconnect the oldest client every N messages.", "count", "0");
+    const QCommandLineOption gap_option("gap-every", "Drop one delta every N messages to create a sequence gap.", "count", "0");
+    const QCommandLineOption delay_option("delay", "Injected latency per message in ms.", "ms", "0");
+    const QCommandLineOption jitter_option("jitter", "Mean of an exponential extra latency in ms.", "ms", "0");
+    const QCommandLineOption align_option("align-start", "Start the feed at the next multiple of N seconds of wall time, with or without clients.", "seconds", "0");
+    const QCommandLineOption duration_option("duration", "Stop after N seconds (0 = run until interrupted).", "seconds", "0");
+
+    parser.addOptions({ port_option, exchange_option, symbols_option, depth_option, levels_option, snapshot_option,
+        seed_option, replay_option, rate_option, burst_option, ramp_option, ramp_interval_option, backlog_option,
+        disconnect_option, gap_option, delay_option, jitter_option, align_option, duration_option });
+    parser.process(app);
+
+    Quant::MockExchangeConfig config;
+    config.port = static_cast<quint16>(parser.value(port_option).toUInt());
+    config.exchange = parser.value(exchange_option);
+    config.symbol_count = parser.value(symbols_option).toInt();
+    config.depth = parser.value(depth_option).toInt();
+    config.levels_per_update = parser.value(levels_option).toInt();
+    config.snapshot_every = parser.value(snapshot_option).toInt();
+    config.seed = parser.value(seed_option).toUInt();
+    config.replay_file = parser.value(replay_option);
+    config.rate = parser.value(rate_option).toDouble();
+    config.burst_interval_ms = parser.value(burst_option).toInt();
+    config.ramp_step = parser.value(ramp_option).toDouble();
+    config.ramp_interval_s = parser.value(ramp_interval_option).toInt();
+    config.backlog_limit_bytes = parser.value(backlog_option).toLongLong();
+    config.disconnect_every = parser.value(disconnect_option).toInt();
+    config.gap_every = parser.value(gap_option).toInt();
+    config.delay_ms = parser.value(delay_option).toInt();
+    config.jitter_ms = parser.value(jitter_option).toDouble();
+    config.align_start_s = parser.value(align_option).toInt();
+    config.duration_s = parser.value(duration_option).toInt();
+
+    Quant::QuantMockExchange exchange(config);
+    QObject::connect(&exchange, &Quant::QuantMockExchange::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+
+    if (!exchange.Start())
+        return 1;
+
+    return app.exec();
+}
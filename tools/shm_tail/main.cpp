@@ -0,0 +1,133 @@
+// Follows the books or results the simulator publishes to shared memory.
+// Plain C++ on purpose: it only needs the QuantShmReader library, like any other consumer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "QuantShmReader.h"
+
+namespace
+{
+	using namespace Quant;
+
+	constexpr int idle_sleep_us = 100;
+	constexpr int replaced_check_interval = 10000; // Idle polls between checks for a restarted publisher
+
+	struct Options
+	{
+		std::string prefix = ShmFormat::default_prefix;
+		bool results = false;
+		bool replay = false;
+		int depth = 1;
+	};
+
+	void PrintUsage()
+	{
+		std::printf("Usage: QuantShmTail [--prefix name] [--results] [--replay] [--depth levels]\n"
+			"  --prefix   segment prefix of the publisher (default %s)\n"
+			"  --results  follow cost results instead of books\n"
+			"  --replay   start with the records the ring still holds\n"
+			"  --depth    levels per side printed for books (default 1)\n", ShmFormat::default_prefix);
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int idx = 1; idx < argc; idx++)
+		{
+			const std::string arg = argv[idx];
+			if (arg == "--prefix" && idx + 1 < argc)
+				options.prefix = argv[++idx];
+			else if (arg == "--results")
+				options.results = true;
+			else if (arg == "--replay")
+				options.replay = true;
+			else if (arg == "--depth" && idx + 1 < argc)
+				options.depth = std::atoi(argv[++idx]);
+			else
+				return false;
+		}
+		return true;
+	}
+
+	void Print(const ShmFormat::BookRecord& book, int depth)
+	{
+		std::printf("%lld %.*s v%llu seq %lld%s", static_cast<long long>(book.timestamp_ns), ShmFormat::symbol_size, book.symbol,
+			static_cast<unsigned long long>(book.version), static_cast<long long>(book.seq_id), book.stale ? " stale" : "");
+		for (int idx = 0; idx < depth && idx < static_cast<int>(book.bid_count); idx++)
+			std::printf(" bid %.10g x %.10g", book.bids[idx].price, book.bids[idx].amount);
+		for (int idx = 0; idx < depth && idx < static_cast<int>(book.ask_count); idx++)
+			std::printf(" ask %.10g x %.10g", book.asks[idx].price, book.asks[idx].amount);
+		std::printf("\n");
+	}
+
+	void Print(const ShmFormat::ResultRecord& result, int)
+	{
+		std::printf("%lld %.*s v%llu usd %.10g slippage %.10g fees %.10g impact %.10g net %.10g maker %.4f %.3fms\n",
+			static_cast<long long>(result.timestamp_ns), ShmFormat::symbol_size, result.symbol,
+			static_cast<unsigned long long>(result.book_version), result.usd_amount, result.slippage, result.fees,
+			result.market_impact, result.net_cost, result.maker_ratio, result.processing_time_ms);
+	}
+
+	template <typename Record>
+	int Follow(const Options& options, ShmFormat::RECORD_KIND kind, const char* suffix)
+	{
+		const std::string name = "/" + options.prefix + suffix;
+		QuantShmReader reader;
+		if (!reader.Open(name, kind))
+		{
+			std::fprintf(stderr, "%s\n", reader.Error().c_str());
+			return 1;
+		}
+		if (options.replay)
+			reader.SeekToOldest();
+
+		Record record;
+		std::uint64_t skipped = 0;
+		int idle_polls = 0;
+		while (true)
+		{
+			if (reader.Next(record))
+			{
+				if (reader.Skipped() != skipped)
+				{
+					std::fprintf(stderr, "lapped by the publisher, %llu records lost\n", static_cast<unsigned long long>(reader.Skipped() - skipped));
+					skipped = reader.Skipped();
+				}
+				Print(record, options.depth);
+				idle_polls = 0;
+				continue;
+			}
+
+			if (++idle_polls >= replaced_check_interval)
+			{
+				idle_polls = 0;
+				if (reader.IsReplaced())
+				{
+					std::fprintf(stderr, "%s was replaced, reopening\n", name.c_str());
+					while (!reader.Open(name, kind))
+						std::this_thread::sleep_for(std::chrono::seconds(1));
+					skipped = 0;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(idle_sleep_us));
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (options.results)
+		return Follow<ShmFormat::ResultRecord>(options, ShmFormat::RESULT, ShmFormat::results_suffix);
+	return Follow<ShmFormat::BookRecord>(options, ShmFormat::BOOK, ShmFormat::books_suffix);
+}